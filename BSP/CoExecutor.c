@@ -0,0 +1,373 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2019 Brian Amos
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "CoExecutor.h"
+
+static void coExecutorTask( void* Parameters );
+
+/**
+ * create the task that runs Executor's coroutines
+ * @param StackWords	must be large enough for the deepest coroutine
+ * 						(they all run on this stack)
+ */
+void CoExecutorInit( CoExecutor* Executor, const char* Name, uint16_t StackWords, UBaseType_t Priority )
+{
+	vListInitialise(&Executor->ready);
+	vListInitialise(&Executor->blocked);
+	Executor->eventPending = pdFALSE;
+	Executor->lastCheck = 0;
+	Executor->nextTimeout = portMAX_DELAY;
+	Executor->resumes = 0;
+	const BaseType_t created = xTaskCreate(coExecutorTask, Name, StackWords, Executor, Priority, &Executor->task);
+	configASSERT(created == pdPASS);
+	(void) created;
+}
+
+/**
+ * add a coroutine to Executor, Function will be called from the beginning
+ * the next time Executor runs
+ *
+ * Executor's lists aren't protected, so only call this before the
+ * scheduler is started or from a coroutine running on Executor
+ */
+void CoStart( CoExecutor* Executor, Coroutine* Co, CoFunction Function, void* Context )
+{
+	vListInitialiseItem(&Co->listItem);
+	listSET_LIST_ITEM_OWNER(&Co->listItem, Co);
+	Co->function = Function;
+	Co->context = Context;
+	Co->executor = Executor;
+	Co->waitObject = NULL;
+	Co->notifiedValue = 0;
+	Co->resumePoint = 0;
+	Co->waitType = CO_WAIT_NONE;
+	Co->timedOut = pdFALSE;
+	vListInsertEnd(&Executor->ready, &Co->listItem);
+}
+
+/**
+ * have Executor check its waiting coroutines - call after sending to a
+ * queue or stream buffer that a coroutine may be waiting on
+ */
+void CoExecutorWake( CoExecutor* Executor )
+{
+	Executor->eventPending = pdTRUE;
+	xTaskNotifyIndexed(Executor->task, CO_EXECUTOR_NOTIFY_INDEX, 0, eNoAction);
+}
+
+void CoExecutorWakeFromISR( CoExecutor* Executor, BaseType_t* HigherPriorityTaskWoken )
+{
+	Executor->eventPending = pdTRUE;
+	xTaskNotifyIndexedFromISR(Executor->task, CO_EXECUTOR_NOTIFY_INDEX, 0, eNoAction, HigherPriorityTaskWoken);
+}
+
+/**
+ * set Bits in Co's notification value (see CoNotifyWait)
+ * may be called from any task, including coroutines on any executor
+ */
+void CoNotify( Coroutine* Co, uint32_t Bits )
+{
+	CoExecutor* executor = Co->executor;
+
+	taskENTER_CRITICAL();
+	Co->notifiedValue |= Bits;
+	taskEXIT_CRITICAL();
+
+	if(xTaskGetCurrentTaskHandle() == executor->task)
+	{
+		//a coroutine on the same executor, the lists can be used directly
+		//instead of making the executor check every waiting coroutine
+		if(	Co->waitType == CO_WAIT_NOTIFY &&
+			listIS_CONTAINED_WITHIN(&executor->blocked, &Co->listItem))
+		{
+			(void) uxListRemove(&Co->listItem);
+			vListInsertEnd(&executor->ready, &Co->listItem);
+		}
+	}
+	else
+	{
+		CoExecutorWake(executor);
+	}
+}
+
+void CoNotifyFromISR( Coroutine* Co, uint32_t Bits, BaseType_t* HigherPriorityTaskWoken )
+{
+	UBaseType_t savedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
+	Co->notifiedValue |= Bits;
+	taskEXIT_CRITICAL_FROM_ISR(savedInterruptStatus);
+
+	CoExecutorWakeFromISR(Co->executor, HigherPriorityTaskWoken);
+}
+
+/**
+ * the operation Co was waiting for has completed (or it never had to wait)
+ */
+static BaseType_t waitEnd( Coroutine* Co, BaseType_t Result )
+{
+	Co->waitType = CO_WAIT_NONE;
+	Co->waitObject = NULL;
+	Co->timedOut = pdFALSE;
+	return Result;
+}
+
+/**
+ * the operation couldn't complete immediately - start waiting if this is the
+ * first attempt, otherwise keep waiting until the wait times out
+ */
+static BaseType_t waitContinue( Coroutine* Co, CoWaitType Type, void* Object, TickType_t TicksToWait )
+{
+	if(Co->waitType == CO_WAIT_NONE)
+	{
+		if(TicksToWait == 0)
+		{
+			return pdFAIL;
+		}
+		Co->waitType = Type;
+		Co->waitObject = Object;
+		Co->waitStart = xTaskGetTickCount();
+		Co->waitTicks = TicksToWait;
+		return CO_PENDING;
+	}
+
+	if(Co->timedOut)
+	{
+		return waitEnd(Co, pdFAIL);
+	}
+	return CO_PENDING;
+}
+
+/**
+ * suspend Co for Ticks
+ * @returns pdPASS
+ */
+BaseType_t CoDelay( Coroutine* Co, TickType_t Ticks )
+{
+	if(Co->waitType == CO_WAIT_NONE)
+	{
+		if(Ticks == 0)
+		{
+			return pdPASS;
+		}
+		(void) waitContinue(Co, CO_WAIT_DELAY, NULL, Ticks);
+		return CO_PENDING;
+	}
+
+	//delays only end by timing out
+	return Co->timedOut ? waitEnd(Co, pdPASS) : CO_PENDING;
+}
+
+/**
+ * receive an item from Queue (see xQueueReceive)
+ * @returns pdPASS if an item was copied into Buffer, pdFAIL if none arrived in time
+ */
+BaseType_t CoQueueReceive( Coroutine* Co, QueueHandle_t Queue, void* Buffer, TickType_t TicksToWait )
+{
+	if(xQueueReceive(Queue, Buffer, 0) == pdPASS)
+	{
+		return waitEnd(Co, pdPASS);
+	}
+	return waitContinue(Co, CO_WAIT_QUEUE, Queue, TicksToWait);
+}
+
+/**
+ * receive up to BufferLen bytes from Stream (see xStreamBufferReceive)
+ * @param Received	set to the number of bytes copied into Buffer
+ * @returns pdPASS if any data was received, pdFAIL if none arrived in time
+ */
+BaseType_t CoStreamBufferReceive( Coroutine* Co, StreamBufferHandle_t Stream, void* Buffer,
+									size_t BufferLen, size_t* Received, TickType_t TicksToWait )
+{
+	*Received = xStreamBufferReceive(Stream, Buffer, BufferLen, 0);
+	if(*Received > 0)
+	{
+		return waitEnd(Co, pdPASS);
+	}
+	return waitContinue(Co, CO_WAIT_STREAM, Stream, TicksToWait);
+}
+
+/**
+ * wait for any bits to be set in Co's notification value (see CoNotify)
+ * @param Value	set to the notification value, which is then cleared to 0
+ * @returns pdPASS if notified, pdFAIL if not notified in time
+ */
+BaseType_t CoNotifyWait( Coroutine* Co, uint32_t* Value, TickType_t TicksToWait )
+{
+	taskENTER_CRITICAL();
+	const uint32_t value = Co->notifiedValue;
+	Co->notifiedValue = 0;
+	taskEXIT_CRITICAL();
+
+	if(value != 0)
+	{
+		if(Value != NULL)
+		{
+			*Value = value;
+		}
+		return waitEnd(Co, pdPASS);
+	}
+	return waitContinue(Co, CO_WAIT_NOTIFY, NULL, TicksToWait);
+}
+
+/**
+ * @returns pdTRUE if the object Co is waiting on is ready
+ * (the coroutine still has to claim it when it runs)
+ */
+static BaseType_t waitSatisfied( const Coroutine* Co )
+{
+	switch(Co->waitType)
+	{
+		case CO_WAIT_QUEUE:
+			return uxQueueMessagesWaiting((QueueHandle_t) Co->waitObject) > 0;
+		case CO_WAIT_STREAM:
+			return xStreamBufferIsEmpty((StreamBufferHandle_t) Co->waitObject) == pdFALSE;
+		case CO_WAIT_NOTIFY:
+			return Co->notifiedValue != 0;
+		default:
+			return pdFALSE;
+	}
+}
+
+/**
+ * move every waiting coroutine that's ready or has timed out to the ready
+ * list and find the next time a wait will time out
+ */
+static void checkBlocked( CoExecutor* Executor )
+{
+	const TickType_t now = xTaskGetTickCount();
+	const ListItem_t* end = listGET_END_MARKER(&Executor->blocked);
+	ListItem_t* item = listGET_HEAD_ENTRY(&Executor->blocked);
+	TickType_t nextTimeout = portMAX_DELAY;
+
+	while(item != end)
+	{
+		Coroutine* co = listGET_LIST_ITEM_OWNER(item);
+		ListItem_t* next = listGET_NEXT(item);
+		BaseType_t ready = waitSatisfied(co);
+
+		if(!ready && co->waitTicks != portMAX_DELAY)
+		{
+			const TickType_t elapsed = now - co->waitStart;
+			if(elapsed >= co->waitTicks)
+			{
+				co->timedOut = pdTRUE;
+				ready = pdTRUE;
+			}
+			else if(co->waitTicks - elapsed < nextTimeout)
+			{
+				nextTimeout = co->waitTicks - elapsed;
+			}
+		}
+
+		if(ready)
+		{
+			(void) uxListRemove(item);
+			vListInsertEnd(&Executor->ready, item);
+		}
+		item = next;
+	}
+
+	Executor->lastCheck = now;
+	Executor->nextTimeout = nextTimeout;
+}
+
+/**
+ * make sure the executor checks Co when its wait times out
+ * (without having to check every other waiting coroutine now)
+ */
+static void noteTimeout( CoExecutor* Executor, const Coroutine* Co )
+{
+	if(Co->waitTicks != portMAX_DELAY)
+	{
+		const TickType_t now = xTaskGetTickCount();
+		const TickType_t waited = now - Co->waitStart;
+		const TickType_t remaining = (waited < Co->waitTicks) ? Co->waitTicks - waited : 0;
+		const TickType_t timeout = (now - Executor->lastCheck) + remaining;
+
+		if(timeout < Executor->nextTimeout)
+		{
+			Executor->nextTimeout = timeout;
+		}
+	}
+}
+
+/**
+ * run each coroutine that's currently ready once
+ * (coroutines that yield run again on the next pass)
+ */
+static void runReady( CoExecutor* Executor )
+{
+	UBaseType_t numReady = listCURRENT_LIST_LENGTH(&Executor->ready);
+
+	while(numReady-- > 0)
+	{
+		Coroutine* co = listGET_OWNER_OF_HEAD_ENTRY(&Executor->ready);
+		(void) uxListRemove(&co->listItem);
+
+		co->function(co);
+		Executor->resumes++;
+
+		if(co->resumePoint == CO_FINISHED)
+		{
+			//no longer in any list
+		}
+		else if(co->waitType != CO_WAIT_NONE)
+		{
+			vListInsertEnd(&Executor->blocked, &co->listItem);
+			noteTimeout(Executor, co);
+		}
+		else
+		{
+			vListInsertEnd(&Executor->ready, &co->listItem);
+		}
+	}
+}
+
+static void coExecutorTask( void* Parameters )
+{
+	CoExecutor* executor = Parameters;
+
+	while(1)
+	{
+		runReady(executor);
+
+		const TickType_t elapsed = xTaskGetTickCount() - executor->lastCheck;
+		const BaseType_t timeoutDue = executor->nextTimeout != portMAX_DELAY && elapsed >= executor->nextTimeout;
+
+		if(executor->eventPending || timeoutDue)
+		{
+			executor->eventPending = pdFALSE;
+			checkBlocked(executor);
+		}
+		else if(listLIST_IS_EMPTY(&executor->ready))
+		{
+			//sleep until CoExecutorWake is called or the next wait times out.
+			//a wake after eventPending was checked leaves the notification
+			//pending, so this returns immediately
+			const TickType_t ticksToWait = (executor->nextTimeout == portMAX_DELAY) ?
+											portMAX_DELAY : executor->nextTimeout - elapsed;
+			(void) xTaskNotifyWaitIndexed(CO_EXECUTOR_NOTIFY_INDEX, 0, 0, NULL, ticksToWait);
+		}
+	}
+}
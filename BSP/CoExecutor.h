@@ -0,0 +1,178 @@
+/**
+ * MIT License
+ * 
+ * Copyright (c) 2019 Brian Amos
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#ifndef BSP_COEXECUTOR_H_
+#define BSP_COEXECUTOR_H_
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+#include <FreeRTOS.h>
+#include <task.h>
+#include <list.h>
+#include <queue.h>
+#include <stream_buffer.h>
+
+/**
+ * Stackless coroutines running inside a FreeRTOS task
+ *
+ * A CoExecutor is a single task that runs any number of coroutines.  Each
+ * coroutine is a function that can suspend itself part way through with
+ * CO_AWAIT (waiting on a queue, stream buffer, delay or notification) and
+ * later resume where it left off.  All coroutines on an executor share the
+ * executor's stack, so a coroutine only costs sizeof(Coroutine) plus
+ * whatever state it keeps in its context, instead of a TCB and a stack of
+ * its own.  Use one executor per priority level that's needed.
+ *
+ * Resuming works the same way as croutine.h: CO_BEGIN/CO_END wrap the
+ * function body in a switch statement and each CO_AWAIT is a case label.
+ * This means:
+ * 	- local variables are NOT preserved across CO_AWAIT/CO_YIELD, keep
+ * 	  anything that needs to survive in the coroutine's context
+ * 	- CO_AWAIT/CO_YIELD can only be used in the coroutine function itself
+ * 	  (not in functions it calls), can't be used inside a switch statement
+ * 	  and only one may appear per source line
+ *
+ * 	void blinker( Coroutine* Co )
+ * 	{
+ * 		BlinkerState* state = Co->context;
+ * 		BaseType_t result;
+ *
+ * 		CO_BEGIN(Co);
+ * 		while(1)
+ * 		{
+ * 			CO_AWAIT(Co, result, CoDelay(Co, state->period));
+ * 			state->count++;
+ * 		}
+ * 		CO_END(Co);
+ * 	}
+ *
+ * Awaitables return pdPASS when the operation completed and pdFAIL if it
+ * timed out (CO_AWAIT only continues past the await once one of these is
+ * returned).  A coroutine may call any non-blocking FreeRTOS API directly.
+ *
+ * Queues and stream buffers don't know about the executor, so whoever
+ * sends to a queue or stream buffer a coroutine is waiting on must follow the
+ * send with CoExecutorWake (or CoExecutorWakeFromISR).  CoNotify does this
+ * itself.  The executor then checks every waiting coroutine, so waking it is
+ * O(number of waiting coroutines).
+ *
+ * The executor waits on its own task notification at CO_EXECUTOR_NOTIFY_INDEX.
+ */
+
+#ifndef CO_EXECUTOR_NOTIFY_INDEX
+#define CO_EXECUTOR_NOTIFY_INDEX tskDEFAULT_INDEX_TO_NOTIFY
+#endif
+
+//returned by awaitables while the coroutine needs to stay suspended
+#define CO_PENDING			( ( BaseType_t ) 2 )
+
+#define CO_FINISHED			0xFFFF
+
+typedef enum
+{
+	CO_WAIT_NONE = 0,
+	CO_WAIT_DELAY,
+	CO_WAIT_QUEUE,
+	CO_WAIT_STREAM,
+	CO_WAIT_NOTIFY
+}CoWaitType;
+
+typedef struct
+{
+	List_t ready;
+	List_t blocked;					//waiting coroutines, in no particular order
+	TaskHandle_t task;
+	volatile BaseType_t eventPending;	//set by CoExecutorWake, cleared when blocked is checked
+	TickType_t lastCheck;			//tick count when blocked was last checked
+	TickType_t nextTimeout;			//ticks after lastCheck that the first wait times out
+	uint32_t resumes;				//number of times a coroutine has been run
+}CoExecutor;
+
+typedef struct Coroutine Coroutine;
+typedef void (*CoFunction)( Coroutine* Co );
+
+struct Coroutine
+{
+	ListItem_t listItem;			//in the executor's ready or blocked list
+	CoFunction function;
+	void* context;					//state that needs to survive across awaits
+	CoExecutor* executor;
+	void* waitObject;				//queue or stream buffer being waited on
+	TickType_t waitStart;
+	TickType_t waitTicks;
+	volatile uint32_t notifiedValue;
+	uint16_t resumePoint;			//line number of the last await, 0 to start, CO_FINISHED when done
+	uint8_t waitType;				//CoWaitType
+	uint8_t timedOut;
+};
+
+void CoExecutorInit( CoExecutor* Executor, const char* Name, uint16_t StackWords, UBaseType_t Priority );
+void CoStart( CoExecutor* Executor, Coroutine* Co, CoFunction Function, void* Context );
+void CoExecutorWake( CoExecutor* Executor );
+void CoExecutorWakeFromISR( CoExecutor* Executor, BaseType_t* HigherPriorityTaskWoken );
+void CoNotify( Coroutine* Co, uint32_t Bits );
+void CoNotifyFromISR( Coroutine* Co, uint32_t Bits, BaseType_t* HigherPriorityTaskWoken );
+
+//awaitables - only call through CO_AWAIT
+BaseType_t CoDelay( Coroutine* Co, TickType_t Ticks );
+BaseType_t CoQueueReceive( Coroutine* Co, QueueHandle_t Queue, void* Buffer, TickType_t TicksToWait );
+BaseType_t CoStreamBufferReceive( Coroutine* Co, StreamBufferHandle_t Stream, void* Buffer,
+									size_t BufferLen, size_t* Received, TickType_t TicksToWait );
+BaseType_t CoNotifyWait( Coroutine* Co, uint32_t* Value, TickType_t TicksToWait );
+
+#define CO_BEGIN( Co )		switch( ( Co )->resumePoint ) { case 0:
+
+#define CO_END( Co )		} ( Co )->resumePoint = CO_FINISHED
+
+/**
+ * suspend the coroutine until Awaitable completes, Result is set to its
+ * return value (pdPASS or pdFAIL)
+ */
+#define CO_AWAIT( Co, Result, Awaitable )						\
+	do															\
+	{															\
+		( Co )->resumePoint = __LINE__;							\
+		case __LINE__:											\
+		if( ( ( Result ) = ( Awaitable ) ) == CO_PENDING )		\
+		{														\
+			return;												\
+		}														\
+	} while( 0 )
+
+/**
+ * let the other ready coroutines run before continuing
+ */
+#define CO_YIELD( Co )											\
+	do															\
+	{															\
+		( Co )->resumePoint = __LINE__;							\
+		return;													\
+		case __LINE__:;											\
+	} while( 0 )
+
+#ifdef __cplusplus
+ }
+#endif
+#endif /* BSP_COEXECUTOR_H_ */
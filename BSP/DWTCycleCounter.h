@@ -0,0 +1,31 @@
+#ifndef BSP_DWTCYCLECOUNTER_H_
+#define BSP_DWTCYCLECOUNTER_H_
+
+#include <stm32f7xx_hal.h>
+
+/**
+ * Helpers for the Cortex-M7 DWT cycle counter, which counts CPU clock
+ * cycles (216 MHz on the Nucleo F767ZI).  SystemView uses the same counter
+ * for its timestamps, so enabling it here doesn't disturb tracing.
+ */
+
+/**
+ * enable the cycle counter - safe to call more than once
+ */
+static inline void CycleCounterInit( void )
+{
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->LAR = 0xC5ACCE55;		//the M7 DWT is locked after reset
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+/**
+ * @returns the current cycle count, differences are valid across
+ * 			a single 32 bit wrap (~19.8 seconds at 216 MHz)
+ */
+static inline uint32_t CycleCount( void )
+{
+	return DWT->CYCCNT;
+}
+
+#endif /* BSP_DWTCYCLECOUNTER_H_ */
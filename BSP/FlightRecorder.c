@@ -0,0 +1,162 @@
+/**
+ * Post-mortem flight recorder - see FlightRecorder.h
+ */
+
+#include <FlightRecorder.h>
+#include <DWTCycleCounter.h>
+#include <stm32f7xx_hal.h>
+#include <string.h>
+
+//.noinit isn't cleared by the startup code
+//(the data cache is left disabled by HWInit, so nothing is lost in it on reset)
+static FlightRecorderData recorder __attribute__((section(".noinit")));
+
+//recording is off until FlightRecorderInit decides the log can be used
+static volatile bool recording = false;
+
+static bool headerValid( void )
+{
+	return	recorder.magic == FLIGHT_RECORDER_MAGIC &&
+			recorder.version == FLIGHT_RECORDER_VERSION &&
+			recorder.eventSize == sizeof(FlightRecorderEvent) &&
+			recorder.numTasks == FLIGHT_RECORDER_NUM_TASKS &&
+			recorder.nameLen == FLIGHT_RECORDER_NAME_LEN &&
+			recorder.numEvents == FLIGHT_RECORDER_NUM_EVENTS;
+}
+
+/**
+ * Check for a recording made before the last reset.  Call this early,
+ * before the scheduler is started.
+ * @returns true if a previous recording was found - it is kept and
+ * 			recording stays paused until FlightRecorderClear is called
+ */
+bool FlightRecorderInit( void )
+{
+	CycleCounterInit();
+
+	if(headerValid() && recorder.head != 0)
+	{
+		//log what caused the reset that ended the recording
+		recording = true;
+		FlightRecorderRecord(FR_EVT_BOOT, 0, RCC->CSR);
+		recording = false;
+		RCC->CSR |= RCC_CSR_RMVF;
+		return true;
+	}
+
+	FlightRecorderClear();
+	return false;
+}
+
+/**
+ * discard the current log and start recording again
+ */
+void FlightRecorderClear( void )
+{
+	recording = false;
+	memset(&recorder, 0, sizeof(recorder));
+	recorder.magic = FLIGHT_RECORDER_MAGIC;
+	recorder.version = FLIGHT_RECORDER_VERSION;
+	recorder.eventSize = sizeof(FlightRecorderEvent);
+	recorder.numTasks = FLIGHT_RECORDER_NUM_TASKS;
+	recorder.nameLen = FLIGHT_RECORDER_NAME_LEN;
+	recorder.numEvents = FLIGHT_RECORDER_NUM_EVENTS;
+	recorder.cpuFreq = SystemCoreClock;
+	recording = true;
+
+	FlightRecorderRecord(FR_EVT_BOOT, 0, RCC->CSR);
+	RCC->CSR |= RCC_CSR_RMVF;
+}
+
+/**
+ * stop recording so the log can be read out
+ * @returns the log, which stays unchanged until FlightRecorderResume
+ */
+const FlightRecorderData* FlightRecorderPause( void )
+{
+	recording = false;
+	return &recorder;
+}
+
+void FlightRecorderResume( void )
+{
+	recording = headerValid();
+}
+
+/**
+ * add an event to the log - safe to call from any task or ISR
+ */
+void FlightRecorderRecord( uint8_t Type, uint16_t Aux, uint32_t Object )
+{
+	if(!recording)
+	{
+		return;
+	}
+
+	//claim a slot without disabling interrupts
+	uint32_t idx;
+	do
+	{
+		idx = __LDREXW(&recorder.head);
+	}while(__STREXW(idx + 1, &recorder.head) != 0);
+
+	FlightRecorderEvent* event = &recorder.events[idx & (FLIGHT_RECORDER_NUM_EVENTS - 1)];
+	event->timestamp = CycleCount();
+	event->type = Type;
+	event->aux = Aux;
+	event->object = Object;
+}
+
+/**
+ * called from traceTASK_SWITCHED_IN
+ * the name of each task is saved the first time it runs, so the
+ * log can be read without the tasks of the previous run
+ */
+void FlightRecorderTaskSwitchedIn( uint32_t Tcb, const char* Name )
+{
+	if(!recording)
+	{
+		return;
+	}
+
+	for(uint32_t i = 0; i < FLIGHT_RECORDER_NUM_TASKS; i++)
+	{
+		if(recorder.tasks[i].tcb == Tcb)
+		{
+			break;
+		}
+		if(recorder.tasks[i].tcb == 0)
+		{
+			//the scheduler is switching context - nothing else can run
+			strncpy(recorder.tasks[i].name, Name, FLIGHT_RECORDER_NAME_LEN);
+			recorder.tasks[i].tcb = Tcb;
+			break;
+		}
+	}
+
+	FlightRecorderRecord(FR_EVT_TASK_SWITCH, 0, Tcb);
+}
+
+void FlightRecorderIsrEnter( void )
+{
+	uint32_t exception = __get_IPSR();
+#if FLIGHT_RECORDER_TRACE_SYSTICK == 0
+	if(exception == (SysTick_IRQn + 16))
+	{
+		return;
+	}
+#endif
+	FlightRecorderRecord(FR_EVT_ISR_ENTER, exception, 0);
+}
+
+void FlightRecorderIsrExit( void )
+{
+	uint32_t exception = __get_IPSR();
+#if FLIGHT_RECORDER_TRACE_SYSTICK == 0
+	if(exception == (SysTick_IRQn + 16))
+	{
+		return;
+	}
+#endif
+	FlightRecorderRecord(FR_EVT_ISR_EXIT, exception, 0);
+}
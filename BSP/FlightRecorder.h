@@ -0,0 +1,134 @@
+/**
+ * MIT License
+ * 
+ * Copyright (c) 2019 Brian Amos
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#ifndef BSP_FLIGHTRECORDER_H_
+#define BSP_FLIGHTRECORDER_H_
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * Post-mortem flight recorder
+ *
+ * A circular log of task switches, ISR entry/exit, queue operations
+ * and user markers kept in .noinit RAM, so it survives a reset
+ * (watchdog, reset button, software reset - not a loss of power).
+ *
+ * Events are recorded through the FreeRTOS trace macros when the build
+ * defines FLIGHT_RECORDER=1 (see TraceHooksFreeRTOS.h), SystemView
+ * keeps working alongside it.
+ *
+ * If FlightRecorderInit finds a recording from before the reset, it is
+ * kept and recording stays paused until FlightRecorderClear is called,
+ * so the history leading up to the reset can't be overwritten before
+ * it is read out (see FlightRecorderTools/flightRecorder.py)
+ */
+
+#define FLIGHT_RECORDER_MAGIC		0x52544C46	//"FLTR"
+#define FLIGHT_RECORDER_VERSION		1
+#define FLIGHT_RECORDER_NUM_EVENTS	4096		//must be a power of 2
+#define FLIGHT_RECORDER_NUM_TASKS	16
+#define FLIGHT_RECORDER_NAME_LEN	12
+
+//the tick interrupt would fill the log 1000 times/second,
+//leaving only a short history of everything else
+#ifndef FLIGHT_RECORDER_TRACE_SYSTICK
+#define FLIGHT_RECORDER_TRACE_SYSTICK 0
+#endif
+
+typedef enum
+{
+	FR_EVT_NONE = 0,
+	FR_EVT_BOOT,				//aux: none, object: RCC->CSR reset flags
+	FR_EVT_TASK_SWITCH,			//object: TCB of the task switched in
+	FR_EVT_ISR_ENTER,			//aux: exception number
+	FR_EVT_ISR_EXIT,			//aux: exception number
+	FR_EVT_QUEUE_SEND,			//aux: items in queue before the send, object: queue
+	FR_EVT_QUEUE_SEND_BLOCK,	//aux: items in queue, object: queue
+	FR_EVT_QUEUE_RECEIVE,		//aux: items in queue before the receive, object: queue
+	FR_EVT_QUEUE_RECEIVE_BLOCK,	//aux: items in queue, object: queue
+	FR_EVT_MARKER				//aux: marker id, object: marker value
+}FR_EVENT_TYPE;
+
+typedef struct
+{
+	uint32_t timestamp;		//DWT cycle count
+	uint8_t type;			//FR_EVENT_TYPE
+	uint8_t reserved;
+	uint16_t aux;
+	uint32_t object;
+}FlightRecorderEvent;
+
+typedef struct
+{
+	uint32_t tcb;
+	char name[FLIGHT_RECORDER_NAME_LEN];
+}FlightRecorderTask;
+
+/**
+ * everything that is kept across a reset
+ * this is also the format read out by the host, so the header
+ * describes the sizes of everything following it
+ */
+typedef struct
+{
+	uint32_t magic;
+	uint16_t version;
+	uint16_t eventSize;
+	uint16_t numTasks;
+	uint16_t nameLen;
+	uint32_t numEvents;
+	uint32_t cpuFreq;			//DWT cycle counter frequency
+	volatile uint32_t head;		//total number of events written
+	FlightRecorderTask tasks[FLIGHT_RECORDER_NUM_TASKS];
+	FlightRecorderEvent events[FLIGHT_RECORDER_NUM_EVENTS];
+}FlightRecorderData;
+
+bool FlightRecorderInit( void );
+void FlightRecorderClear( void );
+const FlightRecorderData* FlightRecorderPause( void );
+void FlightRecorderResume( void );
+
+void FlightRecorderRecord( uint8_t Type, uint16_t Aux, uint32_t Object );
+void FlightRecorderTaskSwitchedIn( uint32_t Tcb, const char* Name );
+void FlightRecorderIsrEnter( void );
+void FlightRecorderIsrExit( void );
+
+/**
+ * add a user defined marker to the log
+ * @param Id	identifies the marker in the converted trace
+ * @param Value	any value worth recording along with it
+ */
+static inline void FlightRecorderMarker( uint16_t Id, uint32_t Value )
+{
+	FlightRecorderRecord(FR_EVT_MARKER, Id, Value);
+}
+
+#ifdef __cplusplus
+ }
+#endif
+#endif /* BSP_FLIGHTRECORDER_H_ */
@@ -0,0 +1,286 @@
+import argparse
+import json
+import struct
+import sys
+
+import serial
+
+
+# these values must match FlightRecorder.h
+MAGIC = 0x52544C46
+VERSION = 1
+HEADER_FORMAT = '<IHHHHIII'
+HEADER_LEN = struct.calcsize(HEADER_FORMAT)
+EVENT_FORMAT = '<IBBHI'
+EVENT_LEN = struct.calcsize(EVENT_FORMAT)
+DUMP_PREAMBLE = b'FRDUMP'
+
+EVT_NONE = 0
+EVT_BOOT = 1
+EVT_TASK_SWITCH = 2
+EVT_ISR_ENTER = 3
+EVT_ISR_EXIT = 4
+EVT_QUEUE_SEND = 5
+EVT_QUEUE_SEND_BLOCK = 6
+EVT_QUEUE_RECEIVE = 7
+EVT_QUEUE_RECEIVE_BLOCK = 8
+EVT_MARKER = 9
+
+QUEUE_EVENT_NAMES = {EVT_QUEUE_SEND: 'queue send',
+                     EVT_QUEUE_SEND_BLOCK: 'queue send (blocked)',
+                     EVT_QUEUE_RECEIVE: 'queue receive',
+                     EVT_QUEUE_RECEIVE_BLOCK: 'queue receive (blocked)'}
+
+# exception numbers (IRQn + 16) of the interrupts used in this repo
+EXCEPTION_NAMES = {11: 'SVCall', 14: 'PendSV', 15: 'SysTick',
+                   16 + 6: 'EXTI0', 16 + 28: 'TIM2', 16 + 38: 'USART2',
+                   16 + 40: 'EXTI15_10', 16 + 67: 'OTG_FS'}
+
+# RCC->CSR reset flags
+RESET_FLAGS = {31: 'low power', 30: 'window watchdog', 29: 'independent watchdog',
+               28: 'software', 27: 'power on', 26: 'reset pin', 25: 'brown out'}
+
+ISR_TID_BASE = 1000
+
+
+# request a dump over the virtual comm port
+# @returns the raw dump
+def readDump(portName: str, timeout: float):
+    with serial.Serial(portName, timeout=timeout) as ser:
+        ser.reset_input_buffer()
+        ser.write(b'd')
+        window = b''
+        while not window.endswith(DUMP_PREAMBLE):
+            byte = ser.read(1)
+            if len(byte) == 0:
+                raise TimeoutError('no response from the flight recorder')
+            window = (window + byte)[-len(DUMP_PREAMBLE):]
+        length = struct.unpack('<I', ser.read(4))[0]
+        data = ser.read(length)
+        if len(data) != length:
+            raise TimeoutError('dump truncated ({} of {} bytes)'.format(len(data), length))
+        return data
+
+
+def clearRecording(portName: str):
+    with serial.Serial(portName) as ser:
+        ser.write(b'c')
+
+
+# @returns (header dict, {tcb: name}, events in the order they were recorded)
+def parseDump(data: bytes):
+    magic, version, eventSize, numTasks, nameLen, numEvents, cpuFreq, head = \
+        struct.unpack_from(HEADER_FORMAT, data, 0)
+    if magic != MAGIC or version != VERSION or eventSize != EVENT_LEN:
+        raise ValueError('not a flight recorder dump (or a different version)')
+    header = {'numEvents': numEvents, 'cpuFreq': cpuFreq, 'head': head}
+
+    tasks = {}
+    offset = HEADER_LEN
+    for i in range(numTasks):
+        tcb = struct.unpack_from('<I', data, offset)[0]
+        name = data[offset + 4:offset + 4 + nameLen].split(b'\x00')[0].decode('utf-8', 'replace')
+        if tcb != 0:
+            tasks[tcb] = name
+        offset += 4 + nameLen
+
+    raw = [struct.unpack_from(EVENT_FORMAT, data, offset + i * EVENT_LEN) for i in range(numEvents)]
+    if head > numEvents:
+        # the log has wrapped, the oldest event is the next one to be overwritten
+        start = head % numEvents
+        raw = raw[start:] + raw[:start]
+    else:
+        raw = raw[:head]
+
+    events = []
+    for timestamp, evtType, _, aux, obj in raw:
+        if evtType != EVT_NONE:
+            events.append((timestamp, evtType, aux, obj))
+    return header, tasks, events
+
+
+# convert 32 bit cycle counts into a monotonic time in cycles
+# a BOOT event starts a new run, which is placed just after the previous one
+def unwrapTimestamps(events: list):
+    unwrapped = []
+    base = 0
+    last = None
+    for timestamp, evtType, aux, obj in events:
+        if last is None:
+            base = -timestamp
+        elif evtType == EVT_BOOT:
+            base = unwrapped[-1][0] + 1 - timestamp
+        elif timestamp < last:
+            base += 1 << 32
+        last = timestamp
+        unwrapped.append((timestamp + base, evtType, aux, obj))
+    return unwrapped
+
+
+def resetReason(csr: int):
+    reasons = [name for bit, name in RESET_FLAGS.items() if csr & (1 << bit)]
+    return ', '.join(reasons) if reasons else 'unknown'
+
+
+def exceptionName(number: int):
+    return EXCEPTION_NAMES.get(number, 'IRQ {}'.format(number - 16))
+
+
+# power of 2 histogram of durations in cycles
+# @returns list of (upper bound in ns, count)
+def log2Histogram(durations: list, cpuFreq: int):
+    buckets = {}
+    for cycles in durations:
+        bucket = max(int(cycles), 1).bit_length()
+        buckets[bucket] = buckets.get(bucket, 0) + 1
+    return [(round((1 << b) / cpuFreq * 1e9), buckets[b]) for b in sorted(buckets)]
+
+
+def printHistogram(title: str, histogram: list, out):
+    out.write('{}\n'.format(title))
+    total = sum(count for _, count in histogram)
+    for upperNs, count in histogram:
+        bar = '#' * max(1, round(40 * count / total))
+        out.write('  < {:>10} ns {:>7} {}\n'.format(upperNs, count, bar))
+
+
+# build a Chrome/Perfetto trace (JSON trace event format)
+# @returns (trace dict, {name: histogram})
+def buildTrace(header: dict, tasks: dict, events: list):
+    cpuFreq = header['cpuFreq']
+    trace = []
+    tids = {}
+
+    def us(cycles):
+        return cycles / cpuFreq * 1e6
+
+    def taskTid(tcb):
+        if tcb not in tids:
+            tids[tcb] = len(tids) + 1
+            name = tasks.get(tcb, 'task 0x{:08x}'.format(tcb))
+            trace.append({'ph': 'M', 'pid': 0, 'tid': tids[tcb], 'name': 'thread_name', 'args': {'name': name}})
+        return tids[tcb]
+
+    isrTids = set()
+
+    def isrTid(number):
+        tid = ISR_TID_BASE + number
+        if tid not in isrTids:
+            isrTids.add(tid)
+            trace.append({'ph': 'M', 'pid': 0, 'tid': tid, 'name': 'thread_name',
+                          'args': {'name': 'ISR ' + exceptionName(number)}})
+        return tid
+
+    trace.append({'ph': 'M', 'pid': 0, 'name': 'process_name', 'args': {'name': 'STM32F767'}})
+
+    isrDurations = {}
+    runLengths = {}
+    currentTask = None
+    taskStart = 0
+    isrStack = []
+
+    def endTask(now):
+        if currentTask is not None:
+            trace.append({'ph': 'X', 'pid': 0, 'tid': taskTid(currentTask), 'ts': us(taskStart),
+                          'dur': us(now - taskStart), 'name': tasks.get(currentTask, 'task')})
+            runLengths.setdefault(tasks.get(currentTask, 'task'), []).append(now - taskStart)
+
+    def endIsr(now):
+        number, start = isrStack.pop()
+        trace.append({'ph': 'X', 'pid': 0, 'tid': isrTid(number), 'ts': us(start),
+                      'dur': us(now - start), 'name': exceptionName(number)})
+        isrDurations.setdefault(exceptionName(number), []).append(now - start)
+
+    def currentTid():
+        if isrStack:
+            return isrTid(isrStack[-1][0])
+        return taskTid(currentTask) if currentTask is not None else 0
+
+    for time, evtType, aux, obj in events:
+        if evtType == EVT_BOOT:
+            while isrStack:
+                endIsr(time)
+            endTask(time)
+            currentTask = None
+            trace.append({'ph': 'i', 'pid': 0, 'tid': 0, 'ts': us(time), 's': 'g',
+                          'name': 'boot', 'args': {'reset': resetReason(obj), 'RCC_CSR': '0x{:08x}'.format(obj)}})
+        elif evtType == EVT_TASK_SWITCH:
+            # the switch happens in PendSV, after every traced ISR has returned
+            while isrStack:
+                endIsr(time)
+            endTask(time)
+            currentTask = obj
+            taskStart = time
+        elif evtType == EVT_ISR_ENTER:
+            isrStack.append((aux, time))
+        elif evtType == EVT_ISR_EXIT:
+            if isrStack and isrStack[-1][0] == aux:
+                endIsr(time)
+        elif evtType in QUEUE_EVENT_NAMES:
+            trace.append({'ph': 'i', 'pid': 0, 'tid': currentTid(), 'ts': us(time), 's': 't',
+                          'name': QUEUE_EVENT_NAMES[evtType],
+                          'args': {'queue': '0x{:08x}'.format(obj), 'itemsWaiting': aux}})
+        elif evtType == EVT_MARKER:
+            trace.append({'ph': 'i', 'pid': 0, 'tid': currentTid(), 'ts': us(time), 's': 't',
+                          'name': 'marker {}'.format(aux), 'args': {'value': obj}})
+
+    # whatever was running when the recording stopped
+    if events:
+        while isrStack:
+            endIsr(events[-1][0])
+        endTask(events[-1][0])
+
+    histograms = {}
+    for name, durations in sorted(isrDurations.items()):
+        histograms['ISR ' + name] = log2Histogram(durations, cpuFreq)
+    for name, durations in sorted(runLengths.items()):
+        histograms['task ' + name] = log2Histogram(durations, cpuFreq)
+
+    result = {'traceEvents': trace,
+              'displayTimeUnit': 'ns',
+              'metadata': {'cpuFreq': cpuFreq,
+                           'eventsRecorded': header['head'],
+                           'eventsInDump': len(events),
+                           'histograms': {name: [{'upperNs': ns, 'count': count} for ns, count in h]
+                                          for name, h in histograms.items()}}}
+    return result, histograms
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Read out a flight recorder dump and convert it into a '
+                                                 'Chrome/Perfetto trace (open in ui.perfetto.dev or chrome://tracing)')
+    source = parser.add_mutually_exclusive_group(required=True)
+    source.add_argument('--port', help='virtual comm port to read the dump from (e.g. /dev/ttyACM0 or COM5)')
+    source.add_argument('--dump', help='previously saved raw dump to convert')
+    parser.add_argument('--save-dump', help='save the raw dump read from --port to this file')
+    parser.add_argument('--clear', action='store_true', help='clear the recording after reading it')
+    parser.add_argument('--timeout', type=float, default=5.0, help='serial timeout in seconds')
+    parser.add_argument('-o', '--output', default='flightRecorder.json', help='trace file to write')
+    args = parser.parse_args()
+
+    if args.port:
+        data = readDump(args.port, args.timeout)
+        if args.save_dump:
+            with open(args.save_dump, 'wb') as f:
+                f.write(data)
+        if args.clear:
+            clearRecording(args.port)
+    else:
+        with open(args.dump, 'rb') as f:
+            data = f.read()
+
+    header, tasks, events = parseDump(data)
+    events = unwrapTimestamps(events)
+    trace, histograms = buildTrace(header, tasks, events)
+
+    with open(args.output, 'w') as f:
+        json.dump(trace, f)
+
+    print('{} events ({} recorded in total) written to {}'.format(len(events), header['head'], args.output))
+    for name, histogram in histograms.items():
+        printHistogram(name, histogram, sys.stdout)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
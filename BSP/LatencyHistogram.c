@@ -0,0 +1,45 @@
+/**
+ * Fixed resolution latency histogram - see LatencyHistogram.h
+ */
+
+#include <LatencyHistogram.h>
+#include <string.h>
+
+/**
+ * clear all counts
+ * @param BinShift	each bin is (1 << BinShift) counts wide
+ */
+void LatencyHistogramReset( LatencyHistogram* Hist, uint32_t BinShift )
+{
+	memset(Hist, 0, sizeof(LatencyHistogram));
+	Hist->binShift = BinShift;
+	Hist->min = UINT32_MAX;
+}
+
+/**
+ * @param PerMille	1-1000 (i.e. 500 for the median, 999 for p99.9)
+ * @returns upper bound of the bin holding the requested percentile
+ * 			(limited to the maximum seen), the maximum if it falls in
+ * 			the overflow, 0 if nothing has been recorded
+ */
+uint32_t LatencyHistogramPercentile( const LatencyHistogram* Hist, uint32_t PerMille )
+{
+	const uint32_t target = (uint32_t)(((uint64_t)Hist->count * PerMille + 999) / 1000);
+	uint32_t total = 0;
+
+	if(Hist->count == 0)
+	{
+		return 0;
+	}
+
+	for(uint32_t i = 0; i < LATENCY_HISTOGRAM_BINS; i++)
+	{
+		total += Hist->bins[i];
+		if(total >= target)
+		{
+			const uint32_t upper = ((i + 1) << Hist->binShift) - 1;
+			return upper < Hist->max ? upper : Hist->max;
+		}
+	}
+	return Hist->max;
+}
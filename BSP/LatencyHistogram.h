@@ -0,0 +1,87 @@
+/**
+ * MIT License
+ * 
+ * Copyright (c) 2019 Brian Amos
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#ifndef BSP_LATENCYHISTOGRAM_H_
+#define BSP_LATENCYHISTOGRAM_H_
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+#include <stdint.h>
+
+/**
+ * Fixed resolution latency histogram
+ *
+ * Unlike the log2 buckets in WakeLatency.h, every bin here is the same
+ * width (1 << binShift counts), which is what's needed to see jitter
+ * of a few cycles.  Values past the last bin are counted in overflow
+ * (max is still exact).
+ *
+ * LatencyHistogramAdd is meant to be called from a single ISR - nothing
+ * else should write to the histogram while it's in use.
+ * There are no hardware dependencies, so this also builds on a host.
+ */
+
+#define LATENCY_HISTOGRAM_BINS 1024
+
+typedef struct
+{
+	uint32_t binShift;
+	uint32_t count;
+	uint32_t min;
+	uint32_t max;
+	uint32_t overflow;
+	uint32_t bins[LATENCY_HISTOGRAM_BINS];
+}LatencyHistogram;
+
+void LatencyHistogramReset( LatencyHistogram* Hist, uint32_t BinShift );
+uint32_t LatencyHistogramPercentile( const LatencyHistogram* Hist, uint32_t PerMille );
+
+static inline void LatencyHistogramAdd( LatencyHistogram* Hist, uint32_t Value )
+{
+	const uint32_t bin = Value >> Hist->binShift;
+
+	if(bin < LATENCY_HISTOGRAM_BINS)
+	{
+		Hist->bins[bin]++;
+	}
+	else
+	{
+		Hist->overflow++;
+	}
+	if(Value < Hist->min)
+	{
+		Hist->min = Value;
+	}
+	if(Value > Hist->max)
+	{
+		Hist->max = Value;
+	}
+	Hist->count++;
+}
+
+#ifdef __cplusplus
+ }
+#endif
+#endif /* BSP_LATENCYHISTOGRAM_H_ */
@@ -0,0 +1,288 @@
+/**
+ * Mutex/semaphore contention and priority inversion profiler - see MutexProfiler.h
+ */
+
+#include <MutexProfiler.h>
+#include <FreeRTOS.h>
+#include <task.h>
+#include <queue.h>
+#include <DWTCycleCounter.h>
+#include <stdio.h>
+#include <string.h>
+
+static MutexProfile profiles[MUTEX_PROFILER_MAX_OBJECTS];
+static uint32_t numProfiles = 0;
+
+/**
+ * start profiling a mutex or semaphore - call before the scheduler
+ * is started (or before the object is used)
+ * @param Object	SemaphoreHandle_t of the object
+ * @param Name		used in the report
+ */
+void MutexProfilerRegister( const void* Object, const char* Name )
+{
+	CycleCounterInit();
+	assert_param(numProfiles < MUTEX_PROFILER_MAX_OBJECTS);
+
+	MutexProfile* profile = &profiles[numProfiles];
+	memset(profile, 0, sizeof(MutexProfile));
+	profile->name = Name;
+#if configUSE_TRACE_FACILITY == 1
+	//counting semaphores aren't "held" by anyone
+	profile->tracksHolder = (ucQueueGetQueueType((QueueHandle_t)Object) != queueQUEUE_TYPE_COUNTING_SEMAPHORE);
+#else
+	profile->tracksHolder = 1;
+#endif
+
+	//the hooks may be looking through the list - publish the entry last
+	taskENTER_CRITICAL();
+	profile->object = Object;
+	numProfiles++;
+	taskEXIT_CRITICAL();
+}
+
+/**
+ * @returns the profile for Object, NULL if it isn't registered
+ */
+const MutexProfile* MutexProfilerGet( const void* Object )
+{
+	for(uint32_t i = 0; i < numProfiles; i++)
+	{
+		if(profiles[i].object == Object)
+		{
+			return &profiles[i];
+		}
+	}
+	return NULL;
+}
+
+static MutexProfile* findProfile( const void* Object )
+{
+	return (MutexProfile*) MutexProfilerGet(Object);
+}
+
+static MutexProfilerWaiter* findWaiter( MutexProfile* Profile, void* Task )
+{
+	for(uint32_t i = 0; i < MUTEX_PROFILER_MAX_WAITERS; i++)
+	{
+		if(Profile->waiters[i].task == Task)
+		{
+			return &Profile->waiters[i];
+		}
+	}
+	return NULL;
+}
+
+static void copyName( char* Dest, void* Task )
+{
+	if(Task != NULL)
+	{
+		strncpy(Dest, pcTaskGetName((TaskHandle_t)Task), MUTEX_PROFILER_NAME_LEN - 1);
+		Dest[MUTEX_PROFILER_NAME_LEN - 1] = '\0';
+	}
+	else
+	{
+		strcpy(Dest, "?");
+	}
+}
+
+/**
+ * the current task stopped waiting for Profile (taken or timed out)
+ */
+static void endWait( MutexProfile* Profile, void* Task, uint32_t Now )
+{
+	MutexProfilerWaiter* waiter = findWaiter(Profile, Task);
+	if(waiter == NULL)
+	{
+		return;
+	}
+
+	const uint32_t waited = Now - waiter->since;
+	Profile->totalWaitCycles += waited;
+	if(waited > Profile->maxWaitCycles)
+	{
+		Profile->maxWaitCycles = waited;
+	}
+
+	//a higher priority task was kept waiting by a lower priority holder
+	if(	Profile->tracksHolder &&
+		waiter->priority > waiter->holderPriority &&
+		waited > (SystemCoreClock / 1000000) * MUTEX_PROFILER_INVERSION_US)
+	{
+		Profile->inversions++;
+		Profile->lastInversionCycles = waited;
+		if(waited > Profile->maxInversionCycles)
+		{
+			Profile->maxInversionCycles = waited;
+		}
+		copyName(Profile->lastInversionWaiter, Task);
+		copyName(Profile->lastInversionHolder, Profile->holder);
+	}
+
+	waiter->task = NULL;
+}
+
+/**
+ * called from traceBLOCKING_ON_QUEUE_RECEIVE - the current task is about to block
+ */
+void MutexProfilerBlocked( const void* Object )
+{
+	MutexProfile* profile = findProfile(Object);
+	if(profile == NULL)
+	{
+		return;
+	}
+
+	void* task = xTaskGetCurrentTaskHandle();
+
+	//a task that times out part way through a wait blocks again without
+	//taking the object - that is still the same wait
+	if(findWaiter(profile, task) != NULL)
+	{
+		return;
+	}
+
+	MutexProfilerWaiter* waiter = findWaiter(profile, NULL);
+	if(waiter != NULL)
+	{
+		waiter->priority = uxTaskPriorityGet(NULL);
+		waiter->holderPriority = profile->holderPriority;
+		waiter->since = CycleCount();
+		waiter->task = task;
+	}
+
+	profile->contended++;
+	if(waiter != NULL && waiter->priority > profile->maxWaiterPriority)
+	{
+		profile->maxWaiterPriority = waiter->priority;
+	}
+}
+
+/**
+ * called from traceQUEUE_RECEIVE - the current task took the object
+ */
+void MutexProfilerTaken( const void* Object )
+{
+	const uint32_t now = CycleCount();
+	MutexProfile* profile = findProfile(Object);
+	if(profile == NULL)
+	{
+		return;
+	}
+
+	void* task = xTaskGetCurrentTaskHandle();
+	endWait(profile, task, now);
+	profile->takes++;
+
+	if(profile->tracksHolder)
+	{
+		profile->holder = task;
+		profile->holderPriority = uxTaskPriorityGet(NULL);
+		profile->takenAt = now;
+	}
+}
+
+/**
+ * called from traceQUEUE_RECEIVE_FAILED
+ */
+void MutexProfilerTimedOut( const void* Object )
+{
+	const uint32_t now = CycleCount();
+	MutexProfile* profile = findProfile(Object);
+	if(profile == NULL)
+	{
+		return;
+	}
+
+	//only count timeouts after waiting, not polls that found the object taken
+	if(findWaiter(profile, xTaskGetCurrentTaskHandle()) != NULL)
+	{
+		profile->timeouts++;
+	}
+	endWait(profile, xTaskGetCurrentTaskHandle(), now);
+}
+
+/**
+ * called from traceQUEUE_SEND - the object is being given
+ */
+void MutexProfilerGiven( const void* Object )
+{
+	const uint32_t now = CycleCount();
+	MutexProfile* profile = findProfile(Object);
+	if(profile == NULL || !profile->tracksHolder || profile->holder == NULL)
+	{
+		return;
+	}
+
+	const uint32_t held = now - profile->takenAt;
+	profile->holds++;
+	profile->totalHoldCycles += held;
+	if(held > profile->maxHoldCycles)
+	{
+		profile->maxHoldCycles = held;
+	}
+	profile->holder = NULL;
+	profile->holderPriority = 0;
+}
+
+static unsigned long cyclesToUs( uint32_t Cycles )
+{
+	return (unsigned long)(((uint64_t)Cycles * 1000000) / SystemCoreClock);
+}
+
+/**
+ * format a text report of every registered object, one line each
+ * the report is cut short if Buff is too small
+ * @returns number of characters written (not including the terminator)
+ */
+uint32_t MutexProfilerReport( char* Buff, uint32_t Len )
+{
+	uint32_t used = 0;
+
+	if(Len == 0)
+	{
+		return 0;
+	}
+	Buff[0] = '\0';
+
+	for(uint32_t i = 0; i < numProfiles; i++)
+	{
+		const MutexProfile* p = &profiles[i];
+		const uint32_t waits = p->contended ? p->contended : 1;
+		const uint32_t holds = p->holds ? p->holds : 1;
+
+		int n = snprintf(Buff + used, Len - used,
+				"%s takes=%lu contended=%lu timeouts=%lu wait avg/max=%lu/%luus "
+				"hold avg/max=%lu/%luus max waiter prio=%lu inversions>%uus=%lu max=%luus",
+				p->name, (unsigned long)p->takes, (unsigned long)p->contended, (unsigned long)p->timeouts,
+				cyclesToUs(p->totalWaitCycles / waits), cyclesToUs(p->maxWaitCycles),
+				cyclesToUs(p->totalHoldCycles / holds), cyclesToUs(p->maxHoldCycles),
+				(unsigned long)p->maxWaiterPriority, MUTEX_PROFILER_INVERSION_US,
+				(unsigned long)p->inversions, cyclesToUs(p->maxInversionCycles));
+		if(n < 0 || used + n >= Len)
+		{
+			return Len - 1;
+		}
+		used += n;
+
+		if(p->inversions != 0)
+		{
+			n = snprintf(Buff + used, Len - used, " last: %s waited %luus on %s",
+							p->lastInversionWaiter, cyclesToUs(p->lastInversionCycles),
+							p->lastInversionHolder);
+			if(n < 0 || used + n >= Len)
+			{
+				return Len - 1;
+			}
+			used += n;
+		}
+
+		n = snprintf(Buff + used, Len - used, "\n");
+		if(n < 0 || used + n >= Len)
+		{
+			return Len - 1;
+		}
+		used += n;
+	}
+	return used;
+}
@@ -0,0 +1,122 @@
+/**
+ * MIT License
+ * 
+ * Copyright (c) 2019 Brian Amos
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#ifndef BSP_MUTEXPROFILER_H_
+#define BSP_MUTEXPROFILER_H_
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+#include <stdint.h>
+
+/**
+ * Mutex/semaphore contention and priority inversion profiler
+ *
+ * Hooked into the FreeRTOS queue trace macros when the build defines
+ * MUTEX_PROFILER=1 (see TraceHooksFreeRTOS.h).  For every registered
+ * mutex or semaphore it records:
+ * 	- takes, contended takes (the caller had to block) and timeouts
+ * 	- wait time (blocked until taken or timed out)
+ * 	- hold time and holder priority (mutexes and binary semaphores)
+ * 	- the highest priority of any task that had to wait
+ *
+ * A priority inversion is counted whenever a task waits longer than
+ * MUTEX_PROFILER_INVERSION_US for an object held by a lower priority task.
+ * The holder and waiter of the most recent one are kept for the report.
+ *
+ * This header is included from FreeRTOSConfig.h, so handles are passed as
+ * void* rather than pulling in the FreeRTOS headers.
+ *
+ * All times are measured with the DWT cycle counter.
+ */
+
+#define MUTEX_PROFILER_MAX_OBJECTS	8
+#define MUTEX_PROFILER_MAX_WAITERS	4
+#define MUTEX_PROFILER_NAME_LEN		16
+
+#ifndef MUTEX_PROFILER_INVERSION_US
+#define MUTEX_PROFILER_INVERSION_US	1000
+#endif
+
+typedef struct
+{
+	void* task;					//NULL if the slot is free
+	uint32_t priority;
+	uint32_t holderPriority;	//priority of the holder when the wait started
+	uint32_t since;
+}MutexProfilerWaiter;
+
+typedef struct
+{
+	const void* object;
+	const char* name;
+	uint8_t tracksHolder;		//mutexes and binary semaphores only
+
+	uint32_t takes;
+	uint32_t contended;
+	uint32_t timeouts;
+	uint32_t totalWaitCycles;
+	uint32_t maxWaitCycles;
+	uint32_t maxWaiterPriority;
+
+	void* holder;
+	uint32_t holderPriority;
+	uint32_t takenAt;
+	uint32_t holds;
+	uint32_t totalHoldCycles;
+	uint32_t maxHoldCycles;
+
+	uint32_t inversions;
+	uint32_t maxInversionCycles;
+	char lastInversionHolder[MUTEX_PROFILER_NAME_LEN];
+	char lastInversionWaiter[MUTEX_PROFILER_NAME_LEN];
+	uint32_t lastInversionCycles;
+
+	MutexProfilerWaiter waiters[MUTEX_PROFILER_MAX_WAITERS];
+}MutexProfile;
+
+void MutexProfilerRegister( const void* Object, const char* Name );
+const MutexProfile* MutexProfilerGet( const void* Object );
+uint32_t MutexProfilerReport( char* Buff, uint32_t Len );
+
+//called from the trace hooks
+void MutexProfilerBlocked( const void* Object );
+void MutexProfilerTaken( const void* Object );
+void MutexProfilerTimedOut( const void* Object );
+void MutexProfilerGiven( const void* Object );
+
+/**
+ * register an object only in builds that profile mutexes, so drivers
+ * can register their mutexes without any cost otherwise
+ */
+#if defined(MUTEX_PROFILER) && MUTEX_PROFILER == 1
+#define MUTEX_PROFILER_REGISTER(Object, Name)	MutexProfilerRegister((Object), (Name))
+#else
+#define MUTEX_PROFILER_REGISTER(Object, Name)
+#endif
+
+#ifdef __cplusplus
+ }
+#endif
+#endif /* BSP_MUTEXPROFILER_H_ */
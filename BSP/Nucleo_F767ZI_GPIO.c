@@ -6,16 +6,10 @@
 #include <Nucleo_F767ZI_GPIO.h>
 #include <stm32f7xx_hal.h>
 
-void GreenOn ( void ) {HAL_GPIO_WritePin(GPIOB, GPIO_PIN_0, GPIO_PIN_SET);}
-void GreenOff ( void ) {HAL_GPIO_WritePin(GPIOB, GPIO_PIN_0, GPIO_PIN_RESET);}
-LED GreenLed = { GreenOn, GreenOff };
-
-void BlueOn ( void ) {HAL_GPIO_WritePin(GPIOB, GPIO_PIN_7, GPIO_PIN_SET);}
-void BlueOff ( void ) {HAL_GPIO_WritePin(GPIOB, GPIO_PIN_7, GPIO_PIN_RESET);}
-LED BlueLed = { BlueOn, BlueOff };
-
-void RedOn ( void ) {HAL_GPIO_WritePin(GPIOB, GPIO_PIN_14, GPIO_PIN_SET);}
-void RedOff ( void ) {HAL_GPIO_WritePin(GPIOB, GPIO_PIN_14, GPIO_PIN_RESET);}
-LED RedLed = { RedOn, RedOff };
+//the runtime LED's share the static inline implementations
+//from Nucleo_F767ZI_GPIO.h
+LED GreenLed = { GreenLedOn, GreenLedOff };
+LED BlueLed = { BlueLedOn, BlueLedOff };
+LED RedLed = { RedLedOn, RedLedOff };
 
 uint_fast8_t ReadPushButton( void ){ return HAL_GPIO_ReadPin(GPIOC, GPIO_PIN_13);}
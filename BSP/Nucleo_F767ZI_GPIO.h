@@ -2,6 +2,7 @@
 #define BSP_NUCLEO_F767ZI_GPIO_H_
 
 #include <stdint.h>
+#include <stm32f7xx_hal.h>
 
 
 //Create a typedef defining a simple function pointer
@@ -22,4 +23,66 @@ extern LED BlueLed;
 extern LED GreenLed;
 extern LED RedLed;
 
+/**
+ * Pin table for the user LED's
+ * All 3 LED's are on the same port, so any combination of them
+ * can be changed with a single write to the port's BSRR
+ * X(<Name>, <Pin>)
+ */
+#define NUCLEO_LED_PORT		GPIOB
+#define NUCLEO_LED_TABLE(X)		\
+	X(Green,	GPIO_PIN_0)		\
+	X(Blue,		GPIO_PIN_7)		\
+	X(Red,		GPIO_PIN_14)
+
+/**
+ * Port level bulk update - sets SetPins and clears ResetPins in a
+ * single, atomic write.  Pins not in either mask are left untouched
+ * (if a pin is in both masks, the hardware gives priority to set)
+ */
+static inline void GpioPortWrite( GPIO_TypeDef* Port, uint16_t SetPins, uint16_t ResetPins )
+{
+	Port->BSRR = ((uint32_t)ResetPins << 16) | SetPins;
+}
+
+//static implementations of each LED, usable with LED_ON/LED_OFF (see iLed.h)
+//each one is a single, atomic write to the port's bit set/reset register
+#define NUCLEO_LED_FUNCS(Name, Pin)																\
+	static inline void Name##LedOn ( void ) {GpioPortWrite(NUCLEO_LED_PORT, Pin, 0);}		\
+	static inline void Name##LedOff ( void ) {GpioPortWrite(NUCLEO_LED_PORT, 0, Pin);}
+NUCLEO_LED_TABLE(NUCLEO_LED_FUNCS)
+#undef NUCLEO_LED_FUNCS
+
+/**
+ * LED group masks - one bit per LED in NUCLEO_LED_TABLE
+ * (GreenLedMask, BlueLedMask, RedLedMask and AllLedsMask)
+ */
+#define NUCLEO_LED_INDEX(Name, Pin)		Name##LedIndex,
+enum { NUCLEO_LED_TABLE(NUCLEO_LED_INDEX) NUM_NUCLEO_LEDS };
+#undef NUCLEO_LED_INDEX
+
+#define NUCLEO_LED_MASK(Name, Pin)		Name##LedMask = 1UL << Name##LedIndex,
+enum { NUCLEO_LED_TABLE(NUCLEO_LED_MASK) AllLedsMask = (1UL << NUM_NUCLEO_LEDS) - 1 };
+#undef NUCLEO_LED_MASK
+
+/**
+ * convert a group mask into the pins it refers to
+ * (this folds down to a constant when Leds is known at compile time)
+ */
+static inline uint16_t NucleoLedPins( uint32_t Leds )
+{
+#define NUCLEO_LED_PIN(Name, Pin)		| ((Leds & Name##LedMask) ? (Pin) : 0)
+	return 0 NUCLEO_LED_TABLE(NUCLEO_LED_PIN);
+#undef NUCLEO_LED_PIN
+}
+
+//static implementation of an LED group, usable with LED_GROUP_WRITE
+//and ILEDGROUP_STATIC (see iLedGroup.h)
+static inline void NucleoLedsOn( uint32_t Leds ) {GpioPortWrite(NUCLEO_LED_PORT, NucleoLedPins(Leds), 0);}
+static inline void NucleoLedsOff( uint32_t Leds ) {GpioPortWrite(NUCLEO_LED_PORT, 0, NucleoLedPins(Leds));}
+static inline void NucleoLedsWrite( uint32_t OnLeds, uint32_t OffLeds )
+{
+	GpioPortWrite(NUCLEO_LED_PORT, NucleoLedPins(OnLeds), NucleoLedPins(OffLeds));
+}
+
 #endif /* BSP_NUCLEO_F767ZI_GPIO_H_ */
@@ -0,0 +1,273 @@
+/**
+ * Priority ordered message queue - see PriorityMessageQueue.h
+ */
+
+#include <PriorityMessageQueue.h>
+#include <string.h>
+
+#define NODE_SIZE(MsgSize) PMQ_STORAGE_SIZE(1, MsgSize)
+
+/**
+ * link a filled node to the end of its priority level
+ * (called from a critical section)
+ */
+static void linkNode( PriorityMessageQueue* Queue, PmqNode* Node )
+{
+	const uint32_t level = Node->priority;
+
+	Node->next = NULL;
+	if(Queue->tail[level] == NULL)
+	{
+		Queue->head[level] = Node;
+		Queue->readyLevels |= (1UL << level);
+	}
+	else
+	{
+		Queue->tail[level]->next = Node;
+	}
+	Queue->tail[level] = Node;
+}
+
+/**
+ * remove the oldest node of the highest non-empty priority level
+ * (called from a critical section, there must be at least 1 message)
+ */
+static PmqNode* unlinkHighest( PriorityMessageQueue* Queue )
+{
+	const uint32_t level = 31 - __builtin_clz(Queue->readyLevels);
+	PmqNode* node = Queue->head[level];
+
+	Queue->head[level] = node->next;
+	if(Queue->head[level] == NULL)
+	{
+		Queue->tail[level] = NULL;
+		Queue->readyLevels &= ~(1UL << level);
+	}
+	return node;
+}
+
+/**
+ * (called from a critical section, there must be at least 1 free node)
+ */
+static PmqNode* popFree( PriorityMessageQueue* Queue )
+{
+	PmqNode* node = Queue->freeNodes;
+	Queue->freeNodes = node->next;
+	return node;
+}
+
+static void pushFree( PriorityMessageQueue* Queue, PmqNode* Node )
+{
+	Node->next = Queue->freeNodes;
+	Queue->freeNodes = Node;
+}
+
+static void fillNode( PmqNode* Node, const void* Msg, uint32_t Len, uint32_t Priority )
+{
+	memcpy(Node->data, Msg, Len);
+	Node->len = Len;
+	Node->priority = (Priority > PMQ_MAX_PRIORITY) ? PMQ_MAX_PRIORITY : Priority;
+}
+
+static void emptyNode( const PmqNode* Node, void* Msg, uint32_t* Len, uint32_t* Priority )
+{
+	memcpy(Msg, Node->data, Node->len);
+	if(Len != NULL)
+	{
+		*Len = Node->len;
+	}
+	if(Priority != NULL)
+	{
+		*Priority = Node->priority;
+	}
+}
+
+/**
+ * setup a queue using caller supplied memory
+ * @param Storage	PMQ_STORAGE_SIZE(MsgCount, MsgSize) bytes, pointer aligned
+ * @returns Queue
+ */
+PriorityMessageQueue* PriorityMessageQueueInit( PriorityMessageQueue* Queue, void* Storage,
+												uint32_t MsgCount, uint32_t MsgSize )
+{
+	configASSERT(MsgCount > 0 && MsgSize > 0);
+
+	memset(Queue, 0, sizeof(PriorityMessageQueue));
+	Queue->msgSize = MsgSize;
+	Queue->nodeSize = NODE_SIZE(MsgSize);
+	Queue->capacity = MsgCount;
+
+	for(uint32_t i = 0; i < MsgCount; i++)
+	{
+		pushFree(Queue, (PmqNode*)((uint8_t*)Storage + i * Queue->nodeSize));
+	}
+
+	Queue->messages = xSemaphoreCreateCountingStatic(MsgCount, 0, &Queue->messagesBuff);
+	Queue->spaces = xSemaphoreCreateCountingStatic(MsgCount, MsgCount, &Queue->spacesBuff);
+	return Queue;
+}
+
+/**
+ * allocate a queue and its message storage in a single block from the FreeRTOS heap
+ * @returns NULL if the heap is exhausted
+ */
+PriorityMessageQueue* PriorityMessageQueueCreate( uint32_t MsgCount, uint32_t MsgSize )
+{
+	PriorityMessageQueue* queue = pvPortMalloc(sizeof(PriorityMessageQueue) + PMQ_STORAGE_SIZE(MsgCount, MsgSize));
+
+	if(queue != NULL)
+	{
+		PriorityMessageQueueInit(queue, queue + 1, MsgCount, MsgSize);
+		queue->dynamic = 1;
+	}
+	return queue;
+}
+
+/**
+ * no tasks may be blocked on the queue
+ */
+void PriorityMessageQueueDelete( PriorityMessageQueue* Queue )
+{
+	vSemaphoreDelete(Queue->messages);
+	vSemaphoreDelete(Queue->spaces);
+	if(Queue->dynamic)
+	{
+		vPortFree(Queue);
+	}
+}
+
+/**
+ * copy a message into the queue, waiting up to TicksToWait for space
+ * @param Len		bytes in Msg, up to the queue's message size
+ * @param Priority	higher numbers are received first
+ * @returns pdPASS, or errQUEUE_FULL if no space became available in time
+ */
+BaseType_t PriorityMessageQueueSend( PriorityMessageQueue* Queue, const void* Msg, uint32_t Len,
+										uint32_t Priority, TickType_t TicksToWait )
+{
+	PmqNode* node;
+
+	configASSERT(Len <= Queue->msgSize);
+	if(xSemaphoreTake(Queue->spaces, TicksToWait) != pdPASS)
+	{
+		return errQUEUE_FULL;
+	}
+
+	//taking a space guarantees a free node, which is ours until it's linked
+	taskENTER_CRITICAL();
+	node = popFree(Queue);
+	taskEXIT_CRITICAL();
+
+	fillNode(node, Msg, Len, Priority);
+
+	taskENTER_CRITICAL();
+	linkNode(Queue, node);
+	taskEXIT_CRITICAL();
+
+	xSemaphoreGive(Queue->messages);
+	return pdPASS;
+}
+
+/**
+ * PriorityMessageQueueSend for ISR's - never blocks
+ */
+BaseType_t PriorityMessageQueueSendFromISR( PriorityMessageQueue* Queue, const void* Msg, uint32_t Len,
+											uint32_t Priority, BaseType_t* HigherPriorityTaskWoken )
+{
+	PmqNode* node;
+	UBaseType_t mask;
+
+	configASSERT(Len <= Queue->msgSize);
+	if(xSemaphoreTakeFromISR(Queue->spaces, HigherPriorityTaskWoken) != pdPASS)
+	{
+		return errQUEUE_FULL;
+	}
+
+	mask = taskENTER_CRITICAL_FROM_ISR();
+	node = popFree(Queue);
+	taskEXIT_CRITICAL_FROM_ISR(mask);
+
+	fillNode(node, Msg, Len, Priority);
+
+	mask = taskENTER_CRITICAL_FROM_ISR();
+	linkNode(Queue, node);
+	taskEXIT_CRITICAL_FROM_ISR(mask);
+
+	xSemaphoreGiveFromISR(Queue->messages, HigherPriorityTaskWoken);
+	return pdPASS;
+}
+
+/**
+ * copy the highest priority message out of the queue, waiting up to
+ * TicksToWait for one to arrive
+ * @param Msg		room for the queue's message size
+ * @param Len		(optional) the message's length
+ * @param Priority	(optional) the message's priority
+ * @returns pdPASS, or errQUEUE_EMPTY if no message arrived in time
+ */
+BaseType_t PriorityMessageQueueReceive( PriorityMessageQueue* Queue, void* Msg, uint32_t* Len,
+										uint32_t* Priority, TickType_t TicksToWait )
+{
+	PmqNode* node;
+
+	if(xSemaphoreTake(Queue->messages, TicksToWait) != pdPASS)
+	{
+		return errQUEUE_EMPTY;
+	}
+
+	taskENTER_CRITICAL();
+	node = unlinkHighest(Queue);
+	taskEXIT_CRITICAL();
+
+	emptyNode(node, Msg, Len, Priority);
+
+	taskENTER_CRITICAL();
+	pushFree(Queue, node);
+	taskEXIT_CRITICAL();
+
+	xSemaphoreGive(Queue->spaces);
+	return pdPASS;
+}
+
+/**
+ * PriorityMessageQueueReceive for ISR's - never blocks
+ */
+BaseType_t PriorityMessageQueueReceiveFromISR( PriorityMessageQueue* Queue, void* Msg, uint32_t* Len,
+												uint32_t* Priority, BaseType_t* HigherPriorityTaskWoken )
+{
+	PmqNode* node;
+	UBaseType_t mask;
+
+	if(xSemaphoreTakeFromISR(Queue->messages, HigherPriorityTaskWoken) != pdPASS)
+	{
+		return errQUEUE_EMPTY;
+	}
+
+	mask = taskENTER_CRITICAL_FROM_ISR();
+	node = unlinkHighest(Queue);
+	taskEXIT_CRITICAL_FROM_ISR(mask);
+
+	emptyNode(node, Msg, Len, Priority);
+
+	mask = taskENTER_CRITICAL_FROM_ISR();
+	pushFree(Queue, node);
+	taskEXIT_CRITICAL_FROM_ISR(mask);
+
+	xSemaphoreGiveFromISR(Queue->spaces, HigherPriorityTaskWoken);
+	return pdPASS;
+}
+
+/**
+ * discard every queued message, waking senders blocked on a full queue
+ */
+void PriorityMessageQueueReset( PriorityMessageQueue* Queue )
+{
+	while(xSemaphoreTake(Queue->messages, 0) == pdPASS)
+	{
+		taskENTER_CRITICAL();
+		pushFree(Queue, unlinkHighest(Queue));
+		taskEXIT_CRITICAL();
+
+		xSemaphoreGive(Queue->spaces);
+	}
+}
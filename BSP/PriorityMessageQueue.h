@@ -0,0 +1,125 @@
+/**
+ * MIT License
+ * 
+ * Copyright (c) 2019 Brian Amos
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#ifndef BSP_PRIORITYMESSAGEQUEUE_H_
+#define BSP_PRIORITYMESSAGEQUEUE_H_
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+#include <FreeRTOS.h>
+#include <semphr.h>
+#include <stdint.h>
+
+/**
+ * Message queue that delivers the highest priority message first
+ *
+ * FreeRTOS queues are strictly FIFO (or LIFO with xQueueSendToFront), so an
+ * urgent message waits behind everything already queued.  Here each priority
+ * level has its own FIFO and a bitmap of the non-empty levels finds the
+ * highest one with a single CLZ, so both send and receive are O(1)
+ * regardless of how many messages are queued.
+ *
+ * 	- storage for every message is allocated up front (a node per message),
+ * 	  send and receive copy directly into / out of a node
+ * 	- blocking is done with 2 counting semaphores (messages and spaces), so
+ * 	  senders block while the queue is full and receivers while it is empty,
+ * 	  with the same timeouts and wake order as a FreeRTOS queue
+ * 	- messages can be shorter than the message size, the length is kept
+ * 	  with each message
+ * 	- higher numbers are more urgent, priorities above PMQ_MAX_PRIORITY are
+ * 	  treated as PMQ_MAX_PRIORITY.  Messages with the same priority are FIFO
+ *
+ * The CMSIS-RTOS2 osMessageQueue (CMSIS_MQ_PRIORITY=1) and FreeRTOS+POSIX
+ * mqueue (posixconfigMQ_PRIORITY=1) wrappers can both be built on this queue.
+ */
+
+#define PMQ_NUM_PRIORITIES	32
+#define PMQ_MAX_PRIORITY	(PMQ_NUM_PRIORITIES - 1)
+
+typedef struct PmqNode
+{
+	struct PmqNode* next;
+	uint32_t len;
+	uint32_t priority;
+	uint8_t data[];
+}PmqNode;
+
+typedef struct
+{
+	SemaphoreHandle_t messages;			//counts queued messages
+	SemaphoreHandle_t spaces;			//counts free nodes
+	StaticSemaphore_t messagesBuff;
+	StaticSemaphore_t spacesBuff;
+	uint32_t msgSize;
+	uint32_t nodeSize;
+	uint32_t capacity;
+	uint32_t readyLevels;				//bit n set when level n has messages
+	PmqNode* head[PMQ_NUM_PRIORITIES];
+	PmqNode* tail[PMQ_NUM_PRIORITIES];
+	PmqNode* freeNodes;
+	uint8_t dynamic;					//created by PriorityMessageQueueCreate
+}PriorityMessageQueue;
+
+/**
+ * @returns bytes of node storage needed by PriorityMessageQueueInit
+ */
+#define PMQ_STORAGE_SIZE(MsgCount, MsgSize) \
+	((MsgCount) * ((sizeof(PmqNode) + (MsgSize) + sizeof(void*) - 1) & ~(sizeof(void*) - 1)))
+
+PriorityMessageQueue* PriorityMessageQueueInit( PriorityMessageQueue* Queue, void* Storage,
+												uint32_t MsgCount, uint32_t MsgSize );
+PriorityMessageQueue* PriorityMessageQueueCreate( uint32_t MsgCount, uint32_t MsgSize );
+void PriorityMessageQueueDelete( PriorityMessageQueue* Queue );
+
+BaseType_t PriorityMessageQueueSend( PriorityMessageQueue* Queue, const void* Msg, uint32_t Len,
+										uint32_t Priority, TickType_t TicksToWait );
+BaseType_t PriorityMessageQueueSendFromISR( PriorityMessageQueue* Queue, const void* Msg, uint32_t Len,
+											uint32_t Priority, BaseType_t* HigherPriorityTaskWoken );
+BaseType_t PriorityMessageQueueReceive( PriorityMessageQueue* Queue, void* Msg, uint32_t* Len,
+										uint32_t* Priority, TickType_t TicksToWait );
+BaseType_t PriorityMessageQueueReceiveFromISR( PriorityMessageQueue* Queue, void* Msg, uint32_t* Len,
+												uint32_t* Priority, BaseType_t* HigherPriorityTaskWoken );
+void PriorityMessageQueueReset( PriorityMessageQueue* Queue );
+
+/**
+ * @returns number of messages waiting to be received
+ */
+static inline uint32_t PriorityMessageQueueCount( PriorityMessageQueue* Queue )
+{
+	return uxSemaphoreGetCount(Queue->messages);
+}
+
+/**
+ * @returns number of messages that can be sent before the queue is full
+ */
+static inline uint32_t PriorityMessageQueueSpaces( PriorityMessageQueue* Queue )
+{
+	return uxSemaphoreGetCount(Queue->spaces);
+}
+
+#ifdef __cplusplus
+ }
+#endif
+#endif /* BSP_PRIORITYMESSAGEQUEUE_H_ */
@@ -0,0 +1,321 @@
+/**
+ * Queue and stream buffer occupancy telemetry - see QueueTelemetry.h
+ */
+
+#include <QueueTelemetry.h>
+#include <FreeRTOS.h>
+#include <task.h>
+#include <queue.h>
+#include <stream_buffer.h>
+#include <SEGGER_SYSVIEW.h>
+#include <stm32f7xx_hal.h>
+#include <stdio.h>
+#include <string.h>
+
+static QueueTelemetryStats objects[QUEUE_TELEMETRY_MAX_OBJECTS];
+static uint32_t numObjects = 0;
+static uint32_t samplePeriodMs;
+
+static void sendModuleDesc( void );
+
+/**
+ * SystemView user events
+ * 	Level:	recorded every sample
+ * 	Errors:	recorded when any of the error counters changed since the last sample
+ */
+static SEGGER_SYSVIEW_MODULE telemetryModule =
+{
+	"M=QueueTelemetry, "
+	"0 Level Object=%I Level=%u HighWater=%u Capacity=%u, "
+	"1 Errors Object=%I SendFails=%u PartialSends=%u Timeouts=%u",
+	2,		//number of events
+	0,		//event offset, assigned by SystemView
+	sendModuleDesc,
+	NULL
+};
+
+static void registerObject( const void* Object, const char* Name,
+							QueueTelemetryKind Kind, uint32_t Capacity )
+{
+	assert_param(numObjects < QUEUE_TELEMETRY_MAX_OBJECTS);
+
+	QueueTelemetryStats* stats = &objects[numObjects];
+	memset(stats, 0, sizeof(QueueTelemetryStats));
+	stats->name = Name;
+	stats->kind = Kind;
+	stats->capacity = Capacity;
+
+	//the hooks may be looking through the list - publish the entry last
+	taskENTER_CRITICAL();
+	stats->object = Object;
+	numObjects++;
+	taskEXIT_CRITICAL();
+}
+
+/**
+ * start collecting telemetry for a queue
+ * @param Queue		QueueHandle_t
+ * @param Name		used in the report and SystemView
+ */
+void QueueTelemetryRegisterQueue( const void* Queue, const char* Name )
+{
+	QueueHandle_t queue = (QueueHandle_t) Queue;
+	registerObject(Queue, Name, QUEUE_TELEMETRY_QUEUE,
+					uxQueueMessagesWaiting(queue) + uxQueueSpacesAvailable(queue));
+}
+
+/**
+ * start collecting telemetry for a stream or message buffer
+ * @param StreamBuffer	StreamBufferHandle_t
+ * @param Name			used in the report and SystemView
+ */
+void QueueTelemetryRegisterStream( const void* StreamBuffer, const char* Name )
+{
+	StreamBufferHandle_t stream = (StreamBufferHandle_t) StreamBuffer;
+	registerObject(StreamBuffer, Name, QUEUE_TELEMETRY_STREAM,
+					xStreamBufferBytesAvailable(stream) + xStreamBufferSpacesAvailable(stream));
+}
+
+/**
+ * @returns the statistics for Object, NULL if it isn't registered
+ */
+const QueueTelemetryStats* QueueTelemetryGet( const void* Object )
+{
+	for(uint32_t i = 0; i < numObjects; i++)
+	{
+		if(objects[i].object == Object)
+		{
+			return &objects[i];
+		}
+	}
+	return NULL;
+}
+
+static QueueTelemetryStats* findObject( const void* Object )
+{
+	return (QueueTelemetryStats*) QueueTelemetryGet(Object);
+}
+
+/**
+ * called from the queue send hooks (task and ISR)
+ * @param Level	number of items in the queue once the send completes
+ */
+void QueueTelemetrySent( const void* Object, uint32_t Level )
+{
+	QueueTelemetryStats* stats = findObject(Object);
+	if(stats == NULL)
+	{
+		return;
+	}
+
+	//overwriting a full queue doesn't add an item
+	if(Level > stats->capacity)
+	{
+		Level = stats->capacity;
+	}
+	stats->sends++;
+	if(Level > stats->highWater)
+	{
+		stats->highWater = Level;
+	}
+}
+
+/**
+ * called from the stream buffer send hooks (task and ISR)
+ * @param Sent		number of bytes written
+ * @param Requested	number of bytes the caller wanted to write
+ * @param Level		number of bytes in the buffer after the send
+ */
+void QueueTelemetryStreamSent( const void* Object, uint32_t Sent, uint32_t Requested, uint32_t Level )
+{
+	QueueTelemetryStats* stats = findObject(Object);
+	if(stats == NULL)
+	{
+		return;
+	}
+
+	if(Sent == 0)
+	{
+		stats->sendFails++;
+		return;
+	}
+	if(Sent < Requested)
+	{
+		stats->partialSends++;
+	}
+	stats->sends++;
+	if(Level > stats->highWater)
+	{
+		stats->highWater = Level;
+	}
+}
+
+/**
+ * called from the trace hooks for failures
+ */
+void QueueTelemetryCount( const void* Object, QueueTelemetryCounter Counter )
+{
+	QueueTelemetryStats* stats = findObject(Object);
+	if(stats == NULL)
+	{
+		return;
+	}
+
+	switch(Counter)
+	{
+		case QUEUE_TELEMETRY_SEND_FAIL:
+			stats->sendFails++;
+			break;
+		case QUEUE_TELEMETRY_SEND_BLOCK:
+			stats->sendBlocks++;
+			break;
+		case QUEUE_TELEMETRY_RECEIVE_TIMEOUT:
+			stats->receiveTimeouts++;
+			break;
+	}
+}
+
+/**
+ * SystemView calls this whenever it (re)sends the system description,
+ * name each object so events can be matched up with them
+ */
+static void sendModuleDesc( void )
+{
+	for(uint32_t i = 0; i < numObjects; i++)
+	{
+		SEGGER_SYSVIEW_NameResource((U32)objects[i].object, objects[i].name);
+	}
+}
+
+/**
+ * sample the fill level of every registered object and record the results
+ * as SystemView events
+ * called periodically by the task created in QueueTelemetryStart, can also
+ * be called from any task if the sampling task isn't used
+ */
+void QueueTelemetrySample( void )
+{
+	static uint32_t lastErrors[QUEUE_TELEMETRY_MAX_OBJECTS];
+
+	for(uint32_t i = 0; i < numObjects; i++)
+	{
+		QueueTelemetryStats* stats = &objects[i];
+
+		if(stats->kind == QUEUE_TELEMETRY_QUEUE)
+		{
+			stats->level = uxQueueMessagesWaiting((QueueHandle_t)stats->object);
+		}
+		else
+		{
+			stats->level = xStreamBufferBytesAvailable((StreamBufferHandle_t)stats->object);
+		}
+		stats->samples++;
+		stats->levelSum += stats->level;
+
+		//the event offset is only assigned once the module is registered
+		if(telemetryModule.EventOffset != 0)
+		{
+			SEGGER_SYSVIEW_RecordU32x4(telemetryModule.EventOffset + 0,
+					SEGGER_SYSVIEW_ShrinkId((U32)stats->object),
+					stats->level, stats->highWater, stats->capacity);
+
+			const uint32_t errors = stats->sendFails + stats->partialSends + stats->receiveTimeouts;
+			if(errors != lastErrors[i])
+			{
+				lastErrors[i] = errors;
+				SEGGER_SYSVIEW_RecordU32x4(telemetryModule.EventOffset + 1,
+						SEGGER_SYSVIEW_ShrinkId((U32)stats->object),
+						stats->sendFails, stats->partialSends, stats->receiveTimeouts);
+			}
+		}
+	}
+}
+
+static void samplingTask( void* NotUsed )
+{
+	TickType_t lastWake = xTaskGetTickCount();
+
+	while(1)
+	{
+		vTaskDelayUntil(&lastWake, samplePeriodMs / portTICK_PERIOD_MS);
+		QueueTelemetrySample();
+	}
+}
+
+/**
+ * register the SystemView module and create the sampling task
+ * call after SEGGER_SYSVIEW_Conf and after registering the objects
+ * @param PeriodMs	time between samples
+ * @param Priority	priority of the sampling task - a high priority gives
+ * 					more regular samples, but adds jitter to everything below it
+ */
+void QueueTelemetryStart( uint32_t PeriodMs, uint32_t Priority )
+{
+	samplePeriodMs = PeriodMs;
+	SEGGER_SYSVIEW_RegisterModule(&telemetryModule);
+	assert_param(xTaskCreate(samplingTask, "telemetry", 256, NULL, Priority, NULL) == pdPASS);
+}
+
+/**
+ * clear all statistics (the objects stay registered)
+ */
+void QueueTelemetryReset( void )
+{
+	for(uint32_t i = 0; i < numObjects; i++)
+	{
+		QueueTelemetryStats* stats = &objects[i];
+		taskENTER_CRITICAL();
+		stats->highWater = 0;
+		stats->sends = 0;
+		stats->sendFails = 0;
+		stats->sendBlocks = 0;
+		stats->partialSends = 0;
+		stats->receiveTimeouts = 0;
+		stats->samples = 0;
+		stats->levelSum = 0;
+		taskEXIT_CRITICAL();
+	}
+}
+
+/**
+ * format a text report of every registered object, one line each
+ * the report is cut short if Buff is too small
+ * @returns number of characters written (not including the terminator)
+ */
+uint32_t QueueTelemetryReport( char* Buff, uint32_t Len )
+{
+	uint32_t used = 0;
+
+	if(Len == 0)
+	{
+		return 0;
+	}
+	Buff[0] = '\0';
+
+	for(uint32_t i = 0; i < numObjects; i++)
+	{
+		const QueueTelemetryStats* s = &objects[i];
+		//average fill in tenths of a percent of the capacity
+		uint32_t avgPermille = 0;
+		if(s->samples != 0 && s->capacity != 0)
+		{
+			avgPermille = (uint32_t)((s->levelSum * 1000) / ((uint64_t)s->samples * s->capacity));
+		}
+
+		int n = snprintf(Buff + used, Len - used,
+				"%s size=%lu level=%lu high=%lu avg=%lu.%lu%% sends=%lu fails=%lu "
+				"partial=%lu blocked=%lu timeouts=%lu\n",
+				s->name, (unsigned long)s->capacity, (unsigned long)s->level,
+				(unsigned long)s->highWater,
+				(unsigned long)(avgPermille / 10), (unsigned long)(avgPermille % 10),
+				(unsigned long)s->sends, (unsigned long)s->sendFails,
+				(unsigned long)s->partialSends, (unsigned long)s->sendBlocks,
+				(unsigned long)s->receiveTimeouts);
+		if(n < 0 || used + n >= Len)
+		{
+			return Len - 1;
+		}
+		used += n;
+	}
+	return used;
+}
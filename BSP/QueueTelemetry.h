@@ -0,0 +1,125 @@
+/**
+ * MIT License
+ * 
+ * Copyright (c) 2019 Brian Amos
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#ifndef BSP_QUEUETELEMETRY_H_
+#define BSP_QUEUETELEMETRY_H_
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+#include <stdint.h>
+
+/**
+ * Queue and stream buffer occupancy telemetry
+ *
+ * Used for sizing queues and stream buffers from measurements rather than
+ * guesses.  Registered objects are tracked by the FreeRTOS trace hooks
+ * when the build defines QUEUE_TELEMETRY=1 (see TraceHooksFreeRTOS.h):
+ * 	- high water mark (updated on every send, so short bursts aren't missed)
+ * 	- successful sends, failed sends (object full) and sends that had to
+ * 	  block waiting for space
+ * 	- partial sends (stream buffers only - the rest of the data was
+ * 	  dropped unless the caller retried)
+ * 	- receive timeouts (a receive that returned empty handed, including
+ * 	  polls with a 0 timeout)
+ *
+ * QueueTelemetryStart creates a task that samples the fill level of each
+ * object periodically (for the average fill) and records the results as
+ * SystemView user events.  QueueTelemetryReport formats a text report that
+ * can be sent anywhere (i.e. over USB).
+ *
+ * This header is included from FreeRTOSConfig.h, so handles are passed as
+ * void* rather than pulling in the FreeRTOS headers.
+ *
+ * NOTE: the hooks look through the list of registered objects on every
+ * queue and stream buffer operation, keep QUEUE_TELEMETRY out of
+ * production builds
+ */
+
+#define QUEUE_TELEMETRY_MAX_OBJECTS	12
+
+typedef enum
+{
+	QUEUE_TELEMETRY_QUEUE = 0,
+	QUEUE_TELEMETRY_STREAM
+}QueueTelemetryKind;
+
+typedef enum
+{
+	QUEUE_TELEMETRY_SEND_FAIL = 0,
+	QUEUE_TELEMETRY_SEND_BLOCK,
+	QUEUE_TELEMETRY_RECEIVE_TIMEOUT
+}QueueTelemetryCounter;
+
+typedef struct
+{
+	const void* object;
+	const char* name;
+	QueueTelemetryKind kind;
+	uint32_t capacity;				//items for queues, bytes for stream buffers
+
+	volatile uint32_t highWater;
+	volatile uint32_t sends;
+	volatile uint32_t sendFails;
+	volatile uint32_t sendBlocks;
+	volatile uint32_t partialSends;
+	volatile uint32_t receiveTimeouts;
+
+	//maintained by the sampling task
+	uint32_t level;
+	uint32_t samples;
+	uint64_t levelSum;
+}QueueTelemetryStats;
+
+void QueueTelemetryRegisterQueue( const void* Queue, const char* Name );
+void QueueTelemetryRegisterStream( const void* StreamBuffer, const char* Name );
+void QueueTelemetryStart( uint32_t PeriodMs, uint32_t Priority );
+void QueueTelemetrySample( void );
+void QueueTelemetryReset( void );
+const QueueTelemetryStats* QueueTelemetryGet( const void* Object );
+uint32_t QueueTelemetryReport( char* Buff, uint32_t Len );
+
+//called from the trace hooks
+void QueueTelemetrySent( const void* Object, uint32_t Level );
+void QueueTelemetryStreamSent( const void* Object, uint32_t Sent, uint32_t Requested, uint32_t Level );
+void QueueTelemetryCount( const void* Object, QueueTelemetryCounter Counter );
+
+/**
+ * register objects only in builds that collect telemetry, so drivers can
+ * register their buffers without any cost otherwise
+ */
+#if defined(QUEUE_TELEMETRY) && QUEUE_TELEMETRY == 1
+#define QUEUE_TELEMETRY_REGISTER_QUEUE(Queue, Name)		QueueTelemetryRegisterQueue((Queue), (Name))
+#define QUEUE_TELEMETRY_REGISTER_STREAM(Stream, Name)	QueueTelemetryRegisterStream((Stream), (Name))
+#define QUEUE_TELEMETRY_START(PeriodMs, Priority)		QueueTelemetryStart((PeriodMs), (Priority))
+#else
+#define QUEUE_TELEMETRY_REGISTER_QUEUE(Queue, Name)
+#define QUEUE_TELEMETRY_REGISTER_STREAM(Stream, Name)
+#define QUEUE_TELEMETRY_START(PeriodMs, Priority)
+#endif
+
+#ifdef __cplusplus
+ }
+#endif
+#endif /* BSP_QUEUETELEMETRY_H_ */
@@ -0,0 +1,99 @@
+/**
+ * Handoff from ISR's running above the RTOS to tasks - see RadarHandoff.h
+ */
+
+#include <RadarHandoff.h>
+
+static RadarChannel* channels[RADAR_MAX_CHANNELS];
+static uint32_t numChannels = 0;
+
+/**
+ * enable the handoff IRQ - call once before any channels are used
+ * @param SwiPriority	NVIC priority of the handoff IRQ, must be allowed to
+ * 						call FreeRTOS (>= configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY)
+ */
+void RadarHandoffInit( uint32_t SwiPriority )
+{
+	assert_param(SwiPriority >= configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY);
+	NVIC_SetPriority(RADAR_SWI_IRQn, SwiPriority);
+	NVIC_ClearPendingIRQ(RADAR_SWI_IRQn);
+	NVIC_EnableIRQ(RADAR_SWI_IRQn);
+}
+
+/**
+ * setup a channel - call before the producing ISR is enabled
+ * @param Buff		storage for the ring
+ * @param Len		number of words in Buff, must be a power of 2
+ * @param Consumer	the task that will call RadarChannelRead
+ */
+void RadarChannelInit( RadarChannel* Channel, uint32_t* Buff, uint32_t Len, TaskHandle_t Consumer )
+{
+	assert_param(Len != 0 && (Len & (Len - 1)) == 0);
+	assert_param(numChannels < RADAR_MAX_CHANNELS);
+
+	Channel->buff = Buff;
+	Channel->len = Len;
+	Channel->head = 0;
+	Channel->tail = 0;
+	Channel->dropped = 0;
+	Channel->consumer = Consumer;
+
+	//the handoff IRQ may be scanning the list - publish the channel last
+	NVIC_DisableIRQ(RADAR_SWI_IRQn);
+	channels[numChannels++] = Channel;
+	NVIC_EnableIRQ(RADAR_SWI_IRQn);
+}
+
+/**
+ * read up to MaxWords from the channel - only call from the consumer task
+ * @param TicksToWait	how long to wait for data if the channel is empty
+ * @returns number of words read, 0 if nothing arrived in time
+ */
+uint32_t RadarChannelRead( RadarChannel* Channel, uint32_t* Dst, uint32_t MaxWords, TickType_t TicksToWait )
+{
+	uint32_t tail = Channel->tail;
+
+	while(Channel->head == tail)
+	{
+		//the handoff IRQ gives a notification for every signal, so data that
+		//arrived after the check above still wakes us up immediately
+		if(ulTaskNotifyTake(pdTRUE, TicksToWait) == 0)
+		{
+			return 0;
+		}
+	}
+
+	const uint32_t available = Channel->head - tail;
+	const uint32_t numWords = available < MaxWords ? available : MaxWords;
+
+	//don't read the data before head
+	__DMB();
+	for(uint32_t i = 0; i < numWords; i++)
+	{
+		Dst[i] = Channel->buff[(tail + i) & (Channel->len - 1)];
+	}
+
+	//the data must be read before the producer can overwrite it
+	__DMB();
+	Channel->tail = tail + numWords;
+	return numWords;
+}
+
+/**
+ * the handoff IRQ - only ever pended by RadarIsrSignal
+ * wakes the consumer of every channel that has data waiting
+ */
+void RADAR_SWI_IRQHandler( void )
+{
+	BaseType_t higherPriorityTaskWoken = pdFALSE;
+
+	for(uint32_t i = 0; i < numChannels; i++)
+	{
+		RadarChannel* channel = channels[i];
+		if(channel->head != channel->tail)
+		{
+			vTaskNotifyGiveFromISR(channel->consumer, &higherPriorityTaskWoken);
+		}
+	}
+	portYIELD_FROM_ISR(higherPriorityTaskWoken);
+}
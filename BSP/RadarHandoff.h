@@ -0,0 +1,125 @@
+/**
+ * MIT License
+ * 
+ * Copyright (c) 2019 Brian Amos
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#ifndef BSP_RADARHANDOFF_H_
+#define BSP_RADARHANDOFF_H_
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+#include <FreeRTOS.h>
+#include <task.h>
+#include <stm32f7xx_hal.h>
+#include <stdbool.h>
+
+/**
+ * Handoff from ISR's running "under the RTOS radar" to tasks
+ *
+ * Interrupts with a higher priority than configMAX_SYSCALL_INTERRUPT_PRIORITY
+ * are never masked by FreeRTOS critical sections, so their latency only
+ * depends on the hardware and other high priority ISR's.  The price is
+ * that they can't call any FreeRTOS API (not even the FromISR versions).
+ *
+ * This module connects them to tasks without ever masking them:
+ * 	- the high priority ISR writes words into a RadarChannel, a lock-free
+ * 	  single producer/single consumer ring, and pends the handoff IRQ
+ * 	  (RadarIsrSignal)
+ * 	- the handoff IRQ is an otherwise unused peripheral interrupt that's
+ * 	  only ever triggered by software.  It runs at a priority that's allowed
+ * 	  to use FreeRTOS and notifies the consumer task of every channel
+ * 	  that has data
+ * 	- the consumer task reads from the channel (RadarChannelRead), blocking
+ * 	  on its task notification while the channel is empty
+ *
+ * PendSV isn't used for the handoff since FreeRTOS uses it for context switches.
+ *
+ * Each channel has exactly one producer (ISR) and one consumer (task).
+ * The consumer's task notification (index 0) is used by the channel,
+ * so the consumer shouldn't use it for anything else.
+ */
+
+//the spare interrupt used for the handoff - SPDIF isn't used on the Nucleo board
+#ifndef RADAR_SWI_IRQn
+#define RADAR_SWI_IRQn			SPDIF_RX_IRQn
+#define RADAR_SWI_IRQHandler	SPDIF_RX_IRQHandler
+#endif
+
+/**
+ * the lowest urgency NVIC priority that is still never masked by FreeRTOS,
+ * ISR's writing to a RadarChannel must be at this priority or higher
+ * (numerically lower)
+ */
+#define RADAR_MAX_ISR_PRIORITY	(configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY - 1)
+
+#define RADAR_MAX_CHANNELS 4
+
+typedef struct
+{
+	uint32_t* buff;
+	uint32_t len;					//power of 2
+	volatile uint32_t head;			//only written by the producer
+	volatile uint32_t tail;			//only written by the consumer
+	volatile uint32_t dropped;		//words the producer couldn't fit
+	TaskHandle_t consumer;
+}RadarChannel;
+
+void RadarHandoffInit( uint32_t SwiPriority );
+void RadarChannelInit( RadarChannel* Channel, uint32_t* Buff, uint32_t Len, TaskHandle_t Consumer );
+uint32_t RadarChannelRead( RadarChannel* Channel, uint32_t* Dst, uint32_t MaxWords, TickType_t TicksToWait );
+
+/**
+ * add a word to the channel - only call from the channel's producer
+ * call RadarIsrSignal once after one or more writes to wake the consumer
+ * @returns false if the channel was full (the word is dropped)
+ */
+static inline bool RadarIsrPut( RadarChannel* Channel, uint32_t Value )
+{
+	const uint32_t head = Channel->head;
+
+	if(head - Channel->tail >= Channel->len)
+	{
+		Channel->dropped++;
+		return false;
+	}
+	Channel->buff[head & (Channel->len - 1)] = Value;
+
+	//the data must be visible before the consumer sees the new head
+	__DMB();
+	Channel->head = head + 1;
+	return true;
+}
+
+/**
+ * pend the handoff IRQ - it runs as soon as no higher priority
+ * interrupts are active
+ */
+static inline void RadarIsrSignal( void )
+{
+	NVIC_SetPendingIRQ(RADAR_SWI_IRQn);
+}
+
+#ifdef __cplusplus
+ }
+#endif
+#endif /* BSP_RADARHANDOFF_H_ */
@@ -0,0 +1,114 @@
+/**
+ * High throughput RTT up-channels - see RttFast.h
+ */
+
+#include <RttFast.h>
+#include <stm32f7xx_hal.h>
+
+#if defined(SEGGER_RTT_LOCK_PROFILE) && (SEGGER_RTT_LOCK_PROFILE == 1)
+volatile RTT_LOCK_PROFILE RttLockProfile;
+#endif
+
+/**
+ * configure an up-channel for use with RttFastWrite
+ * data that doesn't fit is dropped, so the writer never blocks
+ * @param Channel	must be < SEGGER_RTT_MAX_NUM_UP_BUFFERS and only
+ * 					written by one task or ISR
+ * @param Buff		buffer declared with RTT_FAST_BUFFER
+ */
+void RttFastConfig( unsigned Channel, const char* Name, uint8_t* Buff, unsigned Size )
+{
+	assert_param(Channel < SEGGER_RTT_MAX_NUM_UP_BUFFERS);
+	assert_param(((uint32_t)Buff % RTT_FAST_CACHE_LINE) == 0);
+	assert_param(SEGGER_RTT_ConfigUpBuffer(Channel, Name, Buff, Size, SEGGER_RTT_MODE_NO_BLOCK_SKIP) >= 0);
+}
+
+/**
+ * copy NumBytes from Src to Dest a word at a time
+ * Dest is aligned first, the Cortex-M7 handles the unaligned
+ * source reads (normal memory only)
+ * @returns Dest (same as memcpy)
+ */
+void* RttFastCopy( void* Dest, const void* Src, unsigned NumBytes )
+{
+	uint8_t* dest = Dest;
+	const uint8_t* src = Src;
+
+	while(NumBytes > 0 && ((uint32_t)dest & 3) != 0)
+	{
+		*dest++ = *src++;
+		NumBytes--;
+	}
+
+	uint32_t* destWord = (uint32_t*)dest;
+	while(NumBytes >= 16)
+	{
+		destWord[0] = __UNALIGNED_UINT32_READ(src);
+		destWord[1] = __UNALIGNED_UINT32_READ(src + 4);
+		destWord[2] = __UNALIGNED_UINT32_READ(src + 8);
+		destWord[3] = __UNALIGNED_UINT32_READ(src + 12);
+		destWord += 4;
+		src += 16;
+		NumBytes -= 16;
+	}
+	while(NumBytes >= 4)
+	{
+		*destWord++ = __UNALIGNED_UINT32_READ(src);
+		src += 4;
+		NumBytes -= 4;
+	}
+
+	dest = (uint8_t*)destWord;
+	while(NumBytes > 0)
+	{
+		*dest++ = *src++;
+		NumBytes--;
+	}
+	return Dest;
+}
+
+/**
+ * lock-free write to a channel configured with RttFastConfig
+ * only one task or ISR may write to Channel
+ * @returns NumBytes if written, 0 if there wasn't room for all of it
+ * 			(partial writes are never made)
+ */
+unsigned RttFastWrite( unsigned Channel, const void* Data, unsigned NumBytes )
+{
+	SEGGER_RTT_BUFFER_UP* ring = &_SEGGER_RTT.aUp[Channel];
+	const unsigned size = ring->SizeOfBuffer;
+	const unsigned rdOff = ring->RdOff;
+	unsigned wrOff = ring->WrOff;
+
+	if(size == 0)
+	{
+		//channel hasn't been configured
+		return 0;
+	}
+
+	//one byte is always left free to tell a full buffer from an empty one
+	unsigned available = (rdOff > wrOff) ? (rdOff - wrOff - 1) : (size - (wrOff - rdOff) - 1);
+	if(NumBytes > available)
+	{
+		return 0;
+	}
+
+	unsigned first = size - wrOff;
+	if(first > NumBytes)
+	{
+		first = NumBytes;
+	}
+	RttFastCopy(ring->pBuffer + wrOff, Data, first);
+	RttFastCopy(ring->pBuffer, (const uint8_t*)Data + first, NumBytes - first);
+
+	wrOff += NumBytes;
+	if(wrOff >= size)
+	{
+		wrOff -= size;
+	}
+
+	//the data must be in memory before the probe can see the new WrOff
+	__DMB();
+	ring->WrOff = wrOff;
+	return NumBytes;
+}
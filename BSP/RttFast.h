@@ -0,0 +1,66 @@
+/**
+ * MIT License
+ * 
+ * Copyright (c) 2019 Brian Amos
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#ifndef BSP_RTTFAST_H_
+#define BSP_RTTFAST_H_
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+#include <stdint.h>
+#include <SEGGER_RTT.h>
+
+/**
+ * High throughput RTT up-channels
+ *
+ * SEGGER_RTT_Write masks interrupts (SEGGER_RTT_LOCK) for the whole copy,
+ * because any task or ISR may write to any channel.  When a channel is
+ * only ever written by a single task (or a single ISR), no lock is needed:
+ * the writer owns WrOff, the debug probe owns RdOff, and the data only has
+ * to be in memory before WrOff is advanced.
+ *
+ * RttFastWrite is that lock-free single writer path.  Give each producer
+ * its own channel (see SEGGER_RTT_HIGH_THROUGHPUT in SEGGER_RTT_Conf.h for
+ * the number of channels) and a buffer declared with RTT_FAST_BUFFER.
+ *
+ * Buffers are cache line aligned so they can be made non-cacheable
+ * with the MPU if the data cache is ever enabled - the probe reads RAM
+ * directly, so it can't see anything still sitting in the cache.
+ */
+
+#define RTT_FAST_CACHE_LINE		32
+
+/**
+ * declare a buffer suitable for RttFastConfig
+ */
+#define RTT_FAST_BUFFER(Name, Size)	static uint8_t Name[(Size)] __attribute__((aligned(RTT_FAST_CACHE_LINE)))
+
+void RttFastConfig( unsigned Channel, const char* Name, uint8_t* Buff, unsigned Size );
+unsigned RttFastWrite( unsigned Channel, const void* Data, unsigned NumBytes );
+void* RttFastCopy( void* Dest, const void* Src, unsigned NumBytes );
+
+#ifdef __cplusplus
+ }
+#endif
+#endif /* BSP_RTTFAST_H_ */
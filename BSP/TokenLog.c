@@ -0,0 +1,123 @@
+/**
+ * Tokenized logger - see TokenLog.h
+ */
+
+#include <TokenLog.h>
+#include <task.h>
+#include <SEGGER_RTT.h>
+
+TokenLogRecord tokenLogRing[TOKENLOG_NUM_RECORDS];
+volatile uint32_t tokenLogHead = 0;
+
+//only accessed by the (single) reader
+static uint32_t readIdx = 0;
+static uint32_t numDropped = 0;
+
+//RTT up-buffer the drain task copies records into
+#define RTT_BUFFER_SIZE (64 * sizeof(TokenLogRecord))
+static char rttBuffer[RTT_BUFFER_SIZE];
+
+//records moved to RTT at a time
+#define DRAIN_CHUNK 8
+#define DRAIN_PERIOD_MS 10
+
+static void tokenLogDrainTask( void* NotUsed );
+
+/**
+ * Start the cycle counter used for timestamps, configure the RTT up-buffer
+ * and create the task that moves records from the ring into it
+ * (logging works before this is called, records simply wait in the ring)
+ * @param StackSize	size (in FreeRTOS words) of the stack for the drain task
+ * @param Priority	priority of the drain task - usually just above idle
+ */
+void TokenLogInit( const configSTACK_DEPTH_TYPE StackSize, UBaseType_t Priority )
+{
+	CycleCounterInit();
+	SEGGER_RTT_ConfigUpBuffer(TOKENLOG_RTT_CHANNEL, "TokenLog", rttBuffer,
+								RTT_BUFFER_SIZE, SEGGER_RTT_MODE_NO_BLOCK_SKIP);
+	assert_param(xTaskCreate(tokenLogDrainTask, "tokenLog", StackSize, NULL, Priority, NULL) == pdPASS);
+}
+
+/**
+ * copy completed records out of the ring, oldest first
+ * records overwritten before they were read are counted (see TokenLogDropped)
+ * only a single task may read
+ * @returns the number of records copied into Dst
+ */
+uint32_t TokenLogRead( TokenLogRecord* Dst, uint32_t MaxRecords )
+{
+	uint32_t numRead = 0;
+
+	while(numRead < MaxRecords)
+	{
+		const uint32_t head = tokenLogHead;
+		if(readIdx == head)
+		{
+			break;
+		}
+		if(head - readIdx > TOKENLOG_NUM_RECORDS)
+		{
+			//writers have lapped the reader
+			numDropped += head - readIdx - TOKENLOG_NUM_RECORDS;
+			readIdx = head - TOKENLOG_NUM_RECORDS;
+		}
+
+		const TokenLogRecord* record = &tokenLogRing[readIdx & (TOKENLOG_NUM_RECORDS - 1)];
+		const uint32_t seq = record->seq;
+		if(seq == 0 || (int32_t)(seq - (readIdx + 1)) < 0)
+		{
+			//the writer that claimed this slot hasn't finished yet
+			break;
+		}
+		if(seq != readIdx + 1)
+		{
+			//already overwritten by a newer record
+			numDropped++;
+			readIdx++;
+			continue;
+		}
+
+		__DMB();
+		Dst[numRead] = *record;
+		__DMB();
+		if(record->seq != seq)
+		{
+			//overwritten while being copied
+			numDropped++;
+			readIdx++;
+			continue;
+		}
+		numRead++;
+		readIdx++;
+	}
+
+	return numRead;
+}
+
+/**
+ * @returns the number of records lost because the ring was full
+ */
+uint32_t TokenLogDropped( void )
+{
+	return numDropped;
+}
+
+static void tokenLogDrainTask( void* NotUsed )
+{
+	TokenLogRecord records[DRAIN_CHUNK];
+
+	while(1)
+	{
+		uint32_t numRecords = TokenLogRead(records, DRAIN_CHUNK);
+		if(numRecords > 0)
+		{
+			//the host sees gaps in the sequence numbers if the
+			//RTT buffer is full (nothing is reading it)
+			SEGGER_RTT_Write(TOKENLOG_RTT_CHANNEL, records, numRecords * sizeof(TokenLogRecord));
+		}
+		else
+		{
+			vTaskDelay(DRAIN_PERIOD_MS / portTICK_PERIOD_MS);
+		}
+	}
+}
@@ -0,0 +1,167 @@
+/**
+ * MIT License
+ * 
+ * Copyright (c) 2019 Brian Amos
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#ifndef BSP_TOKENLOG_H_
+#define BSP_TOKENLOG_H_
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stm32f7xx_hal.h>
+#include <DWTCycleCounter.h>
+#include <FreeRTOS.h>
+
+/**
+ * Tokenized logging
+ *
+ * LOG_xxx("fmt", args) records only the address of the format string
+ * (the token), a DWT cycle count timestamp and up to TOKENLOG_MAX_ARGS raw
+ * 32 bit arguments - no formatting takes place on the target.
+ *
+ * Format strings are placed in the .tokenlog section, which the linker
+ * script marks as INFO: they stay in the .elf file (where the host
+ * decoder reads them) but take up no flash.  Each string is prefixed
+ * with the level, file and line of the call.
+ *
+ * Arguments are stored as uint32_t, so %f isn't supported and %s can't
+ * be used (the decoder has no access to target RAM) - cast pointers
+ * to uint32_t and print them with %x.
+ *
+ * Calls below TOKENLOG_LEVEL are removed by the preprocessor.  Define
+ * TOKENLOG_LEVEL before including this file (or in the build
+ * configuration) to change it.
+ *
+ * Records are written to a lock-free ring (safe from any task or ISR).
+ * A low priority task started by TokenLogInit copies them into an RTT
+ * up-buffer, decode the captured data with TokenLogDecoder/tokenLogDecoder.py
+ */
+
+#define TOKENLOG_LEVEL_NONE		0
+#define TOKENLOG_LEVEL_ERROR	1
+#define TOKENLOG_LEVEL_WARN		2
+#define TOKENLOG_LEVEL_INFO		3
+#define TOKENLOG_LEVEL_DEBUG	4
+
+#ifndef TOKENLOG_LEVEL
+#define TOKENLOG_LEVEL TOKENLOG_LEVEL_INFO
+#endif
+
+#define TOKENLOG_MAX_ARGS		4
+#define TOKENLOG_NUM_RECORDS	256		//must be a power of 2
+#define TOKENLOG_RTT_CHANNEL	2		//SystemView uses channel 1
+
+/**
+ * A single log entry
+ * this is also the format sent to the host, so all fields are 32 bits
+ */
+typedef struct
+{
+	volatile uint32_t seq;			//sequence number + 1, 0 while being written
+	uint32_t token;					//address of the format string
+	uint32_t timestamp;				//DWT cycle count
+	uint32_t numArgs;
+	uint32_t args[TOKENLOG_MAX_ARGS];
+}TokenLogRecord;
+
+extern TokenLogRecord tokenLogRing[TOKENLOG_NUM_RECORDS];
+extern volatile uint32_t tokenLogHead;
+
+void TokenLogInit( const configSTACK_DEPTH_TYPE StackSize, UBaseType_t Priority );
+uint32_t TokenLogRead( TokenLogRecord* Dst, uint32_t MaxRecords );
+uint32_t TokenLogDropped( void );
+
+/**
+ * claim the next slot in the ring and fill it in
+ * the slot is claimed with LDREX/STREX so tasks and ISR's
+ * can log at the same time without a critical section
+ */
+static inline void TokenLogWrite( uint32_t Token, uint32_t NumArgs, const uint32_t* Args )
+{
+	uint32_t idx;
+	do
+	{
+		idx = __LDREXW(&tokenLogHead);
+	}while(__STREXW(idx + 1, &tokenLogHead) != 0);
+
+	TokenLogRecord* record = &tokenLogRing[idx & (TOKENLOG_NUM_RECORDS - 1)];
+	record->seq = 0;
+	record->token = Token;
+	record->timestamp = CycleCount();
+	record->numArgs = NumArgs;
+	for(uint32_t i = 0; i < NumArgs; i++)
+	{
+		record->args[i] = Args[i];
+	}
+
+	//the record must be complete before it is marked valid
+	__DMB();
+	record->seq = idx + 1;
+}
+
+#define TOKENLOG_STR_(x) #x
+#define TOKENLOG_STR(x) TOKENLOG_STR_(x)
+
+//evaluates to the number of arguments passed (0-8)
+#define TOKENLOG_NARGS(...) TOKENLOG_NARGS_(0, ##__VA_ARGS__, 8, 7, 6, 5, 4, 3, 2, 1, 0)
+#define TOKENLOG_NARGS_(_0, _1, _2, _3, _4, _5, _6, _7, _8, N, ...) N
+
+#define TOKENLOG(LevelName, Fmt, ...)																	\
+	do																									\
+	{																									\
+		_Static_assert(TOKENLOG_NARGS(__VA_ARGS__) <= TOKENLOG_MAX_ARGS, "too many log arguments");	\
+		static const char tokenLogFmt[] __attribute__((section(".tokenlog"), used)) =					\
+				LevelName "|" __FILE__ ":" TOKENLOG_STR(__LINE__) "|" Fmt;								\
+		TokenLogWrite((uint32_t)tokenLogFmt, TOKENLOG_NARGS(__VA_ARGS__),								\
+						(const uint32_t[]){0, ##__VA_ARGS__} + 1);										\
+	}while(0)
+
+#if TOKENLOG_LEVEL >= TOKENLOG_LEVEL_ERROR
+#define LOG_ERROR(Fmt, ...) TOKENLOG("ERR", Fmt, ##__VA_ARGS__)
+#else
+#define LOG_ERROR(Fmt, ...) do{}while(0)
+#endif
+
+#if TOKENLOG_LEVEL >= TOKENLOG_LEVEL_WARN
+#define LOG_WARN(Fmt, ...) TOKENLOG("WRN", Fmt, ##__VA_ARGS__)
+#else
+#define LOG_WARN(Fmt, ...) do{}while(0)
+#endif
+
+#if TOKENLOG_LEVEL >= TOKENLOG_LEVEL_INFO
+#define LOG_INFO(Fmt, ...) TOKENLOG("INF", Fmt, ##__VA_ARGS__)
+#else
+#define LOG_INFO(Fmt, ...) do{}while(0)
+#endif
+
+#if TOKENLOG_LEVEL >= TOKENLOG_LEVEL_DEBUG
+#define LOG_DEBUG(Fmt, ...) TOKENLOG("DBG", Fmt, ##__VA_ARGS__)
+#else
+#define LOG_DEBUG(Fmt, ...) do{}while(0)
+#endif
+
+#ifdef __cplusplus
+ }
+#endif
+#endif /* BSP_TOKENLOG_H_ */
@@ -0,0 +1,107 @@
+import argparse
+import re
+import struct
+import sys
+
+from elftools.elf.elffile import ELFFile
+
+
+# these values must match TokenLog.h
+TOKENLOG_MAX_ARGS = 4
+RECORD_FORMAT = '<' + 'I' * (4 + TOKENLOG_MAX_ARGS)
+RECORD_LEN = struct.calcsize(RECORD_FORMAT)
+
+# printf conversions, length modifiers are dropped since every argument is 32 bits
+CONVERSION = re.compile(r'%([-+ #0]*\d*(?:\.\d+)?)(?:hh|h|ll|l|z|j|t)?([diouxXc%])')
+
+
+# read every format string out of the .tokenlog section
+# @returns dict of token (target address) -> (level, location, format)
+def loadDictionary(elfFileName: str):
+    strings = {}
+    with open(elfFileName, 'rb') as f:
+        elf = ELFFile(f)
+        section = elf.get_section_by_name('.tokenlog')
+        if section is None:
+            raise ValueError('{} has no .tokenlog section'.format(elfFileName))
+        data = section.data()
+        base = section['sh_addr']
+
+    offset = 0
+    while offset < len(data):
+        end = data.find(b'\x00', offset)
+        if end < 0:
+            break
+        if end > offset:
+            level, location, fmt = data[offset:end].decode('utf-8', 'replace').split('|', 2)
+            strings[(base + offset) & 0xffffffff] = (level, location, fmt)
+        offset = end + 1
+    return strings
+
+
+# format a single record the way printf would have on the target
+def formatRecord(fmt: str, args: list):
+    values = iter(args)
+
+    def convert(match):
+        flags, conversion = match.group(1), match.group(2)
+        if conversion == '%':
+            return '%'
+        value = next(values, 0)
+        if conversion in 'di':
+            value = struct.unpack('<i', struct.pack('<I', value))[0]
+            conversion = 'd'
+        elif conversion == 'u':
+            conversion = 'd'
+        elif conversion == 'c':
+            value = value & 0xff
+        return ('%' + flags + conversion) % value
+
+    return CONVERSION.sub(convert, fmt)
+
+
+# decode a capture of the TokenLog RTT channel
+# @returns number of records lost (detected by gaps in the sequence numbers)
+def decode(captureFileName: str, strings: dict, cpuFreq: float, out):
+    numLost = 0
+    expectedSeq = None
+    with open(captureFileName, 'rb') as f:
+        data = f.read()
+
+    for offset in range(0, len(data) - RECORD_LEN + 1, RECORD_LEN):
+        fields = struct.unpack_from(RECORD_FORMAT, data, offset)
+        seq, token, timestamp, numArgs = fields[:4]
+        args = list(fields[4:4 + min(numArgs, TOKENLOG_MAX_ARGS)])
+
+        if expectedSeq is not None and seq != expectedSeq:
+            lost = (seq - expectedSeq) & 0xffffffff
+            numLost += lost
+            out.write('*** {} records lost ***\n'.format(lost))
+        expectedSeq = (seq + 1) & 0xffffffff
+
+        timeUs = timestamp / cpuFreq * 1e6
+        if token in strings:
+            level, location, fmt = strings[token]
+            out.write('{:14.1f}us {} {}: {}\n'.format(timeUs, level, location, formatRecord(fmt, args)))
+        else:
+            out.write('{:14.1f}us ??? unknown token 0x{:08x} args {}\n'.format(timeUs, token, args))
+    return numLost
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Decode TokenLog records captured from RTT')
+    parser.add_argument('elf', help='.elf file the target is running (contains the format strings)')
+    parser.add_argument('capture', help='binary capture of the TokenLog RTT channel (e.g. from JLinkRTTLogger)')
+    parser.add_argument('--cpu-freq', type=float, default=216e6,
+                        help='DWT cycle counter frequency in Hz (default 216MHz)')
+    args = parser.parse_args()
+
+    strings = loadDictionary(args.elf)
+    numLost = decode(args.capture, strings, args.cpu_freq, sys.stdout)
+    if numLost:
+        print('{} records lost in total'.format(numLost), file=sys.stderr)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
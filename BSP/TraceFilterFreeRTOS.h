@@ -0,0 +1,144 @@
+/**
+ * MIT License
+ * 
+ * Copyright (c) 2019 Brian Amos
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#ifndef BSP_TRACEFILTERFREERTOS_H_
+#define BSP_TRACEFILTERFREERTOS_H_
+
+/**
+ * Compile-time filtering of the SystemView kernel events
+ *
+ * SEGGER_SYSVIEW_FreeRTOS.h records every kernel API call.  The groups
+ * below can be removed individually by defining them as 0 in the build
+ * configuration - the trace hooks of a disabled group expand to nothing.
+ * Scheduling events (task switches, ready/blocked, ISR enter/exit) and
+ * object creation are always recorded, SystemView can't make sense of a
+ * trace without them.
+ *
+ * 	TRACE_KERNEL_QUEUE		queue, semaphore and mutex send/receive/peek
+ * 	TRACE_KERNEL_STREAM		stream and message buffer send/receive
+ * 	TRACE_KERNEL_NOTIFY		task notifications
+ * 	TRACE_KERNEL_TASK_API	delays, suspend/resume, priority inheritance, tick jumps
+ *
+ * Events that are compiled in can still be turned off at run time with
+ * SEGGER_SYSVIEW_DisableEvents.
+ *
+ * Included by TraceHooksFreeRTOS.h, which wraps its own SystemView calls
+ * in the TRACE_SYSVIEW_* macros so the tools built on the hooks keep
+ * working with any combination of groups.
+ */
+
+#ifndef TRACE_KERNEL_QUEUE
+#define TRACE_KERNEL_QUEUE		1
+#endif
+#ifndef TRACE_KERNEL_STREAM
+#define TRACE_KERNEL_STREAM		1
+#endif
+#ifndef TRACE_KERNEL_NOTIFY
+#define TRACE_KERNEL_NOTIFY		1
+#endif
+#ifndef TRACE_KERNEL_TASK_API
+#define TRACE_KERNEL_TASK_API	1
+#endif
+
+#if TRACE_KERNEL_QUEUE
+#define TRACE_SYSVIEW_QUEUE(Call)	Call
+#else
+#define TRACE_SYSVIEW_QUEUE(Call)
+#undef traceQUEUE_PEEK
+#define traceQUEUE_PEEK( pxQueue )
+#undef traceQUEUE_PEEK_FROM_ISR
+#define traceQUEUE_PEEK_FROM_ISR( pxQueue )
+#undef traceQUEUE_PEEK_FROM_ISR_FAILED
+#define traceQUEUE_PEEK_FROM_ISR_FAILED( pxQueue )
+#undef traceQUEUE_RECEIVE
+#define traceQUEUE_RECEIVE( pxQueue )
+#undef traceQUEUE_RECEIVE_FAILED
+#define traceQUEUE_RECEIVE_FAILED( pxQueue )
+#undef traceQUEUE_SEMAPHORE_RECEIVE
+#define traceQUEUE_SEMAPHORE_RECEIVE( pxQueue )
+#undef traceQUEUE_RECEIVE_FROM_ISR
+#define traceQUEUE_RECEIVE_FROM_ISR( pxQueue )
+#undef traceQUEUE_RECEIVE_FROM_ISR_FAILED
+#define traceQUEUE_RECEIVE_FROM_ISR_FAILED( pxQueue )
+#undef traceQUEUE_SEND
+#define traceQUEUE_SEND( pxQueue )
+#undef traceQUEUE_SEND_FAILED
+#define traceQUEUE_SEND_FAILED( pxQueue )
+#undef traceQUEUE_SEND_FROM_ISR
+#define traceQUEUE_SEND_FROM_ISR( pxQueue )
+#undef traceQUEUE_SEND_FROM_ISR_FAILED
+#define traceQUEUE_SEND_FROM_ISR_FAILED( pxQueue )
+#endif
+
+#if TRACE_KERNEL_STREAM
+#define TRACE_SYSVIEW_STREAM(Call)	Call
+#else
+#define TRACE_SYSVIEW_STREAM(Call)
+#undef traceSTREAM_BUFFER_SEND
+#define traceSTREAM_BUFFER_SEND( xStreamBuffer, xBytesSent )
+#undef traceSTREAM_BUFFER_SEND_FAILED
+#define traceSTREAM_BUFFER_SEND_FAILED( xStreamBuffer )
+#undef traceSTREAM_BUFFER_SEND_FROM_ISR
+#define traceSTREAM_BUFFER_SEND_FROM_ISR( xStreamBuffer, xBytesSent )
+#undef traceSTREAM_BUFFER_RECEIVE
+#define traceSTREAM_BUFFER_RECEIVE( xStreamBuffer, xReceivedLength )
+#undef traceSTREAM_BUFFER_RECEIVE_FAILED
+#define traceSTREAM_BUFFER_RECEIVE_FAILED( xStreamBuffer )
+#undef traceSTREAM_BUFFER_RECEIVE_FROM_ISR
+#define traceSTREAM_BUFFER_RECEIVE_FROM_ISR( xStreamBuffer, xReceivedLength )
+#endif
+
+#if !TRACE_KERNEL_NOTIFY
+#undef traceTASK_NOTIFY
+#define traceTASK_NOTIFY()
+#undef traceTASK_NOTIFY_FROM_ISR
+#define traceTASK_NOTIFY_FROM_ISR()
+#undef traceTASK_NOTIFY_GIVE_FROM_ISR
+#define traceTASK_NOTIFY_GIVE_FROM_ISR()
+#undef traceTASK_NOTIFY_TAKE
+#define traceTASK_NOTIFY_TAKE()
+#undef traceTASK_NOTIFY_WAIT
+#define traceTASK_NOTIFY_WAIT()
+#endif
+
+#if !TRACE_KERNEL_TASK_API
+#undef traceTASK_DELAY
+#define traceTASK_DELAY()
+#undef traceTASK_DELAY_UNTIL
+#define traceTASK_DELAY_UNTIL( xTimeToWake )
+#undef traceTASK_SUSPEND
+#define traceTASK_SUSPEND( pxTCB )
+#undef traceTASK_RESUME
+#define traceTASK_RESUME( pxTCB )
+#undef traceTASK_RESUME_FROM_ISR
+#define traceTASK_RESUME_FROM_ISR( pxTCB )
+#undef traceTASK_PRIORITY_INHERIT
+#define traceTASK_PRIORITY_INHERIT( pxTCB, uxPriority )
+#undef traceTASK_PRIORITY_DISINHERIT
+#define traceTASK_PRIORITY_DISINHERIT( pxTCB, uxBasePriority )
+#undef traceINCREASE_TICK_COUNT
+#define traceINCREASE_TICK_COUNT( xTicksToJump )
+#endif
+
+#endif /* BSP_TRACEFILTERFREERTOS_H_ */
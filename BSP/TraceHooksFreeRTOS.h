@@ -0,0 +1,236 @@
+/**
+ * MIT License
+ * 
+ * Copyright (c) 2019 Brian Amos
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#ifndef BSP_TRACEHOOKSFREERTOS_H_
+#define BSP_TRACEHOOKSFREERTOS_H_
+
+/**
+ * FreeRTOS trace hooks for the BSP instrumentation
+ * 	- flight recorder (FlightRecorder.h), enabled with FLIGHT_RECORDER=1
+ * 	- mutex profiler (MutexProfiler.h), enabled with MUTEX_PROFILER=1
+ * 	- queue telemetry (QueueTelemetry.h), enabled with QUEUE_TELEMETRY=1
+ *
+ * Include this at the end of FreeRTOSConfig.h, after SEGGER_SYSVIEW_FreeRTOS.h.
+ * A trace macro can only be defined once, so each hook used by any of the
+ * tools is redefined here to make the same SystemView call as before,
+ * followed by the call for each enabled tool.  Tools that aren't enabled
+ * expand to nothing, and if none are enabled the SystemView hooks are
+ * left alone.
+ * The SystemView calls are subject to the kernel trace filters in
+ * TraceFilterFreeRTOS.h.
+ */
+
+#include "TraceFilterFreeRTOS.h"
+
+#if defined(FLIGHT_RECORDER) && FLIGHT_RECORDER == 1
+#include <FlightRecorder.h>
+#define FLIGHT_RECORDER_HOOK_SWITCHED_IN()			FlightRecorderTaskSwitchedIn((uint32_t)pxCurrentTCB, pxCurrentTCB->pcTaskName)
+#define FLIGHT_RECORDER_HOOK(Type, pxQueue)			FlightRecorderRecord((Type), pxQueue->uxMessagesWaiting, (uint32_t)pxQueue)
+#define FLIGHT_RECORDER_HOOK_ISR_ENTER()			FlightRecorderIsrEnter()
+#define FLIGHT_RECORDER_HOOK_ISR_EXIT()				FlightRecorderIsrExit()
+#define TRACE_HOOKS_ENABLED
+#else
+#define FLIGHT_RECORDER_HOOK_SWITCHED_IN()
+#define FLIGHT_RECORDER_HOOK(Type, pxQueue)
+#define FLIGHT_RECORDER_HOOK_ISR_ENTER()
+#define FLIGHT_RECORDER_HOOK_ISR_EXIT()
+#endif
+
+#if defined(MUTEX_PROFILER) && MUTEX_PROFILER == 1
+#include <MutexProfiler.h>
+#define MUTEX_PROFILER_HOOK_BLOCKED(pxQueue)		MutexProfilerBlocked(pxQueue)
+#define MUTEX_PROFILER_HOOK_TAKEN(pxQueue)			MutexProfilerTaken(pxQueue)
+#define MUTEX_PROFILER_HOOK_TIMED_OUT(pxQueue)		MutexProfilerTimedOut(pxQueue)
+#define MUTEX_PROFILER_HOOK_GIVEN(pxQueue)			MutexProfilerGiven(pxQueue)
+#ifndef TRACE_HOOKS_ENABLED
+#define TRACE_HOOKS_ENABLED
+#endif
+#else
+#define MUTEX_PROFILER_HOOK_BLOCKED(pxQueue)
+#define MUTEX_PROFILER_HOOK_TAKEN(pxQueue)
+#define MUTEX_PROFILER_HOOK_TIMED_OUT(pxQueue)
+#define MUTEX_PROFILER_HOOK_GIVEN(pxQueue)
+#endif
+
+#if defined(QUEUE_TELEMETRY) && QUEUE_TELEMETRY == 1
+#include <QueueTelemetry.h>
+//queue hooks run before the item is copied
+#define QUEUE_TELEMETRY_HOOK_SENT(pxQueue)			QueueTelemetrySent(pxQueue, pxQueue->uxMessagesWaiting + 1)
+#define QUEUE_TELEMETRY_HOOK_COUNT(Object, Counter)	QueueTelemetryCount((Object), (Counter))
+//stream buffer hooks run after the data is copied (only used inside stream_buffer.c)
+#define QUEUE_TELEMETRY_HOOK_STREAM_SENT(xStreamBuffer, xBytesSent)		\
+						QueueTelemetryStreamSent(xStreamBuffer, xBytesSent, xDataLengthBytes, prvBytesInBuffer(pxStreamBuffer))
+#ifndef TRACE_HOOKS_ENABLED
+#define TRACE_HOOKS_ENABLED
+#endif
+#else
+#define QUEUE_TELEMETRY_HOOK_SENT(pxQueue)
+#define QUEUE_TELEMETRY_HOOK_COUNT(Object, Counter)
+#define QUEUE_TELEMETRY_HOOK_STREAM_SENT(xStreamBuffer, xBytesSent)
+#endif
+
+#ifdef TRACE_HOOKS_ENABLED
+
+#undef traceTASK_SWITCHED_IN
+#if ( INCLUDE_xTaskGetIdleTaskHandle == 1 )
+  #define traceTASK_SWITCHED_IN()			{																\
+												if(prvGetTCBFromHandle(NULL) == xIdleTaskHandle) {			\
+													SEGGER_SYSVIEW_OnIdle();								\
+												} else {													\
+													SEGGER_SYSVIEW_OnTaskStartExec((U32)pxCurrentTCB);		\
+												}															\
+												FLIGHT_RECORDER_HOOK_SWITCHED_IN();							\
+											}
+#else
+  #define traceTASK_SWITCHED_IN()			{																\
+												if (memcmp(pxCurrentTCB->pcTaskName, "IDLE", 5) != 0) {		\
+													SEGGER_SYSVIEW_OnTaskStartExec((U32)pxCurrentTCB);		\
+												} else {													\
+													SEGGER_SYSVIEW_OnIdle();								\
+												}															\
+												FLIGHT_RECORDER_HOOK_SWITCHED_IN();							\
+											}
+#endif
+
+//the queue hooks are called before the item is copied, so uxMessagesWaiting
+//is the number of items in the queue before the operation
+//semaphores and mutexes are queues, so giving one calls traceQUEUE_SEND
+//and taking one calls traceQUEUE_RECEIVE
+#undef traceQUEUE_SEND
+#if ( configUSE_QUEUE_SETS != 1 )
+  #define traceQUEUE_SEND( pxQueue )		{																\
+												TRACE_SYSVIEW_QUEUE(SEGGER_SYSVIEW_RecordU32x4(apiID_OFFSET + apiID_XQUEUEGENERICSEND,	\
+														SEGGER_SYSVIEW_ShrinkId((U32)pxQueue), (U32)pvItemToQueue,	\
+														xTicksToWait, xCopyPosition));						\
+												FLIGHT_RECORDER_HOOK(FR_EVT_QUEUE_SEND, pxQueue);			\
+												MUTEX_PROFILER_HOOK_GIVEN(pxQueue);							\
+												QUEUE_TELEMETRY_HOOK_SENT(pxQueue);							\
+											}
+#else
+  #define traceQUEUE_SEND( pxQueue )		{																\
+												TRACE_SYSVIEW_QUEUE(SEGGER_SYSVIEW_RecordU32x4(apiID_OFFSET + apiID_XQUEUEGENERICSEND,	\
+														SEGGER_SYSVIEW_ShrinkId((U32)pxQueue), 0u, 0u, xCopyPosition));	\
+												FLIGHT_RECORDER_HOOK(FR_EVT_QUEUE_SEND, pxQueue);			\
+												MUTEX_PROFILER_HOOK_GIVEN(pxQueue);							\
+												QUEUE_TELEMETRY_HOOK_SENT(pxQueue);							\
+											}
+#endif
+
+#undef traceQUEUE_SEND_FROM_ISR
+#define traceQUEUE_SEND_FROM_ISR( pxQueue )	{																\
+												TRACE_SYSVIEW_QUEUE(SEGGER_SYSVIEW_RecordU32x2(apiID_OFFSET + apiID_XQUEUEGENERICSENDFROMISR,	\
+														SEGGER_SYSVIEW_ShrinkId((U32)pxQueue), (U32)pxHigherPriorityTaskWoken));	\
+												FLIGHT_RECORDER_HOOK(FR_EVT_QUEUE_SEND, pxQueue);			\
+												MUTEX_PROFILER_HOOK_GIVEN(pxQueue);							\
+												QUEUE_TELEMETRY_HOOK_SENT(pxQueue);							\
+											}
+
+#undef traceQUEUE_RECEIVE
+#define traceQUEUE_RECEIVE( pxQueue )		{																\
+												TRACE_SYSVIEW_QUEUE(SEGGER_SYSVIEW_RecordU32x4(apiID_OFFSET + apiID_XQUEUEGENERICRECEIVE,	\
+														SEGGER_SYSVIEW_ShrinkId((U32)pxQueue), SEGGER_SYSVIEW_ShrinkId((U32)0),	\
+														xTicksToWait, 1));									\
+												FLIGHT_RECORDER_HOOK(FR_EVT_QUEUE_RECEIVE, pxQueue);		\
+												MUTEX_PROFILER_HOOK_TAKEN(pxQueue);							\
+											}
+
+#undef traceQUEUE_RECEIVE_FAILED
+#define traceQUEUE_RECEIVE_FAILED( pxQueue )	{															\
+												TRACE_SYSVIEW_QUEUE(SEGGER_SYSVIEW_RecordU32x4(apiID_OFFSET + apiID_XQUEUEGENERICRECEIVE,	\
+														SEGGER_SYSVIEW_ShrinkId((U32)pxQueue), SEGGER_SYSVIEW_ShrinkId((U32)0),	\
+														xTicksToWait, 1));									\
+												MUTEX_PROFILER_HOOK_TIMED_OUT(pxQueue);						\
+												QUEUE_TELEMETRY_HOOK_COUNT(pxQueue, QUEUE_TELEMETRY_RECEIVE_TIMEOUT);	\
+											}
+
+#undef traceQUEUE_SEND_FAILED
+#define traceQUEUE_SEND_FAILED( pxQueue )	{																\
+												TRACE_SYSVIEW_QUEUE(SEGGER_SYSVIEW_RecordU32x4(apiID_OFFSET + apiID_XQUEUEGENERICSEND,	\
+														SEGGER_SYSVIEW_ShrinkId((U32)pxQueue), (U32)pvItemToQueue,	\
+														xTicksToWait, xCopyPosition));						\
+												QUEUE_TELEMETRY_HOOK_COUNT(pxQueue, QUEUE_TELEMETRY_SEND_FAIL);	\
+											}
+
+#undef traceQUEUE_SEND_FROM_ISR_FAILED
+#define traceQUEUE_SEND_FROM_ISR_FAILED( pxQueue )	{														\
+												TRACE_SYSVIEW_QUEUE(SEGGER_SYSVIEW_RecordU32x2(apiID_OFFSET + apiID_XQUEUEGENERICSENDFROMISR,	\
+														SEGGER_SYSVIEW_ShrinkId((U32)pxQueue), (U32)pxHigherPriorityTaskWoken));	\
+												QUEUE_TELEMETRY_HOOK_COUNT(pxQueue, QUEUE_TELEMETRY_SEND_FAIL);	\
+											}
+
+#undef traceQUEUE_RECEIVE_FROM_ISR
+#define traceQUEUE_RECEIVE_FROM_ISR( pxQueue )	{															\
+												TRACE_SYSVIEW_QUEUE(SEGGER_SYSVIEW_RecordU32x3(apiID_OFFSET + apiID_XQUEUERECEIVEFROMISR,	\
+														SEGGER_SYSVIEW_ShrinkId((U32)pxQueue), SEGGER_SYSVIEW_ShrinkId((U32)pvBuffer),	\
+														(U32)pxHigherPriorityTaskWoken));					\
+												FLIGHT_RECORDER_HOOK(FR_EVT_QUEUE_RECEIVE, pxQueue);		\
+											}
+
+//SystemView doesn't define the blocking hooks
+#undef traceBLOCKING_ON_QUEUE_SEND
+#define traceBLOCKING_ON_QUEUE_SEND( pxQueue )		{														\
+												FLIGHT_RECORDER_HOOK(FR_EVT_QUEUE_SEND_BLOCK, pxQueue);		\
+												QUEUE_TELEMETRY_HOOK_COUNT(pxQueue, QUEUE_TELEMETRY_SEND_BLOCK);	\
+											}
+#undef traceBLOCKING_ON_QUEUE_RECEIVE
+#define traceBLOCKING_ON_QUEUE_RECEIVE( pxQueue )	{														\
+												FLIGHT_RECORDER_HOOK(FR_EVT_QUEUE_RECEIVE_BLOCK, pxQueue);	\
+												MUTEX_PROFILER_HOOK_BLOCKED(pxQueue);						\
+											}
+
+#undef traceSTREAM_BUFFER_SEND
+#define traceSTREAM_BUFFER_SEND( xStreamBuffer, xBytesSent )	{											\
+												TRACE_SYSVIEW_STREAM(SEGGER_SYSVIEW_RecordU32x2(apiID_OFFSET + apiID_XSTREAMBUFFERSEND,	\
+														(U32)xStreamBuffer, (U32)xBytesSent));				\
+												QUEUE_TELEMETRY_HOOK_STREAM_SENT(xStreamBuffer, xBytesSent);	\
+											}
+#undef traceSTREAM_BUFFER_SEND_FAILED
+#define traceSTREAM_BUFFER_SEND_FAILED( xStreamBuffer )	{												\
+												TRACE_SYSVIEW_STREAM(SEGGER_SYSVIEW_RecordU32x2(apiID_OFFSET + apiID_XSTREAMBUFFERSEND,	\
+														(U32)xStreamBuffer, 0u));							\
+												QUEUE_TELEMETRY_HOOK_STREAM_SENT(xStreamBuffer, 0);			\
+											}
+#undef traceSTREAM_BUFFER_SEND_FROM_ISR
+#define traceSTREAM_BUFFER_SEND_FROM_ISR( xStreamBuffer, xBytesSent )	{									\
+												TRACE_SYSVIEW_STREAM(SEGGER_SYSVIEW_RecordU32x2(apiID_OFFSET + apiID_XSTREAMBUFFERSENDFROMISR,	\
+														(U32)xStreamBuffer, (U32)xBytesSent));				\
+												QUEUE_TELEMETRY_HOOK_STREAM_SENT(xStreamBuffer, xBytesSent);	\
+											}
+#undef traceSTREAM_BUFFER_RECEIVE_FAILED
+#define traceSTREAM_BUFFER_RECEIVE_FAILED( xStreamBuffer )	{											\
+												TRACE_SYSVIEW_STREAM(SEGGER_SYSVIEW_RecordU32x2(apiID_OFFSET + apiID_XSTREAMBUFFERRECEIVE,	\
+														(U32)xStreamBuffer, 0u));							\
+												QUEUE_TELEMETRY_HOOK_COUNT(xStreamBuffer, QUEUE_TELEMETRY_RECEIVE_TIMEOUT);	\
+											}
+#undef traceBLOCKING_ON_STREAM_BUFFER_SEND
+#define traceBLOCKING_ON_STREAM_BUFFER_SEND( xStreamBuffer )	{ QUEUE_TELEMETRY_HOOK_COUNT(xStreamBuffer, QUEUE_TELEMETRY_SEND_BLOCK); }
+
+#undef traceISR_ENTER
+#define traceISR_ENTER()					{ SEGGER_SYSVIEW_RecordEnterISR(); FLIGHT_RECORDER_HOOK_ISR_ENTER(); }
+#undef traceISR_EXIT
+#define traceISR_EXIT()						{ FLIGHT_RECORDER_HOOK_ISR_EXIT(); SEGGER_SYSVIEW_RecordExitISR(); }
+
+#endif /* TRACE_HOOKS_ENABLED */
+
+#endif /* BSP_TRACEHOOKSFREERTOS_H_ */
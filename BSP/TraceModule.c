@@ -0,0 +1,67 @@
+/**
+ * Per-module, per-level SystemView tracing - see TraceModule.h
+ */
+
+#include <TraceModule.h>
+#include <stm32f7xx_hal.h>
+#include <string.h>
+
+static TraceModule* modules[TRACE_MAX_MODULES];
+static uint32_t numModules = 0;
+
+/**
+ * add a module to the registry and register it with SystemView
+ * (which assigns its event offset)
+ */
+void TraceModuleRegister( TraceModule* Module )
+{
+	assert_param(numModules < TRACE_MAX_MODULES);
+	assert_param(strncmp(Module->sysview.sModule, "M=", 2) == 0);
+
+	SEGGER_SYSVIEW_RegisterModule(&Module->sysview);
+	modules[numModules++] = Module;
+}
+
+/**
+ * @returns true if Description ("M=<name>, ...") is for module Name
+ */
+static int nameMatches( const char* Description, const char* Name )
+{
+	const uint32_t len = strlen(Name);
+	const char* moduleName = Description + 2;
+
+	return	strncmp(moduleName, Name, len) == 0 &&
+			(moduleName[len] == ',' || moduleName[len] == '\0');
+}
+
+/**
+ * change the runtime level of a module - calls above the level that was
+ * compiled in stay disabled regardless
+ * @param Name	module name (from "M=<name>" in the description)
+ * @returns number of modules changed
+ */
+uint32_t TraceModuleSetLevel( const char* Name, uint8_t Level )
+{
+	uint32_t changed = 0;
+
+	for(uint32_t i = 0; i < numModules; i++)
+	{
+		if(nameMatches(modules[i]->sysview.sModule, Name))
+		{
+			modules[i]->level = Level;
+			changed++;
+		}
+	}
+	return changed;
+}
+
+/**
+ * change the runtime level of every registered module
+ */
+void TraceModuleSetAllLevels( uint8_t Level )
+{
+	for(uint32_t i = 0; i < numModules; i++)
+	{
+		modules[i]->level = Level;
+	}
+}
@@ -0,0 +1,150 @@
+/**
+ * MIT License
+ * 
+ * Copyright (c) 2019 Brian Amos
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#ifndef BSP_TRACEMODULE_H_
+#define BSP_TRACEMODULE_H_
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+#include <stdint.h>
+#include <SEGGER_SYSVIEW.h>
+
+/**
+ * Per-module, per-level SystemView tracing
+ *
+ * Each source file that traces defines (or uses) a TraceModule, which is
+ * registered with SystemView as a module so it can also record its own
+ * events.  Trace calls are filtered twice:
+ * 	- at compile time: calls above TRACE_LEVEL (defined before including
+ * 	  this file, per source file) are removed by the preprocessor - no code
+ * 	  or format strings are left behind.  The build configuration can cap
+ * 	  every file with TRACE_LEVEL_MAX (i.e. TRACE_LEVEL_MAX=1 for production
+ * 	  builds keeps only errors)
+ * 	- at run time: calls that were compiled in are only recorded if the
+ * 	  module's level (TraceModuleSetLevel) allows them - a single compare
+ *
+ * usage (in a single .c file):
+ * 		#define TRACE_LEVEL TRACE_LEVEL_INFO
+ * 		#include <TraceModule.h>
+ *
+ * 		TRACE_MODULE_DEFINE(usbTrace, "M=usb, 0 TxStart Len=%u, 1 TxDone", 2);
+ *
+ * 		TRACE_MODULE_REGISTER(usbTrace);			//once, at startup
+ * 		TRACE_INFO(usbTrace, "sent %u bytes", numBytes);
+ * 		TRACE_EVENT(usbTrace, TRACE_LEVEL_DEBUG, 0, numBytes);
+ *
+ * Kernel events are filtered separately, see TraceFilterFreeRTOS.h.
+ */
+
+#define TRACE_LEVEL_NONE	0
+#define TRACE_LEVEL_ERROR	1
+#define TRACE_LEVEL_WARN	2
+#define TRACE_LEVEL_INFO	3
+#define TRACE_LEVEL_DEBUG	4
+
+#ifndef TRACE_LEVEL
+#define TRACE_LEVEL TRACE_LEVEL_INFO
+#endif
+
+#ifndef TRACE_LEVEL_MAX
+#define TRACE_LEVEL_MAX TRACE_LEVEL_DEBUG
+#endif
+
+//the level compiled into this file
+#if TRACE_LEVEL < TRACE_LEVEL_MAX
+#define TRACE_LEVEL_COMPILED TRACE_LEVEL
+#else
+#define TRACE_LEVEL_COMPILED TRACE_LEVEL_MAX
+#endif
+
+#define TRACE_MAX_MODULES 8
+
+typedef struct
+{
+	SEGGER_SYSVIEW_MODULE sysview;
+	volatile uint8_t level;			//runtime level, starts at the compiled level
+}TraceModule;
+
+void TraceModuleRegister( TraceModule* Module );
+uint32_t TraceModuleSetLevel( const char* Name, uint8_t Level );
+void TraceModuleSetAllLevels( uint8_t Level );
+
+/**
+ * @param Var			name of the TraceModule variable
+ * @param Description	SystemView module description, must start with "M=<name>"
+ * 						followed by the events, if any
+ * @param NumEvents		number of module events used with TRACE_EVENT
+ */
+#define TRACE_MODULE_DEFINE(Var, Description, NumEvents)	\
+	TraceModule Var = { .sysview = { (Description), (NumEvents), 0, NULL, NULL }, .level = TRACE_LEVEL_COMPILED }
+
+#if TRACE_LEVEL_COMPILED > TRACE_LEVEL_NONE
+#define TRACE_MODULE_REGISTER(Var) TraceModuleRegister(&(Var))
+#else
+#define TRACE_MODULE_REGISTER(Var) do{}while(0)
+#endif
+
+#define TRACE_ENABLED(Var, Level) ((Var).level >= (Level))
+
+#if TRACE_LEVEL_COMPILED >= TRACE_LEVEL_ERROR
+#define TRACE_ERROR(Var, Fmt, ...)	do{ if(TRACE_ENABLED(Var, TRACE_LEVEL_ERROR)) SEGGER_SYSVIEW_ErrorfHost(Fmt, ##__VA_ARGS__); }while(0)
+#else
+#define TRACE_ERROR(Var, Fmt, ...)	do{}while(0)
+#endif
+
+#if TRACE_LEVEL_COMPILED >= TRACE_LEVEL_WARN
+#define TRACE_WARN(Var, Fmt, ...)	do{ if(TRACE_ENABLED(Var, TRACE_LEVEL_WARN)) SEGGER_SYSVIEW_WarnfHost(Fmt, ##__VA_ARGS__); }while(0)
+#else
+#define TRACE_WARN(Var, Fmt, ...)	do{}while(0)
+#endif
+
+#if TRACE_LEVEL_COMPILED >= TRACE_LEVEL_INFO
+#define TRACE_INFO(Var, Fmt, ...)	do{ if(TRACE_ENABLED(Var, TRACE_LEVEL_INFO)) SEGGER_SYSVIEW_PrintfHost(Fmt, ##__VA_ARGS__); }while(0)
+#else
+#define TRACE_INFO(Var, Fmt, ...)	do{}while(0)
+#endif
+
+#if TRACE_LEVEL_COMPILED >= TRACE_LEVEL_DEBUG
+#define TRACE_DEBUG(Var, Fmt, ...)	do{ if(TRACE_ENABLED(Var, TRACE_LEVEL_DEBUG)) SEGGER_SYSVIEW_PrintfHost(Fmt, ##__VA_ARGS__); }while(0)
+#else
+#define TRACE_DEBUG(Var, Fmt, ...)	do{}while(0)
+#endif
+
+/**
+ * record one of the module's own events (numbered from 0 in the description)
+ * Level must be a constant so disabled events are removed at compile time
+ */
+#define TRACE_EVENT(Var, Level, EventId, Value)										\
+	do{																				\
+		if((Level) <= TRACE_LEVEL_COMPILED && TRACE_ENABLED(Var, (Level)))			\
+		{																			\
+			SEGGER_SYSVIEW_RecordU32((Var).sysview.EventOffset + (EventId), (Value));	\
+		}																			\
+	}while(0)
+
+#ifdef __cplusplus
+ }
+#endif
+#endif /* BSP_TRACEMODULE_H_ */
@@ -0,0 +1,50 @@
+import argparse
+import subprocess
+import sys
+
+
+# run arm-none-eabi-size (Berkeley format) on an .elf
+# @returns (text, data, bss)
+def sectionSizes(sizeTool: str, elfFileName: str):
+    out = subprocess.run([sizeTool, '-B', elfFileName], check=True,
+                         stdout=subprocess.PIPE, universal_newlines=True).stdout
+    fields = out.splitlines()[1].split()
+    return int(fields[0]), int(fields[1]), int(fields[2])
+
+
+# total size of the SystemView/RTT code that was linked in
+# (symbols named SEGGER_* and the trace helpers)
+def traceCodeSize(nmTool: str, elfFileName: str):
+    out = subprocess.run([nmTool, '-S', '--size-sort', elfFileName], check=True,
+                         stdout=subprocess.PIPE, universal_newlines=True).stdout
+    total = 0
+    for line in out.splitlines():
+        fields = line.split()
+        if len(fields) == 4 and fields[2] in 'tTrR' and \
+                (fields[3].startswith('SEGGER_') or fields[3].startswith('_SEGGER_') or
+                 fields[3].startswith('TraceModule')):
+            total += int(fields[1], 16)
+    return total
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='Compare the size of builds with different trace settings (i.e. traceFull vs traceProduction)')
+    parser.add_argument('elf', nargs='+', help='.elf files, sizes are compared against the first one')
+    parser.add_argument('--prefix', default='arm-none-eabi-', help='toolchain prefix (default arm-none-eabi-)')
+    args = parser.parse_args()
+
+    rows = []
+    for elf in args.elf:
+        text, data, bss = sectionSizes(args.prefix + 'size', elf)
+        rows.append((elf, text, data, bss, traceCodeSize(args.prefix + 'nm', elf)))
+
+    print('{:40} {:>9} {:>7} {:>7} {:>9} {:>9}'.format('elf', 'text', 'data', 'bss', 'trace', 'flash +/-'))
+    baseFlash = rows[0][1] + rows[0][2]
+    for elf, text, data, bss, trace in rows:
+        print('{:40} {:9} {:7} {:7} {:9} {:+9}'.format(elf[-40:], text, data, bss, trace, text + data - baseFlash))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,124 @@
+/**
+ * ISR to task wake-up latency histograms - see WakeLatency.h
+ */
+
+#include <WakeLatency.h>
+#include <stdio.h>
+#include <string.h>
+
+static WakeLatencyPath* paths[WAKE_LATENCY_MAX_PATHS];
+static uint32_t numPaths = 0;
+
+/**
+ * add a path to the list included in WakeLatencyReport
+ * also enables the cycle counter
+ */
+void WakeLatencyRegister( WakeLatencyPath* Path )
+{
+	CycleCounterInit();
+	assert_param(numPaths < WAKE_LATENCY_MAX_PATHS);
+	paths[numPaths++] = Path;
+}
+
+/**
+ * clear the histogram - only call from the task that reports to the path
+ */
+void WakeLatencyReset( WakeLatencyPath* Path )
+{
+	Path->count = 0;
+	Path->maxCycles = 0;
+	memset(Path->buckets, 0, sizeof(Path->buckets));
+}
+
+/**
+ * @param Percent	1-100
+ * @returns upper bound (in cycles) of the bucket holding the requested
+ * 			percentile (limited to the maximum seen), 0 if nothing has
+ * 			been recorded yet
+ */
+uint32_t WakeLatencyPercentile( const WakeLatencyPath* Path, uint32_t Percent )
+{
+	//count may advance while we're reading, which is fine for a report
+	const uint32_t count = Path->count;
+	const uint32_t target = (uint32_t)(((uint64_t)count * Percent + 99) / 100);
+	uint32_t total = 0;
+
+	if(count == 0)
+	{
+		return 0;
+	}
+
+	for(uint32_t i = 0; i < WAKE_LATENCY_NUM_BUCKETS; i++)
+	{
+		total += Path->buckets[i];
+		if(total >= target)
+		{
+			//the bucket bound can't be worse than the worst case seen
+			const uint32_t bound = (i == 32) ? UINT32_MAX : (1UL << i) - 1;
+			return (bound < Path->maxCycles) ? bound : Path->maxCycles;
+		}
+	}
+	return Path->maxCycles;
+}
+
+static unsigned long cyclesToUs( uint32_t Cycles )
+{
+	return (unsigned long)(((uint64_t)Cycles * 1000000) / SystemCoreClock);
+}
+
+/**
+ * format a text report of every registered path
+ * 		<name> n=<count> p50<=<us>us p99<=<us>us max=<us>us
+ * 		 <bucket upper bound in cycles>:<count> ... (non-empty buckets only)
+ * the report is cut short if Buff is too small
+ * @returns number of characters written (not including the terminator)
+ */
+uint32_t WakeLatencyReport( char* Buff, uint32_t Len )
+{
+	uint32_t used = 0;
+
+	if(Len == 0)
+	{
+		return 0;
+	}
+	Buff[0] = '\0';
+
+	for(uint32_t p = 0; p < numPaths; p++)
+	{
+		const WakeLatencyPath* path = paths[p];
+		int n = snprintf(Buff + used, Len - used, "%s n=%lu p50<=%luus p99<=%luus max=%luus\n",
+							path->name, (unsigned long)path->count,
+							cyclesToUs(WakeLatencyPercentile(path, 50)),
+							cyclesToUs(WakeLatencyPercentile(path, 99)),
+							cyclesToUs(path->maxCycles));
+
+		for(uint32_t i = 0; i < WAKE_LATENCY_NUM_BUCKETS; i++)
+		{
+			if(n < 0 || used + n >= Len)
+			{
+				return Len - 1;
+			}
+			used += n;
+			n = 0;
+			if(path->buckets[i] != 0)
+			{
+				n = snprintf(Buff + used, Len - used, " <%lu:%lu",
+								(i < 32) ? (unsigned long)(1UL << i) : 0xFFFFFFFFUL,
+								(unsigned long)path->buckets[i]);
+			}
+		}
+		if(n < 0 || used + n >= Len)
+		{
+			return Len - 1;
+		}
+		used += n;
+
+		n = snprintf(Buff + used, Len - used, "\n");
+		if(n < 0 || used + n >= Len)
+		{
+			return Len - 1;
+		}
+		used += n;
+	}
+	return used;
+}
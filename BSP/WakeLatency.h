@@ -0,0 +1,130 @@
+/**
+ * MIT License
+ * 
+ * Copyright (c) 2019 Brian Amos
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#ifndef BSP_WAKELATENCY_H_
+#define BSP_WAKELATENCY_H_
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <DWTCycleCounter.h>
+
+/**
+ * ISR to task wake-up latency measurement
+ *
+ * An ISR that wakes a task (semaphore give, queue send, stream buffer send,
+ * task notification...) stamps the cycle count taken when it was entered.
+ * The woken task stamps the cycle count again as soon as it runs and the
+ * difference is added to a log2 histogram kept for that path.
+ *
+ * 		//ISR
+ * 		uint32_t entry = WakeLatencyIsrEntry();
+ * 		...
+ * 		xSemaphoreGiveFromISR(rxDone, &xHigherPriorityTaskWoken);
+ * 		WakeLatencyWake(&rxLatency, entry);
+ *
+ * 		//task
+ * 		xSemaphoreTake(rxDone, portMAX_DELAY);
+ * 		WakeLatencyResumed(&rxLatency);
+ *
+ * If the ISR fires again before the task runs, the first (oldest) stamp is
+ * kept, since that is the event that has been waiting the longest.
+ *
+ * Histogram bucket n counts latencies of 2^(n-1) to 2^n - 1 cycles, so
+ * percentiles are reported as the upper bound of the bucket they fall in.
+ */
+
+#define WAKE_LATENCY_NUM_BUCKETS	33		//one per possible bit length of a 32 bit count
+#define WAKE_LATENCY_MAX_PATHS		8
+
+typedef struct
+{
+	const char* name;
+	volatile uint32_t wakeStamp;	//written by the ISR
+	volatile bool pending;			//set by the ISR, cleared by the task
+
+	//only written by the woken task
+	uint32_t count;
+	uint32_t maxCycles;
+	uint32_t buckets[WAKE_LATENCY_NUM_BUCKETS];
+}WakeLatencyPath;
+
+#define WAKE_LATENCY_PATH_INIT(Name) { .name = (Name) }
+
+/**
+ * call as early as possible in the ISR
+ * @returns the timestamp to pass to WakeLatencyWake
+ */
+static inline uint32_t WakeLatencyIsrEntry( void )
+{
+	return CycleCount();
+}
+
+/**
+ * call from the ISR after the task has been woken
+ * @param Path		path the woken task will report to
+ * @param IsrEntry	value returned by WakeLatencyIsrEntry
+ */
+static inline void WakeLatencyWake( WakeLatencyPath* Path, uint32_t IsrEntry )
+{
+	if(!Path->pending)
+	{
+		Path->wakeStamp = IsrEntry;
+		Path->pending = true;
+	}
+}
+
+/**
+ * call from the woken task as soon as the blocking call returns
+ * calls that weren't preceded by a wake-up aren't counted
+ */
+static inline void WakeLatencyResumed( WakeLatencyPath* Path )
+{
+	const uint32_t now = CycleCount();
+
+	if(Path->pending)
+	{
+		uint32_t latency = now - Path->wakeStamp;
+		Path->pending = false;
+
+		Path->buckets[32 - __CLZ(latency)]++;
+		Path->count++;
+		if(latency > Path->maxCycles)
+		{
+			Path->maxCycles = latency;
+		}
+	}
+}
+
+void WakeLatencyRegister( WakeLatencyPath* Path );
+void WakeLatencyReset( WakeLatencyPath* Path );
+uint32_t WakeLatencyPercentile( const WakeLatencyPath* Path, uint32_t Percent );
+uint32_t WakeLatencyReport( char* Buff, uint32_t Len );
+
+#ifdef __cplusplus
+ }
+#endif
+#endif /* BSP_WAKELATENCY_H_ */
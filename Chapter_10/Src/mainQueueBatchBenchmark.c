@@ -0,0 +1,207 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2019 Brian Amos
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <FreeRTOS.h>
+#include <task.h>
+#include <queue.h>
+#include <Nucleo_F767ZI_Init.h>
+#include <SEGGER_SYSVIEW.h>
+#include <DWTCycleCounter.h>
+#include <stm32f7xx_hal.h>
+#include <stdbool.h>
+
+/*********************************************
+ * Per-item vs batched queue throughput
+ *
+ * NUM_ITEMS 32 bit items are moved through a queue in batches of
+ * 1, 4, 16 and 64 items, once with one call per item (xQueueSend /
+ * xQueueReceive) and once with one call per batch (xQueueSendMultiple /
+ * xQueueReceiveMultiple):
+ * 	no waiter	- the benchmark task sends and receives each batch
+ * 				  itself, so only the queue handling is measured
+ * 	consumer	- a higher priority consumer task is blocked on the
+ * 				  queue, so every wake-up costs a context switch
+ *
+ * Results (CPU cycles per item) are printed to SystemView once per
+ * second and are also available in queueBatchResults
+ *********************************************/
+
+#define STACK_SIZE 256
+#define QUEUE_LENGTH 64
+#define NUM_ITEMS 4096
+#define NUM_BATCH_SIZES 4
+
+void benchmarkTask( void* NotUsed );
+void consumerTask( void* NotUsed );
+
+typedef struct
+{
+	uint32_t batchSize;
+	uint32_t singleNoWaiter;
+	uint32_t batchNoWaiter;
+	uint32_t singleConsumer;
+	uint32_t batchConsumer;
+}QueueBatchResult;
+
+static const uint32_t batchSizes[NUM_BATCH_SIZES] = {1, 4, 16, 64};
+volatile QueueBatchResult queueBatchResults[NUM_BATCH_SIZES];
+
+static QueueHandle_t queue = NULL;
+static TaskHandle_t consumerHandle = NULL;
+static volatile bool consumerBatched = false;
+static volatile uint32_t consumerReceived = 0;
+
+int main(void)
+{
+	HWInit();
+	CycleCounterInit();
+	SEGGER_SYSVIEW_Conf();
+
+	//ensure proper priority grouping for freeRTOS
+	NVIC_SetPriorityGrouping(0);
+
+	queue = xQueueCreate(QUEUE_LENGTH, sizeof(uint32_t));
+	assert_param(queue != NULL);
+
+	assert_param(xTaskCreate(benchmarkTask, "benchmark", STACK_SIZE, NULL, tskIDLE_PRIORITY + 2, NULL) == pdPASS);
+	//the consumer starts suspended so it doesn't interfere with the no waiter runs
+	assert_param(xTaskCreate(consumerTask, "consumer", STACK_SIZE, NULL, tskIDLE_PRIORITY + 3, &consumerHandle) == pdPASS);
+	vTaskSuspend(consumerHandle);
+
+	//start the scheduler - shouldn't return unless there's a problem
+	vTaskStartScheduler();
+
+	//if you've wound up here, there is likely an issue with overrunning the freeRTOS heap
+	while(1)
+	{
+	}
+}
+
+/**
+ * runs at a higher priority than the benchmark task, so it is woken
+ * (and preempts the sender) as soon as anything is sent
+ */
+void consumerTask( void* NotUsed )
+{
+	uint32_t items[QUEUE_LENGTH];
+
+	while(1)
+	{
+		if(consumerBatched)
+		{
+			consumerReceived += xQueueReceiveMultiple(queue, items, QUEUE_LENGTH, portMAX_DELAY);
+		}
+		else if(xQueueReceive(queue, items, portMAX_DELAY) == pdPASS)
+		{
+			consumerReceived++;
+		}
+	}
+}
+
+/**
+ * @returns cycles per item
+ */
+static uint32_t runNoWaiter( uint32_t BatchSize, bool Batched )
+{
+	uint32_t items[QUEUE_LENGTH] = {0};
+	uint32_t start = CycleCount();
+
+	for(uint32_t sent = 0; sent < NUM_ITEMS; sent += BatchSize)
+	{
+		if(Batched)
+		{
+			xQueueSendMultiple(queue, items, BatchSize, 0);
+			xQueueReceiveMultiple(queue, items, BatchSize, 0);
+		}
+		else
+		{
+			for(uint32_t i = 0; i < BatchSize; i++)
+			{
+				xQueueSend(queue, &items[i], 0);
+			}
+			for(uint32_t i = 0; i < BatchSize; i++)
+			{
+				xQueueReceive(queue, &items[i], 0);
+			}
+		}
+	}
+	return (CycleCount() - start) / NUM_ITEMS;
+}
+
+/**
+ * @returns cycles per item
+ */
+static uint32_t runConsumer( uint32_t BatchSize, bool Batched )
+{
+	uint32_t items[QUEUE_LENGTH] = {0};
+
+	consumerBatched = Batched;
+	consumerReceived = 0;
+	vTaskResume(consumerHandle);
+
+	uint32_t start = CycleCount();
+	for(uint32_t sent = 0; sent < NUM_ITEMS; sent += BatchSize)
+	{
+		if(Batched)
+		{
+			xQueueSendMultiple(queue, items, BatchSize, portMAX_DELAY);
+		}
+		else
+		{
+			for(uint32_t i = 0; i < BatchSize; i++)
+			{
+				xQueueSend(queue, &items[i], portMAX_DELAY);
+			}
+		}
+	}
+	uint32_t cycles = CycleCount() - start;
+
+	//the consumer has a higher priority, so everything has been received
+	assert_param(consumerReceived == NUM_ITEMS);
+	vTaskSuspend(consumerHandle);
+	return cycles / NUM_ITEMS;
+}
+
+void benchmarkTask( void* NotUsed )
+{
+	while(1)
+	{
+		for(uint32_t i = 0; i < NUM_BATCH_SIZES; i++)
+		{
+			volatile QueueBatchResult* result = &queueBatchResults[i];
+			result->batchSize = batchSizes[i];
+			result->singleNoWaiter = runNoWaiter(batchSizes[i], false);
+			result->batchNoWaiter = runNoWaiter(batchSizes[i], true);
+			result->singleConsumer = runConsumer(batchSizes[i], false);
+			result->batchConsumer = runConsumer(batchSizes[i], true);
+
+			SEGGER_SYSVIEW_PrintfHost("batch %u cycles/item no waiter single:%u batch:%u consumer single:%u batch:%u",
+										result->batchSize,
+										result->singleNoWaiter, result->batchNoWaiter,
+										result->singleConsumer, result->batchConsumer);
+		}
+		vTaskDelay(1000 / portTICK_PERIOD_MS);
+	}
+}
@@ -0,0 +1,180 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2019 Brian Amos
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <FreeRTOS.h>
+#include <task.h>
+#include <stream_buffer.h>
+#include <Nucleo_F767ZI_Init.h>
+#include <SEGGER_SYSVIEW.h>
+#include <DWTCycleCounter.h>
+#include <stm32f7xx_hal.h>
+
+/*********************************************
+ * Copying vs zero-copy stream buffer throughput
+ *
+ * A producer/consumer pair is run back to back in a single task so
+ * only the buffer handling is measured (no context switches):
+ * 	copy		- data is generated into a local buffer and
+ * 				  copied in with xStreamBufferSend, then copied out
+ * 				  with xStreamBufferReceive and checksummed
+ * 	zero-copy	- data is generated directly into the spans from
+ * 				  xStreamBufferSendAcquire and checksummed directly from
+ * 				  the spans from xStreamBufferReceiveAcquire
+ *
+ * The chunk sizes don't divide the buffer size evenly, so wrapped
+ * (two span) transfers are included.
+ *
+ * Results (CPU cycles per KB moved) are printed to SystemView once per
+ * second and are also available in zeroCopyResults
+ *********************************************/
+
+#define STACK_SIZE 256
+#define BUFFER_SIZE 1024
+#define BYTES_PER_RUN (64 * 1024)
+#define NUM_CHUNK_SIZES 4
+
+void benchmarkTask( void* NotUsed );
+
+typedef struct
+{
+	uint32_t chunkSize;
+	uint32_t copyCyclesPerKB;
+	uint32_t zeroCopyCyclesPerKB;
+}ZeroCopyResult;
+
+static const uint32_t chunkSizes[NUM_CHUNK_SIZES] = {15, 63, 255, 511};
+volatile ZeroCopyResult zeroCopyResults[NUM_CHUNK_SIZES];
+volatile uint32_t checksum;
+
+static StreamBufferHandle_t stream = NULL;
+static uint8_t txChunk[BUFFER_SIZE];
+static uint8_t rxChunk[BUFFER_SIZE];
+
+int main(void)
+{
+	HWInit();
+	CycleCounterInit();
+	SEGGER_SYSVIEW_Conf();
+
+	//ensure proper priority grouping for freeRTOS
+	NVIC_SetPriorityGrouping(0);
+
+	stream = xStreamBufferCreate(BUFFER_SIZE, 1);
+	assert_param(stream != NULL);
+
+	assert_param(xTaskCreate(benchmarkTask, "benchmark", STACK_SIZE, NULL, tskIDLE_PRIORITY + 2, NULL) == pdPASS);
+
+	//start the scheduler - shouldn't return unless there's a problem
+	vTaskStartScheduler();
+
+	//if you've wound up here, there is likely an issue with overrunning the freeRTOS heap
+	while(1)
+	{
+	}
+}
+
+/**
+ * stand-ins for the producer and consumer doing real work on the data
+ */
+static uint8_t nextValue = 0;
+static void generate( uint8_t* Dst, uint32_t Len )
+{
+	for(uint32_t i = 0; i < Len; i++)
+	{
+		Dst[i] = nextValue++;
+	}
+}
+
+static uint32_t sum( const uint8_t* Src, uint32_t Len )
+{
+	uint32_t total = 0;
+	for(uint32_t i = 0; i < Len; i++)
+	{
+		total += Src[i];
+	}
+	return total;
+}
+
+static uint32_t runCopy( uint32_t ChunkSize )
+{
+	uint32_t total = 0;
+	uint32_t start = CycleCount();
+	for(uint32_t moved = 0; moved < BYTES_PER_RUN; moved += ChunkSize)
+	{
+		generate(txChunk, ChunkSize);
+		xStreamBufferSend(stream, txChunk, ChunkSize, 0);
+		uint32_t numBytes = xStreamBufferReceive(stream, rxChunk, ChunkSize, 0);
+		total += sum(rxChunk, numBytes);
+	}
+	uint32_t cycles = CycleCount() - start;
+	checksum = total;
+	return cycles / (BYTES_PER_RUN / 1024);
+}
+
+static uint32_t runZeroCopy( uint32_t ChunkSize )
+{
+	StreamBufferSpan_t spans[2];
+	uint32_t total = 0;
+	uint32_t start = CycleCount();
+	for(uint32_t moved = 0; moved < BYTES_PER_RUN; moved += ChunkSize)
+	{
+		//the buffer is always empty here, so at least ChunkSize is free
+		xStreamBufferSendAcquire(stream, spans, ChunkSize, 0);
+		uint32_t firstLen = spans[0].xLength < ChunkSize ? spans[0].xLength : ChunkSize;
+		generate(spans[0].pucData, firstLen);
+		generate(spans[1].pucData, ChunkSize - firstLen);
+		xStreamBufferSendCommit(stream, ChunkSize);
+
+		uint32_t numBytes = xStreamBufferReceiveAcquire(stream, spans, 0);
+		total += sum(spans[0].pucData, spans[0].xLength);
+		total += sum(spans[1].pucData, spans[1].xLength);
+		xStreamBufferReceiveCommit(stream, numBytes);
+	}
+	uint32_t cycles = CycleCount() - start;
+	assert_param(total == checksum);
+	return cycles / (BYTES_PER_RUN / 1024);
+}
+
+void benchmarkTask( void* NotUsed )
+{
+	while(1)
+	{
+		for(uint32_t i = 0; i < NUM_CHUNK_SIZES; i++)
+		{
+			//restart the pattern so both runs produce the same checksum
+			nextValue = 0;
+			zeroCopyResults[i].chunkSize = chunkSizes[i];
+			zeroCopyResults[i].copyCyclesPerKB = runCopy(chunkSizes[i]);
+			nextValue = 0;
+			zeroCopyResults[i].zeroCopyCyclesPerKB = runZeroCopy(chunkSizes[i]);
+
+			SEGGER_SYSVIEW_PrintfHost("chunk %u cycles/KB copy:%u zero-copy:%u",
+										zeroCopyResults[i].chunkSize,
+										zeroCopyResults[i].copyCyclesPerKB,
+										zeroCopyResults[i].zeroCopyCyclesPerKB);
+		}
+		vTaskDelay(1000 / portTICK_PERIOD_MS);
+	}
+}
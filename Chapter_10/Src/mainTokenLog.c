@@ -0,0 +1,200 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2019 Brian Amos
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#include <FreeRTOS.h>
+#include <task.h>
+#include <queue.h>
+#include <timers.h>
+#include <Nucleo_F767ZI_GPIO.h>
+#include <SEGGER_SYSVIEW.h>
+#include <TokenLog.h>
+#include <Nucleo_F767ZI_Init.h>
+#include <stm32f7xx_hal.h>
+#include <UartQuickDirtyInit.h>
+#include "Uart4Setup.h"
+#include <stdbool.h>
+
+/*********************************************
+ * Tokenized logging from a hot path
+ *
+ * The same interrupt driven UART receiver as mainUartInterruptQueue.c,
+ * but every byte is logged with TokenLog instead of
+ * SEGGER_SYSVIEW_PrintfHost:
+ * 	USART2_IRQHandler	LOG_DEBUG for every byte received (this
+ * 						configuration builds with TOKENLOG_LEVEL_DEBUG)
+ * 	uartPrintOutTask	LOG_INFO for every byte pulled from the queue
+ *
+ * Before the UART traffic starts, the cost of a LOG_INFO call and a
+ * SEGGER_SYSVIEW_PrintfHost call with the same arguments is measured and
+ * logged (CPU cycles per call).
+ *
+ * The records are streamed over RTT channel 2, capture it (e.g. with
+ * JLinkRTTLogger) and decode it against this .elf with
+ * BSP/TokenLogDecoder/tokenLogDecoder.py
+ *********************************************/
+
+#define STACK_SIZE 128
+#define BAUDRATE 256400
+#define NUM_CALLS 100
+
+void uartPrintOutTask( void* NotUsed);
+void startUart4Traffic( TimerHandle_t xTimer );
+static void measureLogCost( void );
+
+static QueueHandle_t uart2_BytesReceived = NULL;
+
+static bool rxInProgress = false;
+
+//number of bytes the ISR has seen, logged along with each byte
+static uint16_t rxCount = 0;
+
+int main(void)
+{
+	HWInit();
+	SEGGER_SYSVIEW_Conf();
+	TokenLogInit(256, tskIDLE_PRIORITY + 1);
+
+	//ensure proper priority grouping for freeRTOS
+	NVIC_SetPriorityGrouping(0);
+
+	//start UART traffic after the receiver is ready for it
+	//(see mainUartInterruptQueue.c)
+	TimerHandle_t oneShotHandle =
+	xTimerCreate(	"startUart4Traffic",
+					5000 /portTICK_PERIOD_MS,
+					pdFALSE,
+					NULL,
+					startUart4Traffic);
+	assert_param(oneShotHandle != NULL);
+	xTimerStart(oneShotHandle, 0);
+
+	uart2_BytesReceived = xQueueCreate(10, sizeof(char));
+	assert_param(uart2_BytesReceived != NULL);
+
+	assert_param(xTaskCreate(uartPrintOutTask, "uartPrint", STACK_SIZE, NULL, tskIDLE_PRIORITY + 3, NULL) == pdPASS);
+
+	//start the scheduler - shouldn't return unless there's a problem
+	vTaskStartScheduler();
+
+	//if you've wound up here, there is likely an issue with overrunning the freeRTOS heap
+	while(1)
+	{
+	}
+}
+
+/**
+ * Start an interrupt driven receive.  This particular ISR is hard-coded
+ * to push characters into a queue
+ */
+void startReceiveInt( void )
+{
+	rxInProgress = true;
+	USART2->CR3 |= USART_CR3_EIE;	//enable error interrupts
+	USART2->CR1 |= (USART_CR1_UE | USART_CR1_RXNEIE);
+	//all 4 bits are for preemption priority -
+	NVIC_SetPriority(USART2_IRQn, 6);
+	NVIC_EnableIRQ(USART2_IRQn);
+}
+
+void startUart4Traffic( TimerHandle_t xTimer )
+{
+	SetupUart4ExternalSim(BAUDRATE);
+}
+
+/**
+ * log the average number of cycles taken by a LOG_INFO call and by a
+ * SEGGER_SYSVIEW_PrintfHost call with the same format and arguments
+ */
+static void measureLogCost( void )
+{
+	uint32_t start = CycleCount();
+	for(uint32_t i = 0; i < NUM_CALLS; i++)
+	{
+		LOG_INFO("cost test %u of %u", i, NUM_CALLS);
+	}
+	const uint32_t tokenLogCycles = (CycleCount() - start) / NUM_CALLS;
+
+	start = CycleCount();
+	for(uint32_t i = 0; i < NUM_CALLS; i++)
+	{
+		SEGGER_SYSVIEW_PrintfHost("cost test %u of %u", i, NUM_CALLS);
+	}
+	const uint32_t printfHostCycles = (CycleCount() - start) / NUM_CALLS;
+
+	LOG_INFO("cycles per call: LOG_INFO %u, SEGGER_SYSVIEW_PrintfHost %u", tokenLogCycles, printfHostCycles);
+}
+
+void uartPrintOutTask( void* NotUsed)
+{
+	char nextByte;
+
+	measureLogCost();
+
+	STM_UartInit(USART2, BAUDRATE, NULL, NULL);
+	startReceiveInt();
+
+	while(1)
+	{
+		xQueueReceive(uart2_BytesReceived, &nextByte, portMAX_DELAY);
+		LOG_INFO("%c", nextByte);
+	}
+}
+
+void USART2_IRQHandler( void )
+{
+	portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
+	SEGGER_SYSVIEW_RecordEnterISR();
+
+	//first check for errors
+	if(	USART2->ISR & (	USART_ISR_ORE_Msk |
+						USART_ISR_NE_Msk |
+						USART_ISR_FE_Msk |
+						USART_ISR_PE_Msk ))
+	{
+		//clear error flags
+		USART2->ICR |= (USART_ICR_FECF |
+						USART_ICR_PECF |
+						USART_ICR_NCF |
+						USART_ICR_ORECF);
+		LOG_WARN("USART2 error, ISR 0x%08x", USART2->ISR);
+	}
+
+	if(	USART2->ISR & USART_ISR_RXNE_Msk)
+	{
+		//read the data register unconditionally to clear
+		//the receive not empty interrupt if no reception is
+		//in progress
+		uint8_t tempVal = (uint8_t) USART2->RDR;
+
+		if(rxInProgress)
+		{
+			rxCount++;
+			//logging from the ISR only costs a handful of stores
+			LOG_DEBUG("rx byte %u: 0x%02x", rxCount, tempVal);
+			xQueueSendFromISR(uart2_BytesReceived, &tempVal, &xHigherPriorityTaskWoken);
+		}
+	}
+	SEGGER_SYSVIEW_RecordExitISR();
+	portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
@@ -30,6 +30,7 @@
 #include <timers.h>
 #include <Nucleo_F767ZI_GPIO.h>
 #include <SEGGER_SYSVIEW.h>
+#include <WakeLatency.h>
 #include <Nucleo_F767ZI_Init.h>
 #include <stm32f7xx_hal.h>
 #include <UartQuickDirtyInit.h>
@@ -58,6 +59,7 @@ void uartPrintOutTask( void* NotUsed);
 void startUart4Traffic( TimerHandle_t xTimer );
 
 static SemaphoreHandle_t rxDone = NULL;
+static WakeLatencyPath rxLatency = WAKE_LATENCY_PATH_INIT("dma rx semaphore");
 
 static bool rxInProgress = false;
 static uint_fast16_t rxLen = 0;
@@ -198,11 +200,20 @@ void uartPrintOutTask( void* NotUsed)
 
 	setupUSART2DMA();
 	STM_UartInit(USART2, BAUDRATE, NULL, &usart2DmaRx);
+	WakeLatencyRegister(&rxLatency);
 	while(1)
 	{
 		startReceiveDMA(rxData, expectedLen);
 		if(xSemaphoreTake(rxDone, 100) == pdPASS)
 		{
+			WakeLatencyResumed(&rxLatency);
+
+			//how long the task took to run after the transfer completed
+			if((rxLatency.count % 64) == 0)
+			{
+				SEGGER_SYSVIEW_PrintfHost("%s: p99 <= %u cycles, max %u cycles", rxLatency.name,
+											WakeLatencyPercentile(&rxLatency, 99), rxLatency.maxCycles);
+			}
 			//NDTR is the remaining number of data items to be transferred,
 			//0 signals completion
 			if(DMA1_Stream5->NDTR == 0)
@@ -231,6 +242,7 @@ void uartPrintOutTask( void* NotUsed)
  */
 void DMA1_Stream5_IRQHandler(void)
 {
+	uint32_t isrEntry = WakeLatencyIsrEntry();
 	portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
 	SEGGER_SYSVIEW_RecordEnterISR();
 
@@ -239,6 +251,7 @@ void DMA1_Stream5_IRQHandler(void)
 		rxInProgress = false;
 		DMA1->HIFCR |= DMA_HIFCR_CTCIF5;
 		xSemaphoreGiveFromISR(rxDone, &xHigherPriorityTaskWoken);
+		WakeLatencyWake(&rxLatency, isrEntry);
 	}
 	SEGGER_SYSVIEW_RecordExitISR();
 	portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
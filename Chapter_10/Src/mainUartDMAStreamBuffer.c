@@ -29,6 +29,7 @@
 #include <timers.h>
 #include <Nucleo_F767ZI_GPIO.h>
 #include <SEGGER_SYSVIEW.h>
+#include <WakeLatency.h>
 #include <Nucleo_F767ZI_Init.h>
 #include <stm32f7xx_hal.h>
 #include <UartQuickDirtyInit.h>
@@ -60,6 +61,7 @@ static uint8_t rxData[20];
 static uint8_t expectedLen = 16;
 
 static StreamBufferHandle_t rxStream = NULL;
+static WakeLatencyPath rxLatency = WAKE_LATENCY_PATH_INIT("dma rx stream buffer");
 
 static bool rxInProgress = false;
 static uint_fast16_t rxLen = 0;
@@ -209,6 +211,7 @@ void uartPrintOutTask( void* NotUsed)
 
 	setupUSART2DMA();
 	STM_UartInit(USART2, BAUDRATE, NULL, &usart2DmaRx);
+	WakeLatencyRegister(&rxLatency);
 	while(1)
 	{
 		memset(rxBufferedData, 0, 20);
@@ -219,6 +222,14 @@ void uartPrintOutTask( void* NotUsed)
 													100 );
 		if(numBytes > 0)
 		{
+			WakeLatencyResumed(&rxLatency);
+
+			//how long the task took to run after the transfer completed
+			if((rxLatency.count % 64) == 0)
+			{
+				SEGGER_SYSVIEW_PrintfHost("%s: p99 <= %u cycles, max %u cycles", rxLatency.name,
+											WakeLatencyPercentile(&rxLatency, 99), rxLatency.maxCycles);
+			}
 			SEGGER_SYSVIEW_PrintfHost("received: ");
 			SEGGER_SYSVIEW_Print((char*)rxBufferedData);
 		}
@@ -236,6 +247,7 @@ void uartPrintOutTask( void* NotUsed)
  */
 void DMA1_Stream5_IRQHandler(void)
 {
+	uint32_t isrEntry = WakeLatencyIsrEntry();
 	portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
 	SEGGER_SYSVIEW_RecordEnterISR();
 
@@ -247,6 +259,7 @@ void DMA1_Stream5_IRQHandler(void)
 									rxData,
 									expectedLen - DMA1_Stream5->NDTR,
 									&xHigherPriorityTaskWoken);
+		WakeLatencyWake(&rxLatency, isrEntry);
 	}
 	SEGGER_SYSVIEW_RecordExitISR();
 	portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
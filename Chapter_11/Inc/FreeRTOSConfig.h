@@ -98,6 +98,7 @@ to exclude the API function. */
 #define INCLUDE_pxTaskGetStackStart			1
 #define INCLUDE_xTaskGetIdleTaskHandle		1
 #define configUSE_TASK_NOTIFICATIONS        1
+#define configTASK_NOTIFICATION_ARRAY_ENTRIES	2
 
 
 /* Run time and task stats gathering related definitions. */
@@ -155,6 +156,7 @@ standard names. */
 /* Section where parameter definitions can be added (for instance, to override default ones in FreeRTOS.h) */
 
 #include "SEGGER_SYSVIEW_FreeRTOS.h"
+#include "TraceHooksFreeRTOS.h"
 /* USER CODE END Defines */ 
 
 #endif /* FREERTOS_CONFIG_H */
@@ -31,6 +31,7 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+ uint32_t CalcCRC32( const uint8_t* Buff, uint32_t Len);
  bool CheckCRC( const uint8_t* Buff, uint32_t Len);
 
 
@@ -123,7 +123,9 @@ Revision: $Rev: 6249 $
 *
 *       SystemView buffer configuration
 */
+#ifndef SEGGER_SYSVIEW_RTT_BUFFER_SIZE                                          // May be overridden by the build configuration (see sysViewUsbTransport.c)
 #define SEGGER_SYSVIEW_RTT_BUFFER_SIZE      6144                                // Number of bytes that SystemView uses for the buffer.
+#endif
 #define SEGGER_SYSVIEW_RTT_CHANNEL          1                                   // The RTT channel that SystemView will use. 0: Auto selection
 
 #define SEGGER_SYSVIEW_USE_STATIC_BUFFER    1                                   // Use a static buffer to generate events instead of a buffer on the stack
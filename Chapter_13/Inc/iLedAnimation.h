@@ -0,0 +1,86 @@
+/**
+ * MIT License
+ * 
+ * Copyright (c) 2019 Brian Amos
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#ifndef INC_ILEDANIMATION_H_
+#define INC_ILEDANIMATION_H_
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * a single point of an RGB animation
+ * intensities are 0-100% (the same units used by iPWM)
+ */
+typedef struct
+{
+	float red;
+	float green;
+	float blue;
+	uint16_t durationMs;	//time this keyframe occupies
+	bool fade;				//true: ramp from the previous keyframe over durationMs
+							//false: jump to this keyframe and hold it for durationMs
+}LedKeyframe;
+
+/**
+ * Load an animation and start playing it immediately
+ *
+ * The implementation is responsible for all of the timing, so the caller
+ * doesn't need to wake up for each step of the animation
+ *
+ * @param Keyframes		keyframes to play, in order.  The first fade starts
+ * 						from the current LED intensities
+ * @param NumKeyframes	number of keyframes
+ * @param Loop			true to repeat the animation until Stop is called
+ * 						false to play it once and hold the final value
+ * @returns the length of one pass through the animation in mS
+ * 			0 if nothing was loaded - there was nothing to play, the
+ * 			animation doesn't fit into the implementation or it couldn't be
+ * 			started.  An animation is
+ * 			never truncated and a failed Load leaves the LED's untouched, so the
+ * 			caller can time the keyframes itself instead
+ **/
+typedef uint32_t (*iLedAnimationLoadFunc)( const LedKeyframe* Keyframes, uint8_t NumKeyframes, bool Loop );
+
+/**
+ * Stop a running animation, leaving the LED's at their current intensity
+ **/
+typedef void (*iLedAnimationStopFunc)( void );
+
+/**
+ * This struct definition holds function pointers to play animations
+ * on a set of RGB LED's without involving the CPU for each step
+ */
+typedef struct
+{
+	const iLedAnimationLoadFunc Load;
+	const iLedAnimationStopFunc Stop;
+}iLedAnimation;
+
+#ifdef __cplusplus
+ }
+#endif
+#endif /* INC_ILEDANIMATION_H_ */
@@ -54,6 +54,20 @@
 
  }iPWM;
 
+ /**
+  * Compile-time alternative to iPWM
+  *
+  * A PWM implementation may also provide a static inline function named
+  * <Instance>SetDutyCycle (for example RedPWMSetDutyCycle for RedPWM).
+  * PWM_SET_DUTY_CYCLE(RedPWM, 50) then resolves to a direct register write
+  * instead of an indirect call through RedPWM.SetDutyCycle
+  *
+  * IPWM_STATIC builds a runtime iPWM from the same function:
+  * 	iPWM RedPWM = IPWM_STATIC(RedPWM);
+  */
+#define PWM_SET_DUTY_CYCLE(Instance, DutyCycle)	Instance##SetDutyCycle(DutyCycle)
+#define IPWM_STATIC(Instance)						{ .SetDutyCycle = Instance##SetDutyCycle }
+
 #ifdef __cplusplus
  }
 #endif
@@ -0,0 +1,51 @@
+/**
+ * MIT License
+ * 
+ * Copyright (c) 2019 Brian Amos
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#ifndef INC_LEDANIMATION_H_
+#define INC_LEDANIMATION_H_
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+#include <iLedAnimation.h>
+
+/**
+ * maximum number of PWM periods a single animation can span
+ * (each PWM period is ~3mS, see ledAnimation.c).  Longer animations are
+ * rejected by Load rather than truncated
+ */
+#define LED_ANIMATION_MAX_SAMPLES 1024
+
+void LedAnimationInit( void );
+
+/**
+ * iLedAnimation implementation that streams precomputed duty cycles
+ * into the red, green and blue PWM timers using DMA
+ */
+extern iLedAnimation PwmDmaAnimation;
+
+#ifdef __cplusplus
+ }
+#endif
+#endif /* INC_LEDANIMATION_H_ */
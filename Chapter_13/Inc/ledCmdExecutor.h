@@ -32,13 +32,15 @@
 #include <FreeRTOS.h>
 #include <queue.h>
 #include <iPWM.h>
+#include <iLedAnimation.h>
 
 typedef enum
 {
 	CMD_ALL_OFF = 0,
 	CMD_ALL_ON = 1,
 	CMD_SET_INTENSITY = 2,
-	CMD_BLINK = 3
+	CMD_BLINK = 3,
+	CMD_FADE = 4		//ramp to the new intensities over the step's delay
 }LED_CMD_NUM;
 
 /**
@@ -54,6 +56,36 @@ typedef struct
 	float blue;
 }LedCmd;
 
+/**
+ * a single step of a LED timeline, in the same format as it is received
+ * from the host.  Intensities are 0-255 (0-100%)
+ */
+typedef struct
+{
+	uint8_t cmdNum;
+	uint8_t red;
+	uint8_t green;
+	uint8_t blue;
+	uint16_t delayMs;	//how long to hold this step before applying the next one
+}LedStep;
+
+/**
+ * LedBatch holds a short timeline of commands that are applied by
+ * the executor in a single wake-up.  Steps with a delay of 0 are applied
+ * back-to-back, the final step stays in effect until the next batch arrives.
+ * A single command is simply a batch with numSteps = 1
+ *
+ * Batches are passed by reference: the producer fills a buffer taken from
+ * CmdExecArgs.freeBatchQueue and queues its address on ledCmdQueue.  The
+ * executor returns the buffer once the next batch has replaced it
+ */
+#define LED_BATCH_MAX_STEPS 40
+typedef struct
+{
+	uint8_t numSteps;
+	LedStep steps[LED_BATCH_MAX_STEPS];
+}LedBatch;
+
 /**
  * define a struct that contains all of the information required for the
  * LED command executor, including the implementations of the abstract iPWM
@@ -61,10 +93,12 @@ typedef struct
  */
 typedef struct
 {
-	QueueHandle_t ledCmdQueue;	//queue containing LedCmd(s), passed by value
+	QueueHandle_t ledCmdQueue;		//queue of LedBatch pointers to play
+	QueueHandle_t freeBatchQueue;	//played LedBatch pointers are returned here
 	iPWM * redPWM;
 	iPWM * bluePWM;
 	iPWM * greenPWM;
+	iLedAnimation * animation;	//optional, NULL to time steps and blinking in the task
 }CmdExecArgs;
 
 void LedCmdExecution( void* Args );
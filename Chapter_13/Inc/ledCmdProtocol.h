@@ -0,0 +1,173 @@
+/**
+ * MIT License
+ * 
+ * Copyright (c) 2019 Brian Amos
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#ifndef INC_LEDCMDPROTOCOL_H_
+#define INC_LEDCMDPROTOCOL_H_
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * Version 1 of the LED command protocol
+ *
+ * Every frame is COBS encoded and terminated with a single 0x00 delimiter, so
+ * a receiver can always resynchronize on the next 0x00 regardless of what was
+ * lost.  After decoding, a frame looks like this:
+ *
+ * <ver> <type> <seq> <len> <payload[len]> <CRC LSB> <CRC> <CRC> <CRC MSB>
+ *
+ * ver		PROTOCOL_VERSION
+ * type		PROTOCOL_FRAME_TYPE
+ * seq		8 bit sequence number (wraps)
+ * len		number of payload bytes (0 - PROTOCOL_MAX_PAYLOAD)
+ * CRC		CRC-32 of ver through the end of payload, little endian
+ *
+ * The host may have up to PROTOCOL_WINDOW_SIZE command frames in flight.
+ * Command frames are applied strictly in sequence order:
+ * 	ACK		seq holds the last sequence number that was applied (cumulative)
+ * 			payload[0] holds the number of batches the device can accept
+ * 	NACK	seq holds the next sequence number the device expects
+ * 			payload[0] holds a PROTOCOL_NACK_REASON
+ * 			the host retransmits everything from seq onward (go-back-N)
+ *
+ * A frame that arrived intact, in order, but can never be applied (NACK_BAD_PAYLOAD
+ * or NACK_UNKNOWN_TYPE) is skipped so it can't stall the window.  Its NACK
+ * carries the rejected frame's seq, which the host treats like a cumulative
+ * ACK - retransmitting it would only be rejected again.
+ *
+ * A host starts every session with a FRAME_SYNC.  Its seq restarts the receive
+ * window (whatever the device expected from a previous session is discarded)
+ * and it is ACK'd like any other frame, so it is retransmitted until it gets
+ * through.  The session id lets the device tell a retransmitted sync apart
+ * from a new host that happens to start at the same seq.
+ */
+#define PROTOCOL_VERSION 1
+#define PROTOCOL_WINDOW_SIZE 8
+#define PROTOCOL_MAX_PAYLOAD 240
+#define PROTOCOL_HEADER_LEN 4
+#define PROTOCOL_CRC_LEN 4
+#define PROTOCOL_SYNC_LEN 4
+#define PROTOCOL_MAX_FRAME_LEN (PROTOCOL_HEADER_LEN + PROTOCOL_MAX_PAYLOAD + PROTOCOL_CRC_LEN)
+
+//COBS adds at most 1 byte per 254 bytes of data (plus the leading code byte)
+//and 1 more byte for the 0x00 delimiter
+#define PROTOCOL_MAX_ENCODED_LEN (PROTOCOL_MAX_FRAME_LEN + PROTOCOL_MAX_FRAME_LEN/254 + 2)
+
+typedef enum
+{
+	FRAME_LED_CMD = 0x01,	//payload: <cmdNum> <red> <green> <blue>
+	FRAME_LED_BATCH = 0x02,	//payload: 1 or more of
+							//<cmdNum> <red> <green> <blue> <delayMs LSB> <delayMs MSB>
+	FRAME_SYNC = 0x03,		//payload: 32 bit session id, little endian
+	FRAME_ACK = 0x80,
+	FRAME_NACK = 0x81
+}PROTOCOL_FRAME_TYPE;
+
+typedef enum
+{
+	NACK_NONE = 0,
+	NACK_BAD_CRC = 1,
+	NACK_BAD_VERSION = 2,
+	NACK_BAD_LENGTH = 3,
+	NACK_OUT_OF_ORDER = 4,
+	NACK_QUEUE_FULL = 5,
+	NACK_UNKNOWN_TYPE = 6,
+	NACK_BAD_ENCODING = 7,
+	NACK_BAD_PAYLOAD = 8	//intact frame, payload invalid for its type - skipped
+}PROTOCOL_NACK_REASON;
+
+/**
+ * a single decoded (or to be encoded) frame
+ */
+typedef struct
+{
+	uint8_t type;
+	uint8_t seq;
+	uint8_t len;
+	uint8_t payload[PROTOCOL_MAX_PAYLOAD];
+}ProtocolFrame;
+
+/**
+ * collects raw bytes from the wire until a 0x00 delimiter is seen
+ * anything longer than PROTOCOL_MAX_ENCODED_LEN is discarded up to the
+ * next delimiter
+ */
+typedef struct
+{
+	uint8_t buff[PROTOCOL_MAX_ENCODED_LEN];
+	uint32_t len;
+	bool overflow;
+	bool ready;
+}ProtocolRxAccumulator;
+
+/**
+ * receive side of the sliding window - tracks the next sequence
+ * number that will be applied
+ */
+typedef struct
+{
+	uint8_t expectedSeq;
+	bool nackSent;		//a gap has already been reported for expectedSeq
+	bool synced;		//a FRAME_SYNC has been received since reset
+	uint32_t session;	//session id of the last FRAME_SYNC
+}ProtocolRxWindow;
+
+typedef enum
+{
+	SEQ_NEW,			//next in-order frame, should be applied
+	SEQ_DUPLICATE,		//already applied (lost ACK), re-ACK without applying
+	SEQ_OUT_OF_ORDER	//a previous frame was lost, NACK with expectedSeq
+}PROTOCOL_SEQ_STATUS;
+
+/**
+ * what the receiver should do with a frame that passed ProtocolParseFrame
+ */
+typedef enum
+{
+	RX_APPLY,		//next in order - apply it and ProtocolAdvance, then ACK
+					//(or NACK_BAD_PAYLOAD/NACK_UNKNOWN_TYPE if it can't be applied)
+	RX_ACK,			//duplicate or sync - ACK ProtocolLastApplied, nothing to apply
+	RX_NACK,		//first frame after a gap - NACK expectedSeq with NACK_OUT_OF_ORDER
+	RX_DROP			//gap has already been NACK'd, ignore
+}PROTOCOL_RX_ACTION;
+
+uint32_t CobsEncode( const uint8_t* Src, uint32_t Len, uint8_t* Dst );
+int32_t CobsDecode( const uint8_t* Src, uint32_t Len, uint8_t* Dst, uint32_t DstLen );
+
+bool ProtocolAccumulate( ProtocolRxAccumulator* Acc, uint8_t Byte );
+PROTOCOL_NACK_REASON ProtocolParseFrame( const uint8_t* Encoded, uint32_t Len, ProtocolFrame* Frame );
+uint32_t ProtocolBuildFrame( const ProtocolFrame* Frame, uint8_t* Dst );
+
+PROTOCOL_SEQ_STATUS ProtocolCheckSeq( const ProtocolRxWindow* Window, uint8_t Seq );
+PROTOCOL_RX_ACTION ProtocolReceive( ProtocolRxWindow* Window, const ProtocolFrame* Frame );
+void ProtocolAdvance( ProtocolRxWindow* Window );
+uint8_t ProtocolLastApplied( const ProtocolRxWindow* Window );
+
+#ifdef __cplusplus
+ }
+#endif
+#endif /* INC_LEDCMDPROTOCOL_H_ */
@@ -29,6 +29,9 @@
 #endif
 
 #include <iPWM.h>
+#include <stm32f7xx_hal.h>
+
+ void PWMInit( void );
 
  /**
   * iPWMLED implementations for each of the LED's on the
@@ -38,6 +41,28 @@
  extern iPWM GreenPWM;
  extern iPWM RedPWM;
 
+ /**
+  * static implementations used by PWM_SET_DUTY_CYCLE (see iPWM.h)
+  * each is a single write to the channel's compare register
+  * (65535 is 100% - see PWMInit)
+  */
+#define PWM_DUTY_TO_COMPARE(DutyCycle) ((uint32_t)((DutyCycle) * (65535.0f/100.0f)))
+
+ static inline void BluePWMSetDutyCycle( float DutyCycle )
+ {
+	 TIM4->CCR2 = PWM_DUTY_TO_COMPARE(DutyCycle);
+ }
+
+ static inline void GreenPWMSetDutyCycle( float DutyCycle )
+ {
+	 TIM3->CCR3 = PWM_DUTY_TO_COMPARE(DutyCycle);
+ }
+
+ static inline void RedPWMSetDutyCycle( float DutyCycle )
+ {
+	 TIM12->CCR1 = PWM_DUTY_TO_COMPARE(DutyCycle);
+ }
+
 
 #ifdef __cplusplus
  }
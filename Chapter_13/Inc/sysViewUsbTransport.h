@@ -0,0 +1,55 @@
+/**
+ * MIT License
+ * 
+ * Copyright (c) 2019 Brian Amos
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#ifndef INC_SYSVIEWUSBTRANSPORT_H_
+#define INC_SYSVIEWUSBTRANSPORT_H_
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+#include <stdint.h>
+#include <FreeRTOS.h>
+
+/**
+ * Statistics kept by the USB SystemView transport
+ * Events that don't fit in the SystemView buffer are dropped by SystemView
+ * itself, which reports the number of dropped events in the stream
+ * (shown as overflow events on the host)
+ */
+typedef struct
+{
+	uint32_t bytesSent;			//total number of trace bytes handed to the USB driver
+	uint32_t peakBytesWaiting;	//largest number of bytes found waiting in the SystemView buffer
+	uint32_t nearFullCount;		//number of times the SystemView buffer couldn't hold another max size packet
+	uint32_t cmdBytesDropped;	//host commands that didn't fit in the SystemView command buffer
+}SysViewTransportStats;
+
+void SysViewUsbTransportInit( const configSTACK_DEPTH_TYPE StackSize, UBaseType_t Priority );
+
+extern volatile SysViewTransportStats sysViewTransportStats;
+
+#ifdef __cplusplus
+ }
+#endif
+#endif /* INC_SYSVIEWUSBTRANSPORT_H_ */
@@ -3,8 +3,8 @@ from serial.tools import list_ports
 from serial import Serial
 from serial import SerialException
 import PySimpleGUI as sg
-from PyCRC.CRC32 import CRC32
 from enum import IntEnum
+from ledProtocol import LedProtocolSender
 
 
 # define the same enums as ledCmdExecutor.h
@@ -13,21 +13,10 @@ class CMD_ID(IntEnum):
     cmd_all_on = 1
     cmd_steady = 2
     cmd_blink = 3
+    cmd_fade = 4
     cmd_none = 255  # not actually a command
 
 
-# build a command with some simple framing to send to the MCU
-# <0x02> <cmdNum> <red> <green> <blue> <crc_lsb> <crc_lsb+1> <crc_lsb+2> <crc_msb>
-def buildCmd(cmdNum: int, red: int, green: int, blue: int):
-    cmd = bytearray([0x02, int(cmdNum & 0xff), int(red) & 0xff, int(green) & 0xff, int(blue) & 0xff])
-    crc = CRC32().calculate(bytes(cmd[0:4]))
-    cmd.append(crc & 0x000000FF)
-    cmd.append((crc & 0x0000FF00) >> 8)
-    cmd.append((crc & 0x00FF0000) >> 16)
-    cmd.append((crc & 0xFF000000) >> 24)
-    return cmd
-
-
 #   Create the main UI window and allow the user to select from a list of ports
 #
 #   @param expects list of COM Ports output from getPorts
@@ -155,17 +144,19 @@ def main():
     if ser is None:
         return
 
+    sender = LedProtocolSender(ser)
+
     # run the primary UI polling loop which watches for UI events
     # and takes the appropriate action
     while True:
         action, cmd = evaluateUI(window, ser)
+        sender.poll()
         if action == 1:
             # update required
             red, green, blue = getSliderValues(window)
-            setStatus(window, "%i %i %i %i" % (cmd, red, green, blue))
-            cmdBytes = buildCmd(cmd, red, green, blue)
-            ser.write(cmdBytes)
-            setStatus(window, "sent cmd  (0x)" + cmdBytes.hex())
+            sender.sendLedCmd(cmd, red, green, blue)
+            setStatus(window, "sent cmd %i %i %i %i, %i in flight" %
+                      (cmd, red, green, blue, len(sender.inFlight)))
         elif action == 2:
             # selected COM PORT changed
             # close the previously opened com port
@@ -174,6 +165,7 @@ def main():
             ser = selectComPort(window)
             if ser is None:
                 return
+            sender = LedProtocolSender(ser)
         elif action == -1:
             # window was closed, time to exit
             ser.close()
@@ -0,0 +1,204 @@
+import random
+import time
+from enum import IntEnum
+
+from PyCRC.CRC32 import CRC32
+
+
+# these values must match ledCmdProtocol.h
+PROTOCOL_VERSION = 1
+PROTOCOL_WINDOW_SIZE = 8
+PROTOCOL_MAX_PAYLOAD = 240
+PROTOCOL_HEADER_LEN = 4
+PROTOCOL_CRC_LEN = 4
+PROTOCOL_SYNC_LEN = 4
+LED_BATCH_MAX_STEPS = 40
+
+
+class FRAME_TYPE(IntEnum):
+    led_cmd = 0x01
+    led_batch = 0x02
+    sync = 0x03
+    ack = 0x80
+    nack = 0x81
+
+
+class NACK_REASON(IntEnum):
+    none = 0
+    bad_crc = 1
+    bad_version = 2
+    bad_length = 3
+    out_of_order = 4
+    queue_full = 5
+    unknown_type = 6
+    bad_encoding = 7
+    bad_payload = 8
+
+
+# the device skipped the frame - its NACK carries the rejected seq and
+# resending it would only be rejected again
+FINAL_NACK_REASONS = (NACK_REASON.bad_payload, NACK_REASON.unknown_type)
+
+
+# Consistent Overhead Byte Stuffing - the result contains no 0x00 bytes
+def cobsEncode(data: bytes):
+    out = bytearray([0])
+    codeIndex = 0
+    code = 1
+    for i, byte in enumerate(data):
+        if byte == 0:
+            out[codeIndex] = code
+            codeIndex = len(out)
+            out.append(0)
+            code = 1
+        else:
+            out.append(byte)
+            code += 1
+            # a full block only needs a new code byte if more data follows
+            if code == 0xFF and i + 1 < len(data):
+                out[codeIndex] = code
+                codeIndex = len(out)
+                out.append(0)
+                code = 1
+    out[codeIndex] = code
+    return bytes(out)
+
+
+# returns the decoded bytes or None if data isn't valid COBS
+def cobsDecode(data: bytes):
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        code = data[i]
+        i += 1
+        if code == 0 or i + code - 1 > len(data):
+            return None
+        out += data[i:i + code - 1]
+        i += code - 1
+        if code < 0xFF and i < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+# build a complete frame, ready to be written to the serial port
+# <ver> <type> <seq> <len> <payload> <crc_lsb> <crc> <crc> <crc_msb>, COBS encoded and 0x00 delimited
+def buildFrame(frameType: int, seq: int, payload: bytes):
+    raw = bytearray([PROTOCOL_VERSION, int(frameType) & 0xff, seq & 0xff, len(payload)])
+    raw += payload
+    crc = CRC32().calculate(bytes(raw))
+    raw += crc.to_bytes(4, 'little')
+    return cobsEncode(bytes(raw)) + b'\x00'
+
+
+# decode a single frame (without the delimiter)
+# returns (type, seq, payload) or None if the frame is invalid
+def parseFrame(encoded: bytes):
+    raw = cobsDecode(encoded)
+    if raw is None or len(raw) < PROTOCOL_HEADER_LEN + PROTOCOL_CRC_LEN:
+        return None
+    if CRC32().calculate(bytes(raw[:-4])) != int.from_bytes(raw[-4:], 'little'):
+        return None
+    if raw[0] != PROTOCOL_VERSION or raw[3] + PROTOCOL_HEADER_LEN + PROTOCOL_CRC_LEN != len(raw):
+        return None
+    return raw[1], raw[2], raw[PROTOCOL_HEADER_LEN:-PROTOCOL_CRC_LEN]
+
+
+# Sender side of the sliding window
+#
+# Keeps up to PROTOCOL_WINDOW_SIZE frames in flight. Frames are released by
+# cumulative ACK's, a NACK rewinds to the sequence number the MCU expects
+# (go-back-N) and anything unacknowledged for `timeout` seconds is resent.
+# Every sender starts its session with a sync frame, so the MCU's window
+# follows a new sender (or a reopened port) instead of NACK'ing every frame
+class LedProtocolSender:
+    def __init__(self, ser, timeout: float = 0.5, session: int = None):
+        self.ser = ser
+        # reads must not block forever, otherwise lost frames are never resent
+        self.ser.timeout = timeout
+        self.timeout = timeout
+        self.nextSeq = 0
+        self.inFlight = []      # list of (seq, frameBytes), oldest first
+        self.lastSendTime = 0.0
+        self.rxBuff = bytearray()
+        self.freeSlots = None
+        self.lastNack = NACK_REASON.none
+        if session is None:
+            session = random.getrandbits(32)
+        self.session = session
+        self.send(FRAME_TYPE.sync, session.to_bytes(PROTOCOL_SYNC_LEN, 'little'))
+
+    def windowFull(self):
+        return len(self.inFlight) >= PROTOCOL_WINDOW_SIZE
+
+    # queue a frame for transmission, waiting for room in the window
+    def send(self, frameType: int, payload: bytes):
+        while self.windowFull():
+            self.poll(block=True)
+        frame = buildFrame(frameType, self.nextSeq, payload)
+        self.inFlight.append((self.nextSeq, frame))
+        self.nextSeq = (self.nextSeq + 1) & 0xff
+        self.ser.write(frame)
+        self.lastSendTime = time.monotonic()
+
+    def sendLedCmd(self, cmdNum: int, red: int, green: int, blue: int):
+        self.send(FRAME_TYPE.led_cmd, bytes([int(cmdNum) & 0xff, int(red) & 0xff,
+                                             int(green) & 0xff, int(blue) & 0xff]))
+
+    # send a timeline of (cmdNum, red, green, blue, delayMs) steps in as few
+    # frames as possible.  Each step is held for delayMs before the next is applied
+    # NOTE: a new frame replaces whatever is left of the previous one, so a
+    # timeline longer than LED_BATCH_MAX_STEPS should only have delays in its final frame
+    def sendLedBatch(self, steps: list):
+        for i in range(0, len(steps), LED_BATCH_MAX_STEPS):
+            payload = bytearray()
+            for cmdNum, red, green, blue, delayMs in steps[i:i + LED_BATCH_MAX_STEPS]:
+                payload += bytes([int(cmdNum) & 0xff, int(red) & 0xff, int(green) & 0xff, int(blue) & 0xff])
+                payload += int(delayMs).to_bytes(2, 'little')
+            self.send(FRAME_TYPE.led_batch, bytes(payload))
+
+    # wait until every frame has been acknowledged
+    def flush(self):
+        while self.inFlight:
+            self.poll(block=True)
+
+    # process any responses from the MCU and retransmit if required
+    def poll(self, block: bool = False):
+        waiting = self.ser.in_waiting
+        if block and waiting == 0:
+            waiting = 1
+        if waiting > 0:
+            self.rxBuff += self.ser.read(waiting)
+
+        while b'\x00' in self.rxBuff:
+            encoded, _, self.rxBuff = self.rxBuff.partition(b'\x00')
+            frame = parseFrame(bytes(encoded))
+            if frame is not None:
+                self._handleResponse(*frame)
+
+        if self.inFlight and time.monotonic() - self.lastSendTime > self.timeout:
+            self._resendFrom(self.inFlight[0][0])
+
+    def _handleResponse(self, frameType: int, seq: int, payload: bytes):
+        if frameType == FRAME_TYPE.ack:
+            self._releaseThrough(seq)
+            if len(payload) > 0:
+                self.freeSlots = payload[0]
+        elif frameType == FRAME_TYPE.nack:
+            if len(payload) > 0:
+                self.lastNack = NACK_REASON(payload[0])
+            if self.lastNack in FINAL_NACK_REASONS:
+                # seq was skipped by the MCU, which also acknowledges everything before it
+                self._releaseThrough(seq)
+            else:
+                self._resendFrom(seq)
+
+    # everything up to and including seq has been applied
+    def _releaseThrough(self, seq: int):
+        while self.inFlight and ((seq - self.inFlight[0][0]) & 0xff) < PROTOCOL_WINDOW_SIZE:
+            self.inFlight.pop(0)
+
+    def _resendFrom(self, seq: int):
+        for frameSeq, frame in self.inFlight:
+            if ((frameSeq - seq) & 0xff) < PROTOCOL_WINDOW_SIZE:
+                self.ser.write(frame)
+        self.lastSendTime = time.monotonic()
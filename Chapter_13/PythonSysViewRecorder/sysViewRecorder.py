@@ -0,0 +1,106 @@
+import argparse
+import datetime
+import getpass
+import platform
+import socket
+import sys
+import time
+
+from serial import Serial
+from serial import SerialException
+from serial.tools import list_ports
+
+
+# these values must match SEGGER_SYSVIEW.h
+SEGGER_SYSVIEW_COMMAND_ID_START = 1
+SEGGER_SYSVIEW_COMMAND_ID_STOP = 2
+
+# version of SystemView the target side was taken from
+SYSVIEW_VERSION = 'V2.52h'
+
+
+# SystemView data files start with a block of ';' comment lines,
+# followed by the raw event stream exactly as read from the target
+def svdatHeader():
+    lines = [
+        ';',
+        '; Version     SEGGER SystemViewer ' + SYSVIEW_VERSION,
+        '; Platform    ' + platform.system(),
+        '; Generated   ' + datetime.datetime.now().strftime('%d.%m.%Y %H:%M:%S'),
+        ';',
+        '; Hostname    ' + socket.gethostname(),
+        '; User        ' + getpass.getuser(),
+        ';',
+        '; Trace recorded over USB virtual comm port (sysViewRecorder.py)',
+        ';',
+    ]
+    return ('\n'.join(lines) + '\n').encode('ascii')
+
+
+# Record from the target until duration seconds pass (or ctrl-c is pressed)
+#
+# @param port serial port the Nucleo's USB virtual comm port is on
+# @param fileName path of the .SVDat file to write
+# @param duration number of seconds to record for, 0 records until interrupted
+def record(port: str, fileName: str, duration: float):
+    with Serial(port, timeout=0.1) as ser, open(fileName, 'wb') as out:
+        # discard anything left over from a previous recording
+        ser.write(bytes([SEGGER_SYSVIEW_COMMAND_ID_STOP]))
+        time.sleep(0.1)
+        ser.reset_input_buffer()
+
+        out.write(svdatHeader())
+        ser.write(bytes([SEGGER_SYSVIEW_COMMAND_ID_START]))
+
+        numBytes = 0
+        startTime = time.monotonic()
+        lastReport = startTime
+        try:
+            while duration == 0 or time.monotonic() - startTime < duration:
+                data = ser.read(max(1, ser.in_waiting))
+                if data:
+                    out.write(data)
+                    numBytes += len(data)
+
+                now = time.monotonic()
+                if now - lastReport >= 1.0:
+                    rate = numBytes / (now - startTime) / 1024
+                    print('\r{} bytes recorded ({:.1f} KB/s)'.format(numBytes, rate), end='')
+                    lastReport = now
+        except KeyboardInterrupt:
+            pass
+        finally:
+            ser.write(bytes([SEGGER_SYSVIEW_COMMAND_ID_STOP]))
+            # collect the stop event and anything still buffered on the target
+            time.sleep(0.2)
+            data = ser.read(ser.in_waiting)
+            out.write(data)
+            numBytes += len(data)
+
+        print('\n{} bytes written to {}'.format(numBytes, fileName))
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Record SystemView data streamed over USB into a .SVDat file')
+    parser.add_argument('port', nargs='?', help='serial port to record from')
+    parser.add_argument('-o', '--output', default='trace.SVDat', help='file to write (default trace.SVDat)')
+    parser.add_argument('-t', '--time', type=float, default=0,
+                        help='seconds to record for (default: until ctrl-c is pressed)')
+    args = parser.parse_args()
+
+    if args.port is None:
+        print('available ports:')
+        for port in list_ports.comports():
+            print('  ' + port.device)
+        return 1
+
+    try:
+        record(args.port, args.output, args.time)
+    except SerialException as e:
+        print(e)
+        return 1
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -1,5 +1,37 @@
 #include <CRC32.h>
 
+/**
+ * nibble-wide lookup table for the reflected CRC-32 polynomial (0xEDB88320)
+ * 16 entries keeps the table small while avoiding a bit-by-bit loop
+ */
+static const uint32_t crcTable[16] =
+{
+	0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC,
+	0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+	0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C,
+	0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+};
+
+/**
+ * calculates a standard CRC-32 (same as zlib, PyCRC, Ethernet)
+ * @param Buff	data to calculate the CRC over
+ * @param Len	number of bytes in Buff
+ * @returns CRC-32 of the data
+ */
+uint32_t CalcCRC32( const uint8_t* Buff, uint32_t Len)
+{
+	uint32_t crc = 0xFFFFFFFF;
+
+	for(uint32_t i = 0; i < Len; i++)
+	{
+		crc ^= Buff[i];
+		crc = (crc >> 4) ^ crcTable[crc & 0x0F];
+		crc = (crc >> 4) ^ crcTable[crc & 0x0F];
+	}
+
+	return ~crc;
+}
+
 /**
  * checks that Buffer ends with a valid CRC-32
  * @param Buff	data, including 4 byte little endian
@@ -9,6 +41,15 @@
  */
 bool CheckCRC( const uint8_t* Buff, uint32_t Len)
 {
-	//TODO
-	return true;
+	if(Len < 4)
+	{
+		return false;
+	}
+
+	uint32_t expected =	 (uint32_t)Buff[Len-4] |
+						((uint32_t)Buff[Len-3] << 8) |
+						((uint32_t)Buff[Len-2] << 16) |
+						((uint32_t)Buff[Len-1] << 24);
+
+	return CalcCRC32(Buff, Len-4) == expected;
 }
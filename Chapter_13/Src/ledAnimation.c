@@ -0,0 +1,248 @@
+#include <ledAnimation.h>
+#include <pwmImplementation.h>
+#include <stm32f7xx_hal.h>
+#include <string.h>
+
+/**
+ * Hardware timed LED animations
+ *
+ * Each keyframe is rendered into one table of compare values per LED
+ * (one sample per PWM period).  A DMA stream copies the next sample into
+ * the LED's CCR register every time a PWM period completes, so the CPU is
+ * only involved when a new animation is loaded.
+ * Since the CCR registers are preloaded (see PWMInit), the new value
+ * is applied at the start of the next PWM period without glitches.
+ *
+ * TIM12 can't generate DMA requests, so the red channel is paced by a
+ * compare event on TIM4 CH1 (CCR1 = 0 matches once per period, the
+ * channel isn't routed to a pin).
+ *
+ * Color	Timer		DMA request		DMA stream/channel
+ * Green	TIM3CH3		TIM3_UP			DMA1 Stream2 Channel5
+ * Blue		TIM4CH2		TIM4_UP			DMA1 Stream6 Channel2
+ * Red		TIM12CH1	TIM4_CH1		DMA1 Stream0 Channel2
+ *
+ * PWMInit must be called before LedAnimationInit
+ */
+
+static uint16_t redSamples[LED_ANIMATION_MAX_SAMPLES];
+static uint16_t greenSamples[LED_ANIMATION_MAX_SAMPLES];
+static uint16_t blueSamples[LED_ANIMATION_MAX_SAMPLES];
+
+static DMA_HandleTypeDef redDma;
+static DMA_HandleTypeDef greenDma;
+static DMA_HandleTypeDef blueDma;
+
+static bool animationRunning = false;
+
+static uint32_t loadAnimation( const LedKeyframe* Keyframes, uint8_t NumKeyframes, bool Loop );
+static void stopAnimation( void );
+
+iLedAnimation PwmDmaAnimation = {.Load = loadAnimation, .Stop = stopAnimation};
+
+/**
+ * set up (but don't start) a DMA stream that copies 16 bit samples
+ * from memory into a timer's CCR register
+ * @returns true if the stream was configured
+ */
+static bool setupDma( DMA_HandleTypeDef* Handle, DMA_Stream_TypeDef* Stream,
+						uint32_t Channel )
+{
+	memset(Handle, 0, sizeof(DMA_HandleTypeDef));
+	Handle->Instance = Stream;
+	Handle->Init.Channel = Channel;
+	Handle->Init.Direction = DMA_MEMORY_TO_PERIPH;
+	Handle->Init.FIFOMode = DMA_FIFOMODE_DISABLE;
+	Handle->Init.MemBurst = DMA_MBURST_SINGLE;
+	Handle->Init.MemDataAlignment = DMA_MDATAALIGN_HALFWORD;
+	Handle->Init.MemInc = DMA_MINC_ENABLE;				//step through the table
+	Handle->Init.Mode = DMA_NORMAL;						//see setCircular
+	Handle->Init.PeriphBurst = DMA_PBURST_SINGLE;
+	Handle->Init.PeriphInc = DMA_PINC_DISABLE;			//always write the same CCR
+	Handle->Init.PeriphDataAlignment = DMA_PDATAALIGN_HALFWORD;
+	Handle->Init.Priority = DMA_PRIORITY_LOW;
+	return HAL_DMA_Init(Handle) == HAL_OK;
+}
+
+/**
+ * circular mode is a single bit in the stream's configuration register,
+ * so it is changed directly rather than running HAL_DMA_Init for every
+ * animation.  The stream must be disabled (stopAnimation)
+ */
+static void setCircular( DMA_HandleTypeDef* Handle, bool Loop )
+{
+	if(Loop)
+	{
+		Handle->Instance->CR |= DMA_SxCR_CIRC;
+		Handle->Init.Mode = DMA_CIRCULAR;
+	}
+	else
+	{
+		Handle->Instance->CR &= ~DMA_SxCR_CIRC;
+		Handle->Init.Mode = DMA_NORMAL;
+	}
+}
+
+/**
+ * Configure the timer DMA requests used to pace the animation
+ */
+void LedAnimationInit( void )
+{
+	__HAL_RCC_DMA1_CLK_ENABLE();
+
+	//TIM4 CH1 is used as a timing-only channel to create a second
+	//DMA request each period (for the red LED)
+	TIM4->CCMR1 &= ~(TIM_CCMR1_OC1M | TIM_CCMR1_CC1S);
+	TIM4->CCR1 = 0;
+	TIM4->CR2 &= ~TIM_CR2_CCDS;		//CC DMA requests on compare, not update
+
+	//the streams are only configured once, loadAnimation just starts them
+	bool dmaReady =	setupDma(&greenDma, DMA1_Stream2, DMA_CHANNEL_5) &&
+					setupDma(&blueDma, DMA1_Stream6, DMA_CHANNEL_2) &&
+					setupDma(&redDma, DMA1_Stream0, DMA_CHANNEL_2);
+	assert_param(dmaReady);
+	(void)dmaReady;
+}
+
+/**
+ * @returns the number of PWM periods per second (the animation sample rate)
+ */
+static uint32_t sampleRateHz( void )
+{
+	//all 3 timers share the same clock, prescaler and period (see PWMInit)
+	//APB1 timers run at twice the APB1 clock
+	uint32_t timerClock = HAL_RCC_GetPCLK1Freq() * 2;
+	return timerClock / ((TIM3->PSC + 1) * (TIM3->ARR + 1));
+}
+
+static uint16_t dutyToCompare( float DutyCycle )
+{
+	return PWM_DUTY_TO_COMPARE(DutyCycle);
+}
+
+static uint32_t keyframeSamples( const LedKeyframe* Keyframe, uint32_t RateHz )
+{
+	return (Keyframe->durationMs * RateHz) / 1000;
+}
+
+/**
+ * @returns true if every keyframe fits into the sample tables
+ */
+static bool keyframesFit( const LedKeyframe* Keyframes, uint8_t NumKeyframes )
+{
+	const uint32_t rateHz = sampleRateHz();
+	uint32_t numSamples = 0;
+
+	for(uint8_t i = 0; i < NumKeyframes; i++)
+	{
+		numSamples += keyframeSamples(&Keyframes[i], rateHz);
+	}
+	return numSamples <= LED_ANIMATION_MAX_SAMPLES;
+}
+
+/**
+ * render keyframes into the sample tables
+ * (keyframesFit must have been checked first)
+ * @returns number of samples written
+ */
+static uint32_t renderKeyframes( const LedKeyframe* Keyframes, uint8_t NumKeyframes )
+{
+	const uint32_t rateHz = sampleRateHz();
+	uint32_t numSamples = 0;
+
+	//fades into the first keyframe start from whatever is on the LED's now
+	int32_t prevRed = TIM12->CCR1;
+	int32_t prevGreen = TIM3->CCR3;
+	int32_t prevBlue = TIM4->CCR2;
+
+	for(uint8_t i = 0; i < NumKeyframes; i++)
+	{
+		const int32_t red = dutyToCompare(Keyframes[i].red);
+		const int32_t green = dutyToCompare(Keyframes[i].green);
+		const int32_t blue = dutyToCompare(Keyframes[i].blue);
+		const uint32_t frameSamples = keyframeSamples(&Keyframes[i], rateHz);
+
+		for(uint32_t n = 1; n <= frameSamples; n++)
+		{
+			if(Keyframes[i].fade)
+			{
+				redSamples[numSamples] = prevRed + ((red - prevRed) * (int32_t)n) / (int32_t)frameSamples;
+				greenSamples[numSamples] = prevGreen + ((green - prevGreen) * (int32_t)n) / (int32_t)frameSamples;
+				blueSamples[numSamples] = prevBlue + ((blue - prevBlue) * (int32_t)n) / (int32_t)frameSamples;
+			}
+			else
+			{
+				redSamples[numSamples] = red;
+				greenSamples[numSamples] = green;
+				blueSamples[numSamples] = blue;
+			}
+			numSamples++;
+		}
+
+		prevRed = red;
+		prevGreen = green;
+		prevBlue = blue;
+	}
+
+	//make sure DMA sees the tables if the data cache is in use
+	SCB_CleanDCache_by_Addr((uint32_t*)redSamples, sizeof(redSamples));
+	SCB_CleanDCache_by_Addr((uint32_t*)greenSamples, sizeof(greenSamples));
+	SCB_CleanDCache_by_Addr((uint32_t*)blueSamples, sizeof(blueSamples));
+
+	return numSamples;
+}
+
+static void stopAnimation( void )
+{
+	if(animationRunning)
+	{
+		TIM3->DIER &= ~TIM_DIER_UDE;
+		TIM4->DIER &= ~(TIM_DIER_UDE | TIM_DIER_CC1DE);
+		HAL_DMA_Abort(&greenDma);
+		HAL_DMA_Abort(&blueDma);
+		HAL_DMA_Abort(&redDma);
+		animationRunning = false;
+	}
+}
+
+static uint32_t loadAnimation( const LedKeyframe* Keyframes, uint8_t NumKeyframes, bool Loop )
+{
+	//refuse (rather than truncate) anything longer than the tables,
+	//whatever is currently playing is left alone
+	if(!keyframesFit(Keyframes, NumKeyframes))
+	{
+		return 0;
+	}
+
+	stopAnimation();
+
+	uint32_t numSamples = renderKeyframes(Keyframes, NumKeyframes);
+	if(numSamples == 0)
+	{
+		return 0;
+	}
+
+	setCircular(&greenDma, Loop);
+	setCircular(&blueDma, Loop);
+	setCircular(&redDma, Loop);
+
+	//the timers aren't requesting transfers yet, so a stream that did start
+	//can simply be aborted again if another one didn't
+	animationRunning = true;
+	if(	HAL_DMA_Start(&greenDma, (uint32_t)greenSamples, (uint32_t)&TIM3->CCR3, numSamples) != HAL_OK ||
+		HAL_DMA_Start(&blueDma, (uint32_t)blueSamples, (uint32_t)&TIM4->CCR2, numSamples) != HAL_OK ||
+		HAL_DMA_Start(&redDma, (uint32_t)redSamples, (uint32_t)&TIM12->CCR1, numSamples) != HAL_OK )
+	{
+		stopAnimation();
+		return 0;
+	}
+
+	//enable the requests as close together as possible so all 3 colors
+	//step through the tables in lock-step
+	__disable_irq();
+	TIM3->DIER |= TIM_DIER_UDE;
+	TIM4->DIER |= TIM_DIER_UDE | TIM_DIER_CC1DE;
+	__enable_irq();
+
+	return (numSamples * 1000) / sampleRateHz();
+}
@@ -20,16 +20,184 @@ void setDutyCycles( const CmdExecArgs* Args, float RedDuty,
 }
 
 
+#define BLINK_PERIOD_MS 250
+
+/**
+ * converts a step received from the host into an LedCmd
+ * (0-255 intensities are scaled to 0-100%)
+ */
+static void stepToCmd( const LedStep* Step, LedCmd* Cmd )
+{
+	Cmd->cmdNum = Step->cmdNum;
+	Cmd->red = Step->red/255.0 * 100;
+	Cmd->green = Step->green/255.0 * 100;
+	Cmd->blue = Step->blue/255.0 * 100;
+}
+
+/**
+ * a blink step expands into alternating on/off keyframes, so a timeline
+ * can't need more keyframes than this before it is too long for the
+ * animation anyway (LED_ANIMATION_MAX_SAMPLES is ~3S)
+ */
+#define BATCH_MAX_KEYFRAMES (2 * LED_BATCH_MAX_STEPS)
+
+/**
+ * converts a step into animation keyframes
+ * blinking steps produce the same on/off pattern the hardware blink
+ * in executeCmd plays, starting with the LED's on
+ * @param Step			step to convert
+ * @param DurationMs	time the step occupies in the animation
+ * @param Keyframes		keyframes are appended here
+ * @param NumKeyframes	number of keyframes already in Keyframes, updated
+ * @returns false if Keyframes doesn't have room for the step
+ */
+static bool stepToKeyframes( const LedStep* Step, uint16_t DurationMs,
+								LedKeyframe* Keyframes, uint8_t* NumKeyframes )
+{
+	LedCmd cmd;
+	stepToCmd(Step, &cmd);
+
+	switch(Step->cmdNum)
+	{
+		case CMD_ALL_OFF:
+			cmd.red = cmd.green = cmd.blue = 0;
+			break;
+		case CMD_ALL_ON:
+			cmd.red = cmd.green = cmd.blue = 100;
+			break;
+	}
+
+	uint16_t remainingMs = DurationMs;
+	bool ledsOn = true;
+	do
+	{
+		if(*NumKeyframes >= BATCH_MAX_KEYFRAMES)
+		{
+			return false;
+		}
+		LedKeyframe* keyframe = &Keyframes[(*NumKeyframes)++];
+		keyframe->red = ledsOn ? cmd.red : 0;
+		keyframe->green = ledsOn ? cmd.green : 0;
+		keyframe->blue = ledsOn ? cmd.blue : 0;
+		keyframe->durationMs = remainingMs;
+		keyframe->fade = (Step->cmdNum == CMD_FADE);
+
+		if(Step->cmdNum == CMD_BLINK && remainingMs > BLINK_PERIOD_MS)
+		{
+			keyframe->durationMs = BLINK_PERIOD_MS;
+		}
+		remainingMs -= keyframe->durationMs;
+		ledsOn = !ledsOn;
+	}while(remainingMs > 0);
+
+	return true;
+}
+
+/**
+ * hands a batch to the animation implementation
+ * Every step but the last one is played by the animation.  The final step
+ * is held until the next batch arrives, so it is applied by the task once
+ * the animation reaches it.  Only a final CMD_FADE is part of the animation,
+ * so its ramp can be played before the task holds it
+ * @returns number of mS until the final step is reached, 0 if the
+ * 			animation couldn't be loaded (the steps need to be timed by the task)
+ */
+static uint32_t playBatch( const CmdExecArgs* Args, const LedBatch* Batch )
+{
+	static LedKeyframe keyframes[BATCH_MAX_KEYFRAMES];
+	uint8_t numKeyframes = 0;
+	const uint8_t finalStep = Batch->numSteps - 1;
+
+	for(uint8_t i = 0; i < finalStep; i++)
+	{
+		if(!stepToKeyframes(&Batch->steps[i], Batch->steps[i].delayMs, keyframes, &numKeyframes))
+		{
+			return 0;
+		}
+	}
+	if(	Batch->steps[finalStep].cmdNum == CMD_FADE &&
+		!stepToKeyframes(&Batch->steps[finalStep], Batch->steps[finalStep].delayMs, keyframes, &numKeyframes))
+	{
+		return 0;
+	}
+	return Args->animation->Load(keyframes, numKeyframes, false);
+}
+
+/**
+ * applies a single command to the LED's
+ * @param Args CmdExecArgs passed to the task
+ * @param Cmd command to execute
+ * @param CurrCmdNum updated with the command that is now in effect
+ * @param BlinkingLedsOn updated with the current blink state
+ * @param Animating true if an animation is running, it is stopped (once)
+ * 					before Cmd is applied.  Updated if Cmd starts one
+ */
+static void executeCmd( const CmdExecArgs* Args, const LedCmd* Cmd,
+						LED_CMD_NUM* CurrCmdNum, bool* BlinkingLedsOn,
+						bool* Animating )
+{
+	if(*Animating)
+	{
+		Args->animation->Stop();
+		*Animating = false;
+	}
+
+	switch(Cmd->cmdNum)
+	{
+		case CMD_SET_INTENSITY:
+		case CMD_FADE:
+			*CurrCmdNum = CMD_SET_INTENSITY;
+			setDutyCycles(Args, Cmd->red, Cmd->green, Cmd->blue);
+			break;
+		case CMD_BLINK:
+			*CurrCmdNum = CMD_BLINK;
+			*BlinkingLedsOn = true;
+			setDutyCycles(Args, Cmd->red, Cmd->green, Cmd->blue);
+			if(Args->animation != NULL)
+			{
+				//let the hardware take care of blinking (if it can't,
+				//the task toggles the LED's instead)
+				const LedKeyframe blink[2] = {
+					{.red = Cmd->red, .green = Cmd->green, .blue = Cmd->blue, .durationMs = BLINK_PERIOD_MS},
+					{.red = 0, .green = 0, .blue = 0, .durationMs = BLINK_PERIOD_MS}};
+				*Animating = (Args->animation->Load(blink, 2, true) > 0);
+			}
+			break;
+		case CMD_ALL_OFF:
+			*CurrCmdNum = CMD_ALL_OFF;
+			setDutyCycles(Args, 0, 0, 0);
+			break;
+		case CMD_ALL_ON:
+			*CurrCmdNum = CMD_ALL_ON;
+			setDutyCycles(Args, 100, 100, 100);
+			break;
+	}
+}
+
 /**
- * Provides a top-level task that waits on
+ * Provides a top-level task that waits on LedBatch(es) to arrive in the queue
+ * and plays back each of their steps.  A newly received batch replaces
+ * whatever remains of the batch currently being played
+ *
+ * When an animation implementation is supplied, the timeline (and blinking)
+ * is handed to it and this task only wakes up once the timeline has reached
+ * the final step to apply it.  Otherwise (or when the timeline is too long
+ * for the animation) each step is timed here (and CMD_FADE behaves like
+ * CMD_SET_INTENSITY)
+ *
  * Args is CmdExecArgs
  */
 void LedCmdExecution( void* Args )
 {
-	//the next command pulled from the queue will be placed into nextCmd
+	//the next batch pulled from the queue will be placed into batch
 	LED_CMD_NUM currCmdNum = CMD_ALL_OFF;
 	bool blinkingLedsOn = false;	//tracks the current blinking state
-	LedCmd nextLedCmd;
+	bool animating = false;			//the animation is driving the LED's
+	LedCmd currLedCmd;
+	static LedBatch noBatch;		//in effect until the first batch arrives
+	LedBatch* batch = &noBatch;		//batch being played, owned by this task
+	LedBatch* nextBatch;
+	uint8_t nextStep = 0;			//index of the next step in batch to apply
 
 	//ensure Args isn't NULL before dereference
 	while(Args == NULL);
@@ -41,33 +209,65 @@ void LedCmdExecution( void* Args )
 	while(args.bluePWM == NULL);
 	while(args.greenPWM == NULL);
 	while(args.ledCmdQueue == NULL);
+	while(args.freeBatchQueue == NULL);
 
 	while(1)
 	{
-		if(xQueueReceive(args.ledCmdQueue, &nextLedCmd, 250) == pdTRUE)
+		TickType_t waitTime = pdMS_TO_TICKS(BLINK_PERIOD_MS);
+		uint32_t animationMs = 0;
+
+		if(args.animation != NULL && nextStep == 0 && batch->numSteps > 1)
 		{
-			switch(nextLedCmd.cmdNum)
+			//timelines that are too long for the animation are
+			//stepped through below instead
+			animationMs = playBatch(&args, batch);
+		}
+
+		if(animationMs > 0)
+		{
+			//the hardware plays everything up to the final step,
+			//which is applied once the animation has reached it
+			animating = true;
+			waitTime = pdMS_TO_TICKS(animationMs);
+			nextStep = batch->numSteps - 1;
+		}
+		else
+		{
+			//apply every step that is due, stopping at the first one
+			//that needs to be held for some time
+			while(nextStep < batch->numSteps)
 			{
-				case CMD_SET_INTENSITY:
-					currCmdNum = CMD_SET_INTENSITY;
-					setDutyCycles(&args, nextLedCmd.red, nextLedCmd.green, nextLedCmd.blue);
-					break;
-				case CMD_BLINK:
-					currCmdNum = CMD_BLINK;
-					blinkingLedsOn = true;
-					setDutyCycles(&args, nextLedCmd.red, nextLedCmd.green, nextLedCmd.blue);
-					break;
-				case CMD_ALL_OFF:
-					currCmdNum = CMD_ALL_OFF;
-					setDutyCycles(&args, 0, 0, 0);
-					break;
-				case CMD_ALL_ON:
-					currCmdNum = CMD_ALL_ON;
-					setDutyCycles(&args, 100, 100, 100);
+				const LedStep* step = &batch->steps[nextStep++];
+				stepToCmd(step, &currLedCmd);
+				executeCmd(&args, &currLedCmd, &currCmdNum, &blinkingLedsOn, &animating);
+
+				if(step->delayMs > 0 && nextStep < batch->numSteps)
+				{
+					waitTime = pdMS_TO_TICKS(step->delayMs);
 					break;
+				}
+			}
+		}
+		bool holdingStep = (nextStep < batch->numSteps);
+
+		if(!holdingStep && (currCmdNum != CMD_BLINK || animating))
+		{
+			//nothing to time - sleep until the next batch arrives
+			waitTime = portMAX_DELAY;
+		}
+
+		if(xQueueReceive(args.ledCmdQueue, &nextBatch, waitTime) == pdTRUE)
+		{
+			//the animation plays from its own tables, so whatever is left
+			//of the previous batch can be handed back right away
+			if(batch != &noBatch)
+			{
+				xQueueSend(args.freeBatchQueue, &batch, 0);
 			}
+			batch = nextBatch;
+			nextStep = 0;
 		}
-		else if (currCmdNum == CMD_BLINK)
+		else if (!holdingStep && currCmdNum == CMD_BLINK && !animating)
 		{
 			//if there is no new command and we should be blinking
 			if(blinkingLedsOn)
@@ -78,7 +278,7 @@ void LedCmdExecution( void* Args )
 			else
 			{
 				blinkingLedsOn = true;
-				setDutyCycles(&args, nextLedCmd.red, nextLedCmd.green, nextLedCmd.blue);
+				setDutyCycles(&args, currLedCmd.red, currLedCmd.green, currLedCmd.blue);
 			}
 		}
 	}
@@ -0,0 +1,297 @@
+#include <ledCmdProtocol.h>
+#include <CRC32.h>
+
+/**
+ * Framing, validation and sequence tracking for the LED command protocol
+ * (see ledCmdProtocol.h for the frame layout).  Nothing in here touches
+ * the USB driver or FreeRTOS, so the same code can be exercised off-target
+ */
+
+/**
+ * Consistent Overhead Byte Stuffing - removes all 0x00 bytes from Src so
+ * 0x00 can be used as an unambiguous frame delimiter
+ * @param Src	data to encode
+ * @param Len	number of bytes in Src
+ * @param Dst	output buffer, must hold at least Len + Len/254 + 1 bytes
+ * @returns number of bytes written to Dst (no delimiter is appended)
+ */
+uint32_t CobsEncode( const uint8_t* Src, uint32_t Len, uint8_t* Dst )
+{
+	uint32_t codeIndex = 0;
+	uint32_t dstIndex = 1;
+	uint8_t code = 1;
+
+	for(uint32_t i = 0; i < Len; i++)
+	{
+		if(Src[i] == 0)
+		{
+			Dst[codeIndex] = code;
+			codeIndex = dstIndex++;
+			code = 1;
+		}
+		else
+		{
+			Dst[dstIndex++] = Src[i];
+			code++;
+			//a full block only needs a new code byte if more data follows
+			if(code == 0xFF && i + 1 < Len)
+			{
+				Dst[codeIndex] = code;
+				codeIndex = dstIndex++;
+				code = 1;
+			}
+		}
+	}
+	Dst[codeIndex] = code;
+
+	return dstIndex;
+}
+
+/**
+ * reverses CobsEncode
+ * @param Src		encoded data, not including the 0x00 delimiter
+ * @param Len		number of bytes in Src
+ * @param Dst		output buffer
+ * @param DstLen	size of Dst
+ * @returns number of decoded bytes or -1 if Src isn't valid COBS data
+ * 			(or won't fit into Dst)
+ */
+int32_t CobsDecode( const uint8_t* Src, uint32_t Len, uint8_t* Dst, uint32_t DstLen )
+{
+	uint32_t srcIndex = 0;
+	uint32_t dstIndex = 0;
+
+	while(srcIndex < Len)
+	{
+		uint8_t code = Src[srcIndex++];
+		if(code == 0 || srcIndex + code - 1 > Len)
+		{
+			return -1;
+		}
+
+		for(uint8_t i = 1; i < code; i++)
+		{
+			if(dstIndex >= DstLen)
+			{
+				return -1;
+			}
+			Dst[dstIndex++] = Src[srcIndex++];
+		}
+
+		//a code less than 0xFF implies a 0x00 followed, unless this
+		//was the last block
+		if(code < 0xFF && srcIndex < Len)
+		{
+			if(dstIndex >= DstLen)
+			{
+				return -1;
+			}
+			Dst[dstIndex++] = 0;
+		}
+	}
+
+	return dstIndex;
+}
+
+/**
+ * add a single byte received from the wire
+ * @param Acc	accumulator the byte is added to
+ * @param Byte	byte received
+ * @returns true when Acc->buff holds a complete encoded frame
+ * 			(Acc->len bytes, delimiter removed).  The accumulator is reset
+ * 			the next time this function is called
+ */
+bool ProtocolAccumulate( ProtocolRxAccumulator* Acc, uint8_t Byte )
+{
+	//a complete frame was returned last time - start a new one
+	if(Acc->ready)
+	{
+		Acc->ready = false;
+		Acc->len = 0;
+	}
+
+	if(Byte == 0)
+	{
+		Acc->ready = !Acc->overflow && Acc->len > 0;
+		Acc->overflow = false;
+		if(!Acc->ready)
+		{
+			Acc->len = 0;
+		}
+		return Acc->ready;
+	}
+
+	if(Acc->len >= sizeof(Acc->buff))
+	{
+		//drop everything until the next delimiter
+		Acc->overflow = true;
+		Acc->len = 0;
+	}
+
+	if(!Acc->overflow)
+	{
+		Acc->buff[Acc->len++] = Byte;
+	}
+	return false;
+}
+
+/**
+ * decode and validate a frame collected by ProtocolAccumulate
+ * @param Encoded	COBS encoded frame (without delimiter)
+ * @param Len		number of bytes in Encoded
+ * @param Frame		populated when the frame is valid
+ * @returns NACK_NONE if Frame is valid, otherwise the reason it was rejected
+ */
+PROTOCOL_NACK_REASON ProtocolParseFrame( const uint8_t* Encoded, uint32_t Len, ProtocolFrame* Frame )
+{
+	uint8_t decoded[PROTOCOL_MAX_FRAME_LEN];
+
+	int32_t decodedLen = CobsDecode(Encoded, Len, decoded, sizeof(decoded));
+	if(decodedLen < 0)
+	{
+		return NACK_BAD_ENCODING;
+	}
+	if(decodedLen < PROTOCOL_HEADER_LEN + PROTOCOL_CRC_LEN)
+	{
+		return NACK_BAD_LENGTH;
+	}
+	if(!CheckCRC(decoded, decodedLen))
+	{
+		return NACK_BAD_CRC;
+	}
+	if(decoded[0] != PROTOCOL_VERSION)
+	{
+		return NACK_BAD_VERSION;
+	}
+	if(decoded[3] > PROTOCOL_MAX_PAYLOAD ||
+	   decoded[3] + PROTOCOL_HEADER_LEN + PROTOCOL_CRC_LEN != decodedLen)
+	{
+		return NACK_BAD_LENGTH;
+	}
+
+	Frame->type = decoded[1];
+	Frame->seq = decoded[2];
+	Frame->len = decoded[3];
+	for(uint8_t i = 0; i < Frame->len; i++)
+	{
+		Frame->payload[i] = decoded[PROTOCOL_HEADER_LEN + i];
+	}
+
+	return NACK_NONE;
+}
+
+/**
+ * serialize, CRC, COBS encode and delimit a frame so it is ready to be sent
+ * @param Frame	frame to send (Frame->len must not exceed PROTOCOL_MAX_PAYLOAD)
+ * @param Dst	output buffer of at least PROTOCOL_MAX_ENCODED_LEN bytes
+ * @returns number of bytes to transmit, including the 0x00 delimiter
+ */
+uint32_t ProtocolBuildFrame( const ProtocolFrame* Frame, uint8_t* Dst )
+{
+	uint8_t raw[PROTOCOL_MAX_FRAME_LEN];
+	uint32_t len = 0;
+
+	raw[len++] = PROTOCOL_VERSION;
+	raw[len++] = Frame->type;
+	raw[len++] = Frame->seq;
+	raw[len++] = Frame->len;
+	for(uint8_t i = 0; i < Frame->len; i++)
+	{
+		raw[len++] = Frame->payload[i];
+	}
+
+	uint32_t crc = CalcCRC32(raw, len);
+	raw[len++] = crc & 0xFF;
+	raw[len++] = (crc >> 8) & 0xFF;
+	raw[len++] = (crc >> 16) & 0xFF;
+	raw[len++] = (crc >> 24) & 0xFF;
+
+	uint32_t encodedLen = CobsEncode(raw, len, Dst);
+	Dst[encodedLen++] = 0;
+
+	return encodedLen;
+}
+
+/**
+ * classify an incoming sequence number against the receive window
+ * sequence numbers that are up to PROTOCOL_WINDOW_SIZE behind the expected
+ * value are treated as retransmissions of frames that were already applied
+ */
+PROTOCOL_SEQ_STATUS ProtocolCheckSeq( const ProtocolRxWindow* Window, uint8_t Seq )
+{
+	uint8_t behind = (uint8_t)(Window->expectedSeq - Seq);
+
+	if(behind == 0)
+	{
+		return SEQ_NEW;
+	}
+	if(behind <= PROTOCOL_WINDOW_SIZE)
+	{
+		return SEQ_DUPLICATE;
+	}
+	return SEQ_OUT_OF_ORDER;
+}
+
+/**
+ * sequence handling for a frame that passed ProtocolParseFrame
+ * a well formed FRAME_SYNC restarts the window at its seq (and counts as
+ * applied), unless it is a retransmission of the sync that started the
+ * current session
+ * @param Window	receive window, updated for syncs and reported gaps
+ * @param Frame		validated frame
+ * @returns what to do with Frame and which response to send
+ */
+PROTOCOL_RX_ACTION ProtocolReceive( ProtocolRxWindow* Window, const ProtocolFrame* Frame )
+{
+	if(Frame->type == FRAME_SYNC && Frame->len == PROTOCOL_SYNC_LEN)
+	{
+		uint32_t session =	Frame->payload[0] | (Frame->payload[1] << 8) |
+							(Frame->payload[2] << 16) | ((uint32_t)Frame->payload[3] << 24);
+
+		if(	!Window->synced || session != Window->session ||
+			ProtocolCheckSeq(Window, Frame->seq) != SEQ_DUPLICATE)
+		{
+			Window->synced = true;
+			Window->session = session;
+			Window->expectedSeq = Frame->seq;
+			ProtocolAdvance(Window);
+		}
+		return RX_ACK;
+	}
+
+	switch(ProtocolCheckSeq(Window, Frame->seq))
+	{
+		case SEQ_NEW:
+			return RX_APPLY;
+		case SEQ_DUPLICATE:
+			//the ACK was probably lost - don't apply the command twice
+			return RX_ACK;
+		case SEQ_OUT_OF_ORDER:
+		default:
+			//only NACK the first frame after a gap, the rest of the
+			//frames in flight will be retransmitted anyway
+			if(Window->nackSent)
+			{
+				return RX_DROP;
+			}
+			Window->nackSent = true;
+			return RX_NACK;
+	}
+}
+
+/**
+ * mark the expected frame as applied (or skipped, if it could never be applied)
+ */
+void ProtocolAdvance( ProtocolRxWindow* Window )
+{
+	Window->expectedSeq++;
+	Window->nackSent = false;
+}
+
+/**
+ * @returns the sequence number reported in a cumulative ACK
+ */
+uint8_t ProtocolLastApplied( const ProtocolRxWindow* Window )
+{
+	return (uint8_t)(Window->expectedSeq - 1);
+}
@@ -35,7 +35,9 @@
 #include <stdio.h>
 #include <pwmImplementation.h>
 #include <ledCmdExecutor.h>
-#include <CRC32.h>
+#include <ledAnimation.h>
+#include <ledCmdProtocol.h>
+#include <QueueTelemetry.h>
 
 // some common variables to use for each task
 // 128 * 4 = 512 bytes
@@ -48,26 +50,52 @@
  * It validates incoming data, populates the
  * data structure used by the LED command executor
  * and pushes commands into the command executor's queue
+ * Every frame is answered with an ACK or NACK so the host knows
+ * whether the command was applied
  */
 void frameDecoder( void* NotUsed);
+static void handleFrame( const ProtocolFrame* Frame );
+static bool takeBatch( void );
+static void rejectFrame( PROTOCOL_NACK_REASON Reason );
+static void sendResponse( uint8_t Type, uint8_t Seq, uint8_t Value );
 
 /**
  * the ledCmdQueue is used to pass data from the protocol decoding task to the
  * LedCmdExecutor
+ * Only pointers to batches are queued.  Each batch is filled in place by
+ * frameDecoder and handed back through freeBatchQueue once LedCmdExecution
+ * has replaced it, so at most one batch is being played, one is waiting in
+ * ledCmdQueue and one is being decoded
  */
+#define LED_BATCH_POOL_SIZE 3
 QueueHandle_t ledCmdQueue = NULL;
+QueueHandle_t freeBatchQueue = NULL;
+static LedBatch batchPool[LED_BATCH_POOL_SIZE];
 
 int main(void)
 {
 	HWInit();
 	PWMInit();
+	LedAnimationInit();
 	VirtualCommInit(256, configMAX_PRIORITIES-1);
 	SEGGER_SYSVIEW_Conf();
 	HAL_NVIC_SetPriorityGrouping(NVIC_PRIORITYGROUP_4);	//ensure proper priority grouping for freeRTOS
 
-	//create a queue for LedCmd structs, capable of holding up to 4 commands
-	ledCmdQueue = xQueueCreate(4, sizeof(LedCmd));
+	//create queues for LedBatch pointers, every batch in the pool is free to start with
+	ledCmdQueue = xQueueCreate(LED_BATCH_POOL_SIZE, sizeof(LedBatch*));
 	assert_param(ledCmdQueue != NULL);
+	freeBatchQueue = xQueueCreate(LED_BATCH_POOL_SIZE, sizeof(LedBatch*));
+	assert_param(freeBatchQueue != NULL);
+	for(uint8_t i = 0; i < LED_BATCH_POOL_SIZE; i++)
+	{
+		LedBatch* batch = &batchPool[i];
+		assert_param(xQueueSend(freeBatchQueue, &batch, 0) == pdPASS);
+	}
+	QUEUE_TELEMETRY_REGISTER_QUEUE(ledCmdQueue, "ledCmdQueue");
+
+	//in telemetry builds, sample ledCmdQueue and the USB stream buffers
+	//every 100mS and record the results as SystemView events
+	QUEUE_TELEMETRY_START(100, tskIDLE_PRIORITY + 1);
 
 	/**
 	 * create a variable that will store the arguments
@@ -80,9 +108,11 @@ int main(void)
 	 */
 	static CmdExecArgs ledTaskArgs;
 	ledTaskArgs.ledCmdQueue = ledCmdQueue;
+	ledTaskArgs.freeBatchQueue = freeBatchQueue;
 	ledTaskArgs.redPWM = &RedPWM;
 	ledTaskArgs.greenPWM = &GreenPWM;
 	ledTaskArgs.bluePWM = &BluePWM;
+	ledTaskArgs.animation = &PwmDmaAnimation;
 
 	//setup tasks, making sure they have been properly created before moving on
 	assert_param(xTaskCreate(frameDecoder, "frameDecoder", 256, NULL, configMAX_PRIORITIES-2, NULL) == pdPASS);
@@ -97,65 +127,200 @@ int main(void)
 	}
 }
 
+/**
+ * protocol state is only ever touched by frameDecoder, it is kept out of
+ * the task's stack since the buffers are sized for the largest frame
+ */
+static ProtocolRxAccumulator rxAccumulator;
+static ProtocolRxWindow rxWindow;
+static ProtocolFrame rxFrame;
+static ProtocolFrame txFrame;
+static uint8_t txBuff[PROTOCOL_MAX_ENCODED_LEN];
+static LedBatch* incomingBatch = NULL;	//taken from freeBatchQueue, NULL until needed
+
+#define LED_STEP_WIRE_LEN 6
+
 /**
  * this task monitors the UBS port, decodes complete frames from the USB Rx StreamBuffer,
- * populates an LedCmd and pushes thecommand into a queue for the LedCmdExecution task to consume
+ * populates an LedBatch and queues a pointer to it for the LedCmdExecution task to consume
+ *
+ * Frames are COBS encoded and delimited by 0x00 (see ledCmdProtocol.h for
+ * the complete layout).  An LED command frame carries 4 bytes of payload:
+ *
+ * <Cmd> <red> <green> <blue>
  *
- * The frame consists of a delimiter byte with value 0x02 and then 4 bytes
- * representing the command number, red duty cycle , green duty cycle, and blue duty cycle,
- * To ensure the frame has been correctly detected and
- * received, a 32 bit CRC must be validated before pushing the RGB values into
- * the queue (it comes across the wire little endian)
+ * A batch frame carries up to LED_BATCH_MAX_STEPS commands, each followed by
+ * the number of milliseconds to hold it before the next one is applied:
  *
- * <STX> <Cmd> <red> <green> <blue> <CRC LSB> <CRC> <CRC> <CRC MSB>
+ * <Cmd> <red> <green> <blue> <delay LSB> <delay MSB> <Cmd> ...
  *
- * STX is ASCII start of text (0x02)
+ * Each frame is answered with a cumulative ACK once the command has been
+ * accepted by ledCmdQueue, or a NACK carrying the sequence number the host
+ * should resume from.  A FRAME_SYNC from the host restarts the sequence numbers
  */
 void frameDecoder( void* NotUsed)
 {
-	LedCmd incomingCmd;
-
-#define FRAME_LEN 9
-	uint8_t frame[FRAME_LEN];
+#define RX_CHUNK_LEN 64
+	uint8_t rxChunk[RX_CHUNK_LEN];
 
 	while(1)
 	{
-		memset(frame, 0, FRAME_LEN);
-
 		//since this is the only task receiving from the streamBuffer, we don't
 		//need to acquire a mutex before accessing it
 		//if more than one task was to be receiving, vcom_rxStream would require
 		//protection from a mutex
+		uint32_t numBytes = xStreamBufferReceive(	*GetUsbRxStreamBuff(),
+													rxChunk,
+													RX_CHUNK_LEN,
+													portMAX_DELAY);
 
-		//first, ensure we received STX (0x02)
-		while(frame[0] != 0x02)
+		for(uint32_t i = 0; i < numBytes; i++)
 		{
-			xStreamBufferReceive(	*GetUsbRxStreamBuff(),
-									frame,
-									1,
-									portMAX_DELAY);
+			if(ProtocolAccumulate(&rxAccumulator, rxChunk[i]))
+			{
+				PROTOCOL_NACK_REASON reason = ProtocolParseFrame(	rxAccumulator.buff,
+																	rxAccumulator.len,
+																	&rxFrame);
+				if(reason == NACK_NONE)
+				{
+					handleFrame(&rxFrame);
+				}
+				else
+				{
+					//the sequence number of a corrupt frame can't be trusted,
+					//so ask for everything from the next expected frame
+					sendResponse(FRAME_NACK, rxWindow.expectedSeq, reason);
+				}
+			}
 		}
+	}
+}
 
-		//now receive the rest of the frame (hopefully)
-		//this won't return until the remainder has bLEDeen received
-		xStreamBufferReceive(	*GetUsbRxStreamBuff(),
-								&frame[1],
-								FRAME_LEN-1,
-								portMAX_DELAY);
+/**
+ * apply a validated frame (in sequence order) and respond to the host
+ */
+static void handleFrame( const ProtocolFrame* Frame )
+{
+	switch(ProtocolReceive(&rxWindow, Frame))
+	{
+		case RX_ACK:
+			sendResponse(FRAME_ACK, ProtocolLastApplied(&rxWindow), uxQueueMessagesWaiting(freeBatchQueue));
+			return;
+		case RX_NACK:
+			sendResponse(FRAME_NACK, rxWindow.expectedSeq, NACK_OUT_OF_ORDER);
+			return;
+		case RX_DROP:
+			return;
+		case RX_APPLY:
+			break;
+	}
 
-		//if the frame is intact, store it into the command
-		//and send it to the ledCmdQueue
-		if(CheckCRC(frame, FRAME_LEN))
-		{
-			//populate the command with current values
-			incomingCmd.cmdNum = frame[1];
-			incomingCmd.red = frame[2]/255.0 * 100;
-			incomingCmd.green = frame[3]/255.0 * 100;
-			incomingCmd.blue = frame[4]/255.0 * 100;
-
-			//push the command to the queue
-			//wait up to 100 ticks and then drop it if not added...
-			xQueueSend(ledCmdQueue, &incomingCmd, 100);
-		}
+	switch(Frame->type)
+	{
+		case FRAME_LED_CMD:
+			if(Frame->len != 4)
+			{
+				rejectFrame(NACK_BAD_PAYLOAD);
+				return;
+			}
+			if(!takeBatch())
+			{
+				return;
+			}
+			//a single command is a batch with one step that is never released
+			incomingBatch->numSteps = 1;
+			incomingBatch->steps[0].cmdNum = Frame->payload[0];
+			incomingBatch->steps[0].red = Frame->payload[1];
+			incomingBatch->steps[0].green = Frame->payload[2];
+			incomingBatch->steps[0].blue = Frame->payload[3];
+			incomingBatch->steps[0].delayMs = 0;
+			break;
+		case FRAME_LED_BATCH:
+			if(	Frame->len == 0 || Frame->len % LED_STEP_WIRE_LEN != 0 ||
+				Frame->len / LED_STEP_WIRE_LEN > LED_BATCH_MAX_STEPS)
+			{
+				rejectFrame(NACK_BAD_PAYLOAD);
+				return;
+			}
+			if(!takeBatch())
+			{
+				return;
+			}
+			incomingBatch->numSteps = Frame->len / LED_STEP_WIRE_LEN;
+			for(uint8_t i = 0; i < incomingBatch->numSteps; i++)
+			{
+				const uint8_t* wireStep = &Frame->payload[i * LED_STEP_WIRE_LEN];
+				incomingBatch->steps[i].cmdNum = wireStep[0];
+				incomingBatch->steps[i].red = wireStep[1];
+				incomingBatch->steps[i].green = wireStep[2];
+				incomingBatch->steps[i].blue = wireStep[3];
+				incomingBatch->steps[i].delayMs = wireStep[4] | (wireStep[5] << 8);
+			}
+			break;
+		case FRAME_SYNC:
+			//a well formed sync is handled by ProtocolReceive
+			rejectFrame(NACK_BAD_PAYLOAD);
+			return;
+		default:
+			rejectFrame(NACK_UNKNOWN_TYPE);
+			return;
+	}
+
+	//ledCmdQueue can hold every batch in the pool, so there's always room
+	if(xQueueSend(ledCmdQueue, &incomingBatch, 0) == pdPASS)
+	{
+		incomingBatch = NULL;
+		ProtocolAdvance(&rxWindow);
+		sendResponse(FRAME_ACK, ProtocolLastApplied(&rxWindow), uxQueueMessagesWaiting(freeBatchQueue));
+	}
+	else
+	{
+		sendResponse(FRAME_NACK, rxWindow.expectedSeq, NACK_QUEUE_FULL);
+	}
+}
+
+/**
+ * make sure incomingBatch points to a free batch
+ * wait up to 100 ticks for LedCmdExecution to return one, then let the host
+ * know the frame was dropped
+ * @returns true if incomingBatch can be filled
+ */
+static bool takeBatch( void )
+{
+	if(incomingBatch == NULL && xQueueReceive(freeBatchQueue, &incomingBatch, 100) != pdPASS)
+	{
+		incomingBatch = NULL;
+		sendResponse(FRAME_NACK, rxWindow.expectedSeq, NACK_QUEUE_FULL);
+		return false;
 	}
+	return true;
+}
+
+/**
+ * skip an in-order frame that can never be applied so it doesn't stall the
+ * window.  The NACK carries the rejected frame's seq so the host drops it
+ * rather than retransmitting it
+ */
+static void rejectFrame( PROTOCOL_NACK_REASON Reason )
+{
+	ProtocolAdvance(&rxWindow);
+	sendResponse(FRAME_NACK, ProtocolLastApplied(&rxWindow), Reason);
+}
+
+/**
+ * send an ACK or NACK back to the host
+ * @param Type	FRAME_ACK or FRAME_NACK
+ * @param Seq	last applied seq (ACK), next expected seq (NACK) or
+ * 				rejected seq (NACK_BAD_PAYLOAD/NACK_UNKNOWN_TYPE)
+ * @param Value	free batches (ACK) or PROTOCOL_NACK_REASON (NACK)
+ */
+static void sendResponse( uint8_t Type, uint8_t Seq, uint8_t Value )
+{
+	txFrame.type = Type;
+	txFrame.seq = Seq;
+	txFrame.len = 1;
+	txFrame.payload[0] = Value;
+
+	uint32_t len = ProtocolBuildFrame(&txFrame, txBuff);
+	TransmitUsbData(txBuff, len, 10);
 }
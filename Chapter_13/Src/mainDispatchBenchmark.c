@@ -0,0 +1,161 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2019 Brian Amos
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <FreeRTOS.h>
+#include <task.h>
+#include <Nucleo_F767ZI_GPIO.h>
+#include <SEGGER_SYSVIEW.h>
+#include <Nucleo_F767ZI_Init.h>
+#include <stm32f7xx_hal.h>
+#include <DWTCycleCounter.h>
+#include <iLed.h>
+#include <pwmImplementation.h>
+
+/*********************************************
+ * Compares the cost of driving LED's and PWM channels through
+ * the runtime interfaces (struct of function pointers) against
+ * the compile-time bindings (LED_ON, PWM_SET_DUTY_CYCLE)
+ *
+ * Results (average CPU cycles per call) are printed to SystemView
+ * once per second and are also available in dispatchResults
+ *********************************************/
+
+#define STACK_SIZE 256
+#define NUM_ITERATIONS 1000
+
+void benchmarkTask( void* NotUsed );
+
+typedef struct
+{
+	uint32_t halWritePin;		//HAL_GPIO_WritePin called directly
+	uint32_t ledRuntime;		//GreenLed.On() / GreenLed.Off()
+	uint32_t ledStatic;			//LED_ON(GreenLed) / LED_OFF(GreenLed)
+	uint32_t pwmRuntime;		//RedPWM.SetDutyCycle()
+	uint32_t pwmStatic;			//PWM_SET_DUTY_CYCLE(RedPWM, ...)
+}DispatchResults;
+
+volatile DispatchResults dispatchResults;
+
+int main(void)
+{
+	HWInit();
+	PWMInit();
+	CycleCounterInit();
+	SEGGER_SYSVIEW_Conf();
+	HAL_NVIC_SetPriorityGrouping(NVIC_PRIORITYGROUP_4);	//ensure proper priority grouping for freeRTOS
+
+	assert_param(xTaskCreate(benchmarkTask, "benchmark", STACK_SIZE, NULL, tskIDLE_PRIORITY + 1, NULL) == pdPASS);
+
+	//start the scheduler - shouldn't return unless there's a problem
+	vTaskStartScheduler();
+
+	//if you've wound up here, there is likely an issue with overrunning the freeRTOS heap
+	while(1)
+	{
+	}
+}
+
+/**
+ * each measurement toggles the LED (or changes the duty cycle) NUM_ITERATIONS
+ * times with interrupts disabled and returns the average cycles per call
+ * (loop overhead included - it is the same for every measurement)
+ */
+static uint32_t measureHalWritePin( void )
+{
+	uint32_t start = CycleCount();
+	for(uint32_t i = 0; i < NUM_ITERATIONS; i++)
+	{
+		HAL_GPIO_WritePin(GPIOB, GPIO_PIN_0, GPIO_PIN_SET);
+		HAL_GPIO_WritePin(GPIOB, GPIO_PIN_0, GPIO_PIN_RESET);
+	}
+	return (CycleCount() - start) / (NUM_ITERATIONS * 2);
+}
+
+static uint32_t measureLedRuntime( const LED* Led )
+{
+	uint32_t start = CycleCount();
+	for(uint32_t i = 0; i < NUM_ITERATIONS; i++)
+	{
+		Led->On();
+		Led->Off();
+	}
+	return (CycleCount() - start) / (NUM_ITERATIONS * 2);
+}
+
+static uint32_t measureLedStatic( void )
+{
+	uint32_t start = CycleCount();
+	for(uint32_t i = 0; i < NUM_ITERATIONS; i++)
+	{
+		LED_ON(GreenLed);
+		LED_OFF(GreenLed);
+	}
+	return (CycleCount() - start) / (NUM_ITERATIONS * 2);
+}
+
+static uint32_t measurePwmRuntime( const iPWM* Pwm )
+{
+	uint32_t start = CycleCount();
+	for(uint32_t i = 0; i < NUM_ITERATIONS; i++)
+	{
+		Pwm->SetDutyCycle(i % 100);
+	}
+	return (CycleCount() - start) / NUM_ITERATIONS;
+}
+
+static uint32_t measurePwmStatic( void )
+{
+	uint32_t start = CycleCount();
+	for(uint32_t i = 0; i < NUM_ITERATIONS; i++)
+	{
+		PWM_SET_DUTY_CYCLE(RedPWM, i % 100);
+	}
+	return (CycleCount() - start) / NUM_ITERATIONS;
+}
+
+void benchmarkTask( void* NotUsed )
+{
+	while(1)
+	{
+		//interrupts are disabled so context switches and ISR's
+		//don't show up in the measurements
+		taskDISABLE_INTERRUPTS();
+		dispatchResults.halWritePin = measureHalWritePin();
+		dispatchResults.ledRuntime = measureLedRuntime(&GreenLed);
+		dispatchResults.ledStatic = measureLedStatic();
+		dispatchResults.pwmRuntime = measurePwmRuntime(&RedPWM);
+		dispatchResults.pwmStatic = measurePwmStatic();
+		taskENABLE_INTERRUPTS();
+
+		SEGGER_SYSVIEW_PrintfHost("LED cycles/call HAL:%u runtime:%u static:%u",
+									dispatchResults.halWritePin,
+									dispatchResults.ledRuntime,
+									dispatchResults.ledStatic);
+		SEGGER_SYSVIEW_PrintfHost("PWM cycles/call runtime:%u static:%u",
+									dispatchResults.pwmRuntime,
+									dispatchResults.pwmStatic);
+		vTaskDelay(1000);
+	}
+}
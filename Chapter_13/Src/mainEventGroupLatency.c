@@ -0,0 +1,211 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2019 Brian Amos
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <FreeRTOS.h>
+#include <task.h>
+#include <event_groups.h>
+#include <Nucleo_F767ZI_GPIO.h>
+#include <SEGGER_SYSVIEW.h>
+#include <SEGGER_RTT.h>
+#include <Nucleo_F767ZI_Init.h>
+#include <stm32f7xx_hal.h>
+#include <DWTCycleCounter.h>
+#include <WakeLatency.h>
+
+/*********************************************
+ * Compares ISR to task latency of the two ways an interrupt can set
+ * event group bits
+ *
+ * 	- xEventGroupSetBitsFromISR: the set is posted to the timer task, which
+ * 	  then unblocks the waiting task
+ * 	- xEventGroupSetBitsDirectFromISR: the waiting task is unblocked from
+ * 	  the ISR itself (requires configUSE_EVENT_GROUP_DIRECT_ISR, which is
+ * 	  defined for the eventGroupLatency build configuration)
+ *
+ * TIM7 interrupts at ISR_RATE_HZ and sets EVENT_BIT, eventWaiter
+ * measures the time from the start of the ISR until it is running.
+ *
+ * timerLoad runs at the same priority as the timer task, busy-waiting for
+ * LOAD_US out of every tick.  When bits are set through the timer task, the
+ * set has to wait for timerLoad's time slice to end, which is the
+ * latency (and jitter) the direct path removes.
+ *
+ * Each path runs for RUN_MS at a time, the accumulated results for both are
+ * printed to the RTT terminal (channel 0) after every pair of runs.
+ *********************************************/
+
+#define STACK_SIZE 256
+#define RUN_MS 2000
+#define ISR_RATE_HZ 1000
+#define LOAD_US 300
+#define EVENT_BIT (1 << 0)
+
+typedef enum
+{
+	SET_VIA_TIMER_TASK = 0,
+	SET_DIRECT
+}SetMode;
+
+void eventWaiter( void* NotUsed );
+void timerLoad( void* NotUsed );
+void reportTask( void* NotUsed );
+static void timerInit( void );
+
+static EventGroupHandle_t events;
+static volatile SetMode setMode = SET_VIA_TIMER_TASK;
+static volatile uint32_t postFailures = 0;
+static WakeLatencyPath daemonLatency = WAKE_LATENCY_PATH_INIT("event group via timer task");
+static WakeLatencyPath directLatency = WAKE_LATENCY_PATH_INIT("event group direct");
+
+int main(void)
+{
+	HWInit();
+	CycleCounterInit();
+	SEGGER_SYSVIEW_Conf();
+	HAL_NVIC_SetPriorityGrouping(NVIC_PRIORITYGROUP_4);	//ensure proper priority grouping for freeRTOS
+
+	events = xEventGroupCreate();
+	assert_param(events != NULL);
+
+	assert_param(xTaskCreate(eventWaiter, "waiter", STACK_SIZE, NULL, configMAX_PRIORITIES-1, NULL) == pdPASS);
+	assert_param(xTaskCreate(timerLoad, "timerLoad", STACK_SIZE, NULL, configTIMER_TASK_PRIORITY, NULL) == pdPASS);
+	assert_param(xTaskCreate(reportTask, "report", STACK_SIZE, NULL, tskIDLE_PRIORITY + 1, NULL) == pdPASS);
+
+	WakeLatencyRegister(&daemonLatency);
+	WakeLatencyRegister(&directLatency);
+	timerInit();
+
+	//start the scheduler - shouldn't return unless there's a problem
+	vTaskStartScheduler();
+
+	//if you've wound up here, there is likely an issue with overrunning the freeRTOS heap
+	while(1)
+	{
+	}
+}
+
+/**
+ * TIM7: basic timer, update interrupt at ISR_RATE_HZ
+ */
+static void timerInit( void )
+{
+	__HAL_RCC_TIM7_CLK_ENABLE();
+
+	//APB1 timers run at twice the APB1 clock
+	const uint32_t timerClockHz = HAL_RCC_GetPCLK1Freq() * 2;
+
+	TIM7->CR1 = 0;
+	TIM7->PSC = (timerClockHz / 1000000) - 1;		//1MHz count
+	TIM7->ARR = (1000000 / ISR_RATE_HZ) - 1;
+	TIM7->EGR = TIM_EGR_UG;
+	TIM7->SR = 0;
+	TIM7->DIER = TIM_DIER_UIE;
+
+	//the ISR uses FreeRTOS API's, so must be at or below the syscall priority
+	NVIC_SetPriority(TIM7_IRQn, configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY);
+	NVIC_EnableIRQ(TIM7_IRQn);
+	TIM7->CR1 |= TIM_CR1_CEN;
+}
+
+void TIM7_IRQHandler( void )
+{
+	const uint32_t entry = WakeLatencyIsrEntry();
+	BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+	SEGGER_SYSVIEW_RecordEnterISR();
+	TIM7->SR = 0;
+
+	if(setMode == SET_DIRECT)
+	{
+		xEventGroupSetBitsDirectFromISR(events, EVENT_BIT, &xHigherPriorityTaskWoken);
+		WakeLatencyWake(&directLatency, entry);
+	}
+	else
+	{
+		if(xEventGroupSetBitsFromISR(events, EVENT_BIT, &xHigherPriorityTaskWoken) == pdPASS)
+		{
+			WakeLatencyWake(&daemonLatency, entry);
+		}
+		else
+		{
+			//the timer command queue was full
+			postFailures++;
+		}
+	}
+
+	SEGGER_SYSVIEW_RecordExitISR();
+	portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
+
+/**
+ * wait for EVENT_BIT and record how long it took to get here
+ */
+void eventWaiter( void* NotUsed )
+{
+	while(1)
+	{
+		xEventGroupWaitBits(events, EVENT_BIT, pdTRUE, pdTRUE, portMAX_DELAY);
+
+		//only one of the paths will have a pending wake-up
+		WakeLatencyResumed(&directLatency);
+		WakeLatencyResumed(&daemonLatency);
+	}
+}
+
+static void busyWaitUs( uint32_t Us )
+{
+	const uint32_t start = CycleCount();
+	const uint32_t cycles = Us * (SystemCoreClock / 1000000);
+	while(CycleCount() - start < cycles);
+}
+
+/**
+ * compete with the timer task for the CPU
+ */
+void timerLoad( void* NotUsed )
+{
+	while(1)
+	{
+		busyWaitUs(LOAD_US);
+		vTaskDelay(1);
+	}
+}
+
+void reportTask( void* NotUsed )
+{
+	static char report[512];
+
+	while(1)
+	{
+		setMode = SET_VIA_TIMER_TASK;
+		vTaskDelay(RUN_MS / portTICK_PERIOD_MS);
+		setMode = SET_DIRECT;
+		vTaskDelay(RUN_MS / portTICK_PERIOD_MS);
+
+		WakeLatencyReport(report, sizeof(report));
+		SEGGER_RTT_WriteString(0, report);
+		SEGGER_RTT_printf(0, "timer task posts failed: %u\n\n", postFailures);
+	}
+}
@@ -0,0 +1,252 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2019 Brian Amos
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <FreeRTOS.h>
+#include <task.h>
+#include <queue.h>
+#include <Nucleo_F767ZI_GPIO.h>
+#include <SEGGER_SYSVIEW.h>
+#include <Nucleo_F767ZI_Init.h>
+#include <stm32f7xx_hal.h>
+#include "VirtualCommDriverMultiTask.h"
+#include <FlightRecorder.h>
+
+/*********************************************
+ * Post-mortem flight recorder demo
+ *
+ * Task switches, ISR's, queue operations and markers are recorded into
+ * a RAM buffer that survives a reset (see FlightRecorder.h).
+ *
+ * Pressing the user button makes a task spin on a condition that never
+ * becomes true (like waiting for a driver that will never finish).
+ * The watchdog task is starved, the independent watchdog resets the
+ * MCU and the recording leading up to the hang is kept.
+ *
+ * Use BSP/FlightRecorderTools/flightRecorder.py to read the recording
+ * over the USB virtual comm port and convert it into a trace that can
+ * be opened in Perfetto (ui.perfetto.dev) or chrome://tracing
+ *
+ * Commands (single characters sent over the virtual comm port):
+ * 'd'	dump the recording (recording is paused during the dump)
+ * 'c'	clear the recording and start over
+ *********************************************/
+
+#define STACK_SIZE 256
+
+//markers to make the converted trace easier to read
+#define MARKER_BATCH_SENT		1
+#define MARKER_BATCH_RECEIVED	2
+#define MARKER_STALL			3
+
+//the dump is preceded by this, followed by the number of bytes in the dump
+static const uint8_t dumpPreamble[] = "FRDUMP";
+
+void producerTask( void* NotUsed );
+void consumerTask( void* NotUsed );
+void stallTask( void* NotUsed );
+void watchdogTask( void* NotUsed );
+void commandTask( void* NotUsed );
+
+static void watchdogInit( void );
+static void watchdogKick( void );
+
+static QueueHandle_t valueQueue = NULL;
+
+int main(void)
+{
+	HWInit();
+	VirtualCommInit(256, configMAX_PRIORITIES-2);
+	SEGGER_SYSVIEW_Conf();
+	HAL_NVIC_SetPriorityGrouping(NVIC_PRIORITYGROUP_4);	//ensure proper priority grouping for freeRTOS
+
+	//a recording from before a reset is kept until it has been read out
+	if(FlightRecorderInit())
+	{
+		RedLed.On();
+	}
+	watchdogInit();
+
+	valueQueue = xQueueCreate(4, sizeof(uint32_t));
+	assert_param(valueQueue != NULL);
+
+	assert_param(xTaskCreate(producerTask, "producer", STACK_SIZE, NULL, tskIDLE_PRIORITY + 2, NULL) == pdPASS);
+	assert_param(xTaskCreate(consumerTask, "consumer", STACK_SIZE, NULL, tskIDLE_PRIORITY + 1, NULL) == pdPASS);
+	assert_param(xTaskCreate(stallTask, "stall", STACK_SIZE, NULL, tskIDLE_PRIORITY + 3, NULL) == pdPASS);
+	assert_param(xTaskCreate(watchdogTask, "watchdog", STACK_SIZE, NULL, tskIDLE_PRIORITY + 1, NULL) == pdPASS);
+	assert_param(xTaskCreate(commandTask, "command", STACK_SIZE, NULL, configMAX_PRIORITIES - 3, NULL) == pdPASS);
+
+	//start the scheduler - shouldn't return unless there's a problem
+	vTaskStartScheduler();
+
+	//if you've wound up here, there is likely an issue with overrunning the freeRTOS heap
+	while(1)
+	{
+	}
+}
+
+/**
+ * sends bursts of values - the queue fills up part way through
+ * each burst, so the producer blocks until the consumer catches up
+ */
+void producerTask( void* NotUsed )
+{
+	uint32_t value = 0;
+
+	while(1)
+	{
+		for(uint32_t i = 0; i < 8; i++)
+		{
+			assert_param(xQueueSend(valueQueue, &value, portMAX_DELAY) == pdPASS);
+			value++;
+		}
+		FlightRecorderMarker(MARKER_BATCH_SENT, value);
+		vTaskDelay(20);
+	}
+}
+
+void consumerTask( void* NotUsed )
+{
+	uint32_t value;
+
+	while(1)
+	{
+		if(xQueueReceive(valueQueue, &value, portMAX_DELAY) == pdPASS)
+		{
+			if((value % 8) == 7)
+			{
+				FlightRecorderMarker(MARKER_BATCH_RECEIVED, value);
+				BlueLed.On();
+			}
+			else
+			{
+				BlueLed.Off();
+			}
+		}
+	}
+}
+
+/**
+ * Once the button is pressed, wait for something that will never happen
+ * without ever blocking - just like polling a flag that is never set
+ * by a driver:
+ * 		while(numWritten != RX_BUFF_LEN);
+ */
+void stallTask( void* NotUsed )
+{
+	volatile uint32_t numWritten = 0;
+	const uint32_t expected = 64;
+
+	while(!ReadPushButton())
+	{
+		vTaskDelay(50);
+	}
+
+	FlightRecorderMarker(MARKER_STALL, numWritten);
+	while(numWritten != expected);
+
+	//never reached
+	vTaskDelete(NULL);
+}
+
+/**
+ * the watchdog is only kicked by a low priority task, so it will
+ * reset the MCU if any higher priority task hogs the CPU
+ */
+void watchdogTask( void* NotUsed )
+{
+	while(1)
+	{
+		watchdogKick();
+		GreenLed.On();
+		vTaskDelay(250);
+		GreenLed.Off();
+		vTaskDelay(250);
+	}
+}
+
+/**
+ * handles commands from flightRecorder.py
+ */
+void commandTask( void* NotUsed )
+{
+	uint8_t cmd;
+
+	while(1)
+	{
+		//if more than one task was to be receiving, vcom_rxStream would require
+		//a mutex to ensure only 1 task was reading from it at a time
+		if(xStreamBufferReceive(*GetUsbRxStreamBuff(), &cmd, 1, portMAX_DELAY) != 1)
+		{
+			continue;
+		}
+
+		if(cmd == 'd')
+		{
+			//nothing is recorded while the dump is being sent, so
+			//the recording doesn't change underneath us
+			const uint8_t* data = (const uint8_t*) FlightRecorderPause();
+			const uint32_t len = sizeof(FlightRecorderData);
+			uint32_t sent = 0;
+
+			TransmitUsbData(dumpPreamble, sizeof(dumpPreamble) - 1, portMAX_DELAY);
+			TransmitUsbData((const uint8_t*)&len, sizeof(len), portMAX_DELAY);
+			while(sent < len)
+			{
+				uint32_t chunk = len - sent;
+				if(chunk > 1024)
+				{
+					chunk = 1024;
+				}
+				sent += TransmitUsbData(data + sent, chunk, 100);
+			}
+			FlightRecorderResume();
+		}
+		else if(cmd == 'c')
+		{
+			FlightRecorderClear();
+			RedLed.Off();
+		}
+	}
+}
+
+/**
+ * start the independent watchdog with a ~2 second timeout
+ * (LSI ~32kHz / 64 = 500Hz, 1000 counts)
+ * once started, it can only be stopped by a reset
+ */
+static void watchdogInit( void )
+{
+	IWDG->KR = 0xCCCC;				//start
+	IWDG->KR = 0x5555;				//unlock PR and RLR
+	IWDG->PR = IWDG_PR_PR_2;		// /64
+	IWDG->RLR = 1000;
+	while(IWDG->SR != 0);			//wait for the new values to be applied
+	IWDG->KR = 0xAAAA;
+}
+
+static void watchdogKick( void )
+{
+	IWDG->KR = 0xAAAA;
+}
@@ -0,0 +1,360 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2019 Brian Amos
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <FreeRTOS.h>
+#include <task.h>
+#include <Nucleo_F767ZI_GPIO.h>
+#include <SEGGER_SYSVIEW.h>
+#include <SEGGER_RTT.h>
+#include <Nucleo_F767ZI_Init.h>
+#include <stm32f7xx_hal.h>
+#include <DWTCycleCounter.h>
+#include <UartQuickDirtyInit.h>
+#include <LatencyHistogram.h>
+#include "VirtualCommDriverMultiTask.h"
+#include <string.h>
+
+/*********************************************
+ * Measures interrupt latency with hardware timestamps
+ *
+ * TIM2 generates the "external" event: every update event is sent out on
+ * TRGO.  TIM5 captures TRGO (internal trigger ITR0, input capture on TRC),
+ * so the capture register holds the exact time of the edge.  The TIM5
+ * capture ISR reads the counter as its first action - the difference is the
+ * time from the edge to the first instruction of the ISR.  The period of
+ * TIM2 is varied randomly so edges don't line up with the RTOS tick.
+ *
+ * Both timers run from the same clock (2x PCLK1 = 108MHz, ~9.3nS per count).
+ *
+ * Each configuration runs for RUN_MS while background load runs:
+ * 	- USB: a task streaming data out of the virtual comm port
+ * 	- UART DMA: USART2 transmitting continuously at 3Mbaud from a circular
+ * 	  DMA stream (bus traffic only, no CPU or interrupts)
+ * 	- heap: a task allocating and freeing random sized blocks
+ * 	- critical sections: a task doing the same work either inside
+ * 	  taskENTER_CRITICAL/taskEXIT_CRITICAL or outside of them
+ *
+ * and the TIM5 IRQ set above or at configMAX_SYSCALL_INTERRUPT_PRIORITY.
+ * Only interrupts at or below configMAX_SYSCALL_INTERRUPT_PRIORITY are
+ * masked by FreeRTOS critical sections, so the critical section heavy load
+ * should only show up in the "masked" results.
+ *
+ * Results are printed to the RTT terminal (channel 0) after each run and
+ * are also available in latencyResults.
+ *
+ * NOTE: the capture ISR isn't instrumented for SystemView, since that
+ * would add to the time being measured
+ *********************************************/
+
+#define STACK_SIZE 256
+#define RUN_MS 5000
+#define EDGE_PERIOD_MIN 5000			//timer counts (~46uS)
+#define EDGE_PERIOD_RANGE 0x1FFF		//random extra counts (up to ~76uS)
+#define CRITICAL_SECTION_US 10
+#define UART_DMA_BAUD 3000000
+
+typedef enum
+{
+	PRIO_ABOVE_SYSCALL = 0,			//never masked by FreeRTOS
+	PRIO_AT_SYSCALL					//masked by critical sections
+}IsrPriority;
+
+typedef struct
+{
+	const char* name;
+	IsrPriority priority;
+	uint8_t criticalSections;
+}LatencyConfig;
+
+typedef struct
+{
+	uint32_t samples;
+	uint32_t overruns;				//edges missed because the previous one wasn't serviced
+	uint32_t minNs;
+	uint32_t p50Ns;
+	uint32_t p99Ns;
+	uint32_t p999Ns;
+	uint32_t maxNs;
+}LatencyResult;
+
+static const LatencyConfig configs[] =
+{
+	{ "above syscall, no critical sections", PRIO_ABOVE_SYSCALL, 0 },
+	{ "above syscall, critical sections   ", PRIO_ABOVE_SYSCALL, 1 },
+	{ "masked,        no critical sections", PRIO_AT_SYSCALL, 0 },
+	{ "masked,        critical sections   ", PRIO_AT_SYSCALL, 1 },
+};
+#define NUM_CONFIGS (sizeof(configs)/sizeof(configs[0]))
+
+volatile LatencyResult latencyResults[NUM_CONFIGS];
+
+static LatencyHistogram histogram;
+static volatile uint32_t overruns = 0;
+static volatile uint8_t useCriticalSections = 0;
+static uint32_t timerClockHz;
+
+static DMA_HandleTypeDef uartTxDma;
+static uint8_t uartPattern[256];
+
+void benchmarkTask( void* NotUsed );
+void criticalSectionLoad( void* NotUsed );
+void usbLoad( void* NotUsed );
+void heapChurn( void* NotUsed );
+static void timersInit( void );
+static void uartDmaLoadInit( void );
+
+int main(void)
+{
+	HWInit();
+	VirtualCommInit(256, configMAX_PRIORITIES-2);
+	CycleCounterInit();
+	SEGGER_SYSVIEW_Conf();
+	HAL_NVIC_SetPriorityGrouping(NVIC_PRIORITYGROUP_4);	//ensure proper priority grouping for freeRTOS
+
+	timersInit();
+	uartDmaLoadInit();
+
+	assert_param(xTaskCreate(benchmarkTask, "benchmark", STACK_SIZE, NULL, configMAX_PRIORITIES-1, NULL) == pdPASS);
+	assert_param(xTaskCreate(usbLoad, "usbLoad", STACK_SIZE, NULL, tskIDLE_PRIORITY + 2, NULL) == pdPASS);
+	assert_param(xTaskCreate(heapChurn, "heapChurn", STACK_SIZE, NULL, tskIDLE_PRIORITY + 2, NULL) == pdPASS);
+	assert_param(xTaskCreate(criticalSectionLoad, "csLoad", STACK_SIZE, NULL, tskIDLE_PRIORITY + 1, NULL) == pdPASS);
+
+	//start the scheduler - shouldn't return unless there's a problem
+	vTaskStartScheduler();
+
+	//if you've wound up here, there is likely an issue with overrunning the freeRTOS heap
+	while(1)
+	{
+	}
+}
+
+/**
+ * TIM2: edge generator, free running up counter, TRGO on every update
+ * TIM5: 32 bit free running counter, channel 1 captures TIM2 TRGO
+ */
+static void timersInit( void )
+{
+	__HAL_RCC_TIM2_CLK_ENABLE();
+	__HAL_RCC_TIM5_CLK_ENABLE();
+
+	//APB1 timers run at twice the APB1 clock
+	timerClockHz = HAL_RCC_GetPCLK1Freq() * 2;
+
+	TIM2->CR1 = TIM_CR1_ARPE;				//period changes apply at the next update
+	TIM2->PSC = 0;
+	TIM2->ARR = EDGE_PERIOD_MIN;
+	TIM2->CR2 = TIM_CR2_MMS_1;				//MMS = 010: TRGO on update
+
+	TIM5->CR1 = 0;
+	TIM5->PSC = 0;
+	TIM5->ARR = 0xFFFFFFFF;
+	TIM5->SMCR = 0;							//TS = 000: ITR0 (TIM2 TRGO), slave mode disabled
+	TIM5->CCMR1 = TIM_CCMR1_CC1S;			//CC1S = 11: IC1 mapped on TRC
+	TIM5->CCER = TIM_CCER_CC1E;				//capture on rising edge
+	TIM5->DIER = TIM_DIER_CC1IE;
+	TIM5->EGR = TIM_EGR_UG;
+	TIM5->SR = 0;
+
+	TIM5->CR1 |= TIM_CR1_CEN;
+	TIM2->CR1 |= TIM_CR1_CEN;
+}
+
+/**
+ * USART2 TX fed by DMA1 Stream6 Channel4 in circular mode, so the DMA
+ * keeps competing for the bus without any CPU involvement
+ */
+static void uartDmaLoadInit( void )
+{
+	for(uint32_t i = 0; i < sizeof(uartPattern); i++)
+	{
+		uartPattern[i] = i;
+	}
+
+	__HAL_RCC_DMA1_CLK_ENABLE();
+	memset(&uartTxDma, 0, sizeof(DMA_HandleTypeDef));
+	uartTxDma.Instance = DMA1_Stream6;
+	uartTxDma.Init.Channel = DMA_CHANNEL_4;
+	uartTxDma.Init.Direction = DMA_MEMORY_TO_PERIPH;
+	uartTxDma.Init.FIFOMode = DMA_FIFOMODE_DISABLE;
+	uartTxDma.Init.MemBurst = DMA_MBURST_SINGLE;
+	uartTxDma.Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
+	uartTxDma.Init.MemInc = DMA_MINC_ENABLE;
+	uartTxDma.Init.Mode = DMA_CIRCULAR;
+	uartTxDma.Init.PeriphBurst = DMA_PBURST_SINGLE;
+	uartTxDma.Init.PeriphInc = DMA_PINC_DISABLE;
+	uartTxDma.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+	uartTxDma.Init.Priority = DMA_PRIORITY_HIGH;
+	assert_param(HAL_DMA_Init(&uartTxDma) == HAL_OK);
+
+	STM_UartInit(USART2, UART_DMA_BAUD, &uartTxDma, NULL);
+	assert_param(HAL_DMA_Start(&uartTxDma, (uint32_t)uartPattern, (uint32_t)&USART2->TDR, sizeof(uartPattern)) == HAL_OK);
+	USART2->CR3 |= USART_CR3_DMAT;
+}
+
+/**
+ * capture ISR - the counter is read before anything else so the
+ * measurement covers only the hardware (stacking, tail-chaining) and
+ * whatever was masking the interrupt
+ */
+void TIM5_IRQHandler( void )
+{
+	const uint32_t now = TIM5->CNT;
+	const uint32_t sr = TIM5->SR;
+	const uint32_t edge = TIM5->CCR1;		//reading CCR1 clears CC1IF
+	static uint32_t rand = 0x12345678;
+
+	if(sr & TIM_SR_CC1OF)
+	{
+		overruns++;
+		TIM5->SR = (uint32_t)~TIM_SR_CC1OF;
+	}
+	LatencyHistogramAdd(&histogram, now - edge);
+
+	//xorshift32 - vary the time to the next edge
+	rand ^= rand << 13;
+	rand ^= rand >> 17;
+	rand ^= rand << 5;
+	TIM2->ARR = EDGE_PERIOD_MIN + (rand & EDGE_PERIOD_RANGE);
+}
+
+static void busyWaitUs( uint32_t Us )
+{
+	const uint32_t start = CycleCount();
+	const uint32_t cycles = Us * (SystemCoreClock / 1000000);
+	while(CycleCount() - start < cycles);
+}
+
+/**
+ * spend half of the time doing "work" - inside a critical section
+ * when useCriticalSections is set
+ */
+void criticalSectionLoad( void* NotUsed )
+{
+	while(1)
+	{
+		if(useCriticalSections)
+		{
+			taskENTER_CRITICAL();
+			busyWaitUs(CRITICAL_SECTION_US);
+			taskEXIT_CRITICAL();
+		}
+		else
+		{
+			busyWaitUs(CRITICAL_SECTION_US);
+		}
+		busyWaitUs(CRITICAL_SECTION_US);
+	}
+}
+
+/**
+ * keep the USB stack and vcom_txStream busy
+ */
+void usbLoad( void* NotUsed )
+{
+	static uint8_t usbData[64];
+	memset(usbData, 'U', sizeof(usbData));
+	usbData[sizeof(usbData) - 1] = '\n';
+
+	while(1)
+	{
+		//returns after the timeout if nothing is reading from the port
+		TransmitUsbData(usbData, sizeof(usbData), 10);
+		vTaskDelay(1);
+	}
+}
+
+/**
+ * allocate and free blocks of random sizes
+ */
+void heapChurn( void* NotUsed )
+{
+	void* blocks[4] = {NULL};
+	uint32_t i = 0;
+
+	while(1)
+	{
+		if(blocks[i] != NULL)
+		{
+			vPortFree(blocks[i]);
+		}
+		blocks[i] = pvPortMalloc(StmRand(16, 512));
+		i = (i + 1) % 4;
+		vTaskDelay(1);
+	}
+}
+
+static uint32_t countsToNs( uint32_t Counts )
+{
+	return (uint32_t)(((uint64_t)Counts * 1000000000) / timerClockHz);
+}
+
+static void runConfig( const LatencyConfig* Config, volatile LatencyResult* Result )
+{
+	const uint32_t priority = (Config->priority == PRIO_ABOVE_SYSCALL) ?
+								configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY - 1 :
+								configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY;
+
+	NVIC_DisableIRQ(TIM5_IRQn);
+	useCriticalSections = Config->criticalSections;
+	LatencyHistogramReset(&histogram, 0);		//1 timer count per bin
+	overruns = 0;
+	NVIC_SetPriority(TIM5_IRQn, priority);
+	TIM5->SR = 0;
+	NVIC_EnableIRQ(TIM5_IRQn);
+
+	vTaskDelay(RUN_MS / portTICK_PERIOD_MS);
+
+	NVIC_DisableIRQ(TIM5_IRQn);
+	Result->samples = histogram.count;
+	Result->overruns = overruns;
+	Result->minNs = countsToNs(histogram.min);
+	Result->p50Ns = countsToNs(LatencyHistogramPercentile(&histogram, 500));
+	Result->p99Ns = countsToNs(LatencyHistogramPercentile(&histogram, 990));
+	Result->p999Ns = countsToNs(LatencyHistogramPercentile(&histogram, 999));
+	Result->maxNs = countsToNs(histogram.max);
+}
+
+void benchmarkTask( void* NotUsed )
+{
+	while(1)
+	{
+		for(uint32_t i = 0; i < NUM_CONFIGS; i++)
+		{
+			runConfig(&configs[i], &latencyResults[i]);
+			SEGGER_RTT_printf(0, "%s: n=%u min %5u p50 %5u p99 %5u p99.9 %5u max %5u nS "
+								"jitter %5u nS overruns %u\n",
+								configs[i].name,
+								latencyResults[i].samples,
+								latencyResults[i].minNs,
+								latencyResults[i].p50Ns,
+								latencyResults[i].p99Ns,
+								latencyResults[i].p999Ns,
+								latencyResults[i].maxNs,
+								latencyResults[i].maxNs - latencyResults[i].minNs,
+								latencyResults[i].overruns);
+		}
+		SEGGER_RTT_WriteString(0, "\n");
+	}
+}
@@ -0,0 +1,211 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2019 Brian Amos
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <FreeRTOS.h>
+#include <task.h>
+#include <Nucleo_F767ZI_GPIO.h>
+#include <SEGGER_SYSVIEW.h>
+#include <SEGGER_RTT.h>
+#include <Nucleo_F767ZI_Init.h>
+#include <stm32f7xx_hal.h>
+#include <DWTCycleCounter.h>
+#include <LatencyHistogram.h>
+#include <WakeLatency.h>
+#include <RadarHandoff.h>
+
+/*********************************************
+ * A timing critical capture ISR running above the RTOS
+ *
+ * TIM2 generates an edge (TRGO) every 100uS, which TIM5 captures
+ * (same setup as interruptLatency).  The TIM5 capture ISR runs at
+ * RADAR_MAX_ISR_PRIORITY, so it is never masked by FreeRTOS.  It
+ * measures its own latency from the capture register and passes
+ * the result to captureTask through a RadarChannel.
+ *
+ * A load task spends most of its time in 50uS critical sections.
+ * The capture ISR latency is unaffected, only the handoff to
+ * captureTask (which needs the kernel) is delayed - and no captures
+ * are lost as long as the ring doesn't fill up.
+ *
+ * Every 2 seconds the capture ISR latency (nS) and the edge to task
+ * latency are printed to the RTT terminal.
+ *********************************************/
+
+#define STACK_SIZE 256
+#define EDGE_RATE_HZ 10000
+#define CRITICAL_SECTION_US 50
+#define RING_LEN 64					//power of 2
+#define REPORT_MS 2000
+
+void captureTask( void* NotUsed );
+void criticalSectionLoad( void* NotUsed );
+static void timersInit( void );
+
+static TaskHandle_t captureTaskHandle;
+static RadarChannel captureChannel;
+static uint32_t captureRing[RING_LEN];
+static WakeLatencyPath handoffLatency = WAKE_LATENCY_PATH_INIT("edge to task");
+static LatencyHistogram isrLatency;
+static uint32_t timerClockHz;
+
+int main(void)
+{
+	HWInit();
+	CycleCounterInit();
+	SEGGER_SYSVIEW_Conf();
+	HAL_NVIC_SetPriorityGrouping(NVIC_PRIORITYGROUP_4);	//ensure proper priority grouping for freeRTOS
+
+	assert_param(xTaskCreate(captureTask, "capture", STACK_SIZE, NULL, configMAX_PRIORITIES-1, &captureTaskHandle) == pdPASS);
+	assert_param(xTaskCreate(criticalSectionLoad, "csLoad", STACK_SIZE, NULL, tskIDLE_PRIORITY + 1, NULL) == pdPASS);
+
+	RadarHandoffInit(configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY);
+	RadarChannelInit(&captureChannel, captureRing, RING_LEN, captureTaskHandle);
+	WakeLatencyRegister(&handoffLatency);
+	timersInit();
+
+	//start the scheduler - shouldn't return unless there's a problem
+	vTaskStartScheduler();
+
+	//if you've wound up here, there is likely an issue with overrunning the freeRTOS heap
+	while(1)
+	{
+	}
+}
+
+/**
+ * TIM2: edge generator, TRGO on every update
+ * TIM5: 32 bit free running counter, channel 1 captures TIM2 TRGO
+ */
+static void timersInit( void )
+{
+	__HAL_RCC_TIM2_CLK_ENABLE();
+	__HAL_RCC_TIM5_CLK_ENABLE();
+
+	//APB1 timers run at twice the APB1 clock
+	timerClockHz = HAL_RCC_GetPCLK1Freq() * 2;
+
+	TIM2->CR1 = 0;
+	TIM2->PSC = 0;
+	TIM2->ARR = timerClockHz / EDGE_RATE_HZ - 1;
+	TIM2->CR2 = TIM_CR2_MMS_1;				//MMS = 010: TRGO on update
+
+	TIM5->CR1 = 0;
+	TIM5->PSC = 0;
+	TIM5->ARR = 0xFFFFFFFF;
+	TIM5->SMCR = 0;							//TS = 000: ITR0 (TIM2 TRGO)
+	TIM5->CCMR1 = TIM_CCMR1_CC1S;			//CC1S = 11: IC1 mapped on TRC
+	TIM5->CCER = TIM_CCER_CC1E;
+	TIM5->DIER = TIM_DIER_CC1IE;
+	TIM5->EGR = TIM_EGR_UG;
+	TIM5->SR = 0;
+
+	//above configMAX_SYSCALL_INTERRUPT_PRIORITY - no FreeRTOS calls allowed
+	NVIC_SetPriority(TIM5_IRQn, RADAR_MAX_ISR_PRIORITY);
+	NVIC_EnableIRQ(TIM5_IRQn);
+
+	TIM5->CR1 |= TIM_CR1_CEN;
+	TIM2->CR1 |= TIM_CR1_CEN;
+}
+
+/**
+ * the timing critical ISR - never masked by the kernel
+ */
+void TIM5_IRQHandler( void )
+{
+	const uint32_t now = TIM5->CNT;
+	const uint32_t edge = TIM5->CCR1;		//reading CCR1 clears CC1IF
+	const uint32_t entry = WakeLatencyIsrEntry();
+
+	RadarIsrPut(&captureChannel, now - edge);
+	WakeLatencyWake(&handoffLatency, entry);
+	RadarIsrSignal();
+}
+
+static uint32_t countsToNs( uint32_t Counts )
+{
+	return (uint32_t)(((uint64_t)Counts * 1000000000) / timerClockHz);
+}
+
+/**
+ * receives the captures and periodically reports on them
+ */
+void captureTask( void* NotUsed )
+{
+	static char report[128];
+	uint32_t captures[RING_LEN];
+	TickType_t lastReport = xTaskGetTickCount();
+
+	LatencyHistogramReset(&isrLatency, 0);
+
+	while(1)
+	{
+		uint32_t numCaptures = RadarChannelRead(&captureChannel, captures, RING_LEN, 10);
+		if(numCaptures > 0)
+		{
+			WakeLatencyResumed(&handoffLatency);
+		}
+		for(uint32_t i = 0; i < numCaptures; i++)
+		{
+			LatencyHistogramAdd(&isrLatency, captures[i]);
+		}
+
+		if(xTaskGetTickCount() - lastReport >= REPORT_MS / portTICK_PERIOD_MS)
+		{
+			lastReport = xTaskGetTickCount();
+			SEGGER_RTT_printf(0, "capture ISR: n=%u min %u p99 %u max %u nS dropped %u\n",
+								isrLatency.count,
+								countsToNs(isrLatency.min),
+								countsToNs(LatencyHistogramPercentile(&isrLatency, 990)),
+								countsToNs(isrLatency.max),
+								captureChannel.dropped);
+			WakeLatencyReport(report, sizeof(report));
+			SEGGER_RTT_WriteString(0, report);
+
+			LatencyHistogramReset(&isrLatency, 0);
+			WakeLatencyReset(&handoffLatency);
+		}
+	}
+}
+
+static void busyWaitUs( uint32_t Us )
+{
+	const uint32_t start = CycleCount();
+	const uint32_t cycles = Us * (SystemCoreClock / 1000000);
+	while(CycleCount() - start < cycles);
+}
+
+/**
+ * spends most of its time with kernel interrupts masked
+ */
+void criticalSectionLoad( void* NotUsed )
+{
+	while(1)
+	{
+		taskENTER_CRITICAL();
+		busyWaitUs(CRITICAL_SECTION_US);
+		taskEXIT_CRITICAL();
+		busyWaitUs(CRITICAL_SECTION_US / 5);
+	}
+}
@@ -0,0 +1,180 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2019 Brian Amos
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <FreeRTOS.h>
+#include <task.h>
+#include <Nucleo_F767ZI_GPIO.h>
+#include <SEGGER_SYSVIEW.h>
+#include <Nucleo_F767ZI_Init.h>
+#include <stm32f7xx_hal.h>
+#include <DWTCycleCounter.h>
+#include <RttFast.h>
+
+/*********************************************
+ * Compares RTT up-channel writes through SEGGER_RTT_Write
+ * (interrupts masked by SEGGER_RTT_LOCK for the whole copy) against
+ * the lock-free single writer RttFastWrite.
+ *
+ * This configuration builds RTT with SEGGER_RTT_HIGH_THROUGHPUT=1
+ * (word copies, larger aligned buffers) and SEGGER_RTT_LOCK_PROFILE=1
+ * (time spent with interrupts masked is measured for every lock).
+ *
+ * The benchmark empties its channels itself after every write, as an
+ * infinitely fast host would, so only the target side cost is measured.
+ * Results are printed to the RTT terminal (channel 0) once per second
+ * and are also available in rttResults.
+ *********************************************/
+
+#define STACK_SIZE 256
+#define NUM_WRITES 256
+#define LOCKED_CHANNEL 3
+#define LOCK_FREE_CHANNEL 4
+#define CHANNEL_SIZE 8192
+
+typedef struct
+{
+	uint32_t writeSize;
+	uint32_t lockedCycles;			//average cycles per SEGGER_RTT_Write
+	uint32_t lockedMaskedCycles;	//average cycles interrupts were masked per write
+	uint32_t lockedMaxMaskedCycles;	//worst case cycles interrupts were masked
+	uint32_t lockFreeCycles;		//average cycles per RttFastWrite (never masks interrupts)
+}RttResult;
+
+static const uint32_t writeSizes[] = {4, 16, 64, 256, 1024};
+#define NUM_SIZES (sizeof(writeSizes)/sizeof(writeSizes[0]))
+
+volatile RttResult rttResults[NUM_SIZES];
+
+RTT_FAST_BUFFER(lockedBuff, CHANNEL_SIZE);
+RTT_FAST_BUFFER(lockFreeBuff, CHANNEL_SIZE);
+static uint8_t sampleData[1024];
+
+void benchmarkTask( void* NotUsed );
+
+int main(void)
+{
+	HWInit();
+	CycleCounterInit();
+	SEGGER_SYSVIEW_Conf();
+	HAL_NVIC_SetPriorityGrouping(NVIC_PRIORITYGROUP_4);	//ensure proper priority grouping for freeRTOS
+
+	RttFastConfig(LOCKED_CHANNEL, "locked", lockedBuff, sizeof(lockedBuff));
+	RttFastConfig(LOCK_FREE_CHANNEL, "lockFree", lockFreeBuff, sizeof(lockFreeBuff));
+
+	for(uint32_t i = 0; i < sizeof(sampleData); i++)
+	{
+		sampleData[i] = i;
+	}
+
+	assert_param(xTaskCreate(benchmarkTask, "benchmark", STACK_SIZE, NULL, tskIDLE_PRIORITY + 1, NULL) == pdPASS);
+
+	//start the scheduler - shouldn't return unless there's a problem
+	vTaskStartScheduler();
+
+	//if you've wound up here, there is likely an issue with overrunning the freeRTOS heap
+	while(1)
+	{
+	}
+}
+
+/**
+ * stand in for the host - mark everything written as read
+ */
+static void drainChannel( unsigned Channel )
+{
+	_SEGGER_RTT.aUp[Channel].RdOff = _SEGGER_RTT.aUp[Channel].WrOff;
+}
+
+static void measureLocked( volatile RttResult* Result, uint32_t Size )
+{
+	uint32_t cycles = 0;
+
+	RttLockProfile.NumLocks = 0;
+	RttLockProfile.TotalCycles = 0;
+	RttLockProfile.MaxCycles = 0;
+
+	for(uint32_t i = 0; i < NUM_WRITES; i++)
+	{
+		uint32_t start = CycleCount();
+		SEGGER_RTT_Write(LOCKED_CHANNEL, sampleData, Size);
+		cycles += CycleCount() - start;
+		drainChannel(LOCKED_CHANNEL);
+	}
+
+	Result->lockedCycles = cycles / NUM_WRITES;
+	Result->lockedMaskedCycles = RttLockProfile.TotalCycles / NUM_WRITES;
+	Result->lockedMaxMaskedCycles = RttLockProfile.MaxCycles;
+}
+
+static void measureLockFree( volatile RttResult* Result, uint32_t Size )
+{
+	uint32_t cycles = 0;
+
+	for(uint32_t i = 0; i < NUM_WRITES; i++)
+	{
+		uint32_t start = CycleCount();
+		RttFastWrite(LOCK_FREE_CHANNEL, sampleData, Size);
+		cycles += CycleCount() - start;
+		drainChannel(LOCK_FREE_CHANNEL);
+	}
+
+	Result->lockFreeCycles = cycles / NUM_WRITES;
+}
+
+static uint32_t bytesPerSecond( uint32_t Size, uint32_t Cycles )
+{
+	return (uint32_t)(((uint64_t)Size * SystemCoreClock) / (Cycles ? Cycles : 1));
+}
+
+void benchmarkTask( void* NotUsed )
+{
+	while(1)
+	{
+		for(uint32_t i = 0; i < NUM_SIZES; i++)
+		{
+			rttResults[i].writeSize = writeSizes[i];
+
+			//nothing else may write RTT (or take the lock) during a measurement,
+			//which also keeps ISR's and context switches out of the numbers
+			taskDISABLE_INTERRUPTS();
+			measureLocked(&rttResults[i], writeSizes[i]);
+			measureLockFree(&rttResults[i], writeSizes[i]);
+			taskENABLE_INTERRUPTS();
+		}
+
+		for(uint32_t i = 0; i < NUM_SIZES; i++)
+		{
+			SEGGER_RTT_printf(0, "%4u bytes: locked %5u cycles (%9u B/s) masked avg %5u max %5u | lock-free %5u cycles (%9u B/s) masked 0\n",
+								rttResults[i].writeSize,
+								rttResults[i].lockedCycles,
+								bytesPerSecond(rttResults[i].writeSize, rttResults[i].lockedCycles),
+								rttResults[i].lockedMaskedCycles,
+								rttResults[i].lockedMaxMaskedCycles,
+								rttResults[i].lockFreeCycles,
+								bytesPerSecond(rttResults[i].writeSize, rttResults[i].lockFreeCycles));
+		}
+		vTaskDelay(1000);
+	}
+}
@@ -0,0 +1,122 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2019 Brian Amos
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <FreeRTOS.h>
+#include <task.h>
+#include <queue.h>
+#include <Nucleo_F767ZI_GPIO.h>
+#include <SEGGER_SYSVIEW.h>
+#include <Nucleo_F767ZI_Init.h>
+#include <stm32f7xx_hal.h>
+#include "VirtualCommDriverMultiTask.h"
+#include <sysViewUsbTransport.h>
+
+/*********************************************
+ * Streams SystemView data over the USB virtual comm port
+ * so traces can be recorded without a debug probe.
+ *
+ * Use PythonSysViewRecorder/sysViewRecorder.py to start
+ * recording and save the trace to a .SVDat file,
+ * which can then be opened in SystemView.
+ *
+ * A producer and consumer pass values through a queue while
+ * a lower priority task blinks an LED to give the trace
+ * something to show.
+ *********************************************/
+
+#define STACK_SIZE 256
+
+void producerTask( void* NotUsed );
+void consumerTask( void* NotUsed );
+void blinkTask( void* NotUsed );
+
+static QueueHandle_t valueQueue = NULL;
+
+int main(void)
+{
+	HWInit();
+	VirtualCommInit(256, configMAX_PRIORITIES-2);
+	SEGGER_SYSVIEW_Conf();
+	HAL_NVIC_SetPriorityGrouping(NVIC_PRIORITYGROUP_4);	//ensure proper priority grouping for freeRTOS
+
+	//the transport runs above the traced tasks so bursts of
+	//events are drained before the SystemView buffer fills
+	SysViewUsbTransportInit(256, configMAX_PRIORITIES-1);
+
+	valueQueue = xQueueCreate(8, sizeof(uint32_t));
+	assert_param(valueQueue != NULL);
+
+	assert_param(xTaskCreate(producerTask, "producer", STACK_SIZE, NULL, tskIDLE_PRIORITY + 1, NULL) == pdPASS);
+	assert_param(xTaskCreate(consumerTask, "consumer", STACK_SIZE, NULL, tskIDLE_PRIORITY + 2, NULL) == pdPASS);
+	assert_param(xTaskCreate(blinkTask, "blink", STACK_SIZE, NULL, tskIDLE_PRIORITY + 1, NULL) == pdPASS);
+
+	//start the scheduler - shouldn't return unless there's a problem
+	vTaskStartScheduler();
+
+	//if you've wound up here, there is likely an issue with overrunning the freeRTOS heap
+	while(1)
+	{
+	}
+}
+
+void producerTask( void* NotUsed )
+{
+	uint32_t value = 0;
+
+	while(1)
+	{
+		assert_param(xQueueSend(valueQueue, &value, portMAX_DELAY) == pdPASS);
+		value++;
+		vTaskDelay(5);
+	}
+}
+
+void consumerTask( void* NotUsed )
+{
+	uint32_t value;
+
+	while(1)
+	{
+		if(xQueueReceive(valueQueue, &value, portMAX_DELAY) == pdPASS)
+		{
+			if((value % 100) == 0)
+			{
+				SEGGER_SYSVIEW_PrintfHost("received %u, %u trace bytes sent",
+											value, sysViewTransportStats.bytesSent);
+			}
+		}
+	}
+}
+
+void blinkTask( void* NotUsed )
+{
+	while(1)
+	{
+		GreenLed.On();
+		vTaskDelay(200);
+		GreenLed.Off();
+		vTaskDelay(200);
+	}
+}
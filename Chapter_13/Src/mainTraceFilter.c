@@ -0,0 +1,178 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2019 Brian Amos
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+//every level is requested here, the build configuration caps it with TRACE_LEVEL_MAX
+#define TRACE_LEVEL TRACE_LEVEL_DEBUG
+
+#include <FreeRTOS.h>
+#include <task.h>
+#include <queue.h>
+#include <Nucleo_F767ZI_GPIO.h>
+#include <SEGGER_SYSVIEW.h>
+#include <Nucleo_F767ZI_Init.h>
+#include <stm32f7xx_hal.h>
+#include <DWTCycleCounter.h>
+#include <TraceModule.h>
+
+/*********************************************
+ * Measures the cost of tracing in the current build configuration
+ *
+ * 	traceFull:			every trace level and kernel event group compiled in
+ * 	traceProduction:	TRACE_LEVEL_MAX=1 (errors only) and the queue, stream,
+ * 						notification and task API kernel events compiled out
+ *
+ * Each measurement is the average CPU cycles per call:
+ * 	baseline	- an empty loop (what a compiled out trace call costs)
+ * 	disabled	- TRACE_DEBUG with the module's runtime level at NONE
+ * 				  (the same as baseline when compiled out)
+ * 	enabled		- TRACE_DEBUG / TRACE_EVENT recorded by SystemView
+ * 	queue		- a non-blocking xQueueSend + xQueueReceive pair,
+ * 				  including the kernel's trace hooks
+ *
+ * Results are printed to SystemView once per second and are also
+ * available in traceResults.  Compare code size between the 2 builds
+ * with BSP/TraceTools/traceSizeReport.py
+ *********************************************/
+
+#define STACK_SIZE 256
+#define NUM_ITERATIONS 1000
+
+void benchmarkTask( void* NotUsed );
+
+typedef struct
+{
+	uint32_t baseline;		//empty loop
+	uint32_t disabled;		//TRACE_DEBUG, runtime level NONE
+	uint32_t printf;		//TRACE_DEBUG, runtime level DEBUG
+	uint32_t event;			//TRACE_EVENT, runtime level DEBUG
+	uint32_t queue;			//xQueueSend + xQueueReceive
+}TraceResults;
+
+volatile TraceResults traceResults;
+
+TRACE_MODULE_DEFINE(benchTrace, "M=TraceBench, 0 Iteration i=%u", 1);
+
+static QueueHandle_t benchQueue = NULL;
+
+int main(void)
+{
+	HWInit();
+	CycleCounterInit();
+	SEGGER_SYSVIEW_Conf();
+	HAL_NVIC_SetPriorityGrouping(NVIC_PRIORITYGROUP_4);	//ensure proper priority grouping for freeRTOS
+
+	TRACE_MODULE_REGISTER(benchTrace);
+
+	benchQueue = xQueueCreate(1, sizeof(uint32_t));
+	assert_param(benchQueue != NULL);
+
+	assert_param(xTaskCreate(benchmarkTask, "benchmark", STACK_SIZE, NULL, tskIDLE_PRIORITY + 1, NULL) == pdPASS);
+
+	//start the scheduler - shouldn't return unless there's a problem
+	vTaskStartScheduler();
+
+	//if you've wound up here, there is likely an issue with overrunning the freeRTOS heap
+	while(1)
+	{
+	}
+}
+
+/**
+ * each measurement makes NUM_ITERATIONS calls and returns the average
+ * cycles per call (loop overhead included - it is the same for every measurement)
+ */
+static uint32_t measureBaseline( void )
+{
+	uint32_t start = CycleCount();
+	for(uint32_t i = 0; i < NUM_ITERATIONS; i++)
+	{
+		__asm volatile("" ::: "memory");
+	}
+	return (CycleCount() - start) / NUM_ITERATIONS;
+}
+
+static uint32_t measurePrintf( void )
+{
+	uint32_t start = CycleCount();
+	for(uint32_t i = 0; i < NUM_ITERATIONS; i++)
+	{
+		__asm volatile("" ::: "memory");
+		TRACE_DEBUG(benchTrace, "iteration %u", i);
+	}
+	return (CycleCount() - start) / NUM_ITERATIONS;
+}
+
+static uint32_t measureEvent( void )
+{
+	uint32_t start = CycleCount();
+	for(uint32_t i = 0; i < NUM_ITERATIONS; i++)
+	{
+		__asm volatile("" ::: "memory");
+		TRACE_EVENT(benchTrace, TRACE_LEVEL_DEBUG, 0, i);
+	}
+	return (CycleCount() - start) / NUM_ITERATIONS;
+}
+
+static uint32_t measureQueue( void )
+{
+	uint32_t value;
+	uint32_t start = CycleCount();
+	for(uint32_t i = 0; i < NUM_ITERATIONS; i++)
+	{
+		xQueueSend(benchQueue, &i, 0);
+		xQueueReceive(benchQueue, &value, 0);
+	}
+	return (CycleCount() - start) / NUM_ITERATIONS;
+}
+
+void benchmarkTask( void* NotUsed )
+{
+	while(1)
+	{
+		//a critical section (rather than taskDISABLE_INTERRUPTS) is used so
+		//the queue's own critical sections don't re-enable interrupts
+		taskENTER_CRITICAL();
+		traceResults.baseline = measureBaseline();
+
+		benchTrace.level = TRACE_LEVEL_NONE;
+		traceResults.disabled = measurePrintf();
+
+		benchTrace.level = TRACE_LEVEL_DEBUG;
+		traceResults.printf = measurePrintf();
+		traceResults.event = measureEvent();
+
+		traceResults.queue = measureQueue();
+		taskEXIT_CRITICAL();
+
+		SEGGER_SYSVIEW_PrintfHost("trace level %u cycles/call baseline:%u disabled:%u printf:%u event:%u",
+									TRACE_LEVEL_COMPILED,
+									traceResults.baseline,
+									traceResults.disabled,
+									traceResults.printf,
+									traceResults.event);
+		SEGGER_SYSVIEW_PrintfHost("queue send+receive cycles:%u", traceResults.queue);
+		vTaskDelay(1000);
+	}
+}
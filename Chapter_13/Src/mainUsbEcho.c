@@ -32,6 +32,7 @@
 #include "VirtualCommDriverMultiTask.h"
 #include <string.h>
 #include <stdio.h>
+#include <QueueTelemetry.h>
 
 // some common variables to use for each task
 // 128 * 4 = 512 bytes
@@ -40,6 +41,7 @@
 
 #define MAX_MSG_LEN 100
 char currentMsg[MAX_MSG_LEN];
+char latencyReport[1024];
 
 void echoUsbRx( void* NotUsed);
 
@@ -50,6 +52,9 @@ int main(void)
 	SEGGER_SYSVIEW_Conf();
 	HAL_NVIC_SetPriorityGrouping(NVIC_PRIORITYGROUP_4);	//ensure proper priority grouping for freeRTOS
 
+	//in telemetry builds, sample the USB stream buffers every 100mS
+	QUEUE_TELEMETRY_START(100, tskIDLE_PRIORITY + 1);
+
 	//setup tasks, making sure they have been properly created before moving on
 	assert_param(xTaskCreate(echoUsbRx, "usbEcho", STACK_SIZE, NULL, configMAX_PRIORITIES-1, NULL) == pdPASS);
 
@@ -64,6 +69,8 @@ int main(void)
 
 /**
  * this task monitors incoming USB data and echo's it back
+ * sending a single '?' returns a report of the USB wake-up latencies instead
+ * (followed by the stream buffer telemetry in usbEchoTelemetry)
  */
 void echoUsbRx( void* NotUsed)
 {
@@ -81,7 +88,20 @@ void echoUsbRx( void* NotUsed)
 											10);
 		if(bytesRead > 0)
 		{
-			TransmitUsbData((uint8_t*)currentMsg, bytesRead, 10);
+			WakeLatencyResumed(&VcomRxLatency);
+
+			if(bytesRead == 1 && currentMsg[0] == '?')
+			{
+				uint32_t len = WakeLatencyReport(latencyReport, sizeof(latencyReport));
+#if defined(QUEUE_TELEMETRY) && QUEUE_TELEMETRY == 1
+				len += QueueTelemetryReport(latencyReport + len, sizeof(latencyReport) - len);
+#endif
+				TransmitUsbData((uint8_t*)latencyReport, len, 10);
+			}
+			else
+			{
+				TransmitUsbData((uint8_t*)currentMsg, bytesRead, 10);
+			}
 		}
 	}
 }
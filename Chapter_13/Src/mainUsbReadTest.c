@@ -32,12 +32,20 @@
 #include "VirtualCommDriverMultiTask.h"
 #include <string.h>
 #include <stdio.h>
+#include <MutexProfiler.h>
 
 // some common variables to use for each task
 // 128 * 4 = 512 bytes
 //(recommended min stack size per task)
 #define STACK_SIZE 128
 
+//formatting the mutex profiler report needs a larger stack
+#if defined(MUTEX_PROFILER) && MUTEX_PROFILER == 1
+#define RX_STACK_SIZE (STACK_SIZE * 3)
+#else
+#define RX_STACK_SIZE STACK_SIZE
+#endif
+
 void monitorUsbRx( void* NotUsed);
 void usbPrintOutTask( void* Number);
 
@@ -51,7 +59,7 @@ int main(void)
 	HAL_NVIC_SetPriorityGrouping(NVIC_PRIORITYGROUP_4);	//ensure proper priority grouping for freeRTOS
 
 	//setup tasks, making sure they have been properly created before moving on
-	retVal = xTaskCreate(monitorUsbRx, "usbRx", STACK_SIZE, NULL, configMAX_PRIORITIES-1, NULL);
+	retVal = xTaskCreate(monitorUsbRx, "usbRx", RX_STACK_SIZE, NULL, configMAX_PRIORITIES-1, NULL);
 	assert_param(retVal == pdPASS);
 	retVal = xTaskCreate(usbPrintOutTask, "usbprint1", STACK_SIZE, (void*)1, tskIDLE_PRIORITY + 2, NULL);
 	assert_param(retVal == pdPASS);
@@ -70,6 +78,9 @@ int main(void)
 /**
  * this is a simple monitor task that will print anythign received over
  * USB to the SEGGER SYSVIEW
+ * When built with MUTEX_PROFILER=1 (usbReadTestProfiled), receiving a
+ * single '?' replies with the contention report for vcom_mutexPtr, showing
+ * how long the two print tasks spend waiting on each other
  */
 void monitorUsbRx( void* NotUsed)
 {
@@ -89,6 +100,15 @@ void monitorUsbRx( void* NotUsed)
 								CURR_MSG_LEN-1,	//make sure to leave a null terminator
 								99);
 		SEGGER_SYSVIEW_PrintfHost(currentMsg);
+
+#if defined(MUTEX_PROFILER) && MUTEX_PROFILER == 1
+		if(strcmp(currentMsg, "?") == 0)
+		{
+			static char report[256];
+			uint32_t len = MutexProfilerReport(report, sizeof(report));
+			TransmitUsbData((uint8_t*)report, len, 100);
+		}
+#endif
 	}
 }
 
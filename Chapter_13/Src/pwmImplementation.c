@@ -92,20 +92,10 @@ void PWMInit( void )
 	HAL_GPIO_Init(GPIOB, &GPIO_InitStruct);
 }
 
-void SetBlueDuty( float DutyCycle )
-{
-	TIM4->CCR2 = DutyCycle/100.0 * 65535;
-}
-iPWM BluePWM = {.SetDutyCycle = SetBlueDuty};
-
-void SetGreenDuty( float DutyCycle )
-{
-	TIM3->CCR3 = DutyCycle/100.0 * 65535;
-}
-iPWM GreenPWM = {.SetDutyCycle = SetGreenDuty};
-
-void SetRedDuty( float DutyCycle )
-{
-	TIM12->CCR1 = DutyCycle/100.0 * 65535;
-}
-iPWM RedPWM = {.SetDutyCycle = SetRedDuty};
+/**
+ * the runtime iPWM instances share the static inline implementations
+ * from pwmImplementation.h, so both bindings always write the same registers
+ */
+iPWM BluePWM = IPWM_STATIC(BluePWM);
+iPWM GreenPWM = IPWM_STATIC(GreenPWM);
+iPWM RedPWM = IPWM_STATIC(RedPWM);
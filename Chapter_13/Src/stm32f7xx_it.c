@@ -144,11 +144,11 @@ void SysTick_Handler(void)
 void OTG_FS_IRQHandler(void)
 {
   /* USER CODE BEGIN OTG_FS_IRQn 0 */
-	SEGGER_SYSVIEW_RecordEnterISR();
+	traceISR_ENTER();
   /* USER CODE END OTG_FS_IRQn 0 */
   HAL_PCD_IRQHandler(&hpcd_USB_OTG_FS);
   /* USER CODE BEGIN OTG_FS_IRQn 1 */
-  SEGGER_SYSVIEW_RecordExitISR();
+  traceISR_EXIT();
   /* USER CODE END OTG_FS_IRQn 1 */
 }
 
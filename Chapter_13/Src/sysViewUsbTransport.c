@@ -0,0 +1,173 @@
+#include <sysViewUsbTransport.h>
+#include <VirtualCommDriverMultiTask.h>
+#include <SEGGER_RTT.h>
+#include <SEGGER_SYSVIEW.h>
+#include <SEGGER_SYSVIEW_ConfDefaults.h>
+#include <task.h>
+#include <stm32f7xx_hal.h>
+#include <string.h>
+
+/**
+ * SystemView transport over the USB virtual comm port
+ *
+ * SystemView records events into its RTT up-buffer, which is normally
+ * drained by a J-Link.  Here a task plays the part of the debug probe:
+ * it moves whatever is waiting in the up-buffer into the USB CDC driver
+ * and copies commands sent by the host (start, stop, etc) into the RTT
+ * down-buffer, where SystemView picks them up after sending its next packet.
+ *
+ * The size of the up-buffer is set by SEGGER_SYSVIEW_RTT_BUFFER_SIZE and
+ * should be large enough to absorb bursts of events while USB is busy.
+ * Since the trace is moved through the same RTT buffers a J-Link reads,
+ * a debug probe must not be recording at the same time.
+ *
+ * VirtualCommInit must be called before SysViewUsbTransportInit
+ * This module expects to be the only user of the virtual comm port
+ */
+
+#if SEGGER_SYSVIEW_RTT_CHANNEL == 0
+#error "SysViewUsbTransport requires a fixed SEGGER_SYSVIEW_RTT_CHANNEL"
+#endif
+
+//number of bytes moved from the up-buffer to USB at a time
+#define CHUNK_SIZE 512
+
+//how long to wait before checking the up-buffer again when it was empty
+#define POLL_PERIOD_MS 2
+
+volatile SysViewTransportStats sysViewTransportStats = {0};
+
+static uint8_t txChunk[CHUNK_SIZE];
+static uint8_t rxChunk[16];
+
+static void sysViewUsbTask( void* NotUsed );
+
+/**
+ * Create the task responsible for moving SystemView data between
+ * the RTT buffers and the virtual comm port
+ * @param StackSize	size (in FreeRTOS words) of the stack used by the task
+ * @param Priority	should be above any task whose activity is being recorded
+ * 					in bursts, otherwise the up-buffer is more likely to fill
+ */
+void SysViewUsbTransportInit( const configSTACK_DEPTH_TYPE StackSize, UBaseType_t Priority )
+{
+	assert_param(xTaskCreate(sysViewUsbTask, "sysViewUsb", StackSize, NULL, Priority, NULL) == pdPASS);
+}
+
+/**
+ * copy up to MaxLen bytes out of the SystemView up-buffer
+ * SystemView only ever moves WrOff and this is the only code moving RdOff,
+ * so no locking is required (the same way a J-Link reads the buffer)
+ * @returns number of bytes copied into Dst
+ */
+static uint32_t readUpBuffer( uint8_t* Dst, uint32_t MaxLen )
+{
+	SEGGER_RTT_BUFFER_UP* ring = &_SEGGER_RTT.aUp[SEGGER_SYSVIEW_RTT_CHANNEL];
+	const uint32_t wrOff = *(volatile unsigned*)&ring->WrOff;
+	uint32_t rdOff = ring->RdOff;
+	uint32_t numBytes = 0;
+
+	uint32_t waiting = (wrOff >= rdOff) ? wrOff - rdOff : ring->SizeOfBuffer - rdOff + wrOff;
+	if(waiting > sysViewTransportStats.peakBytesWaiting)
+	{
+		sysViewTransportStats.peakBytesWaiting = waiting;
+	}
+	if(ring->SizeOfBuffer - waiting < SEGGER_SYSVIEW_MAX_PACKET_SIZE)
+	{
+		sysViewTransportStats.nearFullCount++;
+	}
+
+	//don't read the data before WrOff
+	__DMB();
+
+	if(rdOff > wrOff)
+	{
+		//data wraps around the end of the buffer, read the end first
+		uint32_t len = ring->SizeOfBuffer - rdOff;
+		if(len > MaxLen)
+		{
+			len = MaxLen;
+		}
+		memcpy(Dst, ring->pBuffer + rdOff, len);
+		numBytes = len;
+		rdOff += len;
+		if(rdOff == ring->SizeOfBuffer)
+		{
+			rdOff = 0;
+		}
+	}
+	if(rdOff < wrOff)
+	{
+		uint32_t len = wrOff - rdOff;
+		if(len > MaxLen - numBytes)
+		{
+			len = MaxLen - numBytes;
+		}
+		memcpy(Dst + numBytes, ring->pBuffer + rdOff, len);
+		numBytes += len;
+		rdOff += len;
+	}
+
+	//finish reading before releasing the space to SystemView
+	__DMB();
+	ring->RdOff = rdOff;
+
+	return numBytes;
+}
+
+/**
+ * pass host commands on to SystemView through its down-buffer
+ */
+static void writeDownBuffer( const uint8_t* Src, uint32_t Len )
+{
+	SEGGER_RTT_BUFFER_DOWN* ring = &_SEGGER_RTT.aDown[SEGGER_SYSVIEW_RTT_CHANNEL];
+	uint32_t wrOff = ring->WrOff;
+
+	for(uint32_t i = 0; i < Len; i++)
+	{
+		uint32_t next = wrOff + 1;
+		if(next == ring->SizeOfBuffer)
+		{
+			next = 0;
+		}
+		if(next == *(volatile unsigned*)&ring->RdOff)
+		{
+			sysViewTransportStats.cmdBytesDropped += Len - i;
+			break;
+		}
+		ring->pBuffer[wrOff] = Src[i];
+		wrOff = next;
+	}
+
+	__DMB();
+	ring->WrOff = wrOff;
+}
+
+static void sysViewUsbTask( void* NotUsed )
+{
+	while(1)
+	{
+		uint32_t numRx = xStreamBufferReceive(*GetUsbRxStreamBuff(), rxChunk, sizeof(rxChunk), 0);
+		if(numRx > 0)
+		{
+			writeDownBuffer(rxChunk, numRx);
+		}
+
+		uint32_t numTx = readUpBuffer(txChunk, CHUNK_SIZE);
+		if(numTx > 0)
+		{
+			//the SystemView stream can't resynchronize after missing bytes,
+			//so wait until everything has been accepted by the driver
+			uint32_t sent = 0;
+			while(sent < numTx)
+			{
+				sent += TransmitUsbData(txChunk + sent, numTx - sent, 100);
+			}
+			sysViewTransportStats.bytesSent += numTx;
+		}
+		else
+		{
+			vTaskDelay(POLL_PERIOD_MS / portTICK_PERIOD_MS);
+		}
+	}
+}
@@ -0,0 +1,315 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2019 Brian Amos
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#include <ledCmdProtocol.h>
+#include <CRC32.h>
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * Off-target conformance test for ledCmdProtocol.c (build and run it with
+ * "make" from this directory).  Covers CRC-32, COBS, frame validation and
+ * the receive window: sequence wraparound, duplicates vs. gaps, skipped
+ * frames and resynchronization with FRAME_SYNC
+ */
+
+static uint32_t failures = 0;
+
+#define CHECK(cond)	do { if(!(cond)) { failures++; \
+						printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); } } while(0)
+
+static void frameInit( ProtocolFrame* Frame, uint8_t Type, uint8_t Seq, const uint8_t* Payload, uint8_t Len )
+{
+	Frame->type = Type;
+	Frame->seq = Seq;
+	Frame->len = Len;
+	memcpy(Frame->payload, Payload, Len);
+}
+
+static void syncInit( ProtocolFrame* Frame, uint8_t Seq, uint32_t Session )
+{
+	uint8_t payload[PROTOCOL_SYNC_LEN] = {	Session & 0xFF, (Session >> 8) & 0xFF,
+											(Session >> 16) & 0xFF, (Session >> 24) & 0xFF };
+	frameInit(Frame, FRAME_SYNC, Seq, payload, sizeof(payload));
+}
+
+static bool cobsMatches( const uint8_t* Raw, uint32_t RawLen, const uint8_t* Encoded, uint32_t EncodedLen )
+{
+	uint8_t buff[512];
+	uint8_t decoded[512];
+
+	if(CobsEncode(Raw, RawLen, buff) != EncodedLen || memcmp(buff, Encoded, EncodedLen) != 0)
+	{
+		return false;
+	}
+	for(uint32_t i = 0; i < EncodedLen; i++)
+	{
+		if(buff[i] == 0)
+		{
+			return false;
+		}
+	}
+	return	CobsDecode(Encoded, EncodedLen, decoded, sizeof(decoded)) == (int32_t)RawLen &&
+			memcmp(decoded, Raw, RawLen) == 0;
+}
+
+static void testCrc( void )
+{
+	uint8_t buff[13] = "123456789";
+
+	//standard CRC-32 check value
+	uint32_t crc = CalcCRC32(buff, 9);
+	CHECK(crc == 0xCBF43926);
+
+	buff[9] = crc & 0xFF;
+	buff[10] = (crc >> 8) & 0xFF;
+	buff[11] = (crc >> 16) & 0xFF;
+	buff[12] = (crc >> 24) & 0xFF;
+	CHECK(CheckCRC(buff, sizeof(buff)));
+
+	buff[4] ^= 0x01;
+	CHECK(!CheckCRC(buff, sizeof(buff)));
+}
+
+static void testCobs( void )
+{
+	const uint8_t zero[] = {0x00};
+	const uint8_t zeroEnc[] = {0x01, 0x01};
+	const uint8_t zeros[] = {0x00, 0x00};
+	const uint8_t zerosEnc[] = {0x01, 0x01, 0x01};
+	const uint8_t mixed[] = {0x11, 0x22, 0x00, 0x33};
+	const uint8_t mixedEnc[] = {0x03, 0x11, 0x22, 0x02, 0x33};
+	const uint8_t trailing[] = {0x11, 0x00, 0x00, 0x00};
+	const uint8_t trailingEnc[] = {0x02, 0x11, 0x01, 0x01, 0x01};
+
+	CHECK(cobsMatches(zero, sizeof(zero), zeroEnc, sizeof(zeroEnc)));
+	CHECK(cobsMatches(zeros, sizeof(zeros), zerosEnc, sizeof(zerosEnc)));
+	CHECK(cobsMatches(mixed, sizeof(mixed), mixedEnc, sizeof(mixedEnc)));
+	CHECK(cobsMatches(trailing, sizeof(trailing), trailingEnc, sizeof(trailingEnc)));
+
+	//254 non-zero bytes fill a block exactly, 255 spill into a second one
+	uint8_t raw[255];
+	uint8_t enc[258];
+	for(uint32_t i = 0; i < sizeof(raw); i++)
+	{
+		raw[i] = i + 1;
+	}
+	enc[0] = 0xFF;
+	memcpy(&enc[1], raw, 254);
+	enc[255] = 0x02;
+	enc[256] = 0xFF;
+	CHECK(cobsMatches(raw, 254, enc, 255));
+	CHECK(cobsMatches(raw, 255, enc, 257));
+
+	//malformed input
+	uint8_t out[16];
+	const uint8_t badCode[] = {0x02, 0x11, 0x00};
+	const uint8_t overrun[] = {0x05, 0x11, 0x22};
+	CHECK(CobsDecode(badCode, sizeof(badCode), out, sizeof(out)) == -1);
+	CHECK(CobsDecode(overrun, sizeof(overrun), out, sizeof(out)) == -1);
+	CHECK(CobsDecode(mixedEnc, sizeof(mixedEnc), out, 2) == -1);
+}
+
+/**
+ * feed an encoded frame through the accumulator and parser
+ */
+static PROTOCOL_NACK_REASON receive( const uint8_t* Wire, uint32_t Len, ProtocolFrame* Frame )
+{
+	static ProtocolRxAccumulator acc;
+	PROTOCOL_NACK_REASON reason = NACK_BAD_ENCODING;
+	bool complete = false;
+
+	for(uint32_t i = 0; i < Len; i++)
+	{
+		if(ProtocolAccumulate(&acc, Wire[i]))
+		{
+			complete = true;
+			reason = ProtocolParseFrame(acc.buff, acc.len, Frame);
+		}
+	}
+	CHECK(complete);
+	return reason;
+}
+
+static void testFrames( void )
+{
+	const uint8_t payload[] = {0x02, 0x00, 0xFF, 0x00};
+	ProtocolFrame tx, rx;
+	uint8_t wire[PROTOCOL_MAX_ENCODED_LEN];
+
+	frameInit(&tx, FRAME_LED_CMD, 0xFF, payload, sizeof(payload));
+	uint32_t len = ProtocolBuildFrame(&tx, wire);
+	CHECK(wire[len - 1] == 0);
+	CHECK(memchr(wire, 0, len - 1) == NULL);
+	CHECK(receive(wire, len, &rx) == NACK_NONE);
+	CHECK(rx.type == FRAME_LED_CMD && rx.seq == 0xFF && rx.len == sizeof(payload));
+	CHECK(memcmp(rx.payload, payload, sizeof(payload)) == 0);
+
+	//largest frame survives a round trip
+	uint8_t big[PROTOCOL_MAX_PAYLOAD];
+	for(uint32_t i = 0; i < sizeof(big); i++)
+	{
+		big[i] = i % 3 ? i : 0;
+	}
+	frameInit(&tx, FRAME_LED_BATCH, 7, big, sizeof(big));
+	len = ProtocolBuildFrame(&tx, wire);
+	CHECK(len <= PROTOCOL_MAX_ENCODED_LEN);
+	CHECK(receive(wire, len, &rx) == NACK_NONE);
+	CHECK(rx.len == sizeof(big) && memcmp(rx.payload, big, sizeof(big)) == 0);
+
+	//a corrupted byte is caught by the CRC, not mistaken for a valid frame
+	frameInit(&tx, FRAME_LED_CMD, 3, payload, sizeof(payload));
+	len = ProtocolBuildFrame(&tx, wire);
+	wire[3] ^= 0x40;
+	CHECK(receive(wire, len, &rx) == NACK_BAD_CRC);
+
+	//garbage (no valid COBS) is dropped and the next frame is still received
+	const uint8_t garbage[] = {0x09, 0x01, 0x00};
+	CHECK(receive(garbage, sizeof(garbage), &rx) == NACK_BAD_ENCODING);
+	len = ProtocolBuildFrame(&tx, wire);
+	CHECK(receive(wire, len, &rx) == NACK_NONE);
+}
+
+static void testWraparound( void )
+{
+	ProtocolRxWindow window = {0};
+	ProtocolFrame frame;
+	const uint8_t payload[] = {0, 0, 0, 0};
+
+	window.expectedSeq = 0xFD;
+	for(uint32_t i = 0; i < 6; i++)
+	{
+		frameInit(&frame, FRAME_LED_CMD, 0xFD + i, payload, sizeof(payload));
+		CHECK(ProtocolReceive(&window, &frame) == RX_APPLY);
+		ProtocolAdvance(&window);
+	}
+	CHECK(window.expectedSeq == 0x03);
+	CHECK(ProtocolLastApplied(&window) == 0x02);
+
+	//frames from before the wrap are still recognized as duplicates
+	CHECK(ProtocolCheckSeq(&window, 0xFE) == SEQ_DUPLICATE);
+	CHECK(ProtocolCheckSeq(&window, 0x02) == SEQ_DUPLICATE);
+	CHECK(ProtocolCheckSeq(&window, 0xFB) == SEQ_DUPLICATE);
+	CHECK(ProtocolCheckSeq(&window, 0xFA) == SEQ_OUT_OF_ORDER);
+	CHECK(ProtocolCheckSeq(&window, 0x04) == SEQ_OUT_OF_ORDER);
+}
+
+static void testDuplicateVsGap( void )
+{
+	ProtocolRxWindow window = {0};
+	ProtocolFrame frame;
+	const uint8_t payload[] = {0, 0, 0, 0};
+
+	window.expectedSeq = 10;
+
+	//a retransmission of something already applied is only re-ACK'd
+	frameInit(&frame, FRAME_LED_CMD, 9, payload, sizeof(payload));
+	CHECK(ProtocolReceive(&window, &frame) == RX_ACK);
+	frameInit(&frame, FRAME_LED_CMD, 10 - PROTOCOL_WINDOW_SIZE, payload, sizeof(payload));
+	CHECK(ProtocolReceive(&window, &frame) == RX_ACK);
+	CHECK(window.expectedSeq == 10 && !window.nackSent);
+
+	//frame 10 was lost - only the first frame after the gap is NACK'd
+	frameInit(&frame, FRAME_LED_CMD, 11, payload, sizeof(payload));
+	CHECK(ProtocolReceive(&window, &frame) == RX_NACK);
+	frameInit(&frame, FRAME_LED_CMD, 12, payload, sizeof(payload));
+	CHECK(ProtocolReceive(&window, &frame) == RX_DROP);
+	CHECK(window.expectedSeq == 10);
+
+	//go-back-N retransmission fills the gap and re-arms the NACK
+	frameInit(&frame, FRAME_LED_CMD, 10, payload, sizeof(payload));
+	CHECK(ProtocolReceive(&window, &frame) == RX_APPLY);
+	ProtocolAdvance(&window);
+	CHECK(!window.nackSent);
+	frameInit(&frame, FRAME_LED_CMD, 13, payload, sizeof(payload));
+	CHECK(ProtocolReceive(&window, &frame) == RX_NACK);
+
+	//a frame that can't be applied is skipped rather than stalling the window
+	frameInit(&frame, 0x7F, 11, payload, sizeof(payload));
+	CHECK(ProtocolReceive(&window, &frame) == RX_APPLY);
+	ProtocolAdvance(&window);
+	CHECK(ProtocolLastApplied(&window) == 11);
+	frameInit(&frame, FRAME_LED_CMD, 12, payload, sizeof(payload));
+	CHECK(ProtocolReceive(&window, &frame) == RX_APPLY);
+}
+
+static void testResync( void )
+{
+	ProtocolRxWindow window = {0};
+	ProtocolFrame frame;
+	const uint8_t payload[] = {0, 0, 0, 0};
+
+	//a previous host left the window somewhere the new one doesn't know about
+	window.expectedSeq = 0x80;
+	frameInit(&frame, FRAME_LED_CMD, 0, payload, sizeof(payload));
+	CHECK(ProtocolReceive(&window, &frame) == RX_NACK);
+
+	//the sync restarts the window and counts as applied
+	syncInit(&frame, 0, 0x12345678);
+	CHECK(ProtocolReceive(&window, &frame) == RX_ACK);
+	CHECK(ProtocolLastApplied(&window) == 0);
+	CHECK(!window.nackSent);
+	frameInit(&frame, FRAME_LED_CMD, 1, payload, sizeof(payload));
+	CHECK(ProtocolReceive(&window, &frame) == RX_APPLY);
+	ProtocolAdvance(&window);
+
+	//a retransmitted sync (its ACK was lost) doesn't rewind the window
+	syncInit(&frame, 0, 0x12345678);
+	CHECK(ProtocolReceive(&window, &frame) == RX_ACK);
+	CHECK(ProtocolLastApplied(&window) == 1);
+
+	//a new session starting at the same seq does
+	syncInit(&frame, 0, 0xCAFEF00D);
+	CHECK(ProtocolReceive(&window, &frame) == RX_ACK);
+	CHECK(ProtocolLastApplied(&window) == 0);
+
+	//as does the first sync after the device resets, whatever its session id
+	ProtocolRxWindow fresh = {0};
+	fresh.expectedSeq = 5;
+	syncInit(&frame, 4, 0);
+	CHECK(ProtocolReceive(&fresh, &frame) == RX_ACK);
+	CHECK(fresh.synced && ProtocolLastApplied(&fresh) == 4);
+
+	//a malformed sync is sequence checked like any other frame
+	frameInit(&frame, FRAME_SYNC, 1, payload, 2);
+	CHECK(ProtocolReceive(&window, &frame) == RX_APPLY);
+}
+
+int main( void )
+{
+	testCrc();
+	testCobs();
+	testFrames();
+	testWraparound();
+	testDuplicateVsGap();
+	testResync();
+
+	if(failures)
+	{
+		printf("%lu check(s) failed\n", (unsigned long)failures);
+		return 1;
+	}
+	printf("all checks passed\n");
+	return 0;
+}
@@ -0,0 +1,212 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2019 Brian Amos
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <Nucleo_F767ZI_Init.h>
+#include <Nucleo_F767ZI_GPIO.h>
+#include <cmsis_os2.h>
+#include <cmsis_os2_inline.h>
+#include <RTOS_Dependencies.h>
+#include <SEGGER_SYSVIEW.h>
+#include <DWTCycleCounter.h>
+
+/*********************************************
+ * Cost of the CMSIS-RTOS2 wrapper in a hot loop
+ *
+ * Each primitive is exercised 3 ways from the same task:
+ * 	wrapper	- the regular os* call (cmsis_os2.c)
+ * 	inline	- the os*Task call from cmsis_os2_inline.h
+ * 	direct	- the FreeRTOS call the wrapper ends up making
+ *
+ * None of the calls block (the objects are always available and the
+ * timeouts are 0), so the numbers are the pure call overhead in CPU
+ * cycles per operation pair (give + take, put + get, set + wait).
+ *
+ * Results are printed to SystemView once per second and are also
+ * available in cmsisResults
+ *********************************************/
+
+#define NUM_ITERATIONS 1000
+#define STACK_SIZE 1024
+#define FLAG 0x01
+
+void benchmarkTask( void* NotUsed );
+
+typedef struct
+{
+	uint32_t wrapper;
+	uint32_t inlined;
+	uint32_t direct;
+}CallCycles;
+
+typedef struct
+{
+	CallCycles semaphore;	//release + acquire
+	CallCycles mutex;		//acquire + release
+	CallCycles queue;		//put + get
+	CallCycles flags;		//set + wait (own thread)
+	CallCycles delay;		//osDelay(0) / vTaskDelay isn't called for 0 ticks
+}CmsisResults;
+
+volatile CmsisResults cmsisResults;
+
+static osSemaphoreId_t semaphore;
+static osMutexId_t mutex;
+static osMessageQueueId_t queue;
+
+int main(void)
+{
+	osStatus_t status;
+	osThreadId_t benchmarkThreadId;
+	HWInit();
+	CycleCounterInit();
+	SEGGER_SYSVIEW_Conf();
+
+	status = osKernelInitialize();
+	assert(status == osOK);
+
+	semaphore = osSemaphoreNew(1, 0, NULL);
+	assert(semaphore != NULL);
+	mutex = osMutexNew(NULL);
+	assert(mutex != NULL);
+	queue = osMessageQueueNew(4, sizeof(uint32_t), NULL);
+	assert(queue != NULL);
+
+	osThreadAttr_t benchmarkAttribs = {	.name = "benchmark",
+										.stack_size = STACK_SIZE,
+										.priority = osPriorityNormal };
+	benchmarkThreadId = osThreadNew(benchmarkTask, NULL, &benchmarkAttribs);
+	assert(benchmarkThreadId != NULL);
+
+	osKernelStart();
+
+	while(1)
+	{
+	}
+}
+
+/**
+ * time NUM_ITERATIONS runs of Statement
+ */
+#define MEASURE(Result, Statement)						\
+	do {												\
+		uint32_t start = CycleCount();					\
+		for(uint32_t i = 0; i < NUM_ITERATIONS; i++)	\
+		{												\
+			Statement;									\
+		}												\
+		Result = (CycleCount() - start) / NUM_ITERATIONS;	\
+	} while(0)
+
+static void measureSemaphore( void )
+{
+	SemaphoreHandle_t hSemaphore = (SemaphoreHandle_t)semaphore;
+
+	MEASURE(cmsisResults.semaphore.wrapper,
+			osSemaphoreRelease(semaphore); osSemaphoreAcquire(semaphore, 0));
+	MEASURE(cmsisResults.semaphore.inlined,
+			osSemaphoreReleaseTask(semaphore); osSemaphoreAcquireTask(semaphore, 0));
+	MEASURE(cmsisResults.semaphore.direct,
+			xSemaphoreGive(hSemaphore); xSemaphoreTake(hSemaphore, 0));
+}
+
+static void measureMutex( void )
+{
+	SemaphoreHandle_t hMutex = (SemaphoreHandle_t)mutex;
+
+	MEASURE(cmsisResults.mutex.wrapper,
+			osMutexAcquire(mutex, 0); osMutexRelease(mutex));
+	MEASURE(cmsisResults.mutex.inlined,
+			osMutexAcquireTask(mutex, 0); osMutexReleaseTask(mutex));
+	MEASURE(cmsisResults.mutex.direct,
+			xSemaphoreTake(hMutex, 0); xSemaphoreGive(hMutex));
+}
+
+static void measureQueue( void )
+{
+	uint32_t msg = 0;
+	uint8_t prio;
+
+	MEASURE(cmsisResults.queue.wrapper,
+			osMessageQueuePut(queue, &msg, 0, 0); osMessageQueueGet(queue, &msg, &prio, 0));
+	MEASURE(cmsisResults.queue.inlined,
+			osMessageQueuePutTask(queue, &msg, 0, 0); osMessageQueueGetTask(queue, &msg, &prio, 0));
+#if (CMSIS_MQ_PRIORITY == 1)
+	PriorityMessageQueue* hQueue = (PriorityMessageQueue*)queue;
+	uint32_t prio32;
+	MEASURE(cmsisResults.queue.direct,
+			PriorityMessageQueueSend(hQueue, &msg, sizeof(msg), 0, 0);
+			PriorityMessageQueueReceive(hQueue, &msg, NULL, &prio32, 0));
+#else
+	QueueHandle_t hQueue = (QueueHandle_t)queue;
+	MEASURE(cmsisResults.queue.direct,
+			xQueueSendToBack(hQueue, &msg, 0); xQueueReceive(hQueue, &msg, 0));
+#endif
+}
+
+static void measureFlags( void )
+{
+	osThreadId_t self = osThreadGetId();
+	TaskHandle_t hSelf = (TaskHandle_t)self;
+	uint32_t value;
+
+	MEASURE(cmsisResults.flags.wrapper,
+			osThreadFlagsSet(self, FLAG); osThreadFlagsWait(FLAG, osFlagsWaitAny, 0));
+	MEASURE(cmsisResults.flags.inlined,
+			osThreadFlagsSetTask(self, FLAG); osThreadFlagsWaitAnyTask(FLAG, 0));
+	MEASURE(cmsisResults.flags.direct,
+			xTaskNotify(hSelf, FLAG, eSetBits); xTaskNotifyWait(0, FLAG, &value, 0));
+}
+
+static void measureDelay( void )
+{
+	MEASURE(cmsisResults.delay.wrapper, osDelay(0));
+	MEASURE(cmsisResults.delay.inlined, osDelayTask(0));
+	cmsisResults.delay.direct = 0;
+}
+
+static void print( const char* Name, volatile CallCycles* Result )
+{
+	SEGGER_SYSVIEW_PrintfHost("%s cycles wrapper:%u inline:%u direct:%u",
+								Name, Result->wrapper, Result->inlined, Result->direct);
+}
+
+void benchmarkTask( void* NotUsed )
+{
+	while(1)
+	{
+		measureSemaphore();
+		measureMutex();
+		measureQueue();
+		measureFlags();
+		measureDelay();
+
+		print("semaphore", &cmsisResults.semaphore);
+		print("mutex", &cmsisResults.mutex);
+		print("queue", &cmsisResults.queue);
+		print("flags", &cmsisResults.flags);
+		print("delay", &cmsisResults.delay);
+		osDelay(1000);
+	}
+}
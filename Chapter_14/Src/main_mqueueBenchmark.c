@@ -0,0 +1,168 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2019 Brian Amos
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <Nucleo_F767ZI_Init.h>
+#include <Nucleo_F767ZI_GPIO.h>
+#include <RTOS_Dependencies.h>
+#include <SEGGER_SYSVIEW.h>
+#include <DWTCycleCounter.h>
+
+// FreeRTOS POSIX includes
+#include <FreeRTOS_POSIX.h>
+#include <FreeRTOS_POSIX/pthread.h>
+#include <FreeRTOS_POSIX/mqueue.h>
+#include <FreeRTOS_POSIX/fcntl.h>
+#include <FreeRTOS_POSIX/unistd.h>
+
+/*********************************************
+ * Measures the cost of small POSIX messages
+ *
+ * 	MqueuePrealloc:	posixconfigMQ_PREALLOCATE=1 (default) - slots are
+ * 					allocated by mq_open, mq_send/mq_receive don't use the
+ * 					heap or the global queue list mutex
+ * 	MqueueMalloc:	posixconfigMQ_PREALLOCATE=0 - the original implementation,
+ * 					every message is allocated by mq_send and freed by mq_receive
+ *
+ * Each measurement is the average CPU cycles per call:
+ * 	pair	- mq_send immediately followed by mq_receive (empty queue)
+ * 	burst	- MAX_MSGS sends followed by MAX_MSGS receives (full queue)
+ *
+ * Results are printed to SystemView once per second and are also
+ * available in mqResults, along with the amount of heap used by the
+ * queue and the lowest amount of free heap seen
+ *********************************************/
+
+#define MSG_SIZE 16
+#define MAX_MSGS 8
+#define NUM_ITERATIONS 1000
+
+void* benchmarkThread( void* NotUsed );
+
+typedef struct
+{
+	uint32_t pairCycles;		//mq_send + mq_receive, per message
+	uint32_t burstSendCycles;	//mq_send into a filling queue
+	uint32_t burstRecvCycles;	//mq_receive from a draining queue
+	uint32_t heapUsed;			//bytes allocated by mq_open
+	uint32_t minFreeHeap;		//xPortGetMinimumEverFreeHeapSize
+}MqResults;
+
+volatile MqResults mqResults;
+
+pthread_t benchmarkThreadId;
+
+int main(void)
+{
+	int retVal;
+	HWInit();
+	CycleCounterInit();
+	SEGGER_SYSVIEW_Conf();
+
+	retVal = pthread_create( &benchmarkThreadId, NULL, benchmarkThread, NULL);
+	assert(retVal == 0);
+
+	vTaskStartScheduler();
+
+	//if you've wound up here, there is likely an issue with overrunning the freeRTOS heap
+	while(1)
+	{
+	}
+}
+
+/**
+ * send immediately followed by receive, the queue never holds more than 1 message
+ */
+static uint32_t measurePair( mqd_t Mq )
+{
+	char msg[MSG_SIZE] = "0123456789abcde";
+	char rx[MSG_SIZE];
+
+	uint32_t start = CycleCount();
+	for(uint32_t i = 0; i < NUM_ITERATIONS; i++)
+	{
+		mq_send(Mq, msg, sizeof(msg), 0);
+		mq_receive(Mq, rx, sizeof(rx), NULL);
+	}
+	return (CycleCount() - start) / NUM_ITERATIONS;
+}
+
+/**
+ * fill the queue, then drain it
+ */
+static void measureBurst( mqd_t Mq, uint32_t* SendCycles, uint32_t* RecvCycles )
+{
+	char msg[MSG_SIZE] = "0123456789abcde";
+	char rx[MSG_SIZE];
+	uint32_t sendTotal = 0, recvTotal = 0;
+
+	for(uint32_t i = 0; i < NUM_ITERATIONS / MAX_MSGS; i++)
+	{
+		uint32_t start = CycleCount();
+		for(uint32_t j = 0; j < MAX_MSGS; j++)
+		{
+			mq_send(Mq, msg, sizeof(msg), 0);
+		}
+		uint32_t mid = CycleCount();
+		for(uint32_t j = 0; j < MAX_MSGS; j++)
+		{
+			mq_receive(Mq, rx, sizeof(rx), NULL);
+		}
+		recvTotal += CycleCount() - mid;
+		sendTotal += mid - start;
+	}
+	*SendCycles = sendTotal / ((NUM_ITERATIONS / MAX_MSGS) * MAX_MSGS);
+	*RecvCycles = recvTotal / ((NUM_ITERATIONS / MAX_MSGS) * MAX_MSGS);
+}
+
+void* benchmarkThread( void* NotUsed )
+{
+	struct mq_attr attr = { .mq_flags = 0, .mq_maxmsg = MAX_MSGS, .mq_msgsize = MSG_SIZE, .mq_curmsgs = 0 };
+	uint32_t sendCycles, recvCycles;
+
+	size_t freeBefore = xPortGetFreeHeapSize();
+	//non-blocking, so a lost message can't hang the benchmark
+	mqd_t mq = mq_open("/bench", O_CREAT | O_RDWR | O_NONBLOCK, 0, &attr);
+	assert(mq != (mqd_t) -1);
+	mqResults.heapUsed = freeBefore - xPortGetFreeHeapSize();
+
+	while(1)
+	{
+		mqResults.pairCycles = measurePair(mq);
+		measureBurst(mq, &sendCycles, &recvCycles);
+		mqResults.burstSendCycles = sendCycles;
+		mqResults.burstRecvCycles = recvCycles;
+		mqResults.minFreeHeap = xPortGetMinimumEverFreeHeapSize();
+
+		SEGGER_SYSVIEW_PrintfHost("mq prealloc:%u cycles/msg pair:%u send:%u receive:%u",
+									posixconfigMQ_PREALLOCATE,
+									mqResults.pairCycles,
+									mqResults.burstSendCycles,
+									mqResults.burstRecvCycles);
+		SEGGER_SYSVIEW_PrintfHost("mq heap used:%u min free heap:%u",
+									mqResults.heapUsed,
+									mqResults.minFreeHeap);
+		sleep(1);
+	}
+}
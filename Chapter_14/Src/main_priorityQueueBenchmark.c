@@ -0,0 +1,225 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2019 Brian Amos
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <Nucleo_F767ZI_Init.h>
+#include <Nucleo_F767ZI_GPIO.h>
+#include <RTOS_Dependencies.h>
+#include <SEGGER_SYSVIEW.h>
+#include <DWTCycleCounter.h>
+#include <queue.h>
+#include <cmsis_os2.h>
+
+// FreeRTOS POSIX includes
+#include <FreeRTOS_POSIX.h>
+#include <FreeRTOS_POSIX/pthread.h>
+#include <FreeRTOS_POSIX/mqueue.h>
+#include <FreeRTOS_POSIX/fcntl.h>
+#include <FreeRTOS_POSIX/unistd.h>
+
+/*********************************************
+ * Latency of an urgent message sent behind a full backlog of bulk messages
+ *
+ * Each round fills a queue with MAX_MSGS - 1 low priority messages, sends
+ * 1 high priority message and then drains the queue, spending WORK_CYCLES
+ * "processing" every message received.  The latency is the time from
+ * sending the urgent message until it has been received:
+ * 	fifo	- a plain FreeRTOS queue, the urgent message waits for the
+ * 			  whole backlog to be processed
+ * 	cmsis	- osMessageQueuePut/Get with msg_prio (CMSIS_MQ_PRIORITY=1)
+ * 	posix	- mq_send/mq_receive with msg_prio (posixconfigMQ_PRIORITY=1)
+ *
+ * The position (1 = first message received) and the average / worst case
+ * latency in CPU cycles are printed to SystemView once per second and are
+ * also available in prioResults
+ *********************************************/
+
+#define MSG_SIZE 16
+#define MAX_MSGS 16
+#define NUM_ROUNDS 100
+#define WORK_CYCLES 2000
+
+#define LOW_PRIORITY 0
+#define HIGH_PRIORITY 10
+
+void* benchmarkThread( void* NotUsed );
+
+typedef struct
+{
+	char text[MSG_SIZE - 4];
+	uint32_t urgent;
+}Message;
+
+typedef struct
+{
+	uint32_t position;		//where the urgent message was received
+	uint32_t avgCycles;
+	uint32_t maxCycles;
+}LatencyResult;
+
+typedef struct
+{
+	LatencyResult fifo;
+	LatencyResult cmsis;
+	LatencyResult posix;
+}PrioResults;
+
+volatile PrioResults prioResults;
+
+pthread_t benchmarkThreadId;
+
+static QueueHandle_t fifoQueue;
+static osMessageQueueId_t cmsisQueue;
+static mqd_t posixQueue;
+
+int main(void)
+{
+	int retVal;
+	HWInit();
+	CycleCounterInit();
+	SEGGER_SYSVIEW_Conf();
+
+	retVal = pthread_create( &benchmarkThreadId, NULL, benchmarkThread, NULL);
+	assert(retVal == 0);
+
+	vTaskStartScheduler();
+
+	//if you've wound up here, there is likely an issue with overrunning the freeRTOS heap
+	while(1)
+	{
+	}
+}
+
+/**
+ * stand-in for whatever the receiver does with each message
+ */
+static void processMessage( void )
+{
+	uint32_t start = CycleCount();
+	while(CycleCount() - start < WORK_CYCLES);
+}
+
+/**
+ * each API is wrapped so every measurement runs exactly the same loop
+ */
+static void fifoSend( const Message* Msg, uint32_t Priority )
+{
+	xQueueSend(fifoQueue, Msg, 0);
+}
+
+static void fifoReceive( Message* Msg )
+{
+	xQueueReceive(fifoQueue, Msg, 0);
+}
+
+static void cmsisSend( const Message* Msg, uint32_t Priority )
+{
+	osMessageQueuePut(cmsisQueue, Msg, Priority, 0);
+}
+
+static void cmsisReceive( Message* Msg )
+{
+	osMessageQueueGet(cmsisQueue, Msg, NULL, 0);
+}
+
+static void posixSend( const Message* Msg, uint32_t Priority )
+{
+	mq_send(posixQueue, (const char*)Msg, sizeof(Message), Priority);
+}
+
+static void posixReceive( Message* Msg )
+{
+	mq_receive(posixQueue, (char*)Msg, sizeof(Message), NULL);
+}
+
+static void measure( void (*Send)(const Message*, uint32_t), void (*Receive)(Message*),
+						volatile LatencyResult* Result )
+{
+	Message bulk = {.text = "bulk", .urgent = 0};
+	Message urgent = {.text = "urgent", .urgent = 1};
+	Message rx;
+	uint32_t total = 0, max = 0;
+
+	for(uint32_t round = 0; round < NUM_ROUNDS; round++)
+	{
+		for(uint32_t i = 0; i < MAX_MSGS - 1; i++)
+		{
+			Send(&bulk, LOW_PRIORITY);
+		}
+
+		uint32_t start = CycleCount();
+		uint32_t latency = 0;
+		Send(&urgent, HIGH_PRIORITY);
+
+		for(uint32_t i = 1; i <= MAX_MSGS; i++)
+		{
+			Receive(&rx);
+			if(rx.urgent)
+			{
+				latency = CycleCount() - start;
+				Result->position = i;
+			}
+			processMessage();
+		}
+
+		total += latency;
+		if(latency > max)
+		{
+			max = latency;
+		}
+	}
+	Result->avgCycles = total / NUM_ROUNDS;
+	Result->maxCycles = max;
+}
+
+static void printResult( const char* Name, volatile LatencyResult* Result )
+{
+	SEGGER_SYSVIEW_PrintfHost("%s urgent message received #%u, latency avg:%u max:%u cycles",
+								Name, Result->position, Result->avgCycles, Result->maxCycles);
+}
+
+void* benchmarkThread( void* NotUsed )
+{
+	struct mq_attr attr = { .mq_flags = 0, .mq_maxmsg = MAX_MSGS, .mq_msgsize = sizeof(Message), .mq_curmsgs = 0 };
+
+	fifoQueue = xQueueCreate(MAX_MSGS, sizeof(Message));
+	assert(fifoQueue != NULL);
+	cmsisQueue = osMessageQueueNew(MAX_MSGS, sizeof(Message), NULL);
+	assert(cmsisQueue != NULL);
+	//non-blocking, so a lost message can't hang the benchmark
+	posixQueue = mq_open("/prio", O_CREAT | O_RDWR | O_NONBLOCK, 0, &attr);
+	assert(posixQueue != (mqd_t) -1);
+
+	while(1)
+	{
+		measure(fifoSend, fifoReceive, &prioResults.fifo);
+		measure(cmsisSend, cmsisReceive, &prioResults.cmsis);
+		measure(posixSend, posixReceive, &prioResults.posix);
+
+		printResult("fifo", &prioResults.fifo);
+		printResult("cmsis", &prioResults.cmsis);
+		printResult("posix", &prioResults.posix);
+		sleep(1);
+	}
+}
@@ -0,0 +1,169 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2019 Brian Amos
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <Nucleo_F767ZI_Init.h>
+#include <Nucleo_F767ZI_GPIO.h>
+#include <RTOS_Dependencies.h>
+#include <SEGGER_SYSVIEW.h>
+
+// FreeRTOS POSIX includes
+#include <FreeRTOS_POSIX.h>
+#include <FreeRTOS_POSIX/pthread.h>
+#include <FreeRTOS_POSIX/mqueue.h>
+#include <FreeRTOS_POSIX/fcntl.h>
+#include <FreeRTOS_POSIX/time.h>
+#include <FreeRTOS_POSIX/unistd.h>
+
+/*********************************************
+ * A POSIX application that never touches the FreeRTOS heap
+ *
+ * 	threads	- pthread_attr_setstack, the thread object and TCB are
+ * 			  placed at the start of the stack buffer (xTaskCreateStatic)
+ * 	timer	- taken from the pool set by posixconfigTIMER_POOL_SIZE
+ * 	mqueue	- taken from the pool set by posixconfigMQ_POOL_SIZE
+ * 	mutex	- pthread_mutex_t already holds its FreeRTOS mutex
+ *
+ * The idle and timer tasks are static as well (configSUPPORT_STATIC_ALLOCATION,
+ * see vApplicationGetIdleTaskMemory in cmsis_os2.c).
+ *
+ * A periodic timer posts a message every second, the red thread
+ * receives it and toggles the red LED, the green thread blinks and
+ * checks that the heap is still untouched.  heap_4 only sets up its
+ * free list on the first pvPortMalloc, so xPortGetFreeHeapSize
+ * keeps returning 0 until something allocates from it.
+ *********************************************/
+
+#define STACK_SIZE 2048
+#define MSG_SIZE sizeof(uint32_t)
+
+void* GreenThread( void* NotUsed );
+void* RedThread( void* NotUsed );
+void timerExpired( union sigval NotUsed );
+
+static StackType_t greenStack[STACK_SIZE/sizeof(StackType_t)] __attribute__ ((aligned (portBYTE_ALIGNMENT)));
+static StackType_t redStack[STACK_SIZE/sizeof(StackType_t)] __attribute__ ((aligned (portBYTE_ALIGNMENT)));
+
+static pthread_mutex_t countMutex = PTHREAD_MUTEX_INITIALIZER;
+static uint32_t timerCount = 0;
+static mqd_t ledQueue;
+static timer_t ledTimer;
+
+pthread_t greenThreadId, redThreadId;
+
+int main(void)
+{
+	int retVal;
+	pthread_attr_t attr;
+	struct mq_attr queueAttr = { .mq_maxmsg = 4, .mq_msgsize = MSG_SIZE };
+	struct sigevent timerEvent = {	.sigev_notify = SIGEV_THREAD,
+									.sigev_notify_function = timerExpired,
+									.sigev_notify_attributes = NULL };
+	struct itimerspec period = {	.it_value = { .tv_sec = 1 },
+									.it_interval = { .tv_sec = 1 } };
+	HWInit();
+
+	ledQueue = mq_open("/ledQueue", O_CREAT | O_RDWR, 0, &queueAttr);
+	assert(ledQueue != (mqd_t)-1);
+
+	retVal = timer_create(CLOCK_REALTIME, &timerEvent, &ledTimer);
+	assert(retVal == 0);
+	retVal = timer_settime(ledTimer, 0, &period, NULL);
+	assert(retVal == 0);
+
+	pthread_attr_init(&attr);
+	retVal = pthread_attr_setstack(&attr, greenStack, sizeof(greenStack));
+	assert(retVal == 0);
+	retVal = pthread_create( &greenThreadId, &attr, GreenThread, NULL);
+	assert(retVal == 0);
+
+	retVal = pthread_attr_setstack(&attr, redStack, sizeof(redStack));
+	assert(retVal == 0);
+	retVal = pthread_create( &redThreadId, &attr, RedThread, NULL);
+	assert(retVal == 0);
+
+	//nothing above should have allocated from the heap
+	assert(xPortGetFreeHeapSize() == 0);
+
+	vTaskStartScheduler();
+
+	while(1)
+	{
+	}
+}
+
+/**
+ * runs in the timer task (no notify attributes, so no thread is created)
+ */
+void timerExpired( union sigval NotUsed )
+{
+	uint32_t count;
+
+	pthread_mutex_lock(&countMutex);
+	count = ++timerCount;
+	pthread_mutex_unlock(&countMutex);
+
+	//one message per second, the red thread never lets the queue fill
+	mq_send(ledQueue, (const char*)&count, MSG_SIZE, 0);
+}
+
+void* RedThread( void* NotUsed )
+{
+	uint32_t count;
+
+	while(1)
+	{
+		if(mq_receive(ledQueue, (char*)&count, MSG_SIZE, NULL) == MSG_SIZE)
+		{
+			if(count & 0x01)
+			{
+				RedLed.On();
+			}
+			else
+			{
+				RedLed.Off();
+			}
+		}
+	}
+}
+
+void* GreenThread( void* NotUsed )
+{
+	uint32_t count;
+
+	while(1)
+	{
+		GreenLed.On();
+		sleep(1);
+		GreenLed.Off();
+		sleep(1);
+
+		pthread_mutex_lock(&countMutex);
+		count = timerCount;
+		pthread_mutex_unlock(&countMutex);
+
+		SEGGER_SYSVIEW_PrintfHost("timer expirations:%u free heap:%u", count, xPortGetFreeHeapSize());
+		assert(xPortGetFreeHeapSize() == 0);
+	}
+}
@@ -155,6 +155,7 @@ standard names. */
 /* Section where parameter definitions can be added (for instance, to override default ones in FreeRTOS.h) */
 
 #include "SEGGER_SYSVIEW_FreeRTOS.h"
+#include "TraceHooksFreeRTOS.h"
 /* USER CODE END Defines */ 
 
 #endif /* FREERTOS_CONFIG_H */
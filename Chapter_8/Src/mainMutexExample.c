@@ -30,6 +30,8 @@
 #include <Nucleo_F767ZI_GPIO.h>
 #include <Nucleo_F767ZI_Init.h>
 #include <stm32f7xx_hal.h>
+#include <MutexProfiler.h>
+#include <SEGGER_RTT.h>
 
 // some common variables to use for each task
 // 128 * 4 = 512 bytes
@@ -42,6 +44,9 @@ static void lookBusy( uint32_t numIterations );
 void TaskA( void * argument);
 void TaskB( void* argumet );
 void TaskC( void* argumet );
+#if defined(MUTEX_PROFILER) && MUTEX_PROFILER == 1
+void ReportTask( void* argument );
+#endif
 
 //create storage for a pointer to a mutex (this is the same container as a semaphore)
 SemaphoreHandle_t mutexPtr = NULL;
@@ -55,10 +60,14 @@ int main(void)
 	//create a mutex - note this is just a special case of a binary semaphore
 	mutexPtr = xSemaphoreCreateMutex();
 	assert_param(mutexPtr != NULL);
+	MUTEX_PROFILER_REGISTER(mutexPtr, "mutexPtr");
 
 	assert_param(xTaskCreate(TaskA, "TaskA", STACK_SIZE, NULL, tskIDLE_PRIORITY + 3, NULL) == pdPASS);
 	assert_param(xTaskCreate(TaskB, "TaskB", STACK_SIZE, NULL, tskIDLE_PRIORITY + 2, NULL) == pdPASS);
 	assert_param(xTaskCreate(TaskC, "TaskC", STACK_SIZE, NULL, tskIDLE_PRIORITY + 1, NULL) == pdPASS);
+#if defined(MUTEX_PROFILER) && MUTEX_PROFILER == 1
+	assert_param(xTaskCreate(ReportTask, "Report", STACK_SIZE * 2, NULL, tskIDLE_PRIORITY, NULL) == pdPASS);
+#endif
 
 	//start the scheduler - shouldn't return unless there's a problem
 	vTaskStartScheduler();
@@ -143,6 +152,24 @@ void TaskC( void* argument )
 	}
 }
 
+#if defined(MUTEX_PROFILER) && MUTEX_PROFILER == 1
+/**
+ * print the contention/priority inversion report for mutexPtr
+ * to the RTT terminal every couple of seconds
+ * (runs at idle priority, so it doesn't disturb the other tasks)
+ */
+void ReportTask( void* argument )
+{
+	static char report[512];
+	while(1)
+	{
+		vTaskDelay(2000/portTICK_PERIOD_MS);
+		MutexProfilerReport(report, sizeof(report));
+		SEGGER_RTT_WriteString(0, report);
+	}
+}
+#endif
+
 /**
  * Blink the desired LED twice
  */
@@ -0,0 +1,187 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2019 Brian Amos
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <FreeRTOS.h>
+#include <task.h>
+#include <timers.h>
+#include <SEGGER_SYSVIEW.h>
+#include <SEGGER_RTT.h>
+#include <Nucleo_F767ZI_Init.h>
+#include <stm32f7xx_hal.h>
+#include <DWTCycleCounter.h>
+
+/*********************************************
+ * Software timer start/reset and expiry cost with thousands of timers
+ *
+ * Built twice:
+ * 	- timerListBenchmark: the standard sorted active timer list
+ * 	- timerWheelBenchmark: configUSE_TIMER_WHEEL=1 (hierarchical timing wheel)
+ *
+ * Reset: NUM_TIMERS one-shot "connection timeouts" with periods of 5-60
+ * seconds.  For each fill level, that many timers are started and then
+ * RESETS_PER_RUN random ones are reset.  benchmarkTask runs below the timer
+ * task, so every command is processed before xTimerReset returns and the
+ * cycles per reset include sending the command and the two context switches
+ * as well as placing the timer.  Only the cost of placing the timer depends
+ * on the number of active timers.
+ *
+ * Expiry: BURST_TIMERS timers are started against the same tick, so they all
+ * expire together.  The cycles from the first to the last callback are
+ * divided by the number of timers.
+ *
+ * Results are printed to the RTT terminal (channel 0).
+ *********************************************/
+
+#define STACK_SIZE 256
+#define NUM_TIMERS 2000
+#define RESETS_PER_RUN 500
+#define BURST_TIMERS 1000
+#define BURST_PERIOD_MS 1000
+
+void benchmarkTask( void* NotUsed );
+void timeoutCallback( TimerHandle_t xTimer );
+
+static StaticTimer_t timerBuffers[NUM_TIMERS];
+static TimerHandle_t timers[NUM_TIMERS];
+static const uint32_t fillLevels[] = { 100, 500, 1000, NUM_TIMERS };
+
+static volatile uint32_t expiredCount = 0;
+static volatile uint32_t firstExpiryCycles;
+static volatile uint32_t lastExpiryCycles;
+
+int main(void)
+{
+	HWInit();
+	CycleCounterInit();
+	SEGGER_SYSVIEW_Conf();
+	HAL_NVIC_SetPriorityGrouping(NVIC_PRIORITYGROUP_4);	//ensure proper priority grouping for freeRTOS
+
+	for(uint32_t i = 0; i < NUM_TIMERS; i++)
+	{
+		timers[i] = xTimerCreateStatic(	"timeout",
+										StmRand(5000, 55000) / portTICK_PERIOD_MS,
+										pdFALSE,
+										NULL,
+										timeoutCallback,
+										&timerBuffers[i]);
+		assert_param(timers[i] != NULL);
+	}
+
+	//below the timer task, so each command is processed as soon as it's sent
+	assert_param(xTaskCreate(benchmarkTask, "benchmark", STACK_SIZE, NULL, tskIDLE_PRIORITY + 1, NULL) == pdPASS);
+
+	//start the scheduler - shouldn't return unless there's a problem
+	vTaskStartScheduler();
+
+	//if you've wound up here, there is likely an issue with overrunning the freeRTOS heap
+	while(1)
+	{
+	}
+}
+
+void timeoutCallback( TimerHandle_t xTimer )
+{
+	const uint32_t now = CycleCount();
+
+	if(expiredCount++ == 0)
+	{
+		firstExpiryCycles = now;
+	}
+	lastExpiryCycles = now;
+}
+
+static void stopAll( void )
+{
+	for(uint32_t i = 0; i < NUM_TIMERS; i++)
+	{
+		assert_param(xTimerStop(timers[i], portMAX_DELAY) == pdPASS);
+	}
+}
+
+/**
+ * @returns average cycles per xTimerReset with NumActive timers running
+ */
+static uint32_t resetRun( uint32_t NumActive )
+{
+	stopAll();
+	for(uint32_t i = 0; i < NumActive; i++)
+	{
+		assert_param(xTimerStart(timers[i], portMAX_DELAY) == pdPASS);
+	}
+
+	const uint32_t start = CycleCount();
+	for(uint32_t i = 0; i < RESETS_PER_RUN; i++)
+	{
+		assert_param(xTimerReset(timers[StmRand(0, NumActive)], portMAX_DELAY) == pdPASS);
+	}
+	return (CycleCount() - start) / RESETS_PER_RUN;
+}
+
+/**
+ * @returns average cycles per expired timer when BURST_TIMERS expire together
+ */
+static uint32_t expiryRun( void )
+{
+	stopAll();
+	for(uint32_t i = 0; i < BURST_TIMERS; i++)
+	{
+		assert_param(xTimerChangePeriod(timers[i], BURST_PERIOD_MS / portTICK_PERIOD_MS, portMAX_DELAY) == pdPASS);
+	}
+
+	//restart them all relative to the same tick
+	const TickType_t base = xTaskGetTickCount();
+	expiredCount = 0;
+	for(uint32_t i = 0; i < BURST_TIMERS; i++)
+	{
+		assert_param(xTimerGenericCommand(timers[i], tmrCOMMAND_RESET, base, NULL, portMAX_DELAY) == pdPASS);
+	}
+
+	while(expiredCount < BURST_TIMERS)
+	{
+		vTaskDelay(BURST_PERIOD_MS / portTICK_PERIOD_MS);
+	}
+	return (lastExpiryCycles - firstExpiryCycles) / BURST_TIMERS;
+}
+
+void benchmarkTask( void* NotUsed )
+{
+	while(1)
+	{
+		SEGGER_RTT_printf(0, "%s\n", configUSE_TIMER_WHEEL ? "timer wheel" : "sorted timer list");
+		for(uint32_t i = 0; i < sizeof(fillLevels)/sizeof(fillLevels[0]); i++)
+		{
+			SEGGER_RTT_printf(0, "%5u active timers: %6u cycles per reset\n",
+								fillLevels[i], resetRun(fillLevels[i]));
+		}
+		SEGGER_RTT_printf(0, "%u timers expiring together: %u cycles per timer\n\n",
+							BURST_TIMERS, expiryRun());
+
+		//put the burst timers back to "connection timeout" periods
+		for(uint32_t i = 0; i < BURST_TIMERS; i++)
+		{
+			assert_param(xTimerChangePeriod(timers[i], StmRand(5000, 55000) / portTICK_PERIOD_MS, portMAX_DELAY) == pdPASS);
+		}
+	}
+}
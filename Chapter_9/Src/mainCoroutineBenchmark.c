@@ -0,0 +1,271 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2019 Brian Amos
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <FreeRTOS.h>
+#include <task.h>
+#include <queue.h>
+#include <SEGGER_SYSVIEW.h>
+#include <SEGGER_RTT.h>
+#include <Nucleo_F767ZI_Init.h>
+#include <stm32f7xx_hal.h>
+#include <DWTCycleCounter.h>
+#include <CoExecutor.h>
+
+/*********************************************
+ * Coroutines vs. tasks: RAM and switch cost
+ *
+ * RAM: NUM_RAM_TASKS parked tasks are created and the heap used per task
+ * (TCB + STACK_SIZE word stack + heap overhead) is compared with the RAM
+ * used by each of the NUM_STATE_MACHINES "blinker" coroutines (the
+ * Coroutine itself + its context).  The blinkers keep running on their own
+ * low priority executor, each delaying for a random period and counting
+ * how many times it woke up.
+ *
+ * Switch cost: control is passed back and forth ROUND_TRIPS times
+ * 	- between benchmarkTask and pongTask using task notifications
+ * 	  (2 context switches per round trip)
+ * 	- between pingCoroutine and pongCoroutine on the same executor using
+ * 	  CoNotify/CoNotifyWait (2 coroutine resumes per round trip)
+ * benchmarkTask starts pingCoroutine by sending the number of round trips to
+ * startQueue (a CoQueueReceive awaitable).
+ *
+ * Results are printed to the RTT terminal (channel 0).
+ *********************************************/
+
+#define STACK_SIZE 128
+#define EXECUTOR_STACK_SIZE 256
+#define NUM_RAM_TASKS 8
+#define NUM_STATE_MACHINES 200
+#define ROUND_TRIPS 10000
+
+typedef struct
+{
+	TickType_t period;
+	uint32_t count;
+}BlinkerState;
+
+typedef struct
+{
+	uint32_t roundTrips;
+	uint32_t i;
+	uint32_t start;
+	uint32_t cyclesPerRoundTrip;
+}PingState;
+
+void benchmarkTask( void* NotUsed );
+void pongTask( void* NotUsed );
+void parkedTask( void* NotUsed );
+void blinkerCoroutine( Coroutine* Co );
+void pingCoroutine( Coroutine* Co );
+void pongCoroutine( Coroutine* Co );
+
+static TaskHandle_t benchmarkTaskHandle = NULL;
+static TaskHandle_t pongTaskHandle = NULL;
+static QueueHandle_t startQueue = NULL;
+
+static CoExecutor pingPongExecutor;
+static CoExecutor blinkerExecutor;
+static Coroutine pingCo;
+static Coroutine pongCo;
+static PingState pingState;
+static Coroutine blinkers[NUM_STATE_MACHINES];
+static BlinkerState blinkerStates[NUM_STATE_MACHINES];
+
+int main(void)
+{
+	HWInit();
+	CycleCounterInit();
+	SEGGER_SYSVIEW_Conf();
+	HAL_NVIC_SetPriorityGrouping(NVIC_PRIORITYGROUP_4);	//ensure proper priority grouping for freeRTOS
+
+	startQueue = xQueueCreate(1, sizeof(uint32_t));
+	assert_param(startQueue != NULL);
+
+	//the blinkers can't preempt the measurements
+	CoExecutorInit(&blinkerExecutor, "blinkers", EXECUTOR_STACK_SIZE, tskIDLE_PRIORITY + 1);
+	for(uint32_t i = 0; i < NUM_STATE_MACHINES; i++)
+	{
+		blinkerStates[i].period = StmRand(10, 100) / portTICK_PERIOD_MS;
+		blinkerStates[i].count = 0;
+		CoStart(&blinkerExecutor, &blinkers[i], blinkerCoroutine, &blinkerStates[i]);
+	}
+
+	//pong runs at a higher priority than benchmarkTask in both cases
+	CoExecutorInit(&pingPongExecutor, "pingPong", EXECUTOR_STACK_SIZE, tskIDLE_PRIORITY + 3);
+	CoStart(&pingPongExecutor, &pingCo, pingCoroutine, &pingState);
+	CoStart(&pingPongExecutor, &pongCo, pongCoroutine, NULL);
+
+	assert_param(xTaskCreate(benchmarkTask, "benchmark", 256, NULL, tskIDLE_PRIORITY + 2, &benchmarkTaskHandle) == pdPASS);
+	assert_param(xTaskCreate(pongTask, "pong", STACK_SIZE, NULL, tskIDLE_PRIORITY + 3, &pongTaskHandle) == pdPASS);
+
+	//start the scheduler - shouldn't return unless there's a problem
+	vTaskStartScheduler();
+
+	//if you've wound up here, there is likely an issue with overrunning the freeRTOS heap
+	while(1)
+	{
+	}
+}
+
+/**
+ * a minimal state machine - wake up every period and count
+ */
+void blinkerCoroutine( Coroutine* Co )
+{
+	BlinkerState* state = Co->context;
+	BaseType_t result;
+
+	CO_BEGIN(Co);
+	while(1)
+	{
+		CO_AWAIT(Co, result, CoDelay(Co, state->period));
+		state->count += (result == pdPASS);
+	}
+	CO_END(Co);
+}
+
+/**
+ * wait for a number of round trips from benchmarkTask, then bounce
+ * notifications off pongCoroutine
+ */
+void pingCoroutine( Coroutine* Co )
+{
+	PingState* state = Co->context;
+	BaseType_t result;
+
+	CO_BEGIN(Co);
+	while(1)
+	{
+		CO_AWAIT(Co, result, CoQueueReceive(Co, startQueue, &state->roundTrips, portMAX_DELAY));
+		assert_param(result == pdPASS);
+
+		state->start = CycleCount();
+		for(state->i = 0; state->i < state->roundTrips; state->i++)
+		{
+			CoNotify(&pongCo, 1);
+			CO_AWAIT(Co, result, CoNotifyWait(Co, NULL, portMAX_DELAY));
+		}
+		state->cyclesPerRoundTrip = (CycleCount() - state->start) / state->roundTrips;
+
+		xTaskNotifyGive(benchmarkTaskHandle);
+	}
+	CO_END(Co);
+}
+
+void pongCoroutine( Coroutine* Co )
+{
+	BaseType_t result;
+
+	CO_BEGIN(Co);
+	while(1)
+	{
+		CO_AWAIT(Co, result, CoNotifyWait(Co, NULL, portMAX_DELAY));
+		if(result == pdPASS)
+		{
+			CoNotify(&pingCo, 1);
+		}
+	}
+	CO_END(Co);
+}
+
+void pongTask( void* NotUsed )
+{
+	while(1)
+	{
+		ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+		xTaskNotifyGive(benchmarkTaskHandle);
+	}
+}
+
+void parkedTask( void* NotUsed )
+{
+	while(1)
+	{
+		ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+	}
+}
+
+/**
+ * @returns heap used per task
+ */
+static uint32_t taskRam( void )
+{
+	const size_t freeBefore = xPortGetFreeHeapSize();
+	for(uint32_t i = 0; i < NUM_RAM_TASKS; i++)
+	{
+		assert_param(xTaskCreate(parkedTask, "parked", STACK_SIZE, NULL, tskIDLE_PRIORITY + 1, NULL) == pdPASS);
+	}
+	return (freeBefore - xPortGetFreeHeapSize()) / NUM_RAM_TASKS;
+}
+
+/**
+ * @returns average cycles per task round trip
+ */
+static uint32_t taskRun( void )
+{
+	const uint32_t start = CycleCount();
+	for(uint32_t i = 0; i < ROUND_TRIPS; i++)
+	{
+		xTaskNotifyGive(pongTaskHandle);
+		ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+	}
+	return (CycleCount() - start) / ROUND_TRIPS;
+}
+
+/**
+ * @returns average cycles per coroutine round trip
+ */
+static uint32_t coroutineRun( void )
+{
+	const uint32_t roundTrips = ROUND_TRIPS;
+
+	assert_param(xQueueSend(startQueue, &roundTrips, portMAX_DELAY) == pdPASS);
+	//queues don't know about the executor
+	CoExecutorWake(&pingPongExecutor);
+
+	ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+	return pingState.cyclesPerRoundTrip;
+}
+
+void benchmarkTask( void* NotUsed )
+{
+	const uint32_t bytesPerTask = taskRam();
+
+	while(1)
+	{
+		uint32_t wakeups = 0;
+		for(uint32_t i = 0; i < NUM_STATE_MACHINES; i++)
+		{
+			wakeups += blinkerStates[i].count;
+		}
+
+		SEGGER_RTT_printf(0, "RAM per task (%u word stack): %u bytes\n", STACK_SIZE, bytesPerTask);
+		SEGGER_RTT_printf(0, "RAM per coroutine:            %u bytes (%u state machines, %u wake ups)\n",
+							sizeof(Coroutine) + sizeof(BlinkerState), NUM_STATE_MACHINES, wakeups);
+		SEGGER_RTT_printf(0, "task round trip:      %5u cycles\n", taskRun());
+		SEGGER_RTT_printf(0, "coroutine round trip: %5u cycles\n\n", coroutineRun());
+		vTaskDelay(1000);
+	}
+}
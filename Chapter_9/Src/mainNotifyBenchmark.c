@@ -0,0 +1,174 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2019 Brian Amos
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <FreeRTOS.h>
+#include <task.h>
+#include <semphr.h>
+#include <SEGGER_SYSVIEW.h>
+#include <SEGGER_RTT.h>
+#include <Nucleo_F767ZI_Init.h>
+#include <stm32f7xx_hal.h>
+#include <DWTCycleCounter.h>
+#include <stdbool.h>
+
+/*********************************************
+ * Binary semaphores vs. indexed task notifications
+ *
+ * pingTask and pongTask hand control back and forth ROUND_TRIPS times,
+ * first using a pair of binary semaphores (xSemaphoreGive/xSemaphoreTake),
+ * then using task notifications at NOTIFY_INDEX
+ * (xTaskNotifyGiveIndexed/ulTaskNotifyTakeIndexed).  pongTask runs at a
+ * higher priority, so every give causes a context switch and the cycles per
+ * round trip include 2 gives, 2 takes and 2 context switches.
+ *
+ * NOTIFY_INDEX is deliberately not the default index (0), which is left free
+ * for stream buffers and the non-indexed API.  Before the benchmark starts,
+ * pingTask checks that a notification sent to index 0 doesn't satisfy a take
+ * on NOTIFY_INDEX.
+ *
+ * Results are printed to the RTT terminal (channel 0).
+ *********************************************/
+
+#define STACK_SIZE 256
+#define ROUND_TRIPS 10000
+#define NOTIFY_INDEX 1
+
+#if configTASK_NOTIFICATION_ARRAY_ENTRIES <= NOTIFY_INDEX
+	#error configTASK_NOTIFICATION_ARRAY_ENTRIES must be greater than NOTIFY_INDEX
+#endif
+
+void pingTask( void* NotUsed );
+void pongTask( void* NotUsed );
+
+static TaskHandle_t pingTaskHandle = NULL;
+static TaskHandle_t pongTaskHandle = NULL;
+static SemaphoreHandle_t pingSemPtr = NULL;
+static SemaphoreHandle_t pongSemPtr = NULL;
+
+//selects which mechanism pongTask waits on - only changed while pongTask
+//is blocked in the previous mode
+static volatile bool useNotifications = false;
+
+int main(void)
+{
+	HWInit();
+	CycleCounterInit();
+	SEGGER_SYSVIEW_Conf();
+	HAL_NVIC_SetPriorityGrouping(NVIC_PRIORITYGROUP_4);	//ensure proper priority grouping for freeRTOS
+
+	pingSemPtr = xSemaphoreCreateBinary();
+	pongSemPtr = xSemaphoreCreateBinary();
+	assert_param(pingSemPtr != NULL && pongSemPtr != NULL);
+
+	assert_param(xTaskCreate(pingTask, "ping", STACK_SIZE, NULL, tskIDLE_PRIORITY + 1, &pingTaskHandle) == pdPASS);
+	assert_param(xTaskCreate(pongTask, "pong", STACK_SIZE, NULL, tskIDLE_PRIORITY + 2, &pongTaskHandle) == pdPASS);
+
+	//start the scheduler - shouldn't return unless there's a problem
+	vTaskStartScheduler();
+
+	//if you've wound up here, there is likely an issue with overrunning the freeRTOS heap
+	while(1)
+	{
+	}
+}
+
+/**
+ * returns every "ping" with a "pong", using whichever mechanism
+ * is currently selected
+ */
+void pongTask( void* NotUsed )
+{
+	while(1)
+	{
+		if(useNotifications)
+		{
+			ulTaskNotifyTakeIndexed(NOTIFY_INDEX, pdTRUE, portMAX_DELAY);
+			xTaskNotifyGiveIndexed(pingTaskHandle, NOTIFY_INDEX);
+		}
+		else
+		{
+			xSemaphoreTake(pongSemPtr, portMAX_DELAY);
+			xSemaphoreGive(pingSemPtr);
+		}
+	}
+}
+
+/**
+ * @returns average cycles per round trip using binary semaphores
+ */
+static uint32_t semaphoreRun( void )
+{
+	const uint32_t start = CycleCount();
+	for(uint32_t i = 0; i < ROUND_TRIPS; i++)
+	{
+		xSemaphoreGive(pongSemPtr);
+		xSemaphoreTake(pingSemPtr, portMAX_DELAY);
+	}
+	return (CycleCount() - start) / ROUND_TRIPS;
+}
+
+/**
+ * @returns average cycles per round trip using task notifications at NOTIFY_INDEX
+ */
+static uint32_t notificationRun( void )
+{
+	const uint32_t start = CycleCount();
+	for(uint32_t i = 0; i < ROUND_TRIPS; i++)
+	{
+		xTaskNotifyGiveIndexed(pongTaskHandle, NOTIFY_INDEX);
+		ulTaskNotifyTakeIndexed(NOTIFY_INDEX, pdTRUE, portMAX_DELAY);
+	}
+	return (CycleCount() - start) / ROUND_TRIPS;
+}
+
+void pingTask( void* NotUsed )
+{
+	//a notification on the default index is independent of NOTIFY_INDEX
+	xTaskNotifyGive(xTaskGetCurrentTaskHandle());
+	assert_param(ulTaskNotifyTakeIndexed(NOTIFY_INDEX, pdTRUE, 0) == 0);
+	assert_param(ulTaskNotifyTake(pdTRUE, 0) == 1);
+
+	while(1)
+	{
+		//pongTask is waiting on pongSemPtr
+		useNotifications = false;
+		const uint32_t semCycles = semaphoreRun();
+
+		//switch pongTask over: its next iteration waits on NOTIFY_INDEX
+		useNotifications = true;
+		xSemaphoreGive(pongSemPtr);
+		xSemaphoreTake(pingSemPtr, portMAX_DELAY);
+		const uint32_t notifyCycles = notificationRun();
+
+		//and back again
+		useNotifications = false;
+		xTaskNotifyGiveIndexed(pongTaskHandle, NOTIFY_INDEX);
+		ulTaskNotifyTakeIndexed(NOTIFY_INDEX, pdTRUE, portMAX_DELAY);
+
+		SEGGER_RTT_printf(0, "binary semaphores:    %5u cycles per round trip\n", semCycles);
+		SEGGER_RTT_printf(0, "task notification %u: %5u cycles per round trip\n\n", NOTIFY_INDEX, notifyCycles);
+		vTaskDelay(1000);
+	}
+}
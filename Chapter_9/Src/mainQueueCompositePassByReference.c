@@ -25,6 +25,7 @@
 
 #include <FreeRTOS.h>
 #include <Nucleo_F767ZI_GPIO.h>
+#include <iLedGroup.h>
 #include <queue.h>
 #include <SEGGER_SYSVIEW.h>
 #include <Nucleo_F767ZI_Init.h>
@@ -79,6 +80,10 @@ void sendingTask( void* NotUsed );
 //recvTask and sendingTask
 static QueueHandle_t ledCmdQueue = NULL;
 
+//all 3 LED's are updated with a single register write, so they
+//always change state at the same instant
+static iLedGroup leds = ILEDGROUP_STATIC(NucleoLeds);
+
 int main(void)
 {
 	HWInit();
@@ -120,20 +125,15 @@ void recvTask( void* NotUsed )
 	{
 		if(xQueueReceive(ledCmdQueue, &nextCmd, portMAX_DELAY) == pdTRUE)
 		{
+			uint32_t onLeds = 0;
 			if(nextCmd->redLEDState == 1)
-				RedLed.On();
-			else
-				RedLed.Off();
-
+				onLeds |= RedLedMask;
 			if(nextCmd->blueLEDState == 1)
-				BlueLed.On();
-			else
-				BlueLed.Off();
-
+				onLeds |= BlueLedMask;
 			if(nextCmd->greenLEDState == 1)
-				GreenLed.On();
-			else
-				GreenLed.Off();
+				onLeds |= GreenLedMask;
+
+			leds.Write(onLeds, AllLedsMask & ~onLeds);
 		}
 
 		vTaskDelay(nextCmd->msDelayTime/portTICK_PERIOD_MS);
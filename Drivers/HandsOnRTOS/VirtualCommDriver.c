@@ -30,6 +30,7 @@
 #include <stream_buffer.h>
 #include <task.h>
 #include <SEGGER_SYSVIEW.h>
+#include <TraceModule.h>
 
 
 /******************************** NOTE *****************************/
@@ -42,6 +43,14 @@
  */
 #define txBuffLen 2048
 #define rxBuffLen 2048
+
+//the stream buffer API blocks on the default (index 0) task notification,
+//so transmit complete notifications are sent to their own index
+#if configTASK_NOTIFICATION_ARRAY_ENTRIES > 1
+	#define TX_COMPLETE_NOTIFY_INDEX 1
+#else
+	#define TX_COMPLETE_NOTIFY_INDEX tskDEFAULT_INDEX_TO_NOTIFY
+#endif
 static uint8_t usbTxBuff[txBuffLen];
 static StreamBufferHandle_t txStream = NULL;
 static TaskHandle_t usbTaskHandle = NULL;
@@ -55,6 +64,9 @@ extern USBD_HandleTypeDef hUsbDeviceFS;
 void usbTask( void* NotUsed);
 void usbTxComplete( void );
 
+//transmit progress is traced at INFO, set TRACE_LEVEL_MAX below that to remove it
+TRACE_MODULE_DEFINE(vcomTrace, "M=VirtualComm", 0);
+
 /********************************** PUBLIC *************************************/
 
 /**
@@ -64,6 +76,7 @@ void usbTxComplete( void );
 **/
 void VirtualCommInit( void )
 {
+	TRACE_MODULE_REGISTER(vcomTrace);
 	MX_USB_DEVICE_Init();
 	txStream = xStreamBufferCreate( txBuffLen, 1);
 	vcom_rxStream  = xStreamBufferCreate( rxBuffLen, 1);
@@ -146,9 +159,9 @@ void usbTask( void* NotUsed)
 	{
 		//if there is no TX in progress, immediately send a task notification
 		//to kick things off
-		xTaskNotify( usbTaskHandle, 1, eSetValueWithOverwrite);
+		xTaskNotifyIndexed( usbTaskHandle, TX_COMPLETE_NOTIFY_INDEX, 1, eSetValueWithOverwrite);
 	}
-	ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+	ulTaskNotifyTakeIndexed( TX_COMPLETE_NOTIFY_INDEX, pdTRUE, portMAX_DELAY );
 
 	//setup our own callback to be called when transmission is complete
 	hcdc->TxCallBack = usbTxComplete;
@@ -159,7 +172,7 @@ void usbTask( void* NotUsed)
 
 	while(1)
 	{
-		SEGGER_SYSVIEW_PrintfHost("waiting for txStream");
+		TRACE_INFO(vcomTrace, "waiting for txStream");
 		//wait forever for data to become available in the stream buffer
 		//txStream.  up to txBuffLen bytes of data will be copied into
 		//usbTxBuff when at least 1 byte is available
@@ -169,12 +182,12 @@ void usbTask( void* NotUsed)
 													portMAX_DELAY);
 		if(numBytes > 0)
 		{
-			SEGGER_SYSVIEW_PrintfHost("pulled %d bytes from txStream", numBytes);
+			TRACE_INFO(vcomTrace, "pulled %d bytes from txStream", numBytes);
 			USBD_CDC_SetTxBuffer(&hUsbDeviceFS, usbTxBuff, numBytes);
 			USBD_CDC_TransmitPacket(&hUsbDeviceFS);
 			//wait forever for a notification, clearing it to 0 when received
-			ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
-			SEGGER_SYSVIEW_PrintfHost("tx complete");
+			ulTaskNotifyTakeIndexed( TX_COMPLETE_NOTIFY_INDEX, pdTRUE, portMAX_DELAY );
+			TRACE_INFO(vcomTrace, "tx complete");
 		}
 	}
 }
@@ -182,6 +195,6 @@ void usbTask( void* NotUsed)
 void usbTxComplete( void )
 {
 	portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
-	xTaskNotifyFromISR( usbTaskHandle, 1, eSetValueWithOverwrite, &xHigherPriorityTaskWoken);
+	xTaskNotifyIndexedFromISR( usbTaskHandle, TX_COMPLETE_NOTIFY_INDEX, 1, eSetValueWithOverwrite, &xHigherPriorityTaskWoken);
 	portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
 }
@@ -29,6 +29,8 @@
 #include <task.h>
 #include <semphr.h>
 #include <SEGGER_SYSVIEW.h>
+#include <MutexProfiler.h>
+#include <QueueTelemetry.h>
 
 /**
  * txBuffLen and rxBuffLen should be at least as large as the lengths defined in usbd_cdc_if.c
@@ -42,12 +44,34 @@
 #define txBuffLen 1024
 #define rxBuffLen 1024
 
-uint8_t vcom_usbTxBuff[txBuffLen];
+/**
+ * VCOM_TRACE_TX enables SystemView messages for every USB transfer.
+ * Builds streaming SystemView data over this port set it to 0, otherwise
+ * each transfer would generate more trace data to transfer
+ **/
+#ifndef VCOM_TRACE_TX
+#define VCOM_TRACE_TX 1
+#endif
+
+/**
+ * the stream buffer API blocks on the default (index 0) task notification,
+ * so transmit complete notifications are sent to their own index.  This keeps
+ * a stale "tx complete" from being mistaken for stream buffer activity (and
+ * vice versa)
+ **/
+#if configTASK_NOTIFICATION_ARRAY_ENTRIES > 1
+	#define TX_COMPLETE_NOTIFY_INDEX 1
+#else
+	#define TX_COMPLETE_NOTIFY_INDEX tskDEFAULT_INDEX_TO_NOTIFY
+#endif
+
 StreamBufferHandle_t vcom_rxStream = NULL;
 StreamBufferHandle_t vcom_txStream = NULL;
 TaskHandle_t vcom_usbTaskHandle = NULL;
 SemaphoreHandle_t vcom_mutexPtr = NULL;
 
+WakeLatencyPath VcomTxLatency = WAKE_LATENCY_PATH_INIT("usb tx complete");
+
 
 //hUsbDeviceFS defined in usb_device.c
 extern USBD_HandleTypeDef hUsbDeviceFS;
@@ -73,10 +97,16 @@ void VirtualCommInit(	const configSTACK_DEPTH_TYPE UsbStackSize,
 	vcom_rxStream  = xStreamBufferCreate( rxBuffLen, 1);
 	assert_param( vcom_txStream != NULL);
 	assert_param( vcom_rxStream != NULL);
+	QUEUE_TELEMETRY_REGISTER_STREAM(vcom_txStream, "vcom tx");
+	QUEUE_TELEMETRY_REGISTER_STREAM(vcom_rxStream, "vcom rx");
 
 	vcom_mutexPtr = xSemaphoreCreateMutex();
 	assert_param(vcom_mutexPtr != NULL);
+	MUTEX_PROFILER_REGISTER(vcom_mutexPtr, "vcom");
 	assert_param(xTaskCreate(usbTxTask, "usbTx", UsbStackSize, NULL, UsbTxPriority, &vcom_usbTaskHandle) == pdPASS);
+
+	WakeLatencyRegister(&VcomTxLatency);
+	WakeLatencyRegister(&VcomRxLatency);
 }
 
 /**
@@ -136,8 +166,11 @@ int32_t TransmitUsbData(uint8_t const*  Buff, uint16_t Len, int32_t DelayMs)
  * This function waits for a task notification, which is sent by a callback generated
  * from the USB stack upon completion of a transmission
  *
- * It then then copies up to 2KB of data from the stream buffer to a
- * local buffer, which is passed to the HAL USB stack.
+ * The data is handed to the HAL USB stack directly from the stream buffer's
+ * storage (no intermediate copy).  It is only removed from vcom_txStream once
+ * the transfer has completed, so TransmitUsbData can't overwrite it while
+ * it is being sent.  Data that wraps around the end of the stream buffer is
+ * sent by the next iteration.
  *
  */
 void usbTxTask( void* NotUsed)
@@ -153,9 +186,9 @@ void usbTxTask( void* NotUsed)
 	{
 		//if there is no TX in progress, immediately send a task notification
 		//to kick things off
-		xTaskNotify( vcom_usbTaskHandle, 1, eSetValueWithOverwrite);
+		xTaskNotifyIndexed( vcom_usbTaskHandle, TX_COMPLETE_NOTIFY_INDEX, 1, eSetValueWithOverwrite);
 	}
-	ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+	ulTaskNotifyTakeIndexed( TX_COMPLETE_NOTIFY_INDEX, pdTRUE, portMAX_DELAY );
 
 	//setup our own callback to be called when transmission is complete
 	hcdc->TxCallBack = usbTxComplete;
@@ -166,29 +199,39 @@ void usbTxTask( void* NotUsed)
 
 	while(1)
 	{
+#if VCOM_TRACE_TX
 		SEGGER_SYSVIEW_PrintfHost("waiting for vcom_txStream");
+#endif
 		//wait forever for data to become available in the stream buffer
-		//vcom_txStream.  up to txBuffLen bytes of data will be copied into
-		//vcom_usbTxBuff when at least 1 byte is available
-		uint8_t numBytes = xStreamBufferReceive(	vcom_txStream,
-													vcom_usbTxBuff,
-													txBuffLen,
-													portMAX_DELAY);
-		if(numBytes > 0)
+		//vcom_txStream.  spans point directly into its storage area
+		StreamBufferSpan_t spans[2];
+		if(xStreamBufferReceiveAcquire(vcom_txStream, spans, portMAX_DELAY) > 0)
 		{
-			SEGGER_SYSVIEW_PrintfHost("pulled %d bytes from vcom_txStream", numBytes);
-			USBD_CDC_SetTxBuffer(&hUsbDeviceFS, vcom_usbTxBuff, numBytes);
+			uint16_t numBytes = spans[0].xLength;
+#if VCOM_TRACE_TX
+			SEGGER_SYSVIEW_PrintfHost("sending %u bytes from vcom_txStream", numBytes);
+#endif
+			USBD_CDC_SetTxBuffer(&hUsbDeviceFS, spans[0].pucData, numBytes);
 			USBD_CDC_TransmitPacket(&hUsbDeviceFS);
 			//wait forever for a notification, clearing it to 0 when received
-			ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+			ulTaskNotifyTakeIndexed( TX_COMPLETE_NOTIFY_INDEX, pdTRUE, portMAX_DELAY );
+			WakeLatencyResumed(&VcomTxLatency);
+			//the USB stack is done with the data, release the space
+			xStreamBufferReceiveCommit(vcom_txStream, numBytes);
+#if VCOM_TRACE_TX
 			SEGGER_SYSVIEW_PrintfHost("tx complete");
+#endif
 		}
 	}
 }
 
 void usbTxComplete( void )
 {
+	//called from within HAL_PCD_IRQHandler, so this stamp doesn't include
+	//the time spent in the HAL before the callback
+	uint32_t isrEntry = WakeLatencyIsrEntry();
 	portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
-	xTaskNotifyFromISR( vcom_usbTaskHandle, 1, eSetValueWithOverwrite, &xHigherPriorityTaskWoken);
+	xTaskNotifyIndexedFromISR( vcom_usbTaskHandle, TX_COMPLETE_NOTIFY_INDEX, 1, eSetValueWithOverwrite, &xHigherPriorityTaskWoken);
+	WakeLatencyWake(&VcomTxLatency, isrEntry);
 	portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
 }
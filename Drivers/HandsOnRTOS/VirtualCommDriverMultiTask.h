@@ -31,6 +31,7 @@
 #include <stdint.h>
 #include <FreeRTOS.h>
 #include <stream_buffer.h>
+#include <WakeLatency.h>
 
 void VirtualCommInit(	const configSTACK_DEPTH_TYPE UsbStackSize,
  						UBaseType_t UsbTxPriority );
@@ -39,6 +40,17 @@ StreamBufferHandle_t const* GetUsbRxStreamBuff( void );
 
 int32_t TransmitUsbData(uint8_t const*  Buff, uint16_t Len, int32_t DelayMs);
 
+/**
+ * wake-up latency of the USB paths (see WakeLatency.h)
+ * VcomTxLatency:	transmit complete callback -> usbTx task
+ * VcomRxLatency:	data received callback -> the task reading from
+ * 					GetUsbRxStreamBuff, which should call
+ * 					WakeLatencyResumed(&VcomRxLatency) after each read
+ * 					(defined in usbd_cdc_if.c, registered by VirtualCommInit)
+ */
+extern WakeLatencyPath VcomTxLatency;
+extern WakeLatencyPath VcomRxLatency;
+
 #ifdef __cplusplus
  }
 #endif
@@ -121,6 +121,9 @@ uint8_t UserTxBufferFS[APP_TX_DATA_SIZE];
 extern USBD_HandleTypeDef hUsbDeviceFS;
 
 /* USER CODE BEGIN EXPORTED_VARIABLES */
+//stamped by CDC_Receive_FS, so it's defined here where both
+//VirtualCommDriver.c and VirtualCommDriverMultiTask.c builds can see it
+WakeLatencyPath VcomRxLatency = WAKE_LATENCY_PATH_INIT("usb rx");
 
 /* USER CODE END EXPORTED_VARIABLES */
 
@@ -271,6 +274,7 @@ static int8_t CDC_Control_FS(uint8_t cmd, uint8_t* pbuf, uint16_t length)
 static int8_t CDC_Receive_FS(uint8_t* Buf, uint32_t *Len)
 {
 	/* USER CODE BEGIN 6 */
+	uint32_t isrEntry = WakeLatencyIsrEntry();
 	portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
 
 	USBD_CDC_SetRxBuffer(&hUsbDeviceFS, &Buf[0]);
@@ -278,6 +282,7 @@ static int8_t CDC_Receive_FS(uint8_t* Buf, uint32_t *Len)
 								Buf,
 								*Len,
 								&xHigherPriorityTaskWoken);
+	WakeLatencyWake(&VcomRxLatency, isrEntry);
 
 	USBD_CDC_ReceivePacket(&hUsbDeviceFS);
 	portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
@@ -50,6 +50,22 @@ typedef struct
 	const iLedFunc Off;
 }iLed;
 
+/**
+ * Compile-time alternative to iLed
+ *
+ * An LED implementation may also provide static inline functions named
+ * <Instance>On and <Instance>Off (for example RedLedOn/RedLedOff for RedLed).
+ * LED_ON(RedLed) then resolves to a direct call the compiler can inline,
+ * instead of an indirect call through RedLed.On
+ *
+ * ILED_STATIC builds a runtime iLed from the same functions, for code that
+ * needs to stay independent of the implementation:
+ * 	iLed RedLed = ILED_STATIC(RedLed);
+ */
+#define LED_ON(Instance)		Instance##On()
+#define LED_OFF(Instance)		Instance##Off()
+#define ILED_STATIC(Instance)	{ .On = Instance##On, .Off = Instance##Off }
+
 
 #ifdef __cplusplus
  }
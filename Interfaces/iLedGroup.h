@@ -0,0 +1,76 @@
+/**
+ * MIT License
+ * 
+ * Copyright (c) 2019 Brian Amos
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#ifndef INTERFACES_ILEDGROUP_H_
+#define INTERFACES_ILEDGROUP_H_
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+#include <stdint.h>
+
+//Create typedefs defining function pointers that operate on
+//a set of LED's (one bit per LED, defined by the implementation)
+typedef void (*iLedGroupFunc)(uint32_t Leds);
+typedef void (*iLedGroupWriteFunc)(uint32_t OnLeds, uint32_t OffLeds);
+
+/**
+ * This struct definition holds function pointers to change several
+ * LED's at once.  Implementations guarantee that every LED changed by
+ * a single call changes at the same instant
+ */
+typedef struct
+{
+	/**
+	 * On turns on every LED in Leds, the others are left untouched
+	 */
+	const iLedGroupFunc On;
+
+	/**
+	 * Off turns off every LED in Leds, the others are left untouched
+	 */
+	const iLedGroupFunc Off;
+
+	/**
+	 * Write turns on every LED in OnLeds and turns off every LED in OffLeds
+	 * as a single update
+	 */
+	const iLedGroupWriteFunc Write;
+}iLedGroup;
+
+/**
+ * Compile-time alternative to iLedGroup (see LED_ON in iLed.h)
+ * An implementation provides static inline functions named <Instance>On,
+ * <Instance>Off and <Instance>Write
+ */
+#define LED_GROUP_ON(Instance, Leds)					Instance##On(Leds)
+#define LED_GROUP_OFF(Instance, Leds)					Instance##Off(Leds)
+#define LED_GROUP_WRITE(Instance, OnLeds, OffLeds)	Instance##Write(OnLeds, OffLeds)
+#define ILEDGROUP_STATIC(Instance)	{ .On = Instance##On, .Off = Instance##Off, .Write = Instance##Write }
+
+
+#ifdef __cplusplus
+ }
+#endif
+#endif /* INTERFACES_ILEDGROUP_H_ */
@@ -67,6 +67,7 @@
     typedef struct pthread_attr
     {
         uint32_t ulpthreadAttrStorage;
+        void * pvpthreadAttrStackAddr;
     } PthreadAttrType_t;
 #else
     typedef void                       * PthreadAttrType_t;
@@ -60,6 +60,37 @@
 #ifndef posixconfigMQ_MAX_SIZE
     #define posixconfigMQ_MAX_SIZE    128 /**< Maximum size (in bytes) of each message. */
 #endif
+
+/* When 1, mq_open allocates storage for mq_maxmsg messages of mq_msgsize bytes
+ * up front. mq_send copies straight into a free slot and neither mq_send nor
+ * mq_receive touch the heap or the global queue list mutex.
+ * When 0, every message is allocated by mq_send and freed by mq_receive. */
+#ifndef posixconfigMQ_PREALLOCATE
+    #define posixconfigMQ_PREALLOCATE    1 /**< Preallocate message storage in mq_open. */
+#endif
+
+/* When 1, msg_prio is honored - the highest priority message is received
+ * first, messages of the same priority in the order they were sent (see
+ * PriorityMessageQueue.h, priorities above 31 are treated as 31).
+ * When 0, msg_prio is ignored and messages are received in the order they
+ * were sent. Requires posixconfigMQ_PREALLOCATE. */
+#ifndef posixconfigMQ_PRIORITY
+    #define posixconfigMQ_PRIORITY    0 /**< Receive messages in msg_prio order. */
+#endif
+
+/* When non-zero, mq_open takes queues from a static pool of this many entries
+ * instead of the heap. Each entry has room for posixconfigMQ_MAX_MESSAGES
+ * messages of posixconfigMQ_MAX_SIZE bytes, mq_open fails with ENOSPC for
+ * queues that need more storage. Requires posixconfigMQ_PREALLOCATE. */
+#ifndef posixconfigMQ_POOL_SIZE
+    #define posixconfigMQ_POOL_SIZE    0 /**< Number of statically allocated message queues. */
+#endif
+
+/* When non-zero, timer_create takes timers from a static pool of this many
+ * entries instead of the heap and fails with EAGAIN once they're all in use. */
+#ifndef posixconfigTIMER_POOL_SIZE
+    #define posixconfigTIMER_POOL_SIZE    0 /**< Number of statically allocated timers. */
+#endif
 /**@} */
 
 /**
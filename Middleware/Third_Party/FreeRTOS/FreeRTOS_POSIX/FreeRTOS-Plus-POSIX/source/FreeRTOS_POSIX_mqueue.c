@@ -38,14 +38,76 @@
 #include "FreeRTOS_POSIX/mqueue.h"
 #include "FreeRTOS_POSIX/utils.h"
 
+#if ( posixconfigMQ_PREALLOCATE == 1 ) && ( posixconfigMQ_PRIORITY == 1 )
+    #include "PriorityMessageQueue.h"
+#endif
+
+#if ( posixconfigMQ_PRIORITY == 1 ) && ( posixconfigMQ_PREALLOCATE != 1 )
+    #error "posixconfigMQ_PRIORITY requires posixconfigMQ_PREALLOCATE"
+#endif
+
+#if ( posixconfigMQ_PREALLOCATE == 1 )
+
+    #if ( configSUPPORT_STATIC_ALLOCATION != 1 )
+        #error "posixconfigMQ_PREALLOCATE requires configSUPPORT_STATIC_ALLOCATION"
+    #endif
+
+/**
+ * @brief Preallocated storage for one message.
+ *
+ * mq_open allocates mq_maxmsg slots. Pointers to the slots circulate between
+ * the free slot queue and the message queue, so only a pointer is copied by
+ * the FreeRTOS queues and message data is copied exactly once each way.
+ */
+    typedef struct MessageSlot
+    {
+        size_t xDataSize; /**< Size of the message in pcData. */
+        char pcData[];    /**< mq_msgsize bytes of message data. */
+    } MessageSlot_t;
+
+/**
+ * @brief Size of a slot holding xMsgSize bytes, keeping every slot aligned
+ * for its xDataSize member.
+ */
+    #define mqSLOT_SIZE( xMsgSize ) \
+    ( ( sizeof( MessageSlot_t ) + ( xMsgSize ) + sizeof( size_t ) - 1 ) & ~( sizeof( size_t ) - 1 ) )
+
+/**
+ * @brief Storage used by the message queue for xMaxMessages slot pointers.
+ */
+    #if ( posixconfigMQ_PRIORITY == 1 )
+        #define mqQUEUE_STORAGE_SIZE( xMaxMessages )    PMQ_STORAGE_SIZE( xMaxMessages, sizeof( MessageSlot_t * ) )
+    #else
+        #define mqQUEUE_STORAGE_SIZE( xMaxMessages )    ( ( xMaxMessages ) * sizeof( MessageSlot_t * ) )
+    #endif
+
+/**
+ * @brief Storage mq_open allocates after the queue element (excluding the
+ * name): the message queue's and the free slot queue's storage, then the
+ * slots themselves.
+ */
+    #define mqSTORAGE_SIZE( xMaxMessages, xMsgSize )                 \
+    ( mqQUEUE_STORAGE_SIZE( xMaxMessages ) +                         \
+      ( xMaxMessages ) * sizeof( MessageSlot_t * ) +                 \
+      ( xMaxMessages ) * mqSLOT_SIZE( xMsgSize ) )
+
+/**
+ * @brief Value of QueueListElement_t.ulMagic while a queue exists.
+ */
+    #define mqMAGIC    ( 0x4D515545UL )
+
+#else
+
 /**
  * @brief Element of the FreeRTOS queues that store mq data.
  */
-typedef struct QueueElement
-{
-    char * pcData;    /**< Data in queue. Type char* to match msg_ptr. */
-    size_t xDataSize; /**< Size of data pointed by pcData. */
-} QueueElement_t;
+    typedef struct QueueElement
+    {
+        char * pcData;    /**< Data in queue. Type char* to match msg_ptr. */
+        size_t xDataSize; /**< Size of data pointed by pcData. */
+    } QueueElement_t;
+
+#endif /* posixconfigMQ_PREALLOCATE */
 
 /**
  * @brief Data structure of an mq.
@@ -56,13 +118,53 @@ typedef struct QueueElement
 typedef struct QueueListElement
 {
     Link_t xLink;              /**< Pointer to the next element in the list. */
-    QueueHandle_t xQueue;      /**< FreeRTOS queue handle. */
+    #if ( posixconfigMQ_PRIORITY == 1 )
+        PriorityMessageQueue xQueue; /**< Filled slots, highest msg_prio first. */
+    #else
+        QueueHandle_t xQueue;        /**< FreeRTOS queue handle. */
+    #endif
+    #if ( posixconfigMQ_PREALLOCATE == 1 )
+        #if ( posixconfigMQ_PRIORITY == 0 )
+            StaticQueue_t xQueueBuffer; /**< xQueue's control block. */
+        #endif
+        QueueHandle_t xFreeSlots;         /**< Slots mq_send can copy into. */
+        StaticQueue_t xFreeSlotsBuffer;   /**< xFreeSlots' control block. */
+        uint32_t ulMagic;                 /**< mqMAGIC while the queue exists. */
+    #endif
     size_t xOpenDescriptors;   /**< Number of threads that have opened this queue. */
     char * pcName;             /**< Null-terminated queue name. */
     struct mq_attr xAttr;      /**< Queue attibutes. */
     BaseType_t xPendingUnlink; /**< If pdTRUE, this queue will be unlinked once all descriptors close. */
 } QueueListElement_t;
 
+#if ( posixconfigMQ_POOL_SIZE > 0 )
+
+    #if ( posixconfigMQ_PREALLOCATE != 1 )
+        #error "posixconfigMQ_POOL_SIZE requires posixconfigMQ_PREALLOCATE"
+    #endif
+
+/**
+ * @brief Statically allocated queue, laid out the same way as the heap
+ * allocation in prvCreateNewMessageQueue.
+ */
+    typedef struct QueuePoolEntry
+    {
+        QueueListElement_t xElement; /**< The queue. */
+        char cStorage[ mqSTORAGE_SIZE( posixconfigMQ_MAX_MESSAGES, posixconfigMQ_MAX_SIZE ) + NAME_MAX + 1 ]; /**< Messages and name. */
+    } QueuePoolEntry_t;
+
+/**
+ * @brief Queues handed out by mq_open.
+ */
+    static QueuePoolEntry_t xQueuePool[ posixconfigMQ_POOL_SIZE ];
+
+/**
+ * @brief pdTRUE for every entry of xQueuePool that's in use.
+ */
+    static BaseType_t xQueuePoolInUse[ posixconfigMQ_POOL_SIZE ];
+
+#endif /* if ( posixconfigMQ_POOL_SIZE > 0 ) */
+
 /*-----------------------------------------------------------*/
 
 /**
@@ -104,6 +206,29 @@ static BaseType_t prvCreateNewMessageQueue( QueueListElement_t ** ppxMessageQueu
  */
 static void prvDeleteMessageQueue( const QueueListElement_t * const pxMessageQueue );
 
+#if ( posixconfigMQ_PREALLOCATE == 1 )
+
+/**
+ * @brief Get memory for a queue element, its message storage and its name.
+ *
+ * @param[in] xSize Number of bytes required.
+ *
+ * @return The queue element, or NULL if there is no memory (or no free entry
+ * in the queue pool).
+ */
+    static QueueListElement_t * prvAllocateMessageQueue( size_t xSize );
+
+/**
+ * @brief Release memory obtained from prvAllocateMessageQueue.
+ *
+ * @param[in] pxMessageQueue The queue element to release.
+ *
+ * @return nothing
+ */
+    static void prvFreeMessageQueue( QueueListElement_t * pxMessageQueue );
+
+#endif
+
 /**
  * @brief Attempt to find the queue identified by pcName or xMqId in the queue list.
  *
@@ -118,6 +243,60 @@ static BaseType_t prvFindQueueInList( QueueListElement_t ** const ppxQueueListEl
                                       const char * const pcName,
                                       mqd_t xMessageQueueDescriptor );
 
+#if ( posixconfigMQ_PREALLOCATE == 1 )
+
+/**
+ * @brief Check a descriptor without searching the queue list.
+ *
+ * Used by mq_send and mq_receive so they don't need xQueueListMutex.
+ * @param[in] xMessageQueueDescriptor The queue descriptor to check.
+ *
+ * @return pdTRUE if the descriptor refers to an existing queue; pdFALSE otherwise.
+ */
+    static BaseType_t prvValidateDescriptor( mqd_t xMessageQueueDescriptor );
+
+/**
+ * @brief Queue a filled slot.
+ *
+ * Never blocks - there is always room for a slot taken from xFreeSlots.
+ * @param[in] pxMessageQueue The queue to send to.
+ * @param[in] pxSlot The filled slot.
+ * @param[in] uxPriority msg_prio of the message (ignored unless
+ * posixconfigMQ_PRIORITY is 1).
+ *
+ * @return nothing
+ */
+    static void prvQueueSlot( QueueListElement_t * pxMessageQueue,
+                              MessageSlot_t * pxSlot,
+                              unsigned uxPriority );
+
+/**
+ * @brief Wait for a filled slot.
+ *
+ * @param[in] pxMessageQueue The queue to receive from.
+ * @param[out] ppxSlot The oldest slot (of the highest priority when
+ * posixconfigMQ_PRIORITY is 1).
+ * @param[out] puxPriority msg_prio of the message, may be NULL.
+ * @param[in] xTimeoutTicks How long to wait for a message.
+ *
+ * @return pdTRUE if a slot was received; pdFALSE on timeout.
+ */
+    static BaseType_t prvReceiveSlot( QueueListElement_t * pxMessageQueue,
+                                      MessageSlot_t ** ppxSlot,
+                                      unsigned * puxPriority,
+                                      TickType_t xTimeoutTicks );
+
+#endif
+
+/**
+ * @brief Set errno after a send or receive failed to complete in time.
+ *
+ * @param[in] lMessageQueueFlags Message queue flags to consider.
+ *
+ * @return nothing
+ */
+static void prvSetTimeoutErrno( long lMessageQueueFlags );
+
 /**
  * @brief Initialize the queue list.
  *
@@ -200,6 +379,128 @@ static int prvCalculateTickTimeout( long lMessageQueueFlags,
 
 /*-----------------------------------------------------------*/
 
+#if ( posixconfigMQ_POOL_SIZE > 0 )
+
+    static QueueListElement_t * prvAllocateMessageQueue( size_t xSize )
+    {
+        QueueListElement_t * pxMessageQueue = NULL;
+        size_t xIndex = 0;
+
+        if( xSize <= sizeof( QueuePoolEntry_t ) )
+        {
+            taskENTER_CRITICAL();
+
+            for( xIndex = 0; xIndex < posixconfigMQ_POOL_SIZE; xIndex++ )
+            {
+                if( xQueuePoolInUse[ xIndex ] == pdFALSE )
+                {
+                    xQueuePoolInUse[ xIndex ] = pdTRUE;
+                    pxMessageQueue = &xQueuePool[ xIndex ].xElement;
+                    break;
+                }
+            }
+
+            taskEXIT_CRITICAL();
+        }
+
+        return pxMessageQueue;
+    }
+
+    static void prvFreeMessageQueue( QueueListElement_t * pxMessageQueue )
+    {
+        /* A single write, no critical section needed. */
+        xQueuePoolInUse[ ( QueuePoolEntry_t * ) pxMessageQueue - xQueuePool ] = pdFALSE;
+    }
+
+#elif ( posixconfigMQ_PREALLOCATE == 1 )
+
+    static QueueListElement_t * prvAllocateMessageQueue( size_t xSize )
+    {
+        return pvPortMalloc( xSize );
+    }
+
+    static void prvFreeMessageQueue( QueueListElement_t * pxMessageQueue )
+    {
+        vPortFree( pxMessageQueue );
+    }
+
+#endif /* if ( posixconfigMQ_POOL_SIZE > 0 ) */
+
+/*-----------------------------------------------------------*/
+
+#if ( posixconfigMQ_PREALLOCATE == 1 )
+
+    static BaseType_t prvCreateNewMessageQueue( QueueListElement_t ** ppxMessageQueue,
+                                                const struct mq_attr * const pxAttr,
+                                                const char * const pcName,
+                                                size_t xNameLength )
+    {
+        BaseType_t xStatus = pdTRUE;
+        QueueListElement_t * pxMessageQueue = NULL;
+        char * pcStorage = NULL;
+        const UBaseType_t uxMaxMessages = ( UBaseType_t ) pxAttr->mq_maxmsg;
+        const size_t xSlotSize = mqSLOT_SIZE( ( size_t ) pxAttr->mq_msgsize );
+        UBaseType_t uxSlot = 0;
+
+        /* The queue element, the storage of both queues, all of the message
+         * slots and the queue name are a single allocation. */
+        pxMessageQueue = prvAllocateMessageQueue( sizeof( QueueListElement_t ) +
+                                                  mqSTORAGE_SIZE( ( size_t ) uxMaxMessages, ( size_t ) pxAttr->mq_msgsize ) +
+                                                  xNameLength + 1 );
+
+        if( pxMessageQueue == NULL )
+        {
+            xStatus = pdFALSE;
+        }
+        else
+        {
+            /* Create the queues that carry slot pointers in that storage. */
+            pcStorage = ( char * ) ( pxMessageQueue + 1 );
+            #if ( posixconfigMQ_PRIORITY == 1 )
+                ( void ) PriorityMessageQueueInit( &pxMessageQueue->xQueue,
+                                                   pcStorage,
+                                                   ( uint32_t ) uxMaxMessages,
+                                                   sizeof( MessageSlot_t * ) );
+            #else
+                pxMessageQueue->xQueue = xQueueCreateStatic( uxMaxMessages,
+                                                             sizeof( MessageSlot_t * ),
+                                                             ( uint8_t * ) pcStorage,
+                                                             &pxMessageQueue->xQueueBuffer );
+            #endif
+            pcStorage += mqQUEUE_STORAGE_SIZE( ( size_t ) uxMaxMessages );
+
+            pxMessageQueue->xFreeSlots = xQueueCreateStatic( uxMaxMessages,
+                                                             sizeof( MessageSlot_t * ),
+                                                             ( uint8_t * ) pcStorage,
+                                                             &pxMessageQueue->xFreeSlotsBuffer );
+            pcStorage += ( size_t ) uxMaxMessages * sizeof( MessageSlot_t * );
+
+            /* Every slot starts out free. */
+            for( uxSlot = 0; uxSlot < uxMaxMessages; uxSlot++ )
+            {
+                MessageSlot_t * pxSlot = ( MessageSlot_t * ) ( pcStorage + ( size_t ) uxSlot * xSlotSize );
+                ( void ) xQueueSend( pxMessageQueue->xFreeSlots, &pxSlot, 0 );
+            }
+
+            /* The name is stored after the last slot. Copying xNameLength+1
+             * will cause strncpy to add the null-terminator. */
+            pxMessageQueue->pcName = pcStorage + ( size_t ) uxMaxMessages * xSlotSize;
+            ( void ) strncpy( pxMessageQueue->pcName, pcName, xNameLength + 1 );
+
+            pxMessageQueue->xAttr = *pxAttr;
+            pxMessageQueue->xOpenDescriptors = 1;
+            pxMessageQueue->xPendingUnlink = pdFALSE;
+            pxMessageQueue->ulMagic = mqMAGIC;
+
+            listADD( &xQueueListHead, &pxMessageQueue->xLink );
+            *ppxMessageQueue = pxMessageQueue;
+        }
+
+        return xStatus;
+    }
+
+#else /* if ( posixconfigMQ_PREALLOCATE == 1 ) */
+
 static BaseType_t prvCreateNewMessageQueue( QueueListElement_t ** ppxMessageQueue,
                                             const struct mq_attr * const pxAttr,
                                             const char * const pcName,
@@ -268,8 +569,28 @@ static BaseType_t prvCreateNewMessageQueue( QueueListElement_t ** ppxMessageQueu
     return xStatus;
 }
 
+#endif /* if ( posixconfigMQ_PREALLOCATE == 1 ) */
+
 /*-----------------------------------------------------------*/
 
+#if ( posixconfigMQ_PREALLOCATE == 1 )
+
+    static void prvDeleteMessageQueue( const QueueListElement_t * const pxMessageQueue )
+    {
+        /* Invalidate descriptors that are still in use, then free the queue
+         * element, its slots and its name in one go. */
+        ( ( QueueListElement_t * ) pxMessageQueue )->ulMagic = 0;
+        #if ( posixconfigMQ_PRIORITY == 1 )
+            PriorityMessageQueueDelete( &( ( QueueListElement_t * ) pxMessageQueue )->xQueue );
+        #else
+            vQueueDelete( pxMessageQueue->xQueue );
+        #endif
+        vQueueDelete( pxMessageQueue->xFreeSlots );
+        prvFreeMessageQueue( ( QueueListElement_t * ) pxMessageQueue );
+    }
+
+#else
+
 static void prvDeleteMessageQueue( const QueueListElement_t * const pxMessageQueue )
 {
     QueueElement_t xQueueElement = { 0 };
@@ -289,6 +610,8 @@ static void prvDeleteMessageQueue( const QueueListElement_t * const pxMessageQue
     vPortFree( ( void * ) pxMessageQueue );
 }
 
+#endif /* if ( posixconfigMQ_PREALLOCATE == 1 ) */
+
 /*-----------------------------------------------------------*/
 
 static BaseType_t prvFindQueueInList( QueueListElement_t ** const ppxQueueListElement,
@@ -332,6 +655,79 @@ static BaseType_t prvFindQueueInList( QueueListElement_t ** const ppxQueueListEl
 
 /*-----------------------------------------------------------*/
 
+#if ( posixconfigMQ_PREALLOCATE == 1 )
+
+    static BaseType_t prvValidateDescriptor( mqd_t xMessageQueueDescriptor )
+    {
+        const QueueListElement_t * pxMessageQueue = ( const QueueListElement_t * ) xMessageQueueDescriptor;
+
+        return ( ( pxMessageQueue != NULL ) &&
+                 ( xMessageQueueDescriptor != ( mqd_t ) -1 ) &&
+                 ( pxMessageQueue->ulMagic == mqMAGIC ) ) ? pdTRUE : pdFALSE;
+    }
+
+/*-----------------------------------------------------------*/
+
+    static void prvQueueSlot( QueueListElement_t * pxMessageQueue,
+                              MessageSlot_t * pxSlot,
+                              unsigned uxPriority )
+    {
+        #if ( posixconfigMQ_PRIORITY == 1 )
+            ( void ) PriorityMessageQueueSend( &pxMessageQueue->xQueue, &pxSlot, sizeof( pxSlot ), uxPriority, 0 );
+        #else
+            ( void ) uxPriority;
+            ( void ) xQueueSend( pxMessageQueue->xQueue, &pxSlot, 0 );
+        #endif
+    }
+
+/*-----------------------------------------------------------*/
+
+    static BaseType_t prvReceiveSlot( QueueListElement_t * pxMessageQueue,
+                                      MessageSlot_t ** ppxSlot,
+                                      unsigned * puxPriority,
+                                      TickType_t xTimeoutTicks )
+    {
+        #if ( posixconfigMQ_PRIORITY == 1 )
+            uint32_t ulPriority = 0;
+            BaseType_t xReceived = PriorityMessageQueueReceive( &pxMessageQueue->xQueue,
+                                                                ppxSlot,
+                                                                NULL,
+                                                                &ulPriority,
+                                                                xTimeoutTicks );
+
+            if( ( xReceived == pdTRUE ) && ( puxPriority != NULL ) )
+            {
+                *puxPriority = ( unsigned ) ulPriority;
+            }
+
+            return xReceived;
+        #else
+            ( void ) puxPriority;
+
+            return xQueueReceive( pxMessageQueue->xQueue, ppxSlot, xTimeoutTicks );
+        #endif
+    }
+
+/*-----------------------------------------------------------*/
+
+#endif
+
+static void prvSetTimeoutErrno( long lMessageQueueFlags )
+{
+    if( lMessageQueueFlags & O_NONBLOCK )
+    {
+        /* Set errno to EAGAIN for nonblocking mq. */
+        errno = EAGAIN;
+    }
+    else
+    {
+        /* Otherwise, set errno to ETIMEDOUT. */
+        errno = ETIMEDOUT;
+    }
+}
+
+/*-----------------------------------------------------------*/
+
 static void prvInitializeQueueList( void )
 {
     /* Keep track of whether the queue list has been initialized. */
@@ -473,7 +869,11 @@ int mq_getattr( mqd_t mqdes,
     {
         /* Update the number of messages in the queue and copy the attributes
          * into mqstat. */
-        pxMessageQueue->xAttr.mq_curmsgs = ( long ) uxQueueMessagesWaiting( pxMessageQueue->xQueue );
+        #if ( posixconfigMQ_PRIORITY == 1 )
+            pxMessageQueue->xAttr.mq_curmsgs = ( long ) PriorityMessageQueueCount( &pxMessageQueue->xQueue );
+        #else
+            pxMessageQueue->xAttr.mq_curmsgs = ( long ) uxQueueMessagesWaiting( pxMessageQueue->xQueue );
+        #endif
         *mqstat = pxMessageQueue->xAttr;
     }
     else
@@ -638,22 +1038,37 @@ ssize_t mq_timedreceive( mqd_t mqdes,
     int iCalculateTimeoutReturn = 0;
     TickType_t xTimeoutTicks = 0;
     QueueListElement_t * pxMessageQueue = ( QueueListElement_t * ) mqdes;
-    QueueElement_t xReceiveData = { 0 };
 
-    /* Silence warnings about unused parameters. */
-    ( void ) msg_prio;
+    #if ( posixconfigMQ_PREALLOCATE == 1 )
+        MessageSlot_t * pxSlot = NULL;
+    #else
+        QueueElement_t xReceiveData = { 0 };
 
-    /* Lock the mutex that guards access to the queue list. This call will
-     * never fail because it blocks forever. */
-    ( void ) xSemaphoreTake( ( SemaphoreHandle_t ) &xQueueListMutex, portMAX_DELAY );
+        /* Silence warnings about unused parameters. */
+        ( void ) msg_prio;
+    #endif
 
-    /* Find the mq referenced by mqdes. */
-    if( prvFindQueueInList( NULL, NULL, mqdes ) == pdFALSE )
-    {
-        /* Queue not found; bad descriptor. */
-        errno = EBADF;
-        xStatus = -1;
-    }
+    #if ( posixconfigMQ_PREALLOCATE == 1 )
+        /* Check the descriptor without taking the queue list mutex. */
+        if( prvValidateDescriptor( mqdes ) == pdFALSE )
+        {
+            /* Bad descriptor. */
+            errno = EBADF;
+            xStatus = -1;
+        }
+    #else
+        /* Lock the mutex that guards access to the queue list. This call will
+         * never fail because it blocks forever. */
+        ( void ) xSemaphoreTake( ( SemaphoreHandle_t ) &xQueueListMutex, portMAX_DELAY );
+
+        /* Find the mq referenced by mqdes. */
+        if( prvFindQueueInList( NULL, NULL, mqdes ) == pdFALSE )
+        {
+            /* Queue not found; bad descriptor. */
+            errno = EBADF;
+            xStatus = -1;
+        }
+    #endif /* if ( posixconfigMQ_PREALLOCATE == 1 ) */
 
     /* Verify that msg_len is large enough. */
     if( xStatus == 0 )
@@ -680,41 +1095,54 @@ ssize_t mq_timedreceive( mqd_t mqdes,
         }
     }
 
-    /* Release the mutex protecting the queue list. */
-    ( void ) xSemaphoreGive( ( SemaphoreHandle_t ) &xQueueListMutex );
-
-    if( xStatus == 0 )
-    {
-        /* Receive data from the FreeRTOS queue. */
-        if( xQueueReceive( pxMessageQueue->xQueue,
-                           &xReceiveData,
-                           xTimeoutTicks ) == pdFALSE )
+    #if ( posixconfigMQ_PREALLOCATE == 1 )
+        if( xStatus == 0 )
         {
-            /* If queue receive fails, set the appropriate errno. */
-            if( pxMessageQueue->xAttr.mq_flags & O_NONBLOCK )
+            /* Receive a filled slot. */
+            if( prvReceiveSlot( pxMessageQueue,
+                                &pxSlot,
+                                msg_prio,
+                                xTimeoutTicks ) == pdFALSE )
             {
-                /* Set errno to EAGAIN for nonblocking mq. */
-                errno = EAGAIN;
+                prvSetTimeoutErrno( pxMessageQueue->xAttr.mq_flags );
+                xStatus = -1;
             }
-            else
+        }
+
+        if( xStatus == 0 )
+        {
+            /* Copy the message out and return the slot. There is always room
+             * in xFreeSlots for a slot that was taken from it. */
+            xStatus = ( ssize_t ) pxSlot->xDataSize;
+            ( void ) memcpy( msg_ptr, pxSlot->pcData, pxSlot->xDataSize );
+            ( void ) xQueueSend( pxMessageQueue->xFreeSlots, &pxSlot, 0 );
+        }
+    #else /* if ( posixconfigMQ_PREALLOCATE == 1 ) */
+        /* Release the mutex protecting the queue list. */
+        ( void ) xSemaphoreGive( ( SemaphoreHandle_t ) &xQueueListMutex );
+
+        if( xStatus == 0 )
+        {
+            /* Receive data from the FreeRTOS queue. */
+            if( xQueueReceive( pxMessageQueue->xQueue,
+                               &xReceiveData,
+                               xTimeoutTicks ) == pdFALSE )
             {
-                /* Otherwise, set errno to ETIMEDOUT. */
-                errno = ETIMEDOUT;
+                prvSetTimeoutErrno( pxMessageQueue->xAttr.mq_flags );
+                xStatus = -1;
             }
-
-            xStatus = -1;
         }
-    }
 
-    if( xStatus == 0 )
-    {
-        /* Get the length of data for return value. */
-        xStatus = ( ssize_t ) xReceiveData.xDataSize;
+        if( xStatus == 0 )
+        {
+            /* Get the length of data for return value. */
+            xStatus = ( ssize_t ) xReceiveData.xDataSize;
 
-        /* Copy received data into given buffer, then free it. */
-        ( void ) memcpy( msg_ptr, xReceiveData.pcData, xReceiveData.xDataSize );
-        vPortFree( xReceiveData.pcData );
-    }
+            /* Copy received data into given buffer, then free it. */
+            ( void ) memcpy( msg_ptr, xReceiveData.pcData, xReceiveData.xDataSize );
+            vPortFree( xReceiveData.pcData );
+        }
+    #endif /* if ( posixconfigMQ_PREALLOCATE == 1 ) */
 
     return xStatus;
 }
@@ -730,22 +1158,37 @@ int mq_timedsend( mqd_t mqdes,
     int iStatus = 0, iCalculateTimeoutReturn = 0;
     TickType_t xTimeoutTicks = 0;
     QueueListElement_t * pxMessageQueue = ( QueueListElement_t * ) mqdes;
-    QueueElement_t xSendData = { 0 };
 
-    /* Silence warnings about unused parameters. */
-    ( void ) msg_prio;
+    #if ( posixconfigMQ_PREALLOCATE == 1 )
+        MessageSlot_t * pxSlot = NULL;
+    #else
+        QueueElement_t xSendData = { 0 };
 
-    /* Lock the mutex that guards access to the queue list. This call will
-     * never fail because it blocks forever. */
-    ( void ) xSemaphoreTake( ( SemaphoreHandle_t ) &xQueueListMutex, portMAX_DELAY );
+        /* Silence warnings about unused parameters. */
+        ( void ) msg_prio;
+    #endif
 
-    /* Find the mq referenced by mqdes. */
-    if( prvFindQueueInList( NULL, NULL, mqdes ) == pdFALSE )
-    {
-        /* Queue not found; bad descriptor. */
-        errno = EBADF;
-        iStatus = -1;
-    }
+    #if ( posixconfigMQ_PREALLOCATE == 1 )
+        /* Check the descriptor without taking the queue list mutex. */
+        if( prvValidateDescriptor( mqdes ) == pdFALSE )
+        {
+            /* Bad descriptor. */
+            errno = EBADF;
+            iStatus = -1;
+        }
+    #else
+        /* Lock the mutex that guards access to the queue list. This call will
+         * never fail because it blocks forever. */
+        ( void ) xSemaphoreTake( ( SemaphoreHandle_t ) &xQueueListMutex, portMAX_DELAY );
+
+        /* Find the mq referenced by mqdes. */
+        if( prvFindQueueInList( NULL, NULL, mqdes ) == pdFALSE )
+        {
+            /* Queue not found; bad descriptor. */
+            errno = EBADF;
+            iStatus = -1;
+        }
+    #endif /* if ( posixconfigMQ_PREALLOCATE == 1 ) */
 
     /* Verify that mq_msgsize is large enough. */
     if( iStatus == 0 )
@@ -772,54 +1215,66 @@ int mq_timedsend( mqd_t mqdes,
         }
     }
 
-    /* Release the mutex protecting the queue list. */
-    ( void ) xSemaphoreGive( ( SemaphoreHandle_t ) &xQueueListMutex );
-
-    /* Allocate memory for the message. */
-    if( iStatus == 0 )
-    {
-        xSendData.xDataSize = msg_len;
-        xSendData.pcData = pvPortMalloc( msg_len );
-
-        /* Check that memory allocation succeeded. */
-        if( xSendData.pcData == NULL )
+    #if ( posixconfigMQ_PREALLOCATE == 1 )
+        if( iStatus == 0 )
         {
-            /* msg_len too large. */
-            errno = EMSGSIZE;
-            iStatus = -1;
+            /* Wait for a free slot - a full queue has none. */
+            if( xQueueReceive( pxMessageQueue->xFreeSlots,
+                               &pxSlot,
+                               xTimeoutTicks ) == pdFALSE )
+            {
+                prvSetTimeoutErrno( pxMessageQueue->xAttr.mq_flags );
+                iStatus = -1;
+            }
         }
-        else
+
+        if( iStatus == 0 )
         {
-            /* Copy the data to send. */
-            ( void ) memcpy( xSendData.pcData, msg_ptr, msg_len );
+            /* Copy straight into the slot and queue it. */
+            pxSlot->xDataSize = msg_len;
+            ( void ) memcpy( pxSlot->pcData, msg_ptr, msg_len );
+            prvQueueSlot( pxMessageQueue, pxSlot, msg_prio );
         }
-    }
+    #else /* if ( posixconfigMQ_PREALLOCATE == 1 ) */
+        /* Release the mutex protecting the queue list. */
+        ( void ) xSemaphoreGive( ( SemaphoreHandle_t ) &xQueueListMutex );
 
-    if( iStatus == 0 )
-    {
-        /* Send data to the FreeRTOS queue. */
-        if( xQueueSend( pxMessageQueue->xQueue,
-                        &xSendData,
-                        xTimeoutTicks ) == pdFALSE )
+        /* Allocate memory for the message. */
+        if( iStatus == 0 )
         {
-            /* If queue send fails, set the appropriate errno. */
-            if( pxMessageQueue->xAttr.mq_flags & O_NONBLOCK )
+            xSendData.xDataSize = msg_len;
+            xSendData.pcData = pvPortMalloc( msg_len );
+
+            /* Check that memory allocation succeeded. */
+            if( xSendData.pcData == NULL )
             {
-                /* Set errno to EAGAIN for nonblocking mq. */
-                errno = EAGAIN;
+                /* msg_len too large. */
+                errno = EMSGSIZE;
+                iStatus = -1;
             }
             else
             {
-                /* Otherwise, set errno to ETIMEDOUT. */
-                errno = ETIMEDOUT;
+                /* Copy the data to send. */
+                ( void ) memcpy( xSendData.pcData, msg_ptr, msg_len );
             }
+        }
 
-            /* Free the allocated queue data. */
-            vPortFree( xSendData.pcData );
+        if( iStatus == 0 )
+        {
+            /* Send data to the FreeRTOS queue. */
+            if( xQueueSend( pxMessageQueue->xQueue,
+                            &xSendData,
+                            xTimeoutTicks ) == pdFALSE )
+            {
+                prvSetTimeoutErrno( pxMessageQueue->xAttr.mq_flags );
 
-            iStatus = -1;
+                /* Free the allocated queue data. */
+                vPortFree( xSendData.pcData );
+
+                iStatus = -1;
+            }
         }
-    }
+    #endif /* if ( posixconfigMQ_PREALLOCATE == 1 ) */
 
     return iStatus;
 }
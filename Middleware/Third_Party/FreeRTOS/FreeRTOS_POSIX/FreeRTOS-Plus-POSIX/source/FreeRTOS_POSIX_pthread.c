@@ -44,6 +44,7 @@ typedef struct pthread_attr_internal
 {
     uint16_t usStackSize;                /**< Stack size. */
     uint16_t usSchedPriorityDetachState; /**< Schedule priority 15 bits (LSB) Detach state: 1 bits (MSB) */
+    void * pvStackAddr;                  /**< Caller supplied stack (pthread_attr_setstack), NULL to use the heap. */
 } pthread_attr_internal_t;
 
 #define pthreadDETACH_STATE_MASK      0x8000
@@ -66,6 +67,16 @@ typedef struct pthread_internal
     void * xReturn;                       /**< Return value of pvStartRoutine. */
 } pthread_internal_t;
 
+/**
+ * @brief Bytes at the start of a caller supplied stack that hold the thread
+ * object and the FreeRTOS task control block.
+ */
+#define pthreadSTATIC_OVERHEAD                                                     \
+    ( ( sizeof( pthread_internal_t ) + sizeof( StaticTask_t ) + portBYTE_ALIGNMENT - 1 ) & \
+      ~( ( size_t ) portBYTE_ALIGNMENT_MASK ) )
+
+#define pthreadIS_STATIC( xAttr )    ( ( xAttr ).pvStackAddr != NULL )
+
 /**
  * @brief Terminates the calling thread.
  *
@@ -93,6 +104,7 @@ static const pthread_attr_internal_t xDefaultThreadAttributes =
 {
     .usStackSize                = PTHREAD_STACK_MIN,
     .usSchedPriorityDetachState = ( ( uint16_t ) tskIDLE_PRIORITY & pthreadSCHED_PRIORITY_MASK ) | ( PTHREAD_CREATE_JOINABLE << pthreadDETACH_STATE_SHIFT ),
+    .pvStackAddr                = NULL,
 };
 
 /*-----------------------------------------------------------*/
@@ -112,8 +124,13 @@ static void prvExitThread( void )
     }
     else
     {
-        /* For a detached thread, perform cleanup of thread object. */
-        vPortFree( pxThread );
+        /* For a detached thread, perform cleanup of thread object. A thread
+         * object inside a caller supplied stack is owned by the caller. */
+        if( !pthreadIS_STATIC( pxThread->xAttr ) )
+        {
+            vPortFree( pxThread );
+        }
+
         vTaskDelete( NULL );
     }
 }
@@ -173,6 +190,20 @@ int pthread_attr_getschedparam( const pthread_attr_t * attr,
 
 /*-----------------------------------------------------------*/
 
+int pthread_attr_getstack( const pthread_attr_t * attr,
+                           void ** stackaddr,
+                           size_t * stacksize )
+{
+    pthread_attr_internal_t * pxAttr = ( pthread_attr_internal_t * ) ( attr );
+
+    *stackaddr = pxAttr->pvStackAddr;
+    *stacksize = ( size_t ) pxAttr->usStackSize;
+
+    return 0;
+}
+
+/*-----------------------------------------------------------*/
+
 int pthread_attr_getstacksize( const pthread_attr_t * attr,
                                size_t * stacksize )
 {
@@ -262,6 +293,33 @@ int pthread_attr_setschedpolicy( pthread_attr_t * attr,
 
 /*-----------------------------------------------------------*/
 
+int pthread_attr_setstack( pthread_attr_t * attr,
+                           void * stackaddr,
+                           size_t stacksize )
+{
+    int iStatus = 0;
+    pthread_attr_internal_t * pxAttr = ( pthread_attr_internal_t * ) ( attr );
+
+    /* The thread object and task control block are carved from the start of
+     * the buffer, what's left must still be a usable stack. */
+    if( ( stackaddr == NULL ) ||
+        ( ( ( size_t ) stackaddr & portBYTE_ALIGNMENT_MASK ) != 0 ) ||
+        ( stacksize < PTHREAD_STACK_MIN + pthreadSTATIC_OVERHEAD ) ||
+        ( stacksize > UINT16_MAX ) )
+    {
+        iStatus = EINVAL;
+    }
+    else
+    {
+        pxAttr->pvStackAddr = stackaddr;
+        pxAttr->usStackSize = ( uint16_t ) stacksize;
+    }
+
+    return iStatus;
+}
+
+/*-----------------------------------------------------------*/
+
 int pthread_attr_setstacksize( pthread_attr_t * attr,
                                size_t stacksize )
 {
@@ -289,10 +347,21 @@ int pthread_create( pthread_t * thread,
 {
     int iStatus = 0;
     pthread_internal_t * pxThread = NULL;
+    const pthread_attr_internal_t * pxAttr = ( attr == NULL ) ? &xDefaultThreadAttributes : ( const pthread_attr_internal_t * ) ( attr );
+    uint8_t * pucStaticStack = ( uint8_t * ) pxAttr->pvStackAddr;
     struct sched_param xSchedParam = { .sched_priority = tskIDLE_PRIORITY };
 
-    /* Allocate memory for new thread object. */
-    pxThread = ( pthread_internal_t * ) pvPortMalloc( sizeof( pthread_internal_t ) );
+    if( pthreadIS_STATIC( *pxAttr ) )
+    {
+        /* The thread object lives at the start of the caller's stack buffer,
+         * followed by the task control block. Nothing comes from the heap. */
+        pxThread = ( pthread_internal_t * ) pucStaticStack;
+    }
+    else
+    {
+        /* Allocate memory for new thread object. */
+        pxThread = ( pthread_internal_t * ) pvPortMalloc( sizeof( pthread_internal_t ) );
+    }
 
     if( pxThread == NULL )
     {
@@ -302,16 +371,8 @@ int pthread_create( pthread_t * thread,
 
     if( iStatus == 0 )
     {
-        /* No attributes given, use default attributes. */
-        if( attr == NULL )
-        {
-            pxThread->xAttr = xDefaultThreadAttributes;
-        }
-        /* Otherwise, use provided attributes. */
-        else
-        {
-            pxThread->xAttr = *( ( pthread_attr_internal_t * ) ( attr ) );
-        }
+        /* Copy the provided (or default) attributes. */
+        pxThread->xAttr = *pxAttr;
 
         /* Get priority from attributes */
         xSchedParam.sched_priority = ( int ) pthreadGET_SCHED_PRIORITY( pxThread->xAttr.usSchedPriorityDetachState );
@@ -337,13 +398,29 @@ int pthread_create( pthread_t * thread,
          * the new thread doesn't exit before a tag is assigned. */
         vTaskSuspendAll();
 
+        if( pthreadIS_STATIC( pxThread->xAttr ) )
+        {
+            /* Create the FreeRTOS task that will run the pthread on the
+             * caller's stack. This call will not fail because the arguments
+             * aren't NULL. */
+            pxThread->xTaskHandle = xTaskCreateStatic( prvRunThread,
+                                                       posixconfigPTHREAD_TASK_NAME,
+                                                       ( uint32_t ) ( ( pxThread->xAttr.usStackSize - pthreadSTATIC_OVERHEAD ) / sizeof( StackType_t ) ),
+                                                       ( void * ) pxThread,
+                                                       xSchedParam.sched_priority,
+                                                       ( StackType_t * ) ( pucStaticStack + pthreadSTATIC_OVERHEAD ),
+                                                       ( StaticTask_t * ) ( pxThread + 1 ) );
+
+            vTaskSetApplicationTaskTag( pxThread->xTaskHandle, ( TaskHookFunction_t ) pxThread );
+            *thread = ( pthread_t ) pxThread;
+        }
         /* Create the FreeRTOS task that will run the pthread. */
-        if( xTaskCreate( prvRunThread,
-                         posixconfigPTHREAD_TASK_NAME,
-                         ( uint16_t ) ( pxThread->xAttr.usStackSize / sizeof( StackType_t ) ),
-                         ( void * ) pxThread,
-                         xSchedParam.sched_priority,
-                         &pxThread->xTaskHandle ) != pdPASS )
+        else if( xTaskCreate( prvRunThread,
+                              posixconfigPTHREAD_TASK_NAME,
+                              ( uint16_t ) ( pxThread->xAttr.usStackSize / sizeof( StackType_t ) ),
+                              ( void * ) pxThread,
+                              xSchedParam.sched_priority,
+                              &pxThread->xTaskHandle ) != pdPASS )
         {
             /* Task creation failed, no memory. */
             vPortFree( pxThread );
@@ -463,8 +540,11 @@ int pthread_join( pthread_t pthread,
             *retval = pxThread->xReturn;
         }
 
-        /* Free the thread object. */
-        vPortFree( pxThread );
+        /* Free the thread object, unless it belongs to a caller supplied stack. */
+        if( !pthreadIS_STATIC( pxThread->xAttr ) )
+        {
+            vPortFree( pxThread );
+        }
 
         /* End the critical section. */
         xTaskResumeAll();
@@ -151,9 +151,9 @@ int pthread_mutex_init( pthread_mutex_t * mutex,
         /* Ensure that the FreeRTOS mutex was successfully created. */
         if( ( SemaphoreHandle_t ) &pxMutex->xMutex == NULL )
         {
-            /* Failed to create mutex. Set error EAGAIN and free mutex object. */
+            /* Failed to create mutex. Set error EAGAIN. The mutex object
+             * belongs to the caller and must not be freed. */
             iStatus = EAGAIN;
-            vPortFree( pxMutex );
         }
         else
         {
@@ -56,6 +56,82 @@ typedef struct timer_internal
     TickType_t xTimerPeriod;     /**< Period of this timer. */
 } timer_internal_t;
 
+#if ( posixconfigTIMER_POOL_SIZE > 0 )
+
+/**
+ * @brief Statically allocated timers handed out by timer_create.
+ */
+    static timer_internal_t xTimerPool[ posixconfigTIMER_POOL_SIZE ];
+
+/**
+ * @brief pdTRUE for every entry of xTimerPool that's in use.
+ */
+    static BaseType_t xTimerPoolInUse[ posixconfigTIMER_POOL_SIZE ];
+
+#endif
+
+/**
+ * @brief Get memory for a new timer object.
+ *
+ * @return A timer object, or NULL if none are available.
+ */
+static timer_internal_t * prvAllocateTimer( void );
+
+/**
+ * @brief Release a timer object obtained from prvAllocateTimer.
+ *
+ * @param[in] pxTimer The timer object to release.
+ *
+ * @return nothing
+ */
+static void prvFreeTimer( timer_internal_t * pxTimer );
+
+/*-----------------------------------------------------------*/
+
+#if ( posixconfigTIMER_POOL_SIZE > 0 )
+
+    static timer_internal_t * prvAllocateTimer( void )
+    {
+        timer_internal_t * pxTimer = NULL;
+        size_t xIndex = 0;
+
+        taskENTER_CRITICAL();
+
+        for( xIndex = 0; xIndex < posixconfigTIMER_POOL_SIZE; xIndex++ )
+        {
+            if( xTimerPoolInUse[ xIndex ] == pdFALSE )
+            {
+                xTimerPoolInUse[ xIndex ] = pdTRUE;
+                pxTimer = &xTimerPool[ xIndex ];
+                break;
+            }
+        }
+
+        taskEXIT_CRITICAL();
+
+        return pxTimer;
+    }
+
+    static void prvFreeTimer( timer_internal_t * pxTimer )
+    {
+        /* A single write, no critical section needed. */
+        xTimerPoolInUse[ pxTimer - xTimerPool ] = pdFALSE;
+    }
+
+#else /* if ( posixconfigTIMER_POOL_SIZE > 0 ) */
+
+    static timer_internal_t * prvAllocateTimer( void )
+    {
+        return pvPortMalloc( sizeof( timer_internal_t ) );
+    }
+
+    static void prvFreeTimer( timer_internal_t * pxTimer )
+    {
+        vPortFree( pxTimer );
+    }
+
+#endif /* if ( posixconfigTIMER_POOL_SIZE > 0 ) */
+
 /*-----------------------------------------------------------*/
 
 void prvTimerCallback( TimerHandle_t xTimerHandle )
@@ -119,7 +195,7 @@ int timer_create( clockid_t clockid,
     /* Allocate memory for a new timer object. */
     if( iStatus == 0 )
     {
-        pxTimer = pvPortMalloc( sizeof( timer_internal_t ) );
+        pxTimer = prvAllocateTimer();
 
         if( pxTimer == NULL )
         {
@@ -170,7 +246,7 @@ int timer_delete( timer_t timerid )
     }
 
     /* Free the memory in use by the timer. */
-    vPortFree( pxTimer );
+    prvFreeTimer( pxTimer );
 
     return 0;
 }
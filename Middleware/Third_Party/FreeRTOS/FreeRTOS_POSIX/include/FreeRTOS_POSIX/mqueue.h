@@ -118,7 +118,7 @@ mqd_t mq_open( const char * name,
  *
  * http://pubs.opengroup.org/onlinepubs/9699919799/functions/mq_receive.html
  *
- * @note msg_prio argument is not supported. Messages are not checked for corruption.
+ * @note msg_prio is only supported when posixconfigMQ_PRIORITY is 1. Messages are not checked for corruption.
  *
  * @retval The length of the selected message in bytes - Upon successful completion.
  * The message is removed from the queue
@@ -145,7 +145,7 @@ ssize_t mq_receive( mqd_t mqdes,
  *
  * http://pubs.opengroup.org/onlinepubs/9699919799/functions/mq_send.html
  *
- * @note msg_prio argument is not supported.
+ * @note msg_prio is only supported when posixconfigMQ_PRIORITY is 1.
  *
  * @retval 0 - Upon successful completion.
  * @retval -1 - An error occurred. errno is also set.
@@ -173,7 +173,7 @@ int mq_send( mqd_t mqdes,
  *
  * http://pubs.opengroup.org/onlinepubs/9699919799/functions/mq_timedreceive.html
  *
- * @note msg_prio argument is not supported. Messages are not checked for corruption.
+ * @note msg_prio is only supported when posixconfigMQ_PRIORITY is 1. Messages are not checked for corruption.
  *
  * @retval The length of the selected message in bytes - Upon successful completion.
  * The message is removed from the queue
@@ -204,7 +204,7 @@ ssize_t mq_timedreceive( mqd_t mqdes,
  *
  * http://pubs.opengroup.org/onlinepubs/9699919799/functions/mq_timedsend.html
  *
- * @note msg_prio argument is not supported.
+ * @note msg_prio is only supported when posixconfigMQ_PRIORITY is 1.
  *
  * @retval 0 - Upon successful completion.
  * @retval -1 - An error occurred. errno is also set.
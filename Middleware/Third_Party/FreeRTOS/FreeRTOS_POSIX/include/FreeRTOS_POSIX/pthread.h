@@ -122,6 +122,19 @@ int pthread_attr_getdetachstate( const pthread_attr_t * attr,
 int pthread_attr_getschedparam( const pthread_attr_t * attr,
                                 struct sched_param * param );
 
+/**
+ * @brief Get stack attributes.
+ *
+ * @see http://pubs.opengroup.org/onlinepubs/9699919799/functions/pthread_attr_getstack.html
+ *
+ * @retval 0 - Upon successful completion.
+ *
+ * @note stackaddr is NULL unless pthread_attr_setstack was called.
+ */
+int pthread_attr_getstack( const pthread_attr_t * attr,
+                           void ** stackaddr,
+                           size_t * stacksize );
+
 /**
  * @brief Get stacksize attribute.
  *
@@ -180,6 +193,26 @@ int pthread_attr_setschedparam( pthread_attr_t * attr,
 int pthread_attr_setschedpolicy( pthread_attr_t * attr,
                                  int policy );
 
+/**
+ * @brief Set stack attributes.
+ *
+ * @see http://pubs.opengroup.org/onlinepubs/9699919799/functions/pthread_attr_setstack.html
+ *
+ * @retval 0 - Upon successful completion.
+ * @retval EINVAL - stackaddr is NULL or not aligned to portBYTE_ALIGNMENT, or
+ * stacksize is too small (or larger than 65535 bytes).
+ *
+ * @note Threads created with these attributes don't use the heap -
+ * pthread_create starts them with xTaskCreateStatic. The thread object and
+ * task control block (a few hundred bytes) are placed at the start of
+ * stackaddr, so stacksize must cover them on top of {PTHREAD_STACK_MIN}.
+ * The buffer belongs to the thread until pthread_join returns or, for a
+ * detached thread, until the idle task has cleaned it up.
+ */
+int pthread_attr_setstack( pthread_attr_t * attr,
+                           void * stackaddr,
+                           size_t stacksize );
+
 /**
  * @brief Set stacksize attribute.
  *
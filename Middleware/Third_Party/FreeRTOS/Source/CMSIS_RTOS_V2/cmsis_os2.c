@@ -71,6 +71,11 @@
 #include "event_groups.h"               // ARM.FreeRTOS::RTOS:Event Groups
 #include "semphr.h"                     // ARM.FreeRTOS::RTOS:Core
 
+/* CMSIS_MQ_PRIORITY is set up by the inline header, which relies on the same
+   handle layout. The regular names must not be remapped in here. */
+#undef CMSIS_OS2_INLINE_TASK
+#include "cmsis_os2_inline.h"
+
 /*---------------------------------------------------------------------------*/
 #ifndef __ARM_ARCH_6M__
   #define __ARM_ARCH_6M__         0
@@ -1082,12 +1087,18 @@ uint32_t osEventFlagsSet (osEventFlagsId_t ef_id, uint32_t flags) {
   else if (IS_IRQ()) {
     yield = pdFALSE;
 
+#if (configUSE_EVENT_GROUP_DIRECT_ISR == 1)
+    /* Set the flags and wake the waiting threads without the timer task */
+    rflags = xEventGroupSetBitsDirectFromISR (hEventGroup, (EventBits_t)flags, &yield);
+    portYIELD_FROM_ISR (yield);
+#else
     if (xEventGroupSetBitsFromISR (hEventGroup, (EventBits_t)flags, &yield) != pdFAIL) {
       rflags = (uint32_t)osErrorResource;
     } else {
       rflags = flags;
       portYIELD_FROM_ISR (yield);
     }
+#endif
   }
   else {
     rflags = xEventGroupSetBits (hEventGroup, (EventBits_t)flags);
@@ -1104,11 +1115,15 @@ uint32_t osEventFlagsClear (osEventFlagsId_t ef_id, uint32_t flags) {
     rflags = (uint32_t)osErrorParameter;
   }
   else if (IS_IRQ()) {
+#if (configUSE_EVENT_GROUP_DIRECT_ISR == 1)
+    rflags = xEventGroupClearBitsDirectFromISR (hEventGroup, (EventBits_t)flags);
+#else
     rflags = xEventGroupGetBitsFromISR (hEventGroup);
 
     if (xEventGroupClearBitsFromISR (hEventGroup, (EventBits_t)flags) == pdFAIL) {
       rflags = (uint32_t)osErrorResource;
     }
+#endif
   }
   else {
     rflags = xEventGroupClearBits (hEventGroup, (EventBits_t)flags);
@@ -1581,6 +1596,250 @@ osStatus_t osSemaphoreDelete (osSemaphoreId_t semaphore_id) {
 
 /*---------------------------------------------------------------------------*/
 
+#if (CMSIS_MQ_PRIORITY == 1)
+
+osMessageQueueId_t osMessageQueueNew (uint32_t msg_count, uint32_t msg_size, const osMessageQueueAttr_t *attr) {
+  PriorityMessageQueue *hQueue;
+  int32_t mem;
+  #if (configQUEUE_REGISTRY_SIZE > 0)
+  const char *name;
+  #endif
+
+  hQueue = NULL;
+
+  if (!IS_IRQ() && (msg_count > 0U) && (msg_size > 0U)) {
+    mem = -1;
+
+    if (attr != NULL) {
+      if ((attr->cb_mem != NULL) && (attr->cb_size >= sizeof(PriorityMessageQueue)) &&
+          (attr->mq_mem != NULL) && (attr->mq_size >= PMQ_STORAGE_SIZE(msg_count, msg_size))) {
+        mem = 1;
+      }
+      else {
+        if ((attr->cb_mem == NULL) && (attr->cb_size == 0U) &&
+            (attr->mq_mem == NULL) && (attr->mq_size == 0U)) {
+          mem = 0;
+        }
+      }
+    }
+    else {
+      mem = 0;
+    }
+
+    if (mem == 1) {
+      hQueue = PriorityMessageQueueInit (attr->cb_mem, attr->mq_mem, msg_count, msg_size);
+    }
+    else {
+      if (mem == 0) {
+        hQueue = PriorityMessageQueueCreate (msg_count, msg_size);
+      }
+    }
+
+    #if (configQUEUE_REGISTRY_SIZE > 0)
+    if (hQueue != NULL) {
+      if (attr != NULL) {
+        name = attr->name;
+      } else {
+        name = NULL;
+      }
+      vQueueAddToRegistry (hQueue->messages, name);
+    }
+    #endif
+
+  }
+
+  return ((osMessageQueueId_t)hQueue);
+}
+
+osStatus_t osMessageQueuePut (osMessageQueueId_t mq_id, const void *msg_ptr, uint8_t msg_prio, uint32_t timeout) {
+  PriorityMessageQueue *hQueue = (PriorityMessageQueue *)mq_id;
+  osStatus_t stat;
+  BaseType_t yield;
+
+  stat = osOK;
+
+  if (IS_IRQ()) {
+    if ((hQueue == NULL) || (msg_ptr == NULL) || (timeout != 0U)) {
+      stat = osErrorParameter;
+    }
+    else {
+      yield = pdFALSE;
+
+      if (PriorityMessageQueueSendFromISR (hQueue, msg_ptr, hQueue->msgSize, msg_prio, &yield) != pdPASS) {
+        stat = osErrorResource;
+      } else {
+        portYIELD_FROM_ISR (yield);
+      }
+    }
+  }
+  else {
+    if ((hQueue == NULL) || (msg_ptr == NULL)) {
+      stat = osErrorParameter;
+    }
+    else {
+      if (PriorityMessageQueueSend (hQueue, msg_ptr, hQueue->msgSize, msg_prio, (TickType_t)timeout) != pdPASS) {
+        if (timeout != 0U) {
+          stat = osErrorTimeout;
+        } else {
+          stat = osErrorResource;
+        }
+      }
+    }
+  }
+
+  return (stat);
+}
+
+osStatus_t osMessageQueueGet (osMessageQueueId_t mq_id, void *msg_ptr, uint8_t *msg_prio, uint32_t timeout) {
+  PriorityMessageQueue *hQueue = (PriorityMessageQueue *)mq_id;
+  osStatus_t stat;
+  BaseType_t yield;
+  uint32_t prio;
+
+  stat = osOK;
+
+  if (IS_IRQ()) {
+    if ((hQueue == NULL) || (msg_ptr == NULL) || (timeout != 0U)) {
+      stat = osErrorParameter;
+    }
+    else {
+      yield = pdFALSE;
+
+      if (PriorityMessageQueueReceiveFromISR (hQueue, msg_ptr, NULL, &prio, &yield) != pdPASS) {
+        stat = osErrorResource;
+      } else {
+        portYIELD_FROM_ISR (yield);
+      }
+    }
+  }
+  else {
+    if ((hQueue == NULL) || (msg_ptr == NULL)) {
+      stat = osErrorParameter;
+    }
+    else {
+      if (PriorityMessageQueueReceive (hQueue, msg_ptr, NULL, &prio, (TickType_t)timeout) != pdPASS) {
+        if (timeout != 0U) {
+          stat = osErrorTimeout;
+        } else {
+          stat = osErrorResource;
+        }
+      }
+    }
+  }
+
+  if ((stat == osOK) && (msg_prio != NULL)) {
+    *msg_prio = (uint8_t)prio;
+  }
+
+  return (stat);
+}
+
+uint32_t osMessageQueueGetCapacity (osMessageQueueId_t mq_id) {
+  PriorityMessageQueue *hQueue = (PriorityMessageQueue *)mq_id;
+  uint32_t capacity;
+
+  if (hQueue == NULL) {
+    capacity = 0U;
+  } else {
+    capacity = hQueue->capacity;
+  }
+
+  return (capacity);
+}
+
+uint32_t osMessageQueueGetMsgSize (osMessageQueueId_t mq_id) {
+  PriorityMessageQueue *hQueue = (PriorityMessageQueue *)mq_id;
+  uint32_t size;
+
+  if (hQueue == NULL) {
+    size = 0U;
+  } else {
+    size = hQueue->msgSize;
+  }
+
+  return (size);
+}
+
+uint32_t osMessageQueueGetCount (osMessageQueueId_t mq_id) {
+  PriorityMessageQueue *hQueue = (PriorityMessageQueue *)mq_id;
+  UBaseType_t count;
+
+  if (hQueue == NULL) {
+    count = 0U;
+  }
+  else if (IS_IRQ()) {
+    count = uxQueueMessagesWaitingFromISR (hQueue->messages);
+  }
+  else {
+    count = PriorityMessageQueueCount (hQueue);
+  }
+
+  return ((uint32_t)count);
+}
+
+uint32_t osMessageQueueGetSpace (osMessageQueueId_t mq_id) {
+  PriorityMessageQueue *hQueue = (PriorityMessageQueue *)mq_id;
+  UBaseType_t space;
+
+  if (hQueue == NULL) {
+    space = 0U;
+  }
+  else if (IS_IRQ()) {
+    space = uxQueueMessagesWaitingFromISR (hQueue->spaces);
+  }
+  else {
+    space = PriorityMessageQueueSpaces (hQueue);
+  }
+
+  return ((uint32_t)space);
+}
+
+osStatus_t osMessageQueueReset (osMessageQueueId_t mq_id) {
+  PriorityMessageQueue *hQueue = (PriorityMessageQueue *)mq_id;
+  osStatus_t stat;
+
+  if (IS_IRQ()) {
+    stat = osErrorISR;
+  }
+  else if (hQueue == NULL) {
+    stat = osErrorParameter;
+  }
+  else {
+    stat = osOK;
+    PriorityMessageQueueReset (hQueue);
+  }
+
+  return (stat);
+}
+
+osStatus_t osMessageQueueDelete (osMessageQueueId_t mq_id) {
+  PriorityMessageQueue *hQueue = (PriorityMessageQueue *)mq_id;
+  osStatus_t stat;
+
+#ifndef USE_FreeRTOS_HEAP_1
+  if (IS_IRQ()) {
+    stat = osErrorISR;
+  }
+  else if (hQueue == NULL) {
+    stat = osErrorParameter;
+  }
+  else {
+    #if (configQUEUE_REGISTRY_SIZE > 0)
+    vQueueUnregisterQueue (hQueue->messages);
+    #endif
+
+    stat = osOK;
+    PriorityMessageQueueDelete (hQueue);
+  }
+#else
+  stat = osError;
+#endif
+
+  return (stat);
+}
+
+#else /* CMSIS_MQ_PRIORITY */
+
 osMessageQueueId_t osMessageQueueNew (uint32_t msg_count, uint32_t msg_size, const osMessageQueueAttr_t *attr) {
   QueueHandle_t hQueue;
   int32_t mem;
@@ -1828,6 +2087,9 @@ osStatus_t osMessageQueueDelete (osMessageQueueId_t mq_id) {
   return (stat);
 }
 
+
+#endif /* CMSIS_MQ_PRIORITY */
+
 /*---------------------------------------------------------------------------*/
 
 /* Callback function prototypes */
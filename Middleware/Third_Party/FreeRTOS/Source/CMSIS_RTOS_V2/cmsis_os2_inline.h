@@ -0,0 +1,290 @@
+/**
+ * MIT License
+ * 
+ * Copyright (c) 2019 Brian Amos
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#ifndef CMSIS_OS2_INLINE_H_
+#define CMSIS_OS2_INLINE_H_
+
+/**
+ * Header-only versions of the most frequently used CMSIS-RTOS2 calls
+ *
+ * Every os* function in cmsis_os2.c checks IS_IRQ() (IPSR, PRIMASK and
+ * BASEPRI reads), validates its arguments and branches before it reaches
+ * FreeRTOS.  When the caller already knows which context it's running in,
+ * none of that is needed - the functions below go straight to the FreeRTOS
+ * call and are inlined into the caller:
+ *
+ * 	os<Name>Task	- may only be called from a task (may block)
+ * 	os<Name>ISR		- may only be called from an interrupt (never blocks),
+ * 					  the context switch is requested before returning
+ *
+ * Handles must be valid (no NULL checks) and come from the matching os*New
+ * function in cmsis_os2.c.  Return values are the same as the full calls.
+ *
+ * Defining CMSIS_OS2_INLINE_TASK before including this file in a source
+ * file that only runs in tasks maps the regular names (osSemaphoreAcquire,
+ * osMessageQueuePut, ...) onto the Task versions, so code written against
+ * cmsis_os2.h stays portable and still avoids the wrapper cost.
+ */
+
+#include "cmsis_os2.h"
+#include "cmsis_compiler.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+
+/* Message queues honor msg_prio (higher values are received first) when 1,
+   see PriorityMessageQueue.h. When 0, plain FreeRTOS queues are used and
+   msg_prio is ignored. */
+#ifndef CMSIS_MQ_PRIORITY
+#define CMSIS_MQ_PRIORITY         0
+#endif
+
+#if (CMSIS_MQ_PRIORITY == 1)
+#include "PriorityMessageQueue.h"
+#endif
+
+/* osMutexNew tags recursive mutexes by setting bit 0 of the handle */
+#define OS_INLINE_MUTEX_HANDLE(mutex_id)       ((SemaphoreHandle_t)((uint32_t)(mutex_id) & ~1U))
+#define OS_INLINE_MUTEX_RECURSIVE(mutex_id)    (((uint32_t)(mutex_id) & 1U) != 0U)
+
+/* result of a failed blocking call, as reported by cmsis_os2.c */
+#define OS_INLINE_FAIL(timeout)                (((timeout) != 0U) ? osErrorTimeout : osErrorResource)
+
+/*---------------------------------------------------------------------------*/
+
+__STATIC_FORCEINLINE osStatus_t osDelayTask (uint32_t ticks) {
+  if (ticks != 0U) {
+    vTaskDelay(ticks);
+  }
+  return (osOK);
+}
+
+/*---------------------------------------------------------------------------*/
+
+__STATIC_FORCEINLINE osStatus_t osSemaphoreAcquireTask (osSemaphoreId_t semaphore_id, uint32_t timeout) {
+  if (xSemaphoreTake ((SemaphoreHandle_t)semaphore_id, (TickType_t)timeout) != pdPASS) {
+    return (OS_INLINE_FAIL(timeout));
+  }
+  return (osOK);
+}
+
+__STATIC_FORCEINLINE osStatus_t osSemaphoreReleaseTask (osSemaphoreId_t semaphore_id) {
+  return ((xSemaphoreGive ((SemaphoreHandle_t)semaphore_id) == pdPASS) ? osOK : osErrorResource);
+}
+
+__STATIC_FORCEINLINE osStatus_t osSemaphoreAcquireISR (osSemaphoreId_t semaphore_id) {
+  BaseType_t yield = pdFALSE;
+
+  if (xSemaphoreTakeFromISR ((SemaphoreHandle_t)semaphore_id, &yield) != pdPASS) {
+    return (osErrorResource);
+  }
+  portYIELD_FROM_ISR (yield);
+  return (osOK);
+}
+
+__STATIC_FORCEINLINE osStatus_t osSemaphoreReleaseISR (osSemaphoreId_t semaphore_id) {
+  BaseType_t yield = pdFALSE;
+
+  if (xSemaphoreGiveFromISR ((SemaphoreHandle_t)semaphore_id, &yield) != pdTRUE) {
+    return (osErrorResource);
+  }
+  portYIELD_FROM_ISR (yield);
+  return (osOK);
+}
+
+/*---------------------------------------------------------------------------*/
+
+__STATIC_FORCEINLINE osStatus_t osMutexAcquireTask (osMutexId_t mutex_id, uint32_t timeout) {
+  BaseType_t rval;
+
+  if (OS_INLINE_MUTEX_RECURSIVE(mutex_id)) {
+    rval = xSemaphoreTakeRecursive (OS_INLINE_MUTEX_HANDLE(mutex_id), timeout);
+  } else {
+    rval = xSemaphoreTake (OS_INLINE_MUTEX_HANDLE(mutex_id), timeout);
+  }
+  return ((rval == pdPASS) ? osOK : OS_INLINE_FAIL(timeout));
+}
+
+__STATIC_FORCEINLINE osStatus_t osMutexReleaseTask (osMutexId_t mutex_id) {
+  BaseType_t rval;
+
+  if (OS_INLINE_MUTEX_RECURSIVE(mutex_id)) {
+    rval = xSemaphoreGiveRecursive (OS_INLINE_MUTEX_HANDLE(mutex_id));
+  } else {
+    rval = xSemaphoreGive (OS_INLINE_MUTEX_HANDLE(mutex_id));
+  }
+  return ((rval == pdPASS) ? osOK : osErrorResource);
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* a single notify call - the previous value comes back with the update */
+__STATIC_FORCEINLINE uint32_t osThreadFlagsSetTask (osThreadId_t thread_id, uint32_t flags) {
+  uint32_t prev = 0U;
+
+  (void)xTaskNotifyAndQuery ((TaskHandle_t)thread_id, flags, eSetBits, &prev);
+  return (prev | flags);
+}
+
+__STATIC_FORCEINLINE uint32_t osThreadFlagsSetISR (osThreadId_t thread_id, uint32_t flags) {
+  BaseType_t yield = pdFALSE;
+  uint32_t prev = 0U;
+
+  (void)xTaskNotifyAndQueryFromISR ((TaskHandle_t)thread_id, flags, eSetBits, &prev, &yield);
+  portYIELD_FROM_ISR (yield);
+  return (prev | flags);
+}
+
+/* only the common osFlagsWaitAny case, use osThreadFlagsWait for osFlagsWaitAll
+   and osFlagsNoClear */
+__STATIC_FORCEINLINE uint32_t osThreadFlagsWaitAnyTask (uint32_t flags, uint32_t timeout) {
+  uint32_t nval;
+  TickType_t t0, td, tout;
+
+  tout = timeout;
+  t0 = xTaskGetTickCount();
+
+  while (xTaskNotifyWait (0, flags, &nval, tout) == pdPASS) {
+    if ((nval & flags) != 0U) {
+      return (nval);
+    }
+    if (timeout == 0U) {
+      return ((uint32_t)osErrorResource);
+    }
+    /* woken by flags nobody is waiting for, keep waiting for the remainder */
+    td = xTaskGetTickCount() - t0;
+    tout = (td > timeout) ? 0U : (timeout - td);
+  }
+
+  return ((timeout == 0U) ? (uint32_t)osErrorResource : (uint32_t)osErrorTimeout);
+}
+
+/*---------------------------------------------------------------------------*/
+
+#if (CMSIS_MQ_PRIORITY == 1)
+
+__STATIC_FORCEINLINE osStatus_t osMessageQueuePutTask (osMessageQueueId_t mq_id, const void *msg_ptr, uint8_t msg_prio, uint32_t timeout) {
+  PriorityMessageQueue *hQueue = (PriorityMessageQueue *)mq_id;
+
+  if (PriorityMessageQueueSend (hQueue, msg_ptr, hQueue->msgSize, msg_prio, (TickType_t)timeout) != pdPASS) {
+    return (OS_INLINE_FAIL(timeout));
+  }
+  return (osOK);
+}
+
+__STATIC_FORCEINLINE osStatus_t osMessageQueueGetTask (osMessageQueueId_t mq_id, void *msg_ptr, uint8_t *msg_prio, uint32_t timeout) {
+  uint32_t prio;
+
+  if (PriorityMessageQueueReceive ((PriorityMessageQueue *)mq_id, msg_ptr, NULL, &prio, (TickType_t)timeout) != pdPASS) {
+    return (OS_INLINE_FAIL(timeout));
+  }
+  if (msg_prio != NULL) {
+    *msg_prio = (uint8_t)prio;
+  }
+  return (osOK);
+}
+
+__STATIC_FORCEINLINE osStatus_t osMessageQueuePutISR (osMessageQueueId_t mq_id, const void *msg_ptr, uint8_t msg_prio) {
+  PriorityMessageQueue *hQueue = (PriorityMessageQueue *)mq_id;
+  BaseType_t yield = pdFALSE;
+
+  if (PriorityMessageQueueSendFromISR (hQueue, msg_ptr, hQueue->msgSize, msg_prio, &yield) != pdPASS) {
+    return (osErrorResource);
+  }
+  portYIELD_FROM_ISR (yield);
+  return (osOK);
+}
+
+__STATIC_FORCEINLINE osStatus_t osMessageQueueGetISR (osMessageQueueId_t mq_id, void *msg_ptr, uint8_t *msg_prio) {
+  BaseType_t yield = pdFALSE;
+  uint32_t prio;
+
+  if (PriorityMessageQueueReceiveFromISR ((PriorityMessageQueue *)mq_id, msg_ptr, NULL, &prio, &yield) != pdPASS) {
+    return (osErrorResource);
+  }
+  portYIELD_FROM_ISR (yield);
+  if (msg_prio != NULL) {
+    *msg_prio = (uint8_t)prio;
+  }
+  return (osOK);
+}
+
+#else /* CMSIS_MQ_PRIORITY */
+
+__STATIC_FORCEINLINE osStatus_t osMessageQueuePutTask (osMessageQueueId_t mq_id, const void *msg_ptr, uint8_t msg_prio, uint32_t timeout) {
+  (void)msg_prio;
+
+  if (xQueueSendToBack ((QueueHandle_t)mq_id, msg_ptr, (TickType_t)timeout) != pdPASS) {
+    return (OS_INLINE_FAIL(timeout));
+  }
+  return (osOK);
+}
+
+__STATIC_FORCEINLINE osStatus_t osMessageQueueGetTask (osMessageQueueId_t mq_id, void *msg_ptr, uint8_t *msg_prio, uint32_t timeout) {
+  (void)msg_prio;
+
+  if (xQueueReceive ((QueueHandle_t)mq_id, msg_ptr, (TickType_t)timeout) != pdPASS) {
+    return (OS_INLINE_FAIL(timeout));
+  }
+  return (osOK);
+}
+
+__STATIC_FORCEINLINE osStatus_t osMessageQueuePutISR (osMessageQueueId_t mq_id, const void *msg_ptr, uint8_t msg_prio) {
+  BaseType_t yield = pdFALSE;
+  (void)msg_prio;
+
+  if (xQueueSendToBackFromISR ((QueueHandle_t)mq_id, msg_ptr, &yield) != pdTRUE) {
+    return (osErrorResource);
+  }
+  portYIELD_FROM_ISR (yield);
+  return (osOK);
+}
+
+__STATIC_FORCEINLINE osStatus_t osMessageQueueGetISR (osMessageQueueId_t mq_id, void *msg_ptr, uint8_t *msg_prio) {
+  BaseType_t yield = pdFALSE;
+  (void)msg_prio;
+
+  if (xQueueReceiveFromISR ((QueueHandle_t)mq_id, msg_ptr, &yield) != pdPASS) {
+    return (osErrorResource);
+  }
+  portYIELD_FROM_ISR (yield);
+  return (osOK);
+}
+
+#endif /* CMSIS_MQ_PRIORITY */
+
+/*---------------------------------------------------------------------------*/
+
+#ifdef CMSIS_OS2_INLINE_TASK
+#define osDelay(ticks)                                        osDelayTask(ticks)
+#define osSemaphoreAcquire(semaphore_id, timeout)             osSemaphoreAcquireTask(semaphore_id, timeout)
+#define osSemaphoreRelease(semaphore_id)                      osSemaphoreReleaseTask(semaphore_id)
+#define osMutexAcquire(mutex_id, timeout)                     osMutexAcquireTask(mutex_id, timeout)
+#define osMutexRelease(mutex_id)                              osMutexReleaseTask(mutex_id)
+#define osThreadFlagsSet(thread_id, flags)                    osThreadFlagsSetTask(thread_id, flags)
+#define osMessageQueuePut(mq_id, msg_ptr, msg_prio, timeout)  osMessageQueuePutTask(mq_id, msg_ptr, msg_prio, timeout)
+#define osMessageQueueGet(mq_id, msg_ptr, msg_prio, timeout)  osMessageQueueGetTask(mq_id, msg_ptr, msg_prio, timeout)
+#endif
+
+#endif /* CMSIS_OS2_INLINE_H_ */
@@ -72,8 +72,29 @@ typedef struct EventGroupDef_t
 	#if( ( configSUPPORT_STATIC_ALLOCATION == 1 ) && ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) )
 		uint8_t ucStaticallyAllocated; /*< Set to pdTRUE if the event group is statically allocated to ensure no attempt is made to free the memory. */
 	#endif
+
+	#if( configUSE_EVENT_GROUP_DIRECT_ISR == 1 )
+		volatile UBaseType_t uxLockCount;		/*< Non-zero while a task is using xTasksWaitingForBits, interrupts must not touch the list. */
+		volatile EventBits_t uxPendingBits;		/*< Bits set by interrupts while the event group was locked, set by the task that unlocks it. */
+	#endif
 } EventGroup_t;
 
+/* When event groups can be set directly from interrupts, tasks lock the event
+group while they are using the list of waiting tasks (in the same way queues
+are locked), and the event bits themselves are only updated from critical
+sections. */
+#if( configUSE_EVENT_GROUP_DIRECT_ISR == 1 )
+	#define eventLOCK_EVENT_GROUP( pxEventBits )		prvLockEventGroup( pxEventBits )
+	#define eventUNLOCK_EVENT_GROUP( pxEventBits )		prvUnlockEventGroup( pxEventBits )
+	#define eventENTER_BITS_UPDATE()					taskENTER_CRITICAL()
+	#define eventEXIT_BITS_UPDATE()						taskEXIT_CRITICAL()
+#else
+	#define eventLOCK_EVENT_GROUP( pxEventBits )
+	#define eventUNLOCK_EVENT_GROUP( pxEventBits )
+	#define eventENTER_BITS_UPDATE()
+	#define eventEXIT_BITS_UPDATE()
+#endif
+
 /*-----------------------------------------------------------*/
 
 /*
@@ -86,6 +107,31 @@ typedef struct EventGroupDef_t
  */
 static BaseType_t prvTestWaitCondition( const EventBits_t uxCurrentEventBits, const EventBits_t uxBitsToWaitFor, const BaseType_t xWaitForAllBits ) PRIVILEGED_FUNCTION;
 
+/*
+ * Set bits in the event group then unblock every task whose wait condition is
+ * now met.  Called by tasks with the scheduler suspended (and the event group
+ * locked), or from an interrupt with interrupts masked when xFromISR is
+ * pdTRUE.
+ *
+ * @return pdTRUE if a task with a priority higher than the calling task was
+ * unblocked from an interrupt, otherwise pdFALSE.
+ */
+static BaseType_t prvSetBitsAndUnblockTasks( EventGroup_t *pxEventBits, const EventBits_t uxBitsToSet, const BaseType_t xFromISR ) PRIVILEGED_FUNCTION;
+
+#if( configUSE_EVENT_GROUP_DIRECT_ISR == 1 )
+	/*
+	 * Stop interrupts from using the list of waiting tasks.  Must be called
+	 * with the scheduler suspended, can be nested.
+	 */
+	static void prvLockEventGroup( EventGroup_t *pxEventBits ) PRIVILEGED_FUNCTION;
+
+	/*
+	 * Undo one prvLockEventGroup().  The outermost unlock sets any bits that
+	 * interrupts left pending while the event group was locked.
+	 */
+	static void prvUnlockEventGroup( EventGroup_t *pxEventBits ) PRIVILEGED_FUNCTION;
+#endif
+
 /*-----------------------------------------------------------*/
 
 #if( configSUPPORT_STATIC_ALLOCATION == 1 )
@@ -115,6 +161,13 @@ static BaseType_t prvTestWaitCondition( const EventBits_t uxCurrentEventBits, co
 			pxEventBits->uxEventBits = 0;
 			vListInitialise( &( pxEventBits->xTasksWaitingForBits ) );
 
+			#if( configUSE_EVENT_GROUP_DIRECT_ISR == 1 )
+			{
+				pxEventBits->uxLockCount = 0;
+				pxEventBits->uxPendingBits = 0;
+			}
+			#endif
+
 			#if( configSUPPORT_DYNAMIC_ALLOCATION == 1 )
 			{
 				/* Both static and dynamic allocation can be used, so note that
@@ -166,6 +219,13 @@ static BaseType_t prvTestWaitCondition( const EventBits_t uxCurrentEventBits, co
 			pxEventBits->uxEventBits = 0;
 			vListInitialise( &( pxEventBits->xTasksWaitingForBits ) );
 
+			#if( configUSE_EVENT_GROUP_DIRECT_ISR == 1 )
+			{
+				pxEventBits->uxLockCount = 0;
+				pxEventBits->uxPendingBits = 0;
+			}
+			#endif
+
 			#if( configSUPPORT_STATIC_ALLOCATION == 1 )
 			{
 				/* Both static and dynamic allocation can be used, so note this
@@ -204,6 +264,7 @@ BaseType_t xTimeoutOccurred = pdFALSE;
 	#endif
 
 	vTaskSuspendAll();
+	eventLOCK_EVENT_GROUP( pxEventBits );
 	{
 		uxOriginalBitValue = pxEventBits->uxEventBits;
 
@@ -216,7 +277,9 @@ BaseType_t xTimeoutOccurred = pdFALSE;
 
 			/* Rendezvous always clear the bits.  They will have been cleared
 			already unless this is the only task in the rendezvous. */
+			eventENTER_BITS_UPDATE();
 			pxEventBits->uxEventBits &= ~uxBitsToWaitFor;
+			eventEXIT_BITS_UPDATE();
 
 			xTicksToWait = 0;
 		}
@@ -246,6 +309,7 @@ BaseType_t xTimeoutOccurred = pdFALSE;
 			}
 		}
 	}
+	eventUNLOCK_EVENT_GROUP( pxEventBits );
 	xAlreadyYielded = xTaskResumeAll();
 
 	if( xTicksToWait != ( TickType_t ) 0 )
@@ -327,6 +391,7 @@ BaseType_t xTimeoutOccurred = pdFALSE;
 	#endif
 
 	vTaskSuspendAll();
+	eventLOCK_EVENT_GROUP( pxEventBits );
 	{
 		const EventBits_t uxCurrentEventBits = pxEventBits->uxEventBits;
 
@@ -343,7 +408,9 @@ BaseType_t xTimeoutOccurred = pdFALSE;
 			/* Clear the wait bits if requested to do so. */
 			if( xClearOnExit != pdFALSE )
 			{
+				eventENTER_BITS_UPDATE();
 				pxEventBits->uxEventBits &= ~uxBitsToWaitFor;
+				eventEXIT_BITS_UPDATE();
 			}
 			else
 			{
@@ -394,6 +461,7 @@ BaseType_t xTimeoutOccurred = pdFALSE;
 			traceEVENT_GROUP_WAIT_BITS_BLOCK( xEventGroup, uxBitsToWaitFor );
 		}
 	}
+	eventUNLOCK_EVENT_GROUP( pxEventBits );
 	xAlreadyYielded = xTaskResumeAll();
 
 	if( xTicksToWait != ( TickType_t ) 0 )
@@ -518,92 +586,21 @@ EventBits_t uxReturn;
 
 EventBits_t xEventGroupSetBits( EventGroupHandle_t xEventGroup, const EventBits_t uxBitsToSet )
 {
-ListItem_t *pxListItem, *pxNext;
-ListItem_t const *pxListEnd;
-List_t const * pxList;
-EventBits_t uxBitsToClear = 0, uxBitsWaitedFor, uxControlBits;
 EventGroup_t *pxEventBits = xEventGroup;
-BaseType_t xMatchFound = pdFALSE;
 
 	/* Check the user is not attempting to set the bits used by the kernel
 	itself. */
 	configASSERT( xEventGroup );
 	configASSERT( ( uxBitsToSet & eventEVENT_BITS_CONTROL_BYTES ) == 0 );
 
-	pxList = &( pxEventBits->xTasksWaitingForBits );
-	pxListEnd = listGET_END_MARKER( pxList ); /*lint !e826 !e740 !e9087 The mini list structure is used as the list end to save RAM.  This is checked and valid. */
 	vTaskSuspendAll();
+	eventLOCK_EVENT_GROUP( pxEventBits );
 	{
 		traceEVENT_GROUP_SET_BITS( xEventGroup, uxBitsToSet );
 
-		pxListItem = listGET_HEAD_ENTRY( pxList );
-
-		/* Set the bits. */
-		pxEventBits->uxEventBits |= uxBitsToSet;
-
-		/* See if the new bit value should unblock any tasks. */
-		while( pxListItem != pxListEnd )
-		{
-			pxNext = listGET_NEXT( pxListItem );
-			uxBitsWaitedFor = listGET_LIST_ITEM_VALUE( pxListItem );
-			xMatchFound = pdFALSE;
-
-			/* Split the bits waited for from the control bits. */
-			uxControlBits = uxBitsWaitedFor & eventEVENT_BITS_CONTROL_BYTES;
-			uxBitsWaitedFor &= ~eventEVENT_BITS_CONTROL_BYTES;
-
-			if( ( uxControlBits & eventWAIT_FOR_ALL_BITS ) == ( EventBits_t ) 0 )
-			{
-				/* Just looking for single bit being set. */
-				if( ( uxBitsWaitedFor & pxEventBits->uxEventBits ) != ( EventBits_t ) 0 )
-				{
-					xMatchFound = pdTRUE;
-				}
-				else
-				{
-					mtCOVERAGE_TEST_MARKER();
-				}
-			}
-			else if( ( uxBitsWaitedFor & pxEventBits->uxEventBits ) == uxBitsWaitedFor )
-			{
-				/* All bits are set. */
-				xMatchFound = pdTRUE;
-			}
-			else
-			{
-				/* Need all bits to be set, but not all the bits were set. */
-			}
-
-			if( xMatchFound != pdFALSE )
-			{
-				/* The bits match.  Should the bits be cleared on exit? */
-				if( ( uxControlBits & eventCLEAR_EVENTS_ON_EXIT_BIT ) != ( EventBits_t ) 0 )
-				{
-					uxBitsToClear |= uxBitsWaitedFor;
-				}
-				else
-				{
-					mtCOVERAGE_TEST_MARKER();
-				}
-
-				/* Store the actual event flag value in the task's event list
-				item before removing the task from the event list.  The
-				eventUNBLOCKED_DUE_TO_BIT_SET bit is set so the task knows
-				that is was unblocked due to its required bits matching, rather
-				than because it timed out. */
-				vTaskRemoveFromUnorderedEventList( pxListItem, pxEventBits->uxEventBits | eventUNBLOCKED_DUE_TO_BIT_SET );
-			}
-
-			/* Move onto the next list item.  Note pxListItem->pxNext is not
-			used here as the list item may have been removed from the event list
-			and inserted into the ready/pending reading list. */
-			pxListItem = pxNext;
-		}
-
-		/* Clear any bits that matched when the eventCLEAR_EVENTS_ON_EXIT_BIT
-		bit was set in the control word. */
-		pxEventBits->uxEventBits &= ~uxBitsToClear;
+		( void ) prvSetBitsAndUnblockTasks( pxEventBits, uxBitsToSet, pdFALSE );
 	}
+	eventUNLOCK_EVENT_GROUP( pxEventBits );
 	( void ) xTaskResumeAll();
 
 	return pxEventBits->uxEventBits;
@@ -616,6 +613,9 @@ EventGroup_t *pxEventBits = xEventGroup;
 const List_t *pxTasksWaitingForBits = &( pxEventBits->xTasksWaitingForBits );
 
 	vTaskSuspendAll();
+
+	/* The event group is never unlocked again, as it no longer exists. */
+	eventLOCK_EVENT_GROUP( pxEventBits );
 	{
 		traceEVENT_GROUP_DELETE( xEventGroup );
 
@@ -668,6 +668,250 @@ void vEventGroupClearBitsCallback( void *pvEventGroup, const uint32_t ulBitsToCl
 }
 /*-----------------------------------------------------------*/
 
+static BaseType_t prvSetBitsAndUnblockTasks( EventGroup_t *pxEventBits, const EventBits_t uxBitsToSet, const BaseType_t xFromISR )
+{
+ListItem_t *pxListItem, *pxNext;
+ListItem_t const *pxListEnd;
+List_t const * pxList;
+EventBits_t uxBitsToClear = 0, uxBitsWaitedFor, uxControlBits;
+BaseType_t xMatchFound = pdFALSE, xHigherPriorityTaskWoken = pdFALSE;
+
+	pxList = &( pxEventBits->xTasksWaitingForBits );
+	pxListEnd = listGET_END_MARKER( pxList ); /*lint !e826 !e740 !e9087 The mini list structure is used as the list end to save RAM.  This is checked and valid. */
+	pxListItem = listGET_HEAD_ENTRY( pxList );
+
+	/* Set the bits. */
+	if( xFromISR == pdFALSE )
+	{
+		eventENTER_BITS_UPDATE();
+		pxEventBits->uxEventBits |= uxBitsToSet;
+		eventEXIT_BITS_UPDATE();
+	}
+	else
+	{
+		pxEventBits->uxEventBits |= uxBitsToSet;
+	}
+
+	/* See if the new bit value should unblock any tasks. */
+	while( pxListItem != pxListEnd )
+	{
+		pxNext = listGET_NEXT( pxListItem );
+		uxBitsWaitedFor = listGET_LIST_ITEM_VALUE( pxListItem );
+		xMatchFound = pdFALSE;
+
+		/* Split the bits waited for from the control bits. */
+		uxControlBits = uxBitsWaitedFor & eventEVENT_BITS_CONTROL_BYTES;
+		uxBitsWaitedFor &= ~eventEVENT_BITS_CONTROL_BYTES;
+
+		if( ( uxControlBits & eventWAIT_FOR_ALL_BITS ) == ( EventBits_t ) 0 )
+		{
+			/* Just looking for single bit being set. */
+			if( ( uxBitsWaitedFor & pxEventBits->uxEventBits ) != ( EventBits_t ) 0 )
+			{
+				xMatchFound = pdTRUE;
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		else if( ( uxBitsWaitedFor & pxEventBits->uxEventBits ) == uxBitsWaitedFor )
+		{
+			/* All bits are set. */
+			xMatchFound = pdTRUE;
+		}
+		else
+		{
+			/* Need all bits to be set, but not all the bits were set. */
+		}
+
+		if( xMatchFound != pdFALSE )
+		{
+			/* The bits match.  Should the bits be cleared on exit? */
+			if( ( uxControlBits & eventCLEAR_EVENTS_ON_EXIT_BIT ) != ( EventBits_t ) 0 )
+			{
+				uxBitsToClear |= uxBitsWaitedFor;
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+
+			/* Store the actual event flag value in the task's event list
+			item before removing the task from the event list.  The
+			eventUNBLOCKED_DUE_TO_BIT_SET bit is set so the task knows
+			that is was unblocked due to its required bits matching, rather
+			than because it timed out. */
+			if( xFromISR == pdFALSE )
+			{
+				vTaskRemoveFromUnorderedEventList( pxListItem, pxEventBits->uxEventBits | eventUNBLOCKED_DUE_TO_BIT_SET );
+			}
+			else
+			{
+				#if( configUSE_EVENT_GROUP_DIRECT_ISR == 1 )
+				{
+					if( xTaskRemoveFromUnorderedEventListFromISR( pxListItem, pxEventBits->uxEventBits | eventUNBLOCKED_DUE_TO_BIT_SET ) != pdFALSE )
+					{
+						xHigherPriorityTaskWoken = pdTRUE;
+					}
+					else
+					{
+						mtCOVERAGE_TEST_MARKER();
+					}
+				}
+				#endif /* configUSE_EVENT_GROUP_DIRECT_ISR */
+			}
+		}
+
+		/* Move onto the next list item.  Note pxListItem->pxNext is not
+		used here as the list item may have been removed from the event list
+		and inserted into the ready/pending reading list. */
+		pxListItem = pxNext;
+	}
+
+	/* Clear any bits that matched when the eventCLEAR_EVENTS_ON_EXIT_BIT
+	bit was set in the control word. */
+	if( xFromISR == pdFALSE )
+	{
+		eventENTER_BITS_UPDATE();
+		pxEventBits->uxEventBits &= ~uxBitsToClear;
+		eventEXIT_BITS_UPDATE();
+	}
+	else
+	{
+		pxEventBits->uxEventBits &= ~uxBitsToClear;
+	}
+
+	return xHigherPriorityTaskWoken;
+}
+/*-----------------------------------------------------------*/
+
+#if( configUSE_EVENT_GROUP_DIRECT_ISR == 1 )
+
+	static void prvLockEventGroup( EventGroup_t *pxEventBits )
+	{
+		taskENTER_CRITICAL();
+		{
+			( pxEventBits->uxLockCount )++;
+		}
+		taskEXIT_CRITICAL();
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvUnlockEventGroup( EventGroup_t *pxEventBits )
+	{
+	EventBits_t uxPendingBits;
+
+		/* THIS FUNCTION MUST BE CALLED WITH THE SCHEDULER SUSPENDED. */
+
+		for( ;; )
+		{
+			taskENTER_CRITICAL();
+			{
+				configASSERT( pxEventBits->uxLockCount > ( UBaseType_t ) 0 );
+				uxPendingBits = pxEventBits->uxPendingBits;
+
+				/* Only the outermost unlock sets the pending bits, and the
+				event group is only unlocked once there are none left. */
+				if( ( pxEventBits->uxLockCount > ( UBaseType_t ) 1 ) || ( uxPendingBits == ( EventBits_t ) 0 ) )
+				{
+					( pxEventBits->uxLockCount )--;
+					taskEXIT_CRITICAL();
+					break;
+				}
+				else
+				{
+					pxEventBits->uxPendingBits = 0;
+				}
+			}
+			taskEXIT_CRITICAL();
+
+			/* Still locked, so interrupts are adding to uxPendingBits rather
+			than using the list of waiting tasks. */
+			( void ) prvSetBitsAndUnblockTasks( pxEventBits, uxPendingBits, pdFALSE );
+		}
+	}
+	/*-----------------------------------------------------------*/
+
+	EventBits_t xEventGroupSetBitsDirectFromISR( EventGroupHandle_t xEventGroup, const EventBits_t uxBitsToSet, BaseType_t *pxHigherPriorityTaskWoken )
+	{
+	EventGroup_t *pxEventBits = xEventGroup;
+	UBaseType_t uxSavedInterruptStatus;
+	BaseType_t xTaskWoken = pdFALSE;
+	EventBits_t uxReturn;
+
+		configASSERT( xEventGroup );
+		configASSERT( ( uxBitsToSet & eventEVENT_BITS_CONTROL_BYTES ) == 0 );
+
+		/* See the comments in xQueueGenericSendFromISR(). */
+		portASSERT_IF_INTERRUPT_PRIORITY_INVALID();
+
+		traceEVENT_GROUP_SET_BITS_FROM_ISR( xEventGroup, uxBitsToSet );
+
+		uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+		{
+			if( pxEventBits->uxLockCount == ( UBaseType_t ) 0 )
+			{
+				/* Every waiting task is checked with interrupts masked, so
+				the number of waiting tasks is limited. */
+				configASSERT( listCURRENT_LIST_LENGTH( &( pxEventBits->xTasksWaitingForBits ) ) <= ( UBaseType_t ) configEVENT_GROUP_DIRECT_ISR_MAX_WAITERS );
+
+				xTaskWoken = prvSetBitsAndUnblockTasks( pxEventBits, uxBitsToSet, pdTRUE );
+				uxReturn = pxEventBits->uxEventBits;
+			}
+			else
+			{
+				/* A task is using the list of waiting tasks, it will set the
+				bits when it unlocks the event group. */
+				pxEventBits->uxPendingBits |= uxBitsToSet;
+				uxReturn = pxEventBits->uxEventBits | pxEventBits->uxPendingBits;
+			}
+		}
+		portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
+
+		if( ( xTaskWoken != pdFALSE ) && ( pxHigherPriorityTaskWoken != NULL ) )
+		{
+			*pxHigherPriorityTaskWoken = pdTRUE;
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		return uxReturn;
+	}
+	/*-----------------------------------------------------------*/
+
+	EventBits_t xEventGroupClearBitsDirectFromISR( EventGroupHandle_t xEventGroup, const EventBits_t uxBitsToClear )
+	{
+	EventGroup_t *pxEventBits = xEventGroup;
+	UBaseType_t uxSavedInterruptStatus;
+	EventBits_t uxReturn;
+
+		configASSERT( xEventGroup );
+		configASSERT( ( uxBitsToClear & eventEVENT_BITS_CONTROL_BYTES ) == 0 );
+
+		traceEVENT_GROUP_CLEAR_BITS_FROM_ISR( xEventGroup, uxBitsToClear );
+
+		/* Clearing bits never unblocks a task, and tasks only update the bits
+		from critical sections, so this can always be done directly. */
+		uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+		{
+			uxReturn = pxEventBits->uxEventBits;
+			pxEventBits->uxEventBits &= ~uxBitsToClear;
+
+			/* Bits an interrupt set earlier, that haven't been set yet, are
+			cleared too. */
+			pxEventBits->uxPendingBits &= ~uxBitsToClear;
+		}
+		portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
+
+		return uxReturn;
+	}
+
+#endif /* configUSE_EVENT_GROUP_DIRECT_ISR */
+/*-----------------------------------------------------------*/
+
 static BaseType_t prvTestWaitCondition( const EventBits_t uxCurrentEventBits, const EventBits_t uxBitsToWaitFor, const BaseType_t xWaitForAllBits )
 {
 BaseType_t xWaitConditionMet = pdFALSE;
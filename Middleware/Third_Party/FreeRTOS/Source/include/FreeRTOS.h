@@ -795,6 +795,35 @@ extern "C" {
 	#define configUSE_QUEUE_SETS 0
 #endif
 
+#ifndef configUSE_EVENT_GROUP_DIRECT_ISR
+	#define configUSE_EVENT_GROUP_DIRECT_ISR 0
+#endif
+
+#ifndef configEVENT_GROUP_DIRECT_ISR_MAX_WAITERS
+	/* The most tasks that can be waiting on an event group when its bits are
+	set by xEventGroupSetBitsDirectFromISR(), which bounds the time spent in
+	the interrupt. */
+	#define configEVENT_GROUP_DIRECT_ISR_MAX_WAITERS 4
+#endif
+
+#ifndef configUSE_TIMER_WHEEL
+	#define configUSE_TIMER_WHEEL 0
+#endif
+
+#ifndef configTIMER_WHEEL_LEVELS
+	/* The number of levels in the timer wheel used when configUSE_TIMER_WHEEL
+	is 1.  Each level is 2^configTIMER_WHEEL_SLOT_BITS times coarser than the
+	one below it.  Timers further in the future than the wheel covers are
+	re-filed from the top level until they are in range. */
+	#define configTIMER_WHEEL_LEVELS 4
+#endif
+
+#ifndef configTIMER_WHEEL_SLOT_BITS
+	/* Each level of the timer wheel has 2^configTIMER_WHEEL_SLOT_BITS slots,
+	each slot is a List_t. */
+	#define configTIMER_WHEEL_SLOT_BITS 5
+#endif
+
 #ifndef portTASK_USES_FLOATING_POINT
 	#define portTASK_USES_FLOATING_POINT()
 #endif
@@ -851,6 +880,18 @@ extern "C" {
 	#define configUSE_TASK_NOTIFICATIONS 1
 #endif
 
+/* Number of independent notification values (and states) each task has.
+Index 0 is the one used by the original (non-indexed) task notification API and
+by stream and message buffers, so additional indexes give drivers and libraries
+a notification of their own that can't be consumed by an unrelated wait. */
+#ifndef configTASK_NOTIFICATION_ARRAY_ENTRIES
+	#define configTASK_NOTIFICATION_ARRAY_ENTRIES 1
+#endif
+
+#if configTASK_NOTIFICATION_ARRAY_ENTRIES < 1
+	#error configTASK_NOTIFICATION_ARRAY_ENTRIES must be at least 1
+#endif
+
 #ifndef configUSE_POSIX_ERRNO
 	#define configUSE_POSIX_ERRNO 0
 #endif
@@ -1160,8 +1201,8 @@ typedef struct xSTATIC_TCB
 		struct	_reent	xDummy17;
 	#endif
 	#if ( configUSE_TASK_NOTIFICATIONS == 1 )
-		uint32_t 		ulDummy18;
-		uint8_t 		ucDummy19;
+		uint32_t 		ulDummy18[ configTASK_NOTIFICATION_ARRAY_ENTRIES ];
+		uint8_t 		ucDummy19[ configTASK_NOTIFICATION_ARRAY_ENTRIES ];
 	#endif
 	#if ( tskSTATIC_AND_DYNAMIC_ALLOCATION_POSSIBLE != 0 )
 		uint8_t			uxDummy20;
@@ -1246,6 +1287,11 @@ typedef struct xSTATIC_EVENT_GROUP
 			uint8_t ucDummy4;
 	#endif
 
+	#if( configUSE_EVENT_GROUP_DIRECT_ISR == 1 )
+		UBaseType_t uxDummy5;
+		TickType_t xDummy6;
+	#endif
+
 } StaticEventGroup_t;
 
 /*
@@ -562,6 +562,67 @@ EventBits_t xEventGroupSetBits( EventGroupHandle_t xEventGroup, const EventBits_
 	#define xEventGroupSetBitsFromISR( xEventGroup, uxBitsToSet, pxHigherPriorityTaskWoken ) xTimerPendFunctionCallFromISR( vEventGroupSetBitsCallback, ( void * ) xEventGroup, ( uint32_t ) uxBitsToSet, pxHigherPriorityTaskWoken )
 #endif
 
+/**
+ * event_groups.h
+ *<pre>
+	EventBits_t xEventGroupSetBitsDirectFromISR( EventGroupHandle_t xEventGroup, const EventBits_t uxBitsToSet, BaseType_t *pxHigherPriorityTaskWoken );
+ </pre>
+ *
+ * A version of xEventGroupSetBitsFromISR() that sets the bits and unblocks the
+ * waiting tasks from the interrupt itself, rather than deferring the operation
+ * to the timer daemon task.  Only available when configUSE_EVENT_GROUP_DIRECT_ISR
+ * is set to 1 in FreeRTOSConfig.h.
+ *
+ * To keep the time spent with interrupts masked bounded, no more than
+ * configEVENT_GROUP_DIRECT_ISR_MAX_WAITERS tasks may be blocked on the event
+ * group when this function is called (checked with configASSERT()).  If a task
+ * is using the event group when the interrupt occurs the bits are held as
+ * pending, and set by that task as soon as it has finished with the event
+ * group - no message is sent to the timer task, so this function cannot fail.
+ *
+ * @param xEventGroup The event group in which the bits are to be set.
+ *
+ * @param uxBitsToSet A bitwise value that indicates the bit or bits to set.
+ *
+ * @param pxHigherPriorityTaskWoken Set to pdTRUE if setting the bits unblocked
+ * a task with a priority higher than the currently running task, in which case
+ * a context switch should be requested before the interrupt exits.  Must be
+ * initialised to pdFALSE.
+ *
+ * @return The value of the event group after the bits were set (including any
+ * bits that are still pending).
+ *
+ * \defgroup xEventGroupSetBitsDirectFromISR xEventGroupSetBitsDirectFromISR
+ * \ingroup EventGroup
+ */
+#if( configUSE_EVENT_GROUP_DIRECT_ISR == 1 )
+	EventBits_t xEventGroupSetBitsDirectFromISR( EventGroupHandle_t xEventGroup, const EventBits_t uxBitsToSet, BaseType_t *pxHigherPriorityTaskWoken ) PRIVILEGED_FUNCTION;
+#endif
+
+/**
+ * event_groups.h
+ *<pre>
+	EventBits_t xEventGroupClearBitsDirectFromISR( EventGroupHandle_t xEventGroup, const EventBits_t uxBitsToClear );
+ </pre>
+ *
+ * A version of xEventGroupClearBitsFromISR() that clears the bits from the
+ * interrupt itself.  Clearing bits never unblocks a task so this always takes a
+ * fixed amount of time.  Only available when configUSE_EVENT_GROUP_DIRECT_ISR
+ * is set to 1 in FreeRTOSConfig.h.
+ *
+ * @param xEventGroup The event group in which the bits are to be cleared.
+ *
+ * @param uxBitsToClear A bitwise value that indicates the bit or bits to clear.
+ *
+ * @return The value of the event group before the specified bits were cleared.
+ *
+ * \defgroup xEventGroupClearBitsDirectFromISR xEventGroupClearBitsDirectFromISR
+ * \ingroup EventGroup
+ */
+#if( configUSE_EVENT_GROUP_DIRECT_ISR == 1 )
+	EventBits_t xEventGroupClearBitsDirectFromISR( EventGroupHandle_t xEventGroup, const EventBits_t uxBitsToClear ) PRIVILEGED_FUNCTION;
+#endif
+
 /**
  * event_groups.h
  *<pre>
@@ -792,6 +792,26 @@ BaseType_t xMessageBufferReceiveCompletedFromISR( MessageBufferHandle_t xStreamB
  */
 #define xMessageBufferReceiveCompletedFromISR( xMessageBuffer, pxHigherPriorityTaskWoken ) xStreamBufferReceiveCompletedFromISR( ( StreamBufferHandle_t ) xMessageBuffer, pxHigherPriorityTaskWoken )
 
+/**
+ * message_buffer.h
+ *
+ * Zero-copy message buffer access, see xStreamBufferSendAcquire() and
+ * xStreamBufferReceiveAcquire() in stream_buffer.h.  A message is reserved
+ * with its exact length, written in place and committed; a received message
+ * is used in place and removed whole by the commit.
+ *
+ * \defgroup xMessageBufferSendAcquire xMessageBufferSendAcquire
+ * \ingroup MessageBufferManagement
+ */
+#define xMessageBufferSendAcquire( xMessageBuffer, pxSpans, xDataLengthBytes, xTicksToWait ) xStreamBufferSendAcquire( ( StreamBufferHandle_t ) xMessageBuffer, pxSpans, xDataLengthBytes, xTicksToWait )
+#define xMessageBufferSendAcquireFromISR( xMessageBuffer, pxSpans, xDataLengthBytes ) xStreamBufferSendAcquireFromISR( ( StreamBufferHandle_t ) xMessageBuffer, pxSpans, xDataLengthBytes )
+#define xMessageBufferSendCommit( xMessageBuffer, xDataLengthBytes ) xStreamBufferSendCommit( ( StreamBufferHandle_t ) xMessageBuffer, xDataLengthBytes )
+#define xMessageBufferSendCommitFromISR( xMessageBuffer, xDataLengthBytes, pxHigherPriorityTaskWoken ) xStreamBufferSendCommitFromISR( ( StreamBufferHandle_t ) xMessageBuffer, xDataLengthBytes, pxHigherPriorityTaskWoken )
+#define xMessageBufferReceiveAcquire( xMessageBuffer, pxSpans, xTicksToWait ) xStreamBufferReceiveAcquire( ( StreamBufferHandle_t ) xMessageBuffer, pxSpans, xTicksToWait )
+#define xMessageBufferReceiveAcquireFromISR( xMessageBuffer, pxSpans ) xStreamBufferReceiveAcquireFromISR( ( StreamBufferHandle_t ) xMessageBuffer, pxSpans )
+#define xMessageBufferReceiveCommit( xMessageBuffer ) xStreamBufferReceiveCommit( ( StreamBufferHandle_t ) xMessageBuffer, ( size_t ) 1 )
+#define xMessageBufferReceiveCommitFromISR( xMessageBuffer, pxHigherPriorityTaskWoken ) xStreamBufferReceiveCommitFromISR( ( StreamBufferHandle_t ) xMessageBuffer, ( size_t ) 1, pxHigherPriorityTaskWoken )
+
 #if defined( __cplusplus )
 } /* extern "C" */
 #endif
@@ -1384,6 +1384,139 @@ BaseType_t xQueueGiveFromISR( QueueHandle_t xQueue, BaseType_t * const pxHigherP
  */
 BaseType_t xQueueReceiveFromISR( QueueHandle_t xQueue, void * const pvBuffer, BaseType_t * const pxHigherPriorityTaskWoken ) PRIVILEGED_FUNCTION;
 
+/**
+ * queue. h
+ * <pre>
+ UBaseType_t xQueueSendMultiple(
+									QueueHandle_t xQueue,
+									const void *pvItemsToQueue,
+									UBaseType_t uxItemCount,
+									TickType_t xTicksToWait
+								);
+ * </pre>
+ *
+ * Post uxItemCount items to the back of a queue.  Equivalent to calling
+ * xQueueSendToBack() once per item, but all the items that fit are copied
+ * within a single critical section, and waiting tasks are unblocked (and the
+ * calling task yields) at most once per batch rather than once per item.
+ *
+ * If the queue doesn't have room for all the items, the ones that fit are
+ * posted immediately and the calling task blocks (for no longer than
+ * xTicksToWait in total) until there is room for the rest.  Items are always
+ * posted in order, but if another task sends to the same queue while this
+ * task is blocked its items can end up between the two parts of the batch.
+ *
+ * Can only be used with queues, not semaphores or mutexes.
+ *
+ * @param xQueue The handle to the queue on which the items are to be posted.
+ *
+ * @param pvItemsToQueue A pointer to an array of uxItemCount items, each of
+ * the size the queue was created with.
+ *
+ * @param uxItemCount The number of items to post.
+ *
+ * @param xTicksToWait The maximum amount of time the task should block
+ * waiting for space to become available on the queue.
+ *
+ * @return The number of items posted, which is less than uxItemCount if the
+ * queue stayed full until xTicksToWait expired.
+ *
+ * \defgroup xQueueSendMultiple xQueueSendMultiple
+ * \ingroup QueueManagement
+ */
+UBaseType_t xQueueSendMultiple( QueueHandle_t xQueue, const void * const pvItemsToQueue, const UBaseType_t uxItemCount, TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+
+/**
+ * queue. h
+ * <pre>
+ UBaseType_t xQueueSendMultipleFromISR(
+									QueueHandle_t xQueue,
+									const void *pvItemsToQueue,
+									UBaseType_t uxItemCount,
+									BaseType_t *pxHigherPriorityTaskWoken
+								);
+ * </pre>
+ *
+ * Version of xQueueSendMultiple() that can be used from an interrupt service
+ * routine.  Posts as many of the items as there is room for, without
+ * blocking.
+ *
+ * @param pxHigherPriorityTaskWoken Set to pdTRUE if posting the items
+ * unblocked a task with a priority higher than the currently running task,
+ * in which case a context switch should be requested before the interrupt
+ * is exited.
+ *
+ * @return The number of items posted.
+ *
+ * \defgroup xQueueSendMultipleFromISR xQueueSendMultipleFromISR
+ * \ingroup QueueManagement
+ */
+UBaseType_t xQueueSendMultipleFromISR( QueueHandle_t xQueue, const void * const pvItemsToQueue, const UBaseType_t uxItemCount, BaseType_t * const pxHigherPriorityTaskWoken ) PRIVILEGED_FUNCTION;
+
+/**
+ * queue. h
+ * <pre>
+ UBaseType_t xQueueReceiveMultiple(
+									QueueHandle_t xQueue,
+									void *pvBuffer,
+									UBaseType_t uxMaxItems,
+									TickType_t xTicksToWait
+								);
+ * </pre>
+ *
+ * Receive up to uxMaxItems items from a queue.  Blocks (for no longer than
+ * xTicksToWait) until at least one item is available, then removes as many
+ * of the items in the queue as will fit in pvBuffer, oldest first, within a
+ * single critical section.  Tasks waiting for space are unblocked (and the
+ * calling task yields) at most once per batch rather than once per item.
+ *
+ * Can only be used with queues, not semaphores or mutexes.
+ *
+ * @param xQueue The handle to the queue from which the items are to be
+ * received.
+ *
+ * @param pvBuffer Pointer to an array with room for uxMaxItems items.
+ *
+ * @param uxMaxItems The maximum number of items to receive.
+ *
+ * @param xTicksToWait The maximum amount of time the task should block
+ * waiting for an item to receive should the queue be empty.
+ *
+ * @return The number of items received, 0 if the queue stayed empty until
+ * xTicksToWait expired.
+ *
+ * \defgroup xQueueReceiveMultiple xQueueReceiveMultiple
+ * \ingroup QueueManagement
+ */
+UBaseType_t xQueueReceiveMultiple( QueueHandle_t xQueue, void * const pvBuffer, const UBaseType_t uxMaxItems, TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+
+/**
+ * queue. h
+ * <pre>
+ UBaseType_t xQueueReceiveMultipleFromISR(
+									QueueHandle_t xQueue,
+									void *pvBuffer,
+									UBaseType_t uxMaxItems,
+									BaseType_t *pxHigherPriorityTaskWoken
+								);
+ * </pre>
+ *
+ * Version of xQueueReceiveMultiple() that can be used from an interrupt
+ * service routine.  Receives up to uxMaxItems of the items currently in the
+ * queue, without blocking.
+ *
+ * @param pxHigherPriorityTaskWoken Set to pdTRUE if receiving the items
+ * unblocked a task with a priority higher than the currently running task,
+ * in which case a context switch should be requested before the interrupt
+ * is exited.
+ *
+ * @return The number of items received.
+ *
+ * \defgroup xQueueReceiveMultipleFromISR xQueueReceiveMultipleFromISR
+ * \ingroup QueueManagement
+ */
+UBaseType_t xQueueReceiveMultipleFromISR( QueueHandle_t xQueue, void * const pvBuffer, const UBaseType_t uxMaxItems, BaseType_t * const pxHigherPriorityTaskWoken ) PRIVILEGED_FUNCTION;
+
 /*
  * Utilities to query queues that are safe to use from an ISR.  These utilities
  * should be used only from witin an ISR, or within a critical section.
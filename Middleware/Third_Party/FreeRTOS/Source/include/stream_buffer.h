@@ -64,6 +64,18 @@ extern "C" {
 struct StreamBufferDef_t;
 typedef struct StreamBufferDef_t * StreamBufferHandle_t;
 
+/**
+ * One contiguous region of a stream buffer's storage area, as returned by the
+ * zero-copy functions (xStreamBufferSendAcquire(), xStreamBufferReceiveAcquire()
+ * etc.).  Data that wraps around the end of the storage area is described by
+ * two spans, xLength is 0 for a span that isn't needed.
+ */
+typedef struct StreamBufferSpan
+{
+	uint8_t *pucData;	/* First byte of the region. */
+	size_t xLength;		/* Number of bytes in the region. */
+} StreamBufferSpan_t;
+
 
 /**
  * message_buffer.h
@@ -586,6 +598,133 @@ size_t xStreamBufferReceiveFromISR( StreamBufferHandle_t xStreamBuffer,
 									size_t xBufferLengthBytes,
 									BaseType_t * const pxHigherPriorityTaskWoken ) PRIVILEGED_FUNCTION;
 
+/**
+ * stream_buffer.h
+ *
+<pre>
+size_t xStreamBufferSendAcquire( StreamBufferHandle_t xStreamBuffer,
+                                 StreamBufferSpan_t pxSpans[ 2 ],
+                                 size_t xDataLengthBytes,
+                                 TickType_t xTicksToWait );
+size_t xStreamBufferSendAcquireFromISR( StreamBufferHandle_t xStreamBuffer,
+                                        StreamBufferSpan_t pxSpans[ 2 ],
+                                        size_t xDataLengthBytes );
+size_t xStreamBufferSendCommit( StreamBufferHandle_t xStreamBuffer,
+                                size_t xDataLengthBytes );
+size_t xStreamBufferSendCommitFromISR( StreamBufferHandle_t xStreamBuffer,
+                                       size_t xDataLengthBytes,
+                                       BaseType_t *pxHigherPriorityTaskWoken );
+</pre>
+ *
+ * Zero-copy version of xStreamBufferSend().  Instead of copying from a
+ * caller supplied buffer, the writer fills the stream buffer's own storage
+ * area (e.g. with a DMA transfer) and then commits the bytes it has written.
+ *
+ * xStreamBufferSendAcquire() blocks, like xStreamBufferSend(), until at least
+ * xDataLengthBytes are free (plus room for the length when used as a message
+ * buffer) or xTicksToWait expires.  It then describes the free space in
+ * pxSpans[ 0 ] and, when it wraps around the end of the storage area,
+ * pxSpans[ 1 ].  Nothing is visible to the reader until
+ * xStreamBufferSendCommit() is called with the number of bytes actually
+ * written, starting at pxSpans[ 0 ].pucData and continuing at
+ * pxSpans[ 1 ].pucData.  The commit unblocks a waiting reader exactly as
+ * xStreamBufferSend() would.  Committing 0 bytes abandons the acquisition.
+ *
+ * As with xStreamBufferSend(), there must only be one writer, and the writer
+ * must not acquire again before committing.
+ *
+ * @param xStreamBuffer The handle of the stream buffer being written to.
+ *
+ * @param pxSpans Filled with up to two regions that may be written.
+ *
+ * @param xDataLengthBytes For a stream buffer, the minimum amount of free
+ * space to wait for.  For a message buffer, the exact length of the message.
+ *
+ * @param xTicksToWait The maximum amount of time to wait for the space.
+ *
+ * @return For a stream buffer, the total free space described by pxSpans
+ * (which can be less than xDataLengthBytes if the wait timed out).  For a
+ * message buffer, xDataLengthBytes or 0 if the message doesn't fit.  The
+ * commit functions return the number of bytes committed.
+ *
+ * \defgroup xStreamBufferSendAcquire xStreamBufferSendAcquire
+ * \ingroup StreamBufferManagement
+ */
+size_t xStreamBufferSendAcquire( StreamBufferHandle_t xStreamBuffer,
+								 StreamBufferSpan_t pxSpans[ 2 ],
+								 size_t xDataLengthBytes,
+								 TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+
+size_t xStreamBufferSendAcquireFromISR( StreamBufferHandle_t xStreamBuffer,
+										StreamBufferSpan_t pxSpans[ 2 ],
+										size_t xDataLengthBytes ) PRIVILEGED_FUNCTION;
+
+size_t xStreamBufferSendCommit( StreamBufferHandle_t xStreamBuffer,
+								size_t xDataLengthBytes ) PRIVILEGED_FUNCTION;
+
+size_t xStreamBufferSendCommitFromISR( StreamBufferHandle_t xStreamBuffer,
+									   size_t xDataLengthBytes,
+									   BaseType_t * const pxHigherPriorityTaskWoken ) PRIVILEGED_FUNCTION;
+
+/**
+ * stream_buffer.h
+ *
+<pre>
+size_t xStreamBufferReceiveAcquire( StreamBufferHandle_t xStreamBuffer,
+                                    StreamBufferSpan_t pxSpans[ 2 ],
+                                    TickType_t xTicksToWait );
+size_t xStreamBufferReceiveAcquireFromISR( StreamBufferHandle_t xStreamBuffer,
+                                           StreamBufferSpan_t pxSpans[ 2 ] );
+size_t xStreamBufferReceiveCommit( StreamBufferHandle_t xStreamBuffer,
+                                   size_t xReceivedLength );
+size_t xStreamBufferReceiveCommitFromISR( StreamBufferHandle_t xStreamBuffer,
+                                          size_t xReceivedLength,
+                                          BaseType_t *pxHigherPriorityTaskWoken );
+</pre>
+ *
+ * Zero-copy version of xStreamBufferReceive().  Instead of copying into a
+ * caller supplied buffer, the reader uses the data where it is in the stream
+ * buffer's storage area (e.g. as the source of a DMA or USB transfer) and
+ * then commits the bytes it has consumed.
+ *
+ * xStreamBufferReceiveAcquire() blocks, like xStreamBufferReceive(), until
+ * data is available or xTicksToWait expires.  It then describes the data in
+ * pxSpans[ 0 ] and, when it wraps around the end of the storage area,
+ * pxSpans[ 1 ].  The data stays in the buffer (and the writer can't reuse its
+ * space) until xStreamBufferReceiveCommit() is called with the number of bytes
+ * consumed.  The commit unblocks a waiting writer exactly as
+ * xStreamBufferReceive() would.  For a message buffer the spans hold the next
+ * message and any non-zero commit removes the whole message.
+ *
+ * As with xStreamBufferReceive(), there must only be one reader.
+ *
+ * @param xStreamBuffer The handle of the stream buffer being read from.
+ *
+ * @param pxSpans Filled with up to two regions holding the data.
+ *
+ * @param xTicksToWait The maximum amount of time to wait for data.
+ *
+ * @return The total number of bytes described by pxSpans (for a message
+ * buffer, the length of the next message), 0 if there is no data.  The commit
+ * functions return the number of bytes removed.
+ *
+ * \defgroup xStreamBufferReceiveAcquire xStreamBufferReceiveAcquire
+ * \ingroup StreamBufferManagement
+ */
+size_t xStreamBufferReceiveAcquire( StreamBufferHandle_t xStreamBuffer,
+									StreamBufferSpan_t pxSpans[ 2 ],
+									TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+
+size_t xStreamBufferReceiveAcquireFromISR( StreamBufferHandle_t xStreamBuffer,
+										   StreamBufferSpan_t pxSpans[ 2 ] ) PRIVILEGED_FUNCTION;
+
+size_t xStreamBufferReceiveCommit( StreamBufferHandle_t xStreamBuffer,
+								   size_t xReceivedLength ) PRIVILEGED_FUNCTION;
+
+size_t xStreamBufferReceiveCommitFromISR( StreamBufferHandle_t xStreamBuffer,
+										  size_t xReceivedLength,
+										  BaseType_t * const pxHigherPriorityTaskWoken ) PRIVILEGED_FUNCTION;
+
 /**
  * stream_buffer.h
  *
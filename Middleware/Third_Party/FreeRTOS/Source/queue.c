@@ -51,6 +51,7 @@ correct privileged Vs unprivileged linkage and placement. */
 /* Constants used with the cRxLock and cTxLock structure members. */
 #define queueUNLOCKED					( ( int8_t ) -1 )
 #define queueLOCKED_UNMODIFIED			( ( int8_t ) 0 )
+#define queueLOCK_COUNT_MAX				( ( int8_t ) 127 )
 
 /* When the Queue_t structure is used to represent a base queue its pcHead and
 pcTail members are used as pointers into the queue storage area.  When the
@@ -198,6 +199,16 @@ static BaseType_t prvCopyDataToQueue( Queue_t * const pxQueue, const void *pvIte
  */
 static void prvCopyDataFromQueue( Queue_t * const pxQueue, void * const pvBuffer ) PRIVILEGED_FUNCTION;
 
+/*
+ * Removes up to uxMaxTasks tasks from an event list, used when more than one
+ * item has been added to or removed from a queue at once.  Must be called
+ * from a critical section.
+ *
+ * @return pdTRUE if any of the removed tasks has a higher priority than the
+ * calling task, otherwise pdFALSE.
+ */
+static BaseType_t prvRemoveTasksFromEventList( List_t * const pxEventList, UBaseType_t uxMaxTasks ) PRIVILEGED_FUNCTION;
+
 #if ( configUSE_QUEUE_SETS == 1 )
 	/*
 	 * Checks to see if a queue is a member of a queue set, and if so, notifies
@@ -1869,6 +1880,490 @@ Queue_t * const pxQueue = xQueue;
 }
 /*-----------------------------------------------------------*/
 
+UBaseType_t xQueueSendMultiple( QueueHandle_t xQueue, const void * const pvItemsToQueue, const UBaseType_t uxItemCount, TickType_t xTicksToWait )
+{
+BaseType_t xEntryTimeSet = pdFALSE, xYieldRequired;
+TimeOut_t xTimeOut;
+Queue_t * const pxQueue = xQueue;
+const BaseType_t xCopyPosition = queueSEND_TO_BACK;
+const uint8_t *pucNextItem = ( const uint8_t * ) pvItemsToQueue;
+const void *pvItemToQueue = pvItemsToQueue;
+UBaseType_t uxSent = 0, uxCopied;
+
+	configASSERT( pxQueue );
+	configASSERT( pvItemsToQueue );
+
+	/* Semaphores and mutexes don't have items to copy. */
+	configASSERT( pxQueue->uxItemSize != ( UBaseType_t ) 0U );
+	#if ( ( INCLUDE_xTaskGetSchedulerState == 1 ) || ( configUSE_TIMERS == 1 ) )
+	{
+		configASSERT( !( ( xTaskGetSchedulerState() == taskSCHEDULER_SUSPENDED ) && ( xTicksToWait != 0 ) ) );
+	}
+	#endif
+
+	/*lint -save -e904 This function relaxes the coding standard somewhat to
+	allow return statements within the function itself.  This is done in the
+	interest of execution time efficiency. */
+	for( ;; )
+	{
+		taskENTER_CRITICAL();
+		{
+			/* Copy as many items as there is room for.  Items are always
+			added to the back of the queue so their order is preserved. */
+			uxCopied = 0;
+			xYieldRequired = pdFALSE;
+
+			while( ( uxSent < uxItemCount ) && ( pxQueue->uxMessagesWaiting < pxQueue->uxLength ) )
+			{
+				pvItemToQueue = pucNextItem;
+				traceQUEUE_SEND( pxQueue );
+				( void ) prvCopyDataToQueue( pxQueue, pvItemToQueue, xCopyPosition );
+
+				#if ( configUSE_QUEUE_SETS == 1 )
+				{
+					/* A queue set holds one entry per item. */
+					if( pxQueue->pxQueueSetContainer != NULL )
+					{
+						if( prvNotifyQueueSetContainer( pxQueue, xCopyPosition ) != pdFALSE )
+						{
+							xYieldRequired = pdTRUE;
+						}
+						else
+						{
+							mtCOVERAGE_TEST_MARKER();
+						}
+					}
+					else
+					{
+						mtCOVERAGE_TEST_MARKER();
+					}
+				}
+				#endif /* configUSE_QUEUE_SETS */
+
+				pucNextItem += pxQueue->uxItemSize; /*lint !e9016 Pointer arithmetic on char types ok. */
+				uxSent++;
+				uxCopied++;
+			}
+
+			if( uxCopied > ( UBaseType_t ) 0 )
+			{
+				#if ( configUSE_QUEUE_SETS == 1 )
+				if( pxQueue->pxQueueSetContainer == NULL )
+				#endif /* configUSE_QUEUE_SETS */
+				{
+					/* Each item copied can satisfy one task waiting for data,
+					but the calling task only yields once. */
+					if( prvRemoveTasksFromEventList( &( pxQueue->xTasksWaitingToReceive ), uxCopied ) != pdFALSE )
+					{
+						xYieldRequired = pdTRUE;
+					}
+					else
+					{
+						mtCOVERAGE_TEST_MARKER();
+					}
+				}
+
+				if( xYieldRequired != pdFALSE )
+				{
+					/* Yes it is ok to do this from within the critical section -
+					the kernel takes care of that. */
+					queueYIELD_IF_USING_PREEMPTION();
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+
+			if( uxSent == uxItemCount )
+			{
+				taskEXIT_CRITICAL();
+				return uxSent;
+			}
+			else if( xTicksToWait == ( TickType_t ) 0 )
+			{
+				/* The queue is full and no block time is specified (or the
+				block time has expired) so leave now with what was sent. */
+				taskEXIT_CRITICAL();
+				traceQUEUE_SEND_FAILED( pxQueue );
+				return uxSent;
+			}
+			else if( xEntryTimeSet == pdFALSE )
+			{
+				/* The queue is full and a block time was specified so
+				configure the timeout structure. */
+				vTaskInternalSetTimeOutState( &xTimeOut );
+				xEntryTimeSet = pdTRUE;
+			}
+			else
+			{
+				/* Entry time was already set. */
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		taskEXIT_CRITICAL();
+
+		/* Interrupts and other tasks can send to and receive from the queue
+		now the critical section has been exited. */
+
+		vTaskSuspendAll();
+		prvLockQueue( pxQueue );
+
+		/* Update the timeout state to see if it has expired yet. */
+		if( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) == pdFALSE )
+		{
+			if( prvIsQueueFull( pxQueue ) != pdFALSE )
+			{
+				traceBLOCKING_ON_QUEUE_SEND( pxQueue );
+				vTaskPlaceOnEventList( &( pxQueue->xTasksWaitingToSend ), xTicksToWait );
+				prvUnlockQueue( pxQueue );
+
+				if( xTaskResumeAll() == pdFALSE )
+				{
+					portYIELD_WITHIN_API();
+				}
+			}
+			else
+			{
+				/* Try again. */
+				prvUnlockQueue( pxQueue );
+				( void ) xTaskResumeAll();
+			}
+		}
+		else
+		{
+			/* The timeout has expired. */
+			prvUnlockQueue( pxQueue );
+			( void ) xTaskResumeAll();
+
+			traceQUEUE_SEND_FAILED( pxQueue );
+			return uxSent;
+		}
+	} /*lint -restore */
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t xQueueSendMultipleFromISR( QueueHandle_t xQueue, const void * const pvItemsToQueue, const UBaseType_t uxItemCount, BaseType_t * const pxHigherPriorityTaskWoken )
+{
+UBaseType_t uxSavedInterruptStatus;
+Queue_t * const pxQueue = xQueue;
+const BaseType_t xCopyPosition = queueSEND_TO_BACK;
+const uint8_t *pucNextItem = ( const uint8_t * ) pvItemsToQueue;
+const void *pvItemToQueue;
+UBaseType_t uxSent = 0;
+BaseType_t xTaskWoken = pdFALSE;
+
+	configASSERT( pxQueue );
+	configASSERT( pvItemsToQueue );
+	configASSERT( pxQueue->uxItemSize != ( UBaseType_t ) 0U );
+
+	/* See the comments in xQueueGenericSendFromISR(). */
+	portASSERT_IF_INTERRUPT_PRIORITY_INVALID();
+
+	uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+	{
+		const int8_t cTxLock = pxQueue->cTxLock;
+
+		while( ( uxSent < uxItemCount ) && ( pxQueue->uxMessagesWaiting < pxQueue->uxLength ) )
+		{
+			pvItemToQueue = pucNextItem;
+			traceQUEUE_SEND_FROM_ISR( pxQueue );
+
+			/* pxQueue is not a semaphore or mutex, so prvCopyDataToQueue()
+			cannot result in a task disinheriting a priority. */
+			( void ) prvCopyDataToQueue( pxQueue, pvItemToQueue, xCopyPosition );
+
+			#if ( configUSE_QUEUE_SETS == 1 )
+			{
+				if( ( cTxLock == queueUNLOCKED ) && ( pxQueue->pxQueueSetContainer != NULL ) )
+				{
+					if( prvNotifyQueueSetContainer( pxQueue, xCopyPosition ) != pdFALSE )
+					{
+						xTaskWoken = pdTRUE;
+					}
+					else
+					{
+						mtCOVERAGE_TEST_MARKER();
+					}
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+			}
+			#endif /* configUSE_QUEUE_SETS */
+
+			pucNextItem += pxQueue->uxItemSize; /*lint !e9016 Pointer arithmetic on char types ok. */
+			uxSent++;
+		}
+
+		if( uxSent > ( UBaseType_t ) 0 )
+		{
+			/* The event list is not altered if the queue is locked.  This will
+			be done when the queue is unlocked later. */
+			if( cTxLock == queueUNLOCKED )
+			{
+				#if ( configUSE_QUEUE_SETS == 1 )
+				if( pxQueue->pxQueueSetContainer == NULL )
+				#endif /* configUSE_QUEUE_SETS */
+				{
+					if( prvRemoveTasksFromEventList( &( pxQueue->xTasksWaitingToReceive ), uxSent ) != pdFALSE )
+					{
+						xTaskWoken = pdTRUE;
+					}
+					else
+					{
+						mtCOVERAGE_TEST_MARKER();
+					}
+				}
+			}
+			else
+			{
+				/* Increment the lock count once per item so the task that
+				unlocks the queue knows how many tasks may need unblocking.
+				Unlocking stops early once the event list is empty, so the
+				count can saturate. */
+				if( ( UBaseType_t ) cTxLock + uxSent < ( UBaseType_t ) queueLOCK_COUNT_MAX )
+				{
+					pxQueue->cTxLock = ( int8_t ) ( ( UBaseType_t ) cTxLock + uxSent );
+				}
+				else
+				{
+					pxQueue->cTxLock = queueLOCK_COUNT_MAX;
+				}
+			}
+		}
+		else
+		{
+			traceQUEUE_SEND_FROM_ISR_FAILED( pxQueue );
+		}
+	}
+	portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
+
+	if( ( xTaskWoken != pdFALSE ) && ( pxHigherPriorityTaskWoken != NULL ) )
+	{
+		*pxHigherPriorityTaskWoken = pdTRUE;
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	return uxSent;
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t xQueueReceiveMultiple( QueueHandle_t xQueue, void * const pvBuffer, const UBaseType_t uxMaxItems, TickType_t xTicksToWait )
+{
+BaseType_t xEntryTimeSet = pdFALSE;
+TimeOut_t xTimeOut;
+Queue_t * const pxQueue = xQueue;
+uint8_t *pucNextItem = ( uint8_t * ) pvBuffer;
+UBaseType_t uxReceived;
+
+	configASSERT( pxQueue );
+	configASSERT( pvBuffer );
+	configASSERT( uxMaxItems > ( UBaseType_t ) 0 );
+
+	/* Semaphores and mutexes don't have items to copy. */
+	configASSERT( pxQueue->uxItemSize != ( UBaseType_t ) 0U );
+
+	/* Cannot block if the scheduler is suspended. */
+	#if ( ( INCLUDE_xTaskGetSchedulerState == 1 ) || ( configUSE_TIMERS == 1 ) )
+	{
+		configASSERT( !( ( xTaskGetSchedulerState() == taskSCHEDULER_SUSPENDED ) && ( xTicksToWait != 0 ) ) );
+	}
+	#endif
+
+	/*lint -save -e904  This function relaxes the coding standard somewhat to
+	allow return statements within the function itself.  This is done in the
+	interest of execution time efficiency. */
+	for( ;; )
+	{
+		taskENTER_CRITICAL();
+		{
+			/* Is there data in the queue now?  To be running the calling task
+			must be the highest priority task wanting to access the queue. */
+			if( pxQueue->uxMessagesWaiting > ( UBaseType_t ) 0 )
+			{
+				/* Data available, remove as many items as will fit. */
+				uxReceived = 0;
+
+				while( ( uxReceived < uxMaxItems ) && ( pxQueue->uxMessagesWaiting > ( UBaseType_t ) 0 ) )
+				{
+					prvCopyDataFromQueue( pxQueue, pucNextItem );
+					traceQUEUE_RECEIVE( pxQueue );
+					pxQueue->uxMessagesWaiting--;
+					pucNextItem += pxQueue->uxItemSize; /*lint !e9016 Pointer arithmetic on char types ok. */
+					uxReceived++;
+				}
+
+				/* There is now space for uxReceived items, unblock that many
+				of the tasks waiting to post to the queue but only yield
+				once. */
+				if( prvRemoveTasksFromEventList( &( pxQueue->xTasksWaitingToSend ), uxReceived ) != pdFALSE )
+				{
+					queueYIELD_IF_USING_PREEMPTION();
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+
+				taskEXIT_CRITICAL();
+				return uxReceived;
+			}
+			else
+			{
+				if( xTicksToWait == ( TickType_t ) 0 )
+				{
+					/* The queue was empty and no block time is specified (or
+					the block time has expired) so leave now. */
+					taskEXIT_CRITICAL();
+					traceQUEUE_RECEIVE_FAILED( pxQueue );
+					return 0;
+				}
+				else if( xEntryTimeSet == pdFALSE )
+				{
+					/* The queue was empty and a block time was specified so
+					configure the timeout structure. */
+					vTaskInternalSetTimeOutState( &xTimeOut );
+					xEntryTimeSet = pdTRUE;
+				}
+				else
+				{
+					/* Entry time was already set. */
+					mtCOVERAGE_TEST_MARKER();
+				}
+			}
+		}
+		taskEXIT_CRITICAL();
+
+		/* Interrupts and other tasks can send to and receive from the queue
+		now the critical section has been exited. */
+
+		vTaskSuspendAll();
+		prvLockQueue( pxQueue );
+
+		/* Update the timeout state to see if it has expired yet. */
+		if( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) == pdFALSE )
+		{
+			/* The timeout has not expired.  If the queue is still empty place
+			the task on the list of tasks waiting to receive from the queue. */
+			if( prvIsQueueEmpty( pxQueue ) != pdFALSE )
+			{
+				traceBLOCKING_ON_QUEUE_RECEIVE( pxQueue );
+				vTaskPlaceOnEventList( &( pxQueue->xTasksWaitingToReceive ), xTicksToWait );
+				prvUnlockQueue( pxQueue );
+				if( xTaskResumeAll() == pdFALSE )
+				{
+					portYIELD_WITHIN_API();
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+			}
+			else
+			{
+				/* The queue contains data again.  Loop back to try and read the
+				data. */
+				prvUnlockQueue( pxQueue );
+				( void ) xTaskResumeAll();
+			}
+		}
+		else
+		{
+			/* Timed out.  If there is no data in the queue exit, otherwise loop
+			back and attempt to read the data. */
+			prvUnlockQueue( pxQueue );
+			( void ) xTaskResumeAll();
+
+			if( prvIsQueueEmpty( pxQueue ) != pdFALSE )
+			{
+				traceQUEUE_RECEIVE_FAILED( pxQueue );
+				return 0;
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+	} /*lint -restore */
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t xQueueReceiveMultipleFromISR( QueueHandle_t xQueue, void * const pvBuffer, const UBaseType_t uxMaxItems, BaseType_t * const pxHigherPriorityTaskWoken )
+{
+UBaseType_t uxSavedInterruptStatus;
+Queue_t * const pxQueue = xQueue;
+uint8_t *pucNextItem = ( uint8_t * ) pvBuffer;
+UBaseType_t uxReceived = 0;
+BaseType_t xTaskWoken = pdFALSE;
+
+	configASSERT( pxQueue );
+	configASSERT( pvBuffer );
+	configASSERT( pxQueue->uxItemSize != ( UBaseType_t ) 0U );
+
+	/* See the comments in xQueueReceiveFromISR(). */
+	portASSERT_IF_INTERRUPT_PRIORITY_INVALID();
+
+	uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+	{
+		const int8_t cRxLock = pxQueue->cRxLock;
+
+		while( ( uxReceived < uxMaxItems ) && ( pxQueue->uxMessagesWaiting > ( UBaseType_t ) 0 ) )
+		{
+			traceQUEUE_RECEIVE_FROM_ISR( pxQueue );
+			prvCopyDataFromQueue( pxQueue, pucNextItem );
+			pxQueue->uxMessagesWaiting--;
+			pucNextItem += pxQueue->uxItemSize; /*lint !e9016 Pointer arithmetic on char types ok. */
+			uxReceived++;
+		}
+
+		if( uxReceived > ( UBaseType_t ) 0 )
+		{
+			/* If the queue is locked the event list will not be modified.
+			Instead update the lock count so the task that unlocks the queue
+			will know that an ISR has removed data while the queue was
+			locked. */
+			if( cRxLock == queueUNLOCKED )
+			{
+				xTaskWoken = prvRemoveTasksFromEventList( &( pxQueue->xTasksWaitingToSend ), uxReceived );
+			}
+			else if( ( UBaseType_t ) cRxLock + uxReceived < ( UBaseType_t ) queueLOCK_COUNT_MAX )
+			{
+				pxQueue->cRxLock = ( int8_t ) ( ( UBaseType_t ) cRxLock + uxReceived );
+			}
+			else
+			{
+				pxQueue->cRxLock = queueLOCK_COUNT_MAX;
+			}
+		}
+		else
+		{
+			traceQUEUE_RECEIVE_FROM_ISR_FAILED( pxQueue );
+		}
+	}
+	portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
+
+	if( ( xTaskWoken != pdFALSE ) && ( pxHigherPriorityTaskWoken != NULL ) )
+	{
+		*pxHigherPriorityTaskWoken = pdTRUE;
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	return uxReceived;
+}
+/*-----------------------------------------------------------*/
+
 BaseType_t xQueuePeekFromISR( QueueHandle_t xQueue,  void * const pvBuffer )
 {
 BaseType_t xReturn;
@@ -2164,6 +2659,30 @@ static void prvCopyDataFromQueue( Queue_t * const pxQueue, void * const pvBuffer
 }
 /*-----------------------------------------------------------*/
 
+static BaseType_t prvRemoveTasksFromEventList( List_t * const pxEventList, UBaseType_t uxMaxTasks )
+{
+BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+	/* This function is called from a critical section. */
+
+	while( ( uxMaxTasks > ( UBaseType_t ) 0 ) && ( listLIST_IS_EMPTY( pxEventList ) == pdFALSE ) )
+	{
+		if( xTaskRemoveFromEventList( pxEventList ) != pdFALSE )
+		{
+			xHigherPriorityTaskWoken = pdTRUE;
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		uxMaxTasks--;
+	}
+
+	return xHigherPriorityTaskWoken;
+}
+/*-----------------------------------------------------------*/
+
 static void prvUnlockQueue( Queue_t * const pxQueue )
 {
 	/* THIS FUNCTION MUST BE CALLED WITH THE SCHEDULER SUSPENDED. */
@@ -202,6 +202,63 @@ static size_t prvReadBytesFromBuffer( StreamBuffer_t *pxStreamBuffer,
 									  size_t xMaxCount,
 									  size_t xBytesAvailable ) PRIVILEGED_FUNCTION;
 
+/*
+ * Block until at least xRequiredSpace bytes are free or xTicksToWait expires.
+ * Returns the number of free bytes, which may be less than xRequiredSpace.
+ */
+static size_t prvWaitForSpace( StreamBufferHandle_t xStreamBuffer,
+							   size_t xRequiredSpace,
+							   TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+
+/*
+ * Block until more than xBytesToStoreMessageLength bytes are in the buffer or
+ * xTicksToWait expires.  Returns the number of bytes in the buffer.
+ */
+static size_t prvWaitForData( StreamBufferHandle_t xStreamBuffer,
+							  size_t xBytesToStoreMessageLength,
+							  TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+
+/*
+ * Describe the xCount bytes starting at index xStart of the buffer's storage
+ * area as one span, or two if they wrap around the end.  Returns xCount.
+ */
+static size_t prvGetSpans( const StreamBuffer_t * const pxStreamBuffer,
+						   size_t xStart,
+						   size_t xCount,
+						   StreamBufferSpan_t pxSpans[ 2 ] ) PRIVILEGED_FUNCTION;
+
+/*
+ * The free space a writer may fill in place - all of it for a stream buffer,
+ * xDataLengthBytes after room for the length for a message buffer (or nothing
+ * if the message doesn't fit).
+ */
+static size_t prvAcquireWriteSpans( const StreamBuffer_t * const pxStreamBuffer,
+									StreamBufferSpan_t pxSpans[ 2 ],
+									size_t xDataLengthBytes,
+									size_t xSpace ) PRIVILEGED_FUNCTION;
+
+/*
+ * The data a reader may use in place - everything in a stream buffer, the
+ * next message (without its length) in a message buffer.
+ */
+static size_t prvAcquireReadSpans( StreamBuffer_t * const pxStreamBuffer,
+								   StreamBufferSpan_t pxSpans[ 2 ],
+								   size_t xBytesAvailable ) PRIVILEGED_FUNCTION;
+
+/*
+ * Make xDataLengthBytes written in place visible to the reader, storing the
+ * message length first if this is a message buffer.
+ */
+static size_t prvCommitWrite( StreamBuffer_t * const pxStreamBuffer,
+							  size_t xDataLengthBytes ) PRIVILEGED_FUNCTION;
+
+/*
+ * Remove xReceivedLength bytes that were used in place - or the whole next
+ * message if this is a message buffer.
+ */
+static size_t prvCommitRead( StreamBuffer_t * const pxStreamBuffer,
+							 size_t xReceivedLength ) PRIVILEGED_FUNCTION;
+
 /*
  * Called by both pxStreamBufferCreate() and pxStreamBufferCreateStatic() to
  * initialise the members of the newly created stream buffer structure.
@@ -509,9 +566,8 @@ size_t xStreamBufferSend( StreamBufferHandle_t xStreamBuffer,
 						  TickType_t xTicksToWait )
 {
 StreamBuffer_t * const pxStreamBuffer = xStreamBuffer;
-size_t xReturn, xSpace = 0;
+size_t xReturn, xSpace;
 size_t xRequiredSpace = xDataLengthBytes;
-TimeOut_t xTimeOut;
 
 	configASSERT( pvTxData );
 	configASSERT( pxStreamBuffer );
@@ -532,54 +588,7 @@ TimeOut_t xTimeOut;
 		mtCOVERAGE_TEST_MARKER();
 	}
 
-	if( xTicksToWait != ( TickType_t ) 0 )
-	{
-		vTaskSetTimeOutState( &xTimeOut );
-
-		do
-		{
-			/* Wait until the required number of bytes are free in the message
-			buffer. */
-			taskENTER_CRITICAL();
-			{
-				xSpace = xStreamBufferSpacesAvailable( pxStreamBuffer );
-
-				if( xSpace < xRequiredSpace )
-				{
-					/* Clear notification state as going to wait for space. */
-					( void ) xTaskNotifyStateClear( NULL );
-
-					/* Should only be one writer. */
-					configASSERT( pxStreamBuffer->xTaskWaitingToSend == NULL );
-					pxStreamBuffer->xTaskWaitingToSend = xTaskGetCurrentTaskHandle();
-				}
-				else
-				{
-					taskEXIT_CRITICAL();
-					break;
-				}
-			}
-			taskEXIT_CRITICAL();
-
-			traceBLOCKING_ON_STREAM_BUFFER_SEND( xStreamBuffer );
-			( void ) xTaskNotifyWait( ( uint32_t ) 0, ( uint32_t ) 0, NULL, xTicksToWait );
-			pxStreamBuffer->xTaskWaitingToSend = NULL;
-
-		} while( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) == pdFALSE );
-	}
-	else
-	{
-		mtCOVERAGE_TEST_MARKER();
-	}
-
-	if( xSpace == ( size_t ) 0 )
-	{
-		xSpace = xStreamBufferSpacesAvailable( pxStreamBuffer );
-	}
-	else
-	{
-		mtCOVERAGE_TEST_MARKER();
-	}
+	xSpace = prvWaitForSpace( xStreamBuffer, xRequiredSpace, xTicksToWait );
 
 	xReturn = prvWriteMessageToBuffer( pxStreamBuffer, pvTxData, xDataLengthBytes, xSpace, xRequiredSpace );
 
@@ -735,54 +744,7 @@ size_t xReceivedLength = 0, xBytesAvailable, xBytesToStoreMessageLength;
 		xBytesToStoreMessageLength = 0;
 	}
 
-	if( xTicksToWait != ( TickType_t ) 0 )
-	{
-		/* Checking if there is data and clearing the notification state must be
-		performed atomically. */
-		taskENTER_CRITICAL();
-		{
-			xBytesAvailable = prvBytesInBuffer( pxStreamBuffer );
-
-			/* If this function was invoked by a message buffer read then
-			xBytesToStoreMessageLength holds the number of bytes used to hold
-			the length of the next discrete message.  If this function was
-			invoked by a stream buffer read then xBytesToStoreMessageLength will
-			be 0. */
-			if( xBytesAvailable <= xBytesToStoreMessageLength )
-			{
-				/* Clear notification state as going to wait for data. */
-				( void ) xTaskNotifyStateClear( NULL );
-
-				/* Should only be one reader. */
-				configASSERT( pxStreamBuffer->xTaskWaitingToReceive == NULL );
-				pxStreamBuffer->xTaskWaitingToReceive = xTaskGetCurrentTaskHandle();
-			}
-			else
-			{
-				mtCOVERAGE_TEST_MARKER();
-			}
-		}
-		taskEXIT_CRITICAL();
-
-		if( xBytesAvailable <= xBytesToStoreMessageLength )
-		{
-			/* Wait for data to be available. */
-			traceBLOCKING_ON_STREAM_BUFFER_RECEIVE( xStreamBuffer );
-			( void ) xTaskNotifyWait( ( uint32_t ) 0, ( uint32_t ) 0, NULL, xTicksToWait );
-			pxStreamBuffer->xTaskWaitingToReceive = NULL;
-
-			/* Recheck the data available after blocking. */
-			xBytesAvailable = prvBytesInBuffer( pxStreamBuffer );
-		}
-		else
-		{
-			mtCOVERAGE_TEST_MARKER();
-		}
-	}
-	else
-	{
-		xBytesAvailable = prvBytesInBuffer( pxStreamBuffer );
-	}
+	xBytesAvailable = prvWaitForData( xStreamBuffer, xBytesToStoreMessageLength, xTicksToWait );
 
 	/* Whether receiving a discrete message (where xBytesToStoreMessageLength
 	holds the number of bytes used to store the message length) or a stream of
@@ -967,6 +929,202 @@ configMESSAGE_BUFFER_LENGTH_TYPE xTempNextMessageLength;
 }
 /*-----------------------------------------------------------*/
 
+size_t xStreamBufferSendAcquire( StreamBufferHandle_t xStreamBuffer,
+								 StreamBufferSpan_t pxSpans[ 2 ],
+								 size_t xDataLengthBytes,
+								 TickType_t xTicksToWait )
+{
+StreamBuffer_t * const pxStreamBuffer = xStreamBuffer;
+size_t xRequiredSpace = xDataLengthBytes, xSpace;
+
+	configASSERT( pxSpans );
+	configASSERT( pxStreamBuffer );
+	configASSERT( xDataLengthBytes > ( size_t ) 0 );
+
+	/* Message buffers also need room for the length of the message. */
+	if( ( pxStreamBuffer->ucFlags & sbFLAGS_IS_MESSAGE_BUFFER ) != ( uint8_t ) 0 )
+	{
+		xRequiredSpace += sbBYTES_TO_STORE_MESSAGE_LENGTH;
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	xSpace = prvWaitForSpace( xStreamBuffer, xRequiredSpace, xTicksToWait );
+
+	return prvAcquireWriteSpans( pxStreamBuffer, pxSpans, xDataLengthBytes, xSpace );
+}
+/*-----------------------------------------------------------*/
+
+size_t xStreamBufferSendAcquireFromISR( StreamBufferHandle_t xStreamBuffer,
+										StreamBufferSpan_t pxSpans[ 2 ],
+										size_t xDataLengthBytes )
+{
+StreamBuffer_t * const pxStreamBuffer = xStreamBuffer;
+
+	configASSERT( pxSpans );
+	configASSERT( pxStreamBuffer );
+	configASSERT( xDataLengthBytes > ( size_t ) 0 );
+
+	return prvAcquireWriteSpans( pxStreamBuffer, pxSpans, xDataLengthBytes, xStreamBufferSpacesAvailable( pxStreamBuffer ) );
+}
+/*-----------------------------------------------------------*/
+
+size_t xStreamBufferSendCommit( StreamBufferHandle_t xStreamBuffer,
+								size_t xDataLengthBytes )
+{
+StreamBuffer_t * const pxStreamBuffer = xStreamBuffer;
+size_t xReturn;
+
+	configASSERT( pxStreamBuffer );
+
+	xReturn = prvCommitWrite( pxStreamBuffer, xDataLengthBytes );
+
+	if( xReturn > ( size_t ) 0 )
+	{
+		traceSTREAM_BUFFER_SEND( xStreamBuffer, xReturn );
+
+		/* Was a task waiting for the data? */
+		if( prvBytesInBuffer( pxStreamBuffer ) >= pxStreamBuffer->xTriggerLevelBytes )
+		{
+			sbSEND_COMPLETED( pxStreamBuffer );
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+size_t xStreamBufferSendCommitFromISR( StreamBufferHandle_t xStreamBuffer,
+									   size_t xDataLengthBytes,
+									   BaseType_t * const pxHigherPriorityTaskWoken )
+{
+StreamBuffer_t * const pxStreamBuffer = xStreamBuffer;
+size_t xReturn;
+
+	configASSERT( pxStreamBuffer );
+
+	xReturn = prvCommitWrite( pxStreamBuffer, xDataLengthBytes );
+
+	if( xReturn > ( size_t ) 0 )
+	{
+		/* Was a task waiting for the data? */
+		if( prvBytesInBuffer( pxStreamBuffer ) >= pxStreamBuffer->xTriggerLevelBytes )
+		{
+			sbSEND_COMPLETE_FROM_ISR( pxStreamBuffer, pxHigherPriorityTaskWoken );
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	traceSTREAM_BUFFER_SEND_FROM_ISR( xStreamBuffer, xReturn );
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+size_t xStreamBufferReceiveAcquire( StreamBufferHandle_t xStreamBuffer,
+									StreamBufferSpan_t pxSpans[ 2 ],
+									TickType_t xTicksToWait )
+{
+StreamBuffer_t * const pxStreamBuffer = xStreamBuffer;
+size_t xBytesToStoreMessageLength, xBytesAvailable;
+
+	configASSERT( pxSpans );
+	configASSERT( pxStreamBuffer );
+
+	if( ( pxStreamBuffer->ucFlags & sbFLAGS_IS_MESSAGE_BUFFER ) != ( uint8_t ) 0 )
+	{
+		xBytesToStoreMessageLength = sbBYTES_TO_STORE_MESSAGE_LENGTH;
+	}
+	else
+	{
+		xBytesToStoreMessageLength = 0;
+	}
+
+	xBytesAvailable = prvWaitForData( xStreamBuffer, xBytesToStoreMessageLength, xTicksToWait );
+
+	return prvAcquireReadSpans( pxStreamBuffer, pxSpans, xBytesAvailable );
+}
+/*-----------------------------------------------------------*/
+
+size_t xStreamBufferReceiveAcquireFromISR( StreamBufferHandle_t xStreamBuffer,
+										   StreamBufferSpan_t pxSpans[ 2 ] )
+{
+StreamBuffer_t * const pxStreamBuffer = xStreamBuffer;
+
+	configASSERT( pxSpans );
+	configASSERT( pxStreamBuffer );
+
+	return prvAcquireReadSpans( pxStreamBuffer, pxSpans, prvBytesInBuffer( pxStreamBuffer ) );
+}
+/*-----------------------------------------------------------*/
+
+size_t xStreamBufferReceiveCommit( StreamBufferHandle_t xStreamBuffer,
+								   size_t xReceivedLength )
+{
+StreamBuffer_t * const pxStreamBuffer = xStreamBuffer;
+
+	configASSERT( pxStreamBuffer );
+
+	xReceivedLength = prvCommitRead( pxStreamBuffer, xReceivedLength );
+
+	/* Was a task waiting for space in the buffer? */
+	if( xReceivedLength != ( size_t ) 0 )
+	{
+		traceSTREAM_BUFFER_RECEIVE( xStreamBuffer, xReceivedLength );
+		sbRECEIVE_COMPLETED( pxStreamBuffer );
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	return xReceivedLength;
+}
+/*-----------------------------------------------------------*/
+
+size_t xStreamBufferReceiveCommitFromISR( StreamBufferHandle_t xStreamBuffer,
+										  size_t xReceivedLength,
+										  BaseType_t * const pxHigherPriorityTaskWoken )
+{
+StreamBuffer_t * const pxStreamBuffer = xStreamBuffer;
+
+	configASSERT( pxStreamBuffer );
+
+	xReceivedLength = prvCommitRead( pxStreamBuffer, xReceivedLength );
+
+	/* Was a task waiting for space in the buffer? */
+	if( xReceivedLength != ( size_t ) 0 )
+	{
+		sbRECEIVE_COMPLETED_FROM_ISR( pxStreamBuffer, pxHigherPriorityTaskWoken );
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	traceSTREAM_BUFFER_RECEIVE_FROM_ISR( xStreamBuffer, xReceivedLength );
+
+	return xReceivedLength;
+}
+/*-----------------------------------------------------------*/
+
 BaseType_t xStreamBufferIsEmpty( StreamBufferHandle_t xStreamBuffer )
 {
 const StreamBuffer_t * const pxStreamBuffer = xStreamBuffer;
@@ -1186,6 +1344,306 @@ size_t xCount, xFirstLength, xNextTail;
 }
 /*-----------------------------------------------------------*/
 
+static size_t prvWaitForSpace( StreamBufferHandle_t xStreamBuffer,
+							   size_t xRequiredSpace,
+							   TickType_t xTicksToWait )
+{
+StreamBuffer_t * const pxStreamBuffer = xStreamBuffer;
+size_t xSpace = 0;
+TimeOut_t xTimeOut;
+
+	if( xTicksToWait != ( TickType_t ) 0 )
+	{
+		vTaskSetTimeOutState( &xTimeOut );
+
+		do
+		{
+			/* Wait until the required number of bytes are free in the message
+			buffer. */
+			taskENTER_CRITICAL();
+			{
+				xSpace = xStreamBufferSpacesAvailable( pxStreamBuffer );
+
+				if( xSpace < xRequiredSpace )
+				{
+					/* Clear notification state as going to wait for space. */
+					( void ) xTaskNotifyStateClear( NULL );
+
+					/* Should only be one writer. */
+					configASSERT( pxStreamBuffer->xTaskWaitingToSend == NULL );
+					pxStreamBuffer->xTaskWaitingToSend = xTaskGetCurrentTaskHandle();
+				}
+				else
+				{
+					taskEXIT_CRITICAL();
+					break;
+				}
+			}
+			taskEXIT_CRITICAL();
+
+			traceBLOCKING_ON_STREAM_BUFFER_SEND( xStreamBuffer );
+			( void ) xTaskNotifyWait( ( uint32_t ) 0, ( uint32_t ) 0, NULL, xTicksToWait );
+			pxStreamBuffer->xTaskWaitingToSend = NULL;
+
+		} while( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) == pdFALSE );
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	if( xSpace == ( size_t ) 0 )
+	{
+		xSpace = xStreamBufferSpacesAvailable( pxStreamBuffer );
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	return xSpace;
+}
+/*-----------------------------------------------------------*/
+
+static size_t prvWaitForData( StreamBufferHandle_t xStreamBuffer,
+							  size_t xBytesToStoreMessageLength,
+							  TickType_t xTicksToWait )
+{
+StreamBuffer_t * const pxStreamBuffer = xStreamBuffer;
+size_t xBytesAvailable;
+
+	if( xTicksToWait != ( TickType_t ) 0 )
+	{
+		/* Checking if there is data and clearing the notification state must be
+		performed atomically. */
+		taskENTER_CRITICAL();
+		{
+			xBytesAvailable = prvBytesInBuffer( pxStreamBuffer );
+
+			/* If this function was invoked by a message buffer read then
+			xBytesToStoreMessageLength holds the number of bytes used to hold
+			the length of the next discrete message.  If this function was
+			invoked by a stream buffer read then xBytesToStoreMessageLength will
+			be 0. */
+			if( xBytesAvailable <= xBytesToStoreMessageLength )
+			{
+				/* Clear notification state as going to wait for data. */
+				( void ) xTaskNotifyStateClear( NULL );
+
+				/* Should only be one reader. */
+				configASSERT( pxStreamBuffer->xTaskWaitingToReceive == NULL );
+				pxStreamBuffer->xTaskWaitingToReceive = xTaskGetCurrentTaskHandle();
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		taskEXIT_CRITICAL();
+
+		if( xBytesAvailable <= xBytesToStoreMessageLength )
+		{
+			/* Wait for data to be available. */
+			traceBLOCKING_ON_STREAM_BUFFER_RECEIVE( xStreamBuffer );
+			( void ) xTaskNotifyWait( ( uint32_t ) 0, ( uint32_t ) 0, NULL, xTicksToWait );
+			pxStreamBuffer->xTaskWaitingToReceive = NULL;
+
+			/* Recheck the data available after blocking. */
+			xBytesAvailable = prvBytesInBuffer( pxStreamBuffer );
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+	else
+	{
+		xBytesAvailable = prvBytesInBuffer( pxStreamBuffer );
+	}
+
+	return xBytesAvailable;
+}
+/*-----------------------------------------------------------*/
+
+static size_t prvGetSpans( const StreamBuffer_t * const pxStreamBuffer,
+						   size_t xStart,
+						   size_t xCount,
+						   StreamBufferSpan_t pxSpans[ 2 ] )
+{
+size_t xFirstLength;
+
+	configASSERT( xStart < pxStreamBuffer->xLength );
+
+	/* The first span runs to the end of the storage area at most, anything
+	left over wraps back to the start. */
+	xFirstLength = configMIN( pxStreamBuffer->xLength - xStart, xCount );
+
+	pxSpans[ 0 ].pucData = &( pxStreamBuffer->pucBuffer[ xStart ] );
+	pxSpans[ 0 ].xLength = xFirstLength;
+	pxSpans[ 1 ].pucData = pxStreamBuffer->pucBuffer;
+	pxSpans[ 1 ].xLength = xCount - xFirstLength;
+
+	return xCount;
+}
+/*-----------------------------------------------------------*/
+
+static size_t prvAcquireWriteSpans( const StreamBuffer_t * const pxStreamBuffer,
+									StreamBufferSpan_t pxSpans[ 2 ],
+									size_t xDataLengthBytes,
+									size_t xSpace )
+{
+size_t xStart = pxStreamBuffer->xHead, xCount;
+
+	if( ( pxStreamBuffer->ucFlags & sbFLAGS_IS_MESSAGE_BUFFER ) == ( uint8_t ) 0 )
+	{
+		/* A stream buffer - everything that's free may be written. */
+		xCount = xSpace;
+	}
+	else if( xSpace >= ( xDataLengthBytes + sbBYTES_TO_STORE_MESSAGE_LENGTH ) )
+	{
+		/* A message buffer - the message goes after its length, which is only
+		written by the commit. */
+		xCount = xDataLengthBytes;
+		xStart += sbBYTES_TO_STORE_MESSAGE_LENGTH;
+
+		if( xStart >= pxStreamBuffer->xLength )
+		{
+			xStart -= pxStreamBuffer->xLength;
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+	else
+	{
+		/* Not enough space for the whole message. */
+		xCount = 0;
+	}
+
+	return prvGetSpans( pxStreamBuffer, xStart, xCount, pxSpans );
+}
+/*-----------------------------------------------------------*/
+
+static size_t prvAcquireReadSpans( StreamBuffer_t * const pxStreamBuffer,
+								   StreamBufferSpan_t pxSpans[ 2 ],
+								   size_t xBytesAvailable )
+{
+const size_t xOriginalTail = pxStreamBuffer->xTail;
+size_t xStart = xOriginalTail, xCount;
+configMESSAGE_BUFFER_LENGTH_TYPE xTempNextMessageLength;
+
+	if( ( pxStreamBuffer->ucFlags & sbFLAGS_IS_MESSAGE_BUFFER ) == ( uint8_t ) 0 )
+	{
+		/* A stream buffer - everything may be read. */
+		xCount = xBytesAvailable;
+	}
+	else if( xBytesAvailable > sbBYTES_TO_STORE_MESSAGE_LENGTH )
+	{
+		/* A message buffer - read the length of the next message, then put
+		the tail back, the message stays in the buffer until the commit. */
+		( void ) prvReadBytesFromBuffer( pxStreamBuffer, ( uint8_t * ) &xTempNextMessageLength, sbBYTES_TO_STORE_MESSAGE_LENGTH, xBytesAvailable );
+		xCount = ( size_t ) xTempNextMessageLength;
+		xStart = pxStreamBuffer->xTail;
+		pxStreamBuffer->xTail = xOriginalTail;
+	}
+	else
+	{
+		xCount = 0;
+	}
+
+	return prvGetSpans( pxStreamBuffer, xStart, xCount, pxSpans );
+}
+/*-----------------------------------------------------------*/
+
+static size_t prvCommitWrite( StreamBuffer_t * const pxStreamBuffer,
+							  size_t xDataLengthBytes )
+{
+size_t xNextHead;
+
+	if( xDataLengthBytes > ( size_t ) 0 )
+	{
+		if( ( pxStreamBuffer->ucFlags & sbFLAGS_IS_MESSAGE_BUFFER ) != ( uint8_t ) 0 )
+		{
+			/* The data is already in place, only the length needs to be
+			copied in front of it. */
+			configASSERT( xStreamBufferSpacesAvailable( pxStreamBuffer ) >= ( xDataLengthBytes + sbBYTES_TO_STORE_MESSAGE_LENGTH ) );
+			( void ) prvWriteBytesToBuffer( pxStreamBuffer, ( const uint8_t * ) &( xDataLengthBytes ), sbBYTES_TO_STORE_MESSAGE_LENGTH );
+		}
+		else
+		{
+			configASSERT( xStreamBufferSpacesAvailable( pxStreamBuffer ) >= xDataLengthBytes );
+		}
+
+		/* Moving the head makes the data visible to the reader. */
+		xNextHead = pxStreamBuffer->xHead + xDataLengthBytes;
+
+		if( xNextHead >= pxStreamBuffer->xLength )
+		{
+			xNextHead -= pxStreamBuffer->xLength;
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		pxStreamBuffer->xHead = xNextHead;
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	return xDataLengthBytes;
+}
+/*-----------------------------------------------------------*/
+
+static size_t prvCommitRead( StreamBuffer_t * const pxStreamBuffer,
+							 size_t xReceivedLength )
+{
+size_t xBytesAvailable, xNextTail;
+configMESSAGE_BUFFER_LENGTH_TYPE xTempNextMessageLength;
+
+	xBytesAvailable = prvBytesInBuffer( pxStreamBuffer );
+
+	if( xReceivedLength > ( size_t ) 0 )
+	{
+		if( ( pxStreamBuffer->ucFlags & sbFLAGS_IS_MESSAGE_BUFFER ) != ( uint8_t ) 0 )
+		{
+			/* Messages are always removed whole - skip the length, then the
+			message itself. */
+			configASSERT( xBytesAvailable > sbBYTES_TO_STORE_MESSAGE_LENGTH );
+			( void ) prvReadBytesFromBuffer( pxStreamBuffer, ( uint8_t * ) &xTempNextMessageLength, sbBYTES_TO_STORE_MESSAGE_LENGTH, xBytesAvailable );
+			xReceivedLength = ( size_t ) xTempNextMessageLength;
+		}
+		else
+		{
+			configASSERT( xReceivedLength <= xBytesAvailable );
+		}
+
+		/* Moving the tail returns the space to the writer. */
+		xNextTail = pxStreamBuffer->xTail + xReceivedLength;
+
+		if( xNextTail >= pxStreamBuffer->xLength )
+		{
+			xNextTail -= pxStreamBuffer->xLength;
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		pxStreamBuffer->xTail = xNextTail;
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	return xReceivedLength;
+}
+/*-----------------------------------------------------------*/
+
 static size_t prvBytesInBuffer( const StreamBuffer_t * const pxStreamBuffer )
 {
 /* Returns the distance between xTail and xHead. */
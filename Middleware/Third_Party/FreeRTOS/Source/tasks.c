@@ -316,8 +316,8 @@ typedef struct tskTaskControlBlock 			/* The old naming convention is used to pr
 	#endif
 
 	#if( configUSE_TASK_NOTIFICATIONS == 1 )
-		volatile uint32_t ulNotifiedValue;
-		volatile uint8_t ucNotifyState;
+		volatile uint32_t ulNotifiedValue[ configTASK_NOTIFICATION_ARRAY_ENTRIES ];
+		volatile uint8_t ucNotifyState[ configTASK_NOTIFICATION_ARRAY_ENTRIES ];
 	#endif
 
 	/* See the comments in FreeRTOS.h with the definition of
@@ -997,8 +997,8 @@ UBaseType_t x;
 
 	#if ( configUSE_TASK_NOTIFICATIONS == 1 )
 	{
-		pxNewTCB->ulNotifiedValue = 0;
-		pxNewTCB->ucNotifyState = taskNOT_WAITING_NOTIFICATION;
+		( void ) memset( ( void * ) &( pxNewTCB->ulNotifiedValue[ 0 ] ), 0x00, sizeof( pxNewTCB->ulNotifiedValue ) );
+		( void ) memset( ( void * ) &( pxNewTCB->ucNotifyState[ 0 ] ), taskNOT_WAITING_NOTIFICATION, sizeof( pxNewTCB->ucNotifyState ) );
 	}
 	#endif
 
@@ -1426,17 +1426,20 @@ static void prvAddNewTaskToReadyList( TCB_t *pxNewTCB )
 					{
 						#if( configUSE_TASK_NOTIFICATIONS == 1 )
 						{
+							BaseType_t x;
+
 							/* The task does not appear on the event list item of
 							and of the RTOS objects, but could still be in the
-							blocked state if it is waiting on its notification
-							rather than waiting on an object. */
-							if( pxTCB->ucNotifyState == taskWAITING_NOTIFICATION )
-							{
-								eReturn = eBlocked;
-							}
-							else
+							blocked state if it is waiting on one of its
+							notifications rather than waiting on an object. */
+							eReturn = eSuspended;
+							for( x = 0; x < configTASK_NOTIFICATION_ARRAY_ENTRIES; x++ )
 							{
-								eReturn = eSuspended;
+								if( pxTCB->ucNotifyState[ x ] == taskWAITING_NOTIFICATION )
+								{
+									eReturn = eBlocked;
+									break;
+								}
 							}
 						}
 						#else
@@ -1741,11 +1744,16 @@ static void prvAddNewTaskToReadyList( TCB_t *pxNewTCB )
 
 			#if( configUSE_TASK_NOTIFICATIONS == 1 )
 			{
-				if( pxTCB->ucNotifyState == taskWAITING_NOTIFICATION )
+				BaseType_t x;
+
+				for( x = 0; x < configTASK_NOTIFICATION_ARRAY_ENTRIES; x++ )
 				{
-					/* The task was blocked to wait for a notification, but is
-					now suspended, so no notification was received. */
-					pxTCB->ucNotifyState = taskNOT_WAITING_NOTIFICATION;
+					if( pxTCB->ucNotifyState[ x ] == taskWAITING_NOTIFICATION )
+					{
+						/* The task was blocked to wait for a notification, but is
+						now suspended, so no notification was received. */
+						pxTCB->ucNotifyState[ x ] = taskNOT_WAITING_NOTIFICATION;
+					}
 				}
 			}
 			#endif
@@ -3204,6 +3212,64 @@ TCB_t *pxUnblockedTCB;
 }
 /*-----------------------------------------------------------*/
 
+#if( configUSE_EVENT_GROUP_DIRECT_ISR == 1 )
+
+	BaseType_t xTaskRemoveFromUnorderedEventListFromISR( ListItem_t * pxEventListItem, const TickType_t xItemValue )
+	{
+	TCB_t *pxUnblockedTCB;
+	BaseType_t xReturn;
+
+		/* THIS FUNCTION MUST BE CALLED FROM A CRITICAL SECTION.  It is used by
+		event groups that are set directly from an interrupt.  The event group
+		is responsible for making sure no task is accessing the event list at
+		the same time. */
+
+		/* Store the new item value in the event list. */
+		listSET_LIST_ITEM_VALUE( pxEventListItem, xItemValue | taskEVENT_LIST_ITEM_VALUE_IN_USE );
+
+		pxUnblockedTCB = listGET_LIST_ITEM_OWNER( pxEventListItem ); /*lint !e9079 void * is used as this macro is used with timers and co-routines too.  Alignment is known to be fine as the type of the pointer stored and retrieved is the same. */
+		configASSERT( pxUnblockedTCB );
+		( void ) uxListRemove( pxEventListItem );
+
+		/* As xTaskRemoveFromEventList(), the ready lists can only be used if
+		the scheduler isn't suspended. */
+		if( uxSchedulerSuspended == ( UBaseType_t ) pdFALSE )
+		{
+			( void ) uxListRemove( &( pxUnblockedTCB->xStateListItem ) );
+			prvAddTaskToReadyList( pxUnblockedTCB );
+
+			#if( configUSE_TICKLESS_IDLE != 0 )
+			{
+				prvResetNextTaskUnblockTime();
+			}
+			#endif
+		}
+		else
+		{
+			/* The delayed and ready lists cannot be accessed, so hold this task
+			pending until the scheduler is resumed. */
+			vListInsertEnd( &( xPendingReadyList ), &( pxUnblockedTCB->xEventListItem ) );
+		}
+
+		if( pxUnblockedTCB->uxPriority > pxCurrentTCB->uxPriority )
+		{
+			/* Mark that a yield is pending in case the user is not using the
+			"xHigherPriorityTaskWoken" parameter to an ISR safe FreeRTOS
+			function. */
+			xReturn = pdTRUE;
+			xYieldPending = pdTRUE;
+		}
+		else
+		{
+			xReturn = pdFALSE;
+		}
+
+		return xReturn;
+	}
+
+#endif /* configUSE_EVENT_GROUP_DIRECT_ISR */
+/*-----------------------------------------------------------*/
+
 void vTaskSetTimeOutState( TimeOut_t * const pxTimeOut )
 {
 	configASSERT( pxTimeOut );
@@ -4588,17 +4654,19 @@ TickType_t uxReturn;
 
 #if( configUSE_TASK_NOTIFICATIONS == 1 )
 
-	uint32_t ulTaskNotifyTake( BaseType_t xClearCountOnExit, TickType_t xTicksToWait )
+	uint32_t ulTaskGenericNotifyTake( UBaseType_t uxIndexToWait, BaseType_t xClearCountOnExit, TickType_t xTicksToWait )
 	{
 	uint32_t ulReturn;
 
+		configASSERT( uxIndexToWait < configTASK_NOTIFICATION_ARRAY_ENTRIES );
+
 		taskENTER_CRITICAL();
 		{
 			/* Only block if the notification count is not already non-zero. */
-			if( pxCurrentTCB->ulNotifiedValue == 0UL )
+			if( pxCurrentTCB->ulNotifiedValue[ uxIndexToWait ] == 0UL )
 			{
 				/* Mark this task as waiting for a notification. */
-				pxCurrentTCB->ucNotifyState = taskWAITING_NOTIFICATION;
+				pxCurrentTCB->ucNotifyState[ uxIndexToWait ] = taskWAITING_NOTIFICATION;
 
 				if( xTicksToWait > ( TickType_t ) 0 )
 				{
@@ -4626,17 +4694,17 @@ TickType_t uxReturn;
 		taskENTER_CRITICAL();
 		{
 			traceTASK_NOTIFY_TAKE();
-			ulReturn = pxCurrentTCB->ulNotifiedValue;
+			ulReturn = pxCurrentTCB->ulNotifiedValue[ uxIndexToWait ];
 
 			if( ulReturn != 0UL )
 			{
 				if( xClearCountOnExit != pdFALSE )
 				{
-					pxCurrentTCB->ulNotifiedValue = 0UL;
+					pxCurrentTCB->ulNotifiedValue[ uxIndexToWait ] = 0UL;
 				}
 				else
 				{
-					pxCurrentTCB->ulNotifiedValue = ulReturn - ( uint32_t ) 1;
+					pxCurrentTCB->ulNotifiedValue[ uxIndexToWait ] = ulReturn - ( uint32_t ) 1;
 				}
 			}
 			else
@@ -4644,7 +4712,7 @@ TickType_t uxReturn;
 				mtCOVERAGE_TEST_MARKER();
 			}
 
-			pxCurrentTCB->ucNotifyState = taskNOT_WAITING_NOTIFICATION;
+			pxCurrentTCB->ucNotifyState[ uxIndexToWait ] = taskNOT_WAITING_NOTIFICATION;
 		}
 		taskEXIT_CRITICAL();
 
@@ -4656,22 +4724,24 @@ TickType_t uxReturn;
 
 #if( configUSE_TASK_NOTIFICATIONS == 1 )
 
-	BaseType_t xTaskNotifyWait( uint32_t ulBitsToClearOnEntry, uint32_t ulBitsToClearOnExit, uint32_t *pulNotificationValue, TickType_t xTicksToWait )
+	BaseType_t xTaskGenericNotifyWait( UBaseType_t uxIndexToWait, uint32_t ulBitsToClearOnEntry, uint32_t ulBitsToClearOnExit, uint32_t *pulNotificationValue, TickType_t xTicksToWait )
 	{
 	BaseType_t xReturn;
 
+		configASSERT( uxIndexToWait < configTASK_NOTIFICATION_ARRAY_ENTRIES );
+
 		taskENTER_CRITICAL();
 		{
 			/* Only block if a notification is not already pending. */
-			if( pxCurrentTCB->ucNotifyState != taskNOTIFICATION_RECEIVED )
+			if( pxCurrentTCB->ucNotifyState[ uxIndexToWait ] != taskNOTIFICATION_RECEIVED )
 			{
 				/* Clear bits in the task's notification value as bits may get
 				set	by the notifying task or interrupt.  This can be used to
 				clear the value to zero. */
-				pxCurrentTCB->ulNotifiedValue &= ~ulBitsToClearOnEntry;
+				pxCurrentTCB->ulNotifiedValue[ uxIndexToWait ] &= ~ulBitsToClearOnEntry;
 
 				/* Mark this task as waiting for a notification. */
-				pxCurrentTCB->ucNotifyState = taskWAITING_NOTIFICATION;
+				pxCurrentTCB->ucNotifyState[ uxIndexToWait ] = taskWAITING_NOTIFICATION;
 
 				if( xTicksToWait > ( TickType_t ) 0 )
 				{
@@ -4704,14 +4774,14 @@ TickType_t uxReturn;
 			{
 				/* Output the current notification value, which may or may not
 				have changed. */
-				*pulNotificationValue = pxCurrentTCB->ulNotifiedValue;
+				*pulNotificationValue = pxCurrentTCB->ulNotifiedValue[ uxIndexToWait ];
 			}
 
 			/* If ucNotifyValue is set then either the task never entered the
 			blocked state (because a notification was already pending) or the
 			task unblocked because of a notification.  Otherwise the task
 			unblocked because of a timeout. */
-			if( pxCurrentTCB->ucNotifyState != taskNOTIFICATION_RECEIVED )
+			if( pxCurrentTCB->ucNotifyState[ uxIndexToWait ] != taskNOTIFICATION_RECEIVED )
 			{
 				/* A notification was not received. */
 				xReturn = pdFALSE;
@@ -4720,11 +4790,11 @@ TickType_t uxReturn;
 			{
 				/* A notification was already pending or a notification was
 				received while the task was waiting. */
-				pxCurrentTCB->ulNotifiedValue &= ~ulBitsToClearOnExit;
+				pxCurrentTCB->ulNotifiedValue[ uxIndexToWait ] &= ~ulBitsToClearOnExit;
 				xReturn = pdTRUE;
 			}
 
-			pxCurrentTCB->ucNotifyState = taskNOT_WAITING_NOTIFICATION;
+			pxCurrentTCB->ucNotifyState[ uxIndexToWait ] = taskNOT_WAITING_NOTIFICATION;
 		}
 		taskEXIT_CRITICAL();
 
@@ -4736,12 +4806,13 @@ TickType_t uxReturn;
 
 #if( configUSE_TASK_NOTIFICATIONS == 1 )
 
-	BaseType_t xTaskGenericNotify( TaskHandle_t xTaskToNotify, uint32_t ulValue, eNotifyAction eAction, uint32_t *pulPreviousNotificationValue )
+	BaseType_t xTaskGenericNotify( TaskHandle_t xTaskToNotify, UBaseType_t uxIndexToNotify, uint32_t ulValue, eNotifyAction eAction, uint32_t *pulPreviousNotificationValue )
 	{
 	TCB_t * pxTCB;
 	BaseType_t xReturn = pdPASS;
 	uint8_t ucOriginalNotifyState;
 
+		configASSERT( uxIndexToNotify < configTASK_NOTIFICATION_ARRAY_ENTRIES );
 		configASSERT( xTaskToNotify );
 		pxTCB = xTaskToNotify;
 
@@ -4749,31 +4820,31 @@ TickType_t uxReturn;
 		{
 			if( pulPreviousNotificationValue != NULL )
 			{
-				*pulPreviousNotificationValue = pxTCB->ulNotifiedValue;
+				*pulPreviousNotificationValue = pxTCB->ulNotifiedValue[ uxIndexToNotify ];
 			}
 
-			ucOriginalNotifyState = pxTCB->ucNotifyState;
+			ucOriginalNotifyState = pxTCB->ucNotifyState[ uxIndexToNotify ];
 
-			pxTCB->ucNotifyState = taskNOTIFICATION_RECEIVED;
+			pxTCB->ucNotifyState[ uxIndexToNotify ] = taskNOTIFICATION_RECEIVED;
 
 			switch( eAction )
 			{
 				case eSetBits	:
-					pxTCB->ulNotifiedValue |= ulValue;
+					pxTCB->ulNotifiedValue[ uxIndexToNotify ] |= ulValue;
 					break;
 
 				case eIncrement	:
-					( pxTCB->ulNotifiedValue )++;
+					( pxTCB->ulNotifiedValue[ uxIndexToNotify ] )++;
 					break;
 
 				case eSetValueWithOverwrite	:
-					pxTCB->ulNotifiedValue = ulValue;
+					pxTCB->ulNotifiedValue[ uxIndexToNotify ] = ulValue;
 					break;
 
 				case eSetValueWithoutOverwrite :
 					if( ucOriginalNotifyState != taskNOTIFICATION_RECEIVED )
 					{
-						pxTCB->ulNotifiedValue = ulValue;
+						pxTCB->ulNotifiedValue[ uxIndexToNotify ] = ulValue;
 					}
 					else
 					{
@@ -4791,7 +4862,7 @@ TickType_t uxReturn;
 					/* Should not get here if all enums are handled.
 					Artificially force an assert by testing a value the
 					compiler can't assume is const. */
-					configASSERT( pxTCB->ulNotifiedValue == ~0UL );
+					configASSERT( pxTCB->ulNotifiedValue[ uxIndexToNotify ] == ~0UL );
 
 					break;
 			}
@@ -4850,7 +4921,7 @@ TickType_t uxReturn;
 
 #if( configUSE_TASK_NOTIFICATIONS == 1 )
 
-	BaseType_t xTaskGenericNotifyFromISR( TaskHandle_t xTaskToNotify, uint32_t ulValue, eNotifyAction eAction, uint32_t *pulPreviousNotificationValue, BaseType_t *pxHigherPriorityTaskWoken )
+	BaseType_t xTaskGenericNotifyFromISR( TaskHandle_t xTaskToNotify, UBaseType_t uxIndexToNotify, uint32_t ulValue, eNotifyAction eAction, uint32_t *pulPreviousNotificationValue, BaseType_t *pxHigherPriorityTaskWoken )
 	{
 	TCB_t * pxTCB;
 	uint8_t ucOriginalNotifyState;
@@ -4858,6 +4929,7 @@ TickType_t uxReturn;
 	UBaseType_t uxSavedInterruptStatus;
 
 		configASSERT( xTaskToNotify );
+		configASSERT( uxIndexToNotify < configTASK_NOTIFICATION_ARRAY_ENTRIES );
 
 		/* RTOS ports that support interrupt nesting have the concept of a
 		maximum	system call (or maximum API call) interrupt priority.
@@ -4883,30 +4955,30 @@ TickType_t uxReturn;
 		{
 			if( pulPreviousNotificationValue != NULL )
 			{
-				*pulPreviousNotificationValue = pxTCB->ulNotifiedValue;
+				*pulPreviousNotificationValue = pxTCB->ulNotifiedValue[ uxIndexToNotify ];
 			}
 
-			ucOriginalNotifyState = pxTCB->ucNotifyState;
-			pxTCB->ucNotifyState = taskNOTIFICATION_RECEIVED;
+			ucOriginalNotifyState = pxTCB->ucNotifyState[ uxIndexToNotify ];
+			pxTCB->ucNotifyState[ uxIndexToNotify ] = taskNOTIFICATION_RECEIVED;
 
 			switch( eAction )
 			{
 				case eSetBits	:
-					pxTCB->ulNotifiedValue |= ulValue;
+					pxTCB->ulNotifiedValue[ uxIndexToNotify ] |= ulValue;
 					break;
 
 				case eIncrement	:
-					( pxTCB->ulNotifiedValue )++;
+					( pxTCB->ulNotifiedValue[ uxIndexToNotify ] )++;
 					break;
 
 				case eSetValueWithOverwrite	:
-					pxTCB->ulNotifiedValue = ulValue;
+					pxTCB->ulNotifiedValue[ uxIndexToNotify ] = ulValue;
 					break;
 
 				case eSetValueWithoutOverwrite :
 					if( ucOriginalNotifyState != taskNOTIFICATION_RECEIVED )
 					{
-						pxTCB->ulNotifiedValue = ulValue;
+						pxTCB->ulNotifiedValue[ uxIndexToNotify ] = ulValue;
 					}
 					else
 					{
@@ -4924,7 +4996,7 @@ TickType_t uxReturn;
 					/* Should not get here if all enums are handled.
 					Artificially force an assert by testing a value the
 					compiler can't assume is const. */
-					configASSERT( pxTCB->ulNotifiedValue == ~0UL );
+					configASSERT( pxTCB->ulNotifiedValue[ uxIndexToNotify ] == ~0UL );
 					break;
 			}
 
@@ -4979,13 +5051,14 @@ TickType_t uxReturn;
 
 #if( configUSE_TASK_NOTIFICATIONS == 1 )
 
-	void vTaskNotifyGiveFromISR( TaskHandle_t xTaskToNotify, BaseType_t *pxHigherPriorityTaskWoken )
+	void vTaskGenericNotifyGiveFromISR( TaskHandle_t xTaskToNotify, UBaseType_t uxIndexToNotify, BaseType_t *pxHigherPriorityTaskWoken )
 	{
 	TCB_t * pxTCB;
 	uint8_t ucOriginalNotifyState;
 	UBaseType_t uxSavedInterruptStatus;
 
 		configASSERT( xTaskToNotify );
+		configASSERT( uxIndexToNotify < configTASK_NOTIFICATION_ARRAY_ENTRIES );
 
 		/* RTOS ports that support interrupt nesting have the concept of a
 		maximum	system call (or maximum API call) interrupt priority.
@@ -5009,12 +5082,12 @@ TickType_t uxReturn;
 
 		uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
 		{
-			ucOriginalNotifyState = pxTCB->ucNotifyState;
-			pxTCB->ucNotifyState = taskNOTIFICATION_RECEIVED;
+			ucOriginalNotifyState = pxTCB->ucNotifyState[ uxIndexToNotify ];
+			pxTCB->ucNotifyState[ uxIndexToNotify ] = taskNOTIFICATION_RECEIVED;
 
 			/* 'Giving' is equivalent to incrementing a count in a counting
 			semaphore. */
-			( pxTCB->ulNotifiedValue )++;
+			( pxTCB->ulNotifiedValue[ uxIndexToNotify ] )++;
 
 			traceTASK_NOTIFY_GIVE_FROM_ISR();
 
@@ -5066,20 +5139,22 @@ TickType_t uxReturn;
 
 #if( configUSE_TASK_NOTIFICATIONS == 1 )
 
-	BaseType_t xTaskNotifyStateClear( TaskHandle_t xTask )
+	BaseType_t xTaskGenericNotifyStateClear( TaskHandle_t xTask, UBaseType_t uxIndexToClear )
 	{
 	TCB_t *pxTCB;
 	BaseType_t xReturn;
 
+		configASSERT( uxIndexToClear < configTASK_NOTIFICATION_ARRAY_ENTRIES );
+
 		/* If null is passed in here then it is the calling task that is having
 		its notification state cleared. */
 		pxTCB = prvGetTCBFromHandle( xTask );
 
 		taskENTER_CRITICAL();
 		{
-			if( pxTCB->ucNotifyState == taskNOTIFICATION_RECEIVED )
+			if( pxTCB->ucNotifyState[ uxIndexToClear ] == taskNOTIFICATION_RECEIVED )
 			{
-				pxTCB->ucNotifyState = taskNOT_WAITING_NOTIFICATION;
+				pxTCB->ucNotifyState[ uxIndexToClear ] = taskNOT_WAITING_NOTIFICATION;
 				xReturn = pdPASS;
 			}
 			else
@@ -69,6 +69,30 @@ defining trmTIMER_SERVICE_TASK_NAME in FreeRTOSConfig.h. */
 #define tmrSTATUS_IS_STATICALLY_ALLOCATED	( ( uint8_t ) 0x02 )
 #define tmrSTATUS_IS_AUTORELOAD				( ( uint8_t ) 0x04 )
 
+#if( configUSE_TIMER_WHEEL == 1 )
+	/* The number of slots in each level of the timer wheel. */
+	#define tmrWHEEL_SLOTS			( ( UBaseType_t ) 1U << configTIMER_WHEEL_SLOT_BITS )
+	#define tmrWHEEL_SLOT_MASK		( ( TickType_t ) tmrWHEEL_SLOTS - ( TickType_t ) 1U )
+
+	/* Slots are indexed with bits of the expiry time, so the span of the whole
+	wheel must be smaller than the range of the tick count for the indexes to
+	remain valid when the tick count overflows. */
+	#if( configUSE_16_BIT_TICKS == 1 )
+		#define tmrTICK_TYPE_BITS	16
+	#else
+		#define tmrTICK_TYPE_BITS	32
+	#endif
+	#if( ( configTIMER_WHEEL_LEVELS * configTIMER_WHEEL_SLOT_BITS ) >= tmrTICK_TYPE_BITS )
+		#error configTIMER_WHEEL_LEVELS * configTIMER_WHEEL_SLOT_BITS must be less than the number of bits in TickType_t
+	#endif
+
+	/* Times are compared relative to the time the wheel has been processed up
+	to, so tick count overflows need no special handling. */
+	#define tmrTIME_REACHED( xTime, xTimeNow )	( ( TickType_t ) ( ( xTime ) - xWheelTime ) <= ( TickType_t ) ( ( xTimeNow ) - xWheelTime ) )
+#else
+	#define tmrTIME_REACHED( xTime, xTimeNow )	( ( xTime ) <= ( xTimeNow ) )
+#endif
+
 /* The definition of the timers themselves. */
 typedef struct tmrTimerControl /* The old naming convention is used to prevent breaking kernel aware debuggers. */
 {
@@ -132,10 +156,24 @@ timer service task is allowed to access these lists.
 xActiveTimerList1 and xActiveTimerList2 could be at function scope but that
 breaks some kernel aware debuggers, and debuggers that reply on removing the
 static qualifier. */
-PRIVILEGED_DATA static List_t xActiveTimerList1;
-PRIVILEGED_DATA static List_t xActiveTimerList2;
-PRIVILEGED_DATA static List_t *pxCurrentTimerList;
-PRIVILEGED_DATA static List_t *pxOverflowTimerList;
+#if( configUSE_TIMER_WHEEL == 0 )
+	PRIVILEGED_DATA static List_t xActiveTimerList1;
+	PRIVILEGED_DATA static List_t xActiveTimerList2;
+	PRIVILEGED_DATA static List_t *pxCurrentTimerList;
+	PRIVILEGED_DATA static List_t *pxOverflowTimerList;
+#else
+	/* When configUSE_TIMER_WHEEL is 1 active timers are stored in a
+	hierarchical timing wheel instead, so starting and stopping a timer takes
+	the same time however many timers are active.  Slot n of level 0 holds the
+	timers that expire on the next tick count with n in its least significant
+	configTIMER_WHEEL_SLOT_BITS bits.  Each level above covers a span
+	2^configTIMER_WHEEL_SLOT_BITS times longer, its timers are moved down a
+	level when the span their slot covers is reached.  Timers within a slot are
+	not sorted. */
+	PRIVILEGED_DATA static List_t xTimerWheel[ configTIMER_WHEEL_LEVELS ][ tmrWHEEL_SLOTS ];
+	PRIVILEGED_DATA static TickType_t xWheelTime = ( TickType_t ) 0U;				/*< Every tick up to and including this one has been processed. */
+	PRIVILEGED_DATA static UBaseType_t uxActiveWheelTimers = ( UBaseType_t ) 0U;	/*< The number of timers in the wheel. */
+#endif
 
 /* A queue that is used to send commands to the timer service task. */
 PRIVILEGED_DATA static QueueHandle_t xTimerQueue = NULL;
@@ -176,21 +214,53 @@ static void prvProcessReceivedCommands( void ) PRIVILEGED_FUNCTION;
 
 /*
  * Insert the timer into either xActiveTimerList1, or xActiveTimerList2,
- * depending on if the expire time causes a timer counter overflow.
+ * depending on if the expire time causes a timer counter overflow (or into the
+ * timer wheel when configUSE_TIMER_WHEEL is 1).
  */
 static BaseType_t prvInsertTimerInActiveList( Timer_t * const pxTimer, const TickType_t xNextExpiryTime, const TickType_t xTimeNow, const TickType_t xCommandTime ) PRIVILEGED_FUNCTION;
 
-/*
- * An active timer has reached its expire time.  Reload the timer if it is an
- * auto reload timer, then call its callback.
- */
-static void prvProcessExpiredTimer( const TickType_t xNextExpireTime, const TickType_t xTimeNow ) PRIVILEGED_FUNCTION;
-
-/*
- * The tick count has overflowed.  Switch the timer lists after ensuring the
- * current timer list does not still reference some timers.
- */
-static void prvSwitchTimerLists( void ) PRIVILEGED_FUNCTION;
+#if( configUSE_TIMER_WHEEL == 0 )
+
+	/*
+	 * An active timer has reached its expire time.  Reload the timer if it is an
+	 * auto reload timer, then call its callback.
+	 */
+	static void prvProcessExpiredTimer( const TickType_t xNextExpireTime, const TickType_t xTimeNow ) PRIVILEGED_FUNCTION;
+
+	/*
+	 * The tick count has overflowed.  Switch the timer lists after ensuring the
+	 * current timer list does not still reference some timers.
+	 */
+	static void prvSwitchTimerLists( void ) PRIVILEGED_FUNCTION;
+
+#else
+
+	/*
+	 * Place an active timer in the wheel slot for the expiry time held in its
+	 * list item.
+	 */
+	static void prvWheelInsert( Timer_t * const pxTimer ) PRIVILEGED_FUNCTION;
+
+	/*
+	 * Move the timers in any higher level slot whose span starts at xTick down
+	 * the wheel.
+	 */
+	static void prvWheelCascade( const TickType_t xTick ) PRIVILEGED_FUNCTION;
+
+	/*
+	 * Return the first tick after xWheelTime at which a timer expires or timers
+	 * have to be moved down the wheel.  There must be at least one active
+	 * timer.
+	 */
+	static TickType_t prvWheelNextEventTime( void ) PRIVILEGED_FUNCTION;
+
+	/*
+	 * Advance the wheel to xTimeNow, reloading and calling the callback of every
+	 * timer that expires on the way.
+	 */
+	static void prvProcessExpiredTimers( const TickType_t xTimeNow ) PRIVILEGED_FUNCTION;
+
+#endif /* configUSE_TIMER_WHEEL */
 
 /*
  * Obtain the current tick count, setting *pxTimerListsWereSwitched to pdTRUE
@@ -202,7 +272,8 @@ static TickType_t prvSampleTimeNow( BaseType_t * const pxTimerListsWereSwitched
  * If the timer list contains any active timers then return the expire time of
  * the timer that will expire first and set *pxListWasEmpty to false.  If the
  * timer list does not contain any timers then return 0 and set *pxListWasEmpty
- * to pdTRUE.
+ * to pdTRUE.  When configUSE_TIMER_WHEEL is 1 the time returned is the next
+ * time the wheel needs processing.
  */
 static TickType_t prvGetNextExpireTime( BaseType_t * const pxListWasEmpty ) PRIVILEGED_FUNCTION;
 
@@ -479,45 +550,49 @@ Timer_t *pxTimer = xTimer;
 }
 /*-----------------------------------------------------------*/
 
-static void prvProcessExpiredTimer( const TickType_t xNextExpireTime, const TickType_t xTimeNow )
-{
-BaseType_t xResult;
-Timer_t * const pxTimer = ( Timer_t * ) listGET_OWNER_OF_HEAD_ENTRY( pxCurrentTimerList ); /*lint !e9087 !e9079 void * is used as this macro is used with tasks and co-routines too.  Alignment is known to be fine as the type of the pointer stored and retrieved is the same. */
-
-	/* Remove the timer from the list of active timers.  A check has already
-	been performed to ensure the list is not empty. */
-	( void ) uxListRemove( &( pxTimer->xTimerListItem ) );
-	traceTIMER_EXPIRED( pxTimer );
+#if( configUSE_TIMER_WHEEL == 0 )
 
-	/* If the timer is an auto reload timer then calculate the next
-	expiry time and re-insert the timer in the list of active timers. */
-	if( ( pxTimer->ucStatus & tmrSTATUS_IS_AUTORELOAD ) != 0 )
+	static void prvProcessExpiredTimer( const TickType_t xNextExpireTime, const TickType_t xTimeNow )
 	{
-		/* The timer is inserted into a list using a time relative to anything
-		other than the current time.  It will therefore be inserted into the
-		correct list relative to the time this task thinks it is now. */
-		if( prvInsertTimerInActiveList( pxTimer, ( xNextExpireTime + pxTimer->xTimerPeriodInTicks ), xTimeNow, xNextExpireTime ) != pdFALSE )
+	BaseType_t xResult;
+	Timer_t * const pxTimer = ( Timer_t * ) listGET_OWNER_OF_HEAD_ENTRY( pxCurrentTimerList ); /*lint !e9087 !e9079 void * is used as this macro is used with tasks and co-routines too.  Alignment is known to be fine as the type of the pointer stored and retrieved is the same. */
+
+		/* Remove the timer from the list of active timers.  A check has already
+		been performed to ensure the list is not empty. */
+		( void ) uxListRemove( &( pxTimer->xTimerListItem ) );
+		traceTIMER_EXPIRED( pxTimer );
+
+		/* If the timer is an auto reload timer then calculate the next
+		expiry time and re-insert the timer in the list of active timers. */
+		if( ( pxTimer->ucStatus & tmrSTATUS_IS_AUTORELOAD ) != 0 )
 		{
-			/* The timer expired before it was added to the active timer
-			list.  Reload it now.  */
-			xResult = xTimerGenericCommand( pxTimer, tmrCOMMAND_START_DONT_TRACE, xNextExpireTime, NULL, tmrNO_DELAY );
-			configASSERT( xResult );
-			( void ) xResult;
+			/* The timer is inserted into a list using a time relative to anything
+			other than the current time.  It will therefore be inserted into the
+			correct list relative to the time this task thinks it is now. */
+			if( prvInsertTimerInActiveList( pxTimer, ( xNextExpireTime + pxTimer->xTimerPeriodInTicks ), xTimeNow, xNextExpireTime ) != pdFALSE )
+			{
+				/* The timer expired before it was added to the active timer
+				list.  Reload it now.  */
+				xResult = xTimerGenericCommand( pxTimer, tmrCOMMAND_START_DONT_TRACE, xNextExpireTime, NULL, tmrNO_DELAY );
+				configASSERT( xResult );
+				( void ) xResult;
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
 		}
 		else
 		{
+			pxTimer->ucStatus &= ~tmrSTATUS_IS_ACTIVE;
 			mtCOVERAGE_TEST_MARKER();
 		}
-	}
-	else
-	{
-		pxTimer->ucStatus &= ~tmrSTATUS_IS_ACTIVE;
-		mtCOVERAGE_TEST_MARKER();
+
+		/* Call the timer callback. */
+		pxTimer->pxCallbackFunction( ( TimerHandle_t ) pxTimer );
 	}
 
-	/* Call the timer callback. */
-	pxTimer->pxCallbackFunction( ( TimerHandle_t ) pxTimer );
-}
+#endif /* configUSE_TIMER_WHEEL */
 /*-----------------------------------------------------------*/
 
 static portTASK_FUNCTION( prvTimerTask, pvParameters )
@@ -572,10 +647,19 @@ BaseType_t xTimerListsWereSwitched;
 		if( xTimerListsWereSwitched == pdFALSE )
 		{
 			/* The tick count has not overflowed, has the timer expired? */
-			if( ( xListWasEmpty == pdFALSE ) && ( xNextExpireTime <= xTimeNow ) )
+			if( ( xListWasEmpty == pdFALSE ) && tmrTIME_REACHED( xNextExpireTime, xTimeNow ) )
 			{
 				( void ) xTaskResumeAll();
-				prvProcessExpiredTimer( xNextExpireTime, xTimeNow );
+
+				#if( configUSE_TIMER_WHEEL == 1 )
+				{
+					prvProcessExpiredTimers( xTimeNow );
+				}
+				#else
+				{
+					prvProcessExpiredTimer( xNextExpireTime, xTimeNow );
+				}
+				#endif
 			}
 			else
 			{
@@ -585,12 +669,16 @@ BaseType_t xTimerListsWereSwitched;
 				received - whichever comes first.  The following line cannot
 				be reached unless xNextExpireTime > xTimeNow, except in the
 				case when the current timer list is empty. */
-				if( xListWasEmpty != pdFALSE )
+				#if( configUSE_TIMER_WHEEL == 0 )
 				{
-					/* The current timer list is empty - is the overflow list
-					also empty? */
-					xListWasEmpty = listLIST_IS_EMPTY( pxOverflowTimerList );
+					if( xListWasEmpty != pdFALSE )
+					{
+						/* The current timer list is empty - is the overflow list
+						also empty? */
+						xListWasEmpty = listLIST_IS_EMPTY( pxOverflowTimerList );
+					}
 				}
+				#endif
 
 				vQueueWaitForMessageRestricted( xTimerQueue, ( xNextExpireTime - xTimeNow ), xListWasEmpty );
 
@@ -627,10 +715,27 @@ TickType_t xNextExpireTime;
 	this task to unblock when the tick count overflows, at which point the
 	timer lists will be switched and the next expiry time can be
 	re-assessed.  */
-	*pxListWasEmpty = listLIST_IS_EMPTY( pxCurrentTimerList );
+	#if( configUSE_TIMER_WHEEL == 1 )
+	{
+		*pxListWasEmpty = ( uxActiveWheelTimers == ( UBaseType_t ) 0U ) ? pdTRUE : pdFALSE;
+	}
+	#else
+	{
+		*pxListWasEmpty = listLIST_IS_EMPTY( pxCurrentTimerList );
+	}
+	#endif
+
 	if( *pxListWasEmpty == pdFALSE )
 	{
-		xNextExpireTime = listGET_ITEM_VALUE_OF_HEAD_ENTRY( pxCurrentTimerList );
+		#if( configUSE_TIMER_WHEEL == 1 )
+		{
+			xNextExpireTime = prvWheelNextEventTime();
+		}
+		#else
+		{
+			xNextExpireTime = listGET_ITEM_VALUE_OF_HEAD_ENTRY( pxCurrentTimerList );
+		}
+		#endif
 	}
 	else
 	{
@@ -645,21 +750,32 @@ TickType_t xNextExpireTime;
 static TickType_t prvSampleTimeNow( BaseType_t * const pxTimerListsWereSwitched )
 {
 TickType_t xTimeNow;
-PRIVILEGED_DATA static TickType_t xLastTime = ( TickType_t ) 0U; /*lint !e956 Variable is only accessible to one task. */
+#if( configUSE_TIMER_WHEEL == 0 )
+	PRIVILEGED_DATA static TickType_t xLastTime = ( TickType_t ) 0U; /*lint !e956 Variable is only accessible to one task. */
+#endif
 
 	xTimeNow = xTaskGetTickCount();
 
-	if( xTimeNow < xLastTime )
-	{
-		prvSwitchTimerLists();
-		*pxTimerListsWereSwitched = pdTRUE;
-	}
-	else
+	#if( configUSE_TIMER_WHEEL == 1 )
 	{
+		/* The wheel has no lists to switch when the tick count overflows. */
 		*pxTimerListsWereSwitched = pdFALSE;
 	}
+	#else
+	{
+		if( xTimeNow < xLastTime )
+		{
+			prvSwitchTimerLists();
+			*pxTimerListsWereSwitched = pdTRUE;
+		}
+		else
+		{
+			*pxTimerListsWereSwitched = pdFALSE;
+		}
 
-	xLastTime = xTimeNow;
+		xLastTime = xTimeNow;
+	}
+	#endif
 
 	return xTimeNow;
 }
@@ -672,35 +788,65 @@ BaseType_t xProcessTimerNow = pdFALSE;
 	listSET_LIST_ITEM_VALUE( &( pxTimer->xTimerListItem ), xNextExpiryTime );
 	listSET_LIST_ITEM_OWNER( &( pxTimer->xTimerListItem ), pxTimer );
 
-	if( xNextExpiryTime <= xTimeNow )
+	#if( configUSE_TIMER_WHEEL == 1 )
 	{
-		/* Has the expiry time elapsed between the command to start/reset a
-		timer was issued, and the time the command was processed? */
-		if( ( ( TickType_t ) ( xTimeNow - xCommandTime ) ) >= pxTimer->xTimerPeriodInTicks ) /*lint !e961 MISRA exception as the casts are only redundant for some ports. */
+		/* Comparing the times relative to xCommandTime means tick count
+		overflows need no special handling.  Has the expiry time elapsed between
+		the command being issued and the command being processed? */
+		if( ( TickType_t ) ( xTimeNow - xCommandTime ) >= ( TickType_t ) ( xNextExpiryTime - xCommandTime ) ) /*lint !e961 MISRA exception as the casts are only redundant for some ports. */
 		{
-			/* The time between a command being issued and the command being
-			processed actually exceeds the timers period.  */
 			xProcessTimerNow = pdTRUE;
 		}
 		else
 		{
-			vListInsert( pxOverflowTimerList, &( pxTimer->xTimerListItem ) );
+			if( uxActiveWheelTimers == ( UBaseType_t ) 0U )
+			{
+				/* There is nothing to step through, so the wheel can move
+				straight to the current time. */
+				xWheelTime = xTimeNow;
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+
+			prvWheelInsert( pxTimer );
+			uxActiveWheelTimers++;
 		}
 	}
-	else
+	#else
 	{
-		if( ( xTimeNow < xCommandTime ) && ( xNextExpiryTime >= xCommandTime ) )
+		if( xNextExpiryTime <= xTimeNow )
 		{
-			/* If, since the command was issued, the tick count has overflowed
-			but the expiry time has not, then the timer must have already passed
-			its expiry time and should be processed immediately. */
-			xProcessTimerNow = pdTRUE;
+			/* Has the expiry time elapsed between the command to start/reset a
+			timer was issued, and the time the command was processed? */
+			if( ( ( TickType_t ) ( xTimeNow - xCommandTime ) ) >= pxTimer->xTimerPeriodInTicks ) /*lint !e961 MISRA exception as the casts are only redundant for some ports. */
+			{
+				/* The time between a command being issued and the command being
+				processed actually exceeds the timers period.  */
+				xProcessTimerNow = pdTRUE;
+			}
+			else
+			{
+				vListInsert( pxOverflowTimerList, &( pxTimer->xTimerListItem ) );
+			}
 		}
 		else
 		{
-			vListInsert( pxCurrentTimerList, &( pxTimer->xTimerListItem ) );
+			if( ( xTimeNow < xCommandTime ) && ( xNextExpiryTime >= xCommandTime ) )
+			{
+				/* If, since the command was issued, the tick count has overflowed
+				but the expiry time has not, then the timer must have already passed
+				its expiry time and should be processed immediately. */
+				xProcessTimerNow = pdTRUE;
+			}
+			else
+			{
+				vListInsert( pxCurrentTimerList, &( pxTimer->xTimerListItem ) );
+			}
 		}
 	}
+	#endif
 
 	return xProcessTimerNow;
 }
@@ -749,6 +895,12 @@ TickType_t xTimeNow;
 			{
 				/* The timer is in a list, remove it. */
 				( void ) uxListRemove( &( pxTimer->xTimerListItem ) );
+
+				#if( configUSE_TIMER_WHEEL == 1 )
+				{
+					uxActiveWheelTimers--;
+				}
+				#endif
 			}
 			else
 			{
@@ -789,7 +941,9 @@ TickType_t xTimeNow;
 						}
 						else
 						{
-							mtCOVERAGE_TEST_MARKER();
+							/* A one-shot timer that has expired is no longer
+							active. */
+							pxTimer->ucStatus &= ~tmrSTATUS_IS_ACTIVE;
 						}
 					}
 					else
@@ -854,63 +1008,234 @@ TickType_t xTimeNow;
 }
 /*-----------------------------------------------------------*/
 
-static void prvSwitchTimerLists( void )
-{
-TickType_t xNextExpireTime, xReloadTime;
-List_t *pxTemp;
-Timer_t *pxTimer;
-BaseType_t xResult;
+#if( configUSE_TIMER_WHEEL == 0 )
 
-	/* The tick count has overflowed.  The timer lists must be switched.
-	If there are any timers still referenced from the current timer list
-	then they must have expired and should be processed before the lists
-	are switched. */
-	while( listLIST_IS_EMPTY( pxCurrentTimerList ) == pdFALSE )
+	static void prvSwitchTimerLists( void )
 	{
-		xNextExpireTime = listGET_ITEM_VALUE_OF_HEAD_ENTRY( pxCurrentTimerList );
+	TickType_t xNextExpireTime, xReloadTime;
+	List_t *pxTemp;
+	Timer_t *pxTimer;
+	BaseType_t xResult;
+
+		/* The tick count has overflowed.  The timer lists must be switched.
+		If there are any timers still referenced from the current timer list
+		then they must have expired and should be processed before the lists
+		are switched. */
+		while( listLIST_IS_EMPTY( pxCurrentTimerList ) == pdFALSE )
+		{
+			xNextExpireTime = listGET_ITEM_VALUE_OF_HEAD_ENTRY( pxCurrentTimerList );
 
-		/* Remove the timer from the list. */
-		pxTimer = ( Timer_t * ) listGET_OWNER_OF_HEAD_ENTRY( pxCurrentTimerList ); /*lint !e9087 !e9079 void * is used as this macro is used with tasks and co-routines too.  Alignment is known to be fine as the type of the pointer stored and retrieved is the same. */
-		( void ) uxListRemove( &( pxTimer->xTimerListItem ) );
-		traceTIMER_EXPIRED( pxTimer );
+			/* Remove the timer from the list. */
+			pxTimer = ( Timer_t * ) listGET_OWNER_OF_HEAD_ENTRY( pxCurrentTimerList ); /*lint !e9087 !e9079 void * is used as this macro is used with tasks and co-routines too.  Alignment is known to be fine as the type of the pointer stored and retrieved is the same. */
+			( void ) uxListRemove( &( pxTimer->xTimerListItem ) );
+			traceTIMER_EXPIRED( pxTimer );
 
-		/* Execute its callback, then send a command to restart the timer if
-		it is an auto-reload timer.  It cannot be restarted here as the lists
-		have not yet been switched. */
-		pxTimer->pxCallbackFunction( ( TimerHandle_t ) pxTimer );
+			/* Execute its callback, then send a command to restart the timer if
+			it is an auto-reload timer.  It cannot be restarted here as the lists
+			have not yet been switched. */
+			pxTimer->pxCallbackFunction( ( TimerHandle_t ) pxTimer );
 
-		if( ( pxTimer->ucStatus & tmrSTATUS_IS_AUTORELOAD ) != 0 )
+			if( ( pxTimer->ucStatus & tmrSTATUS_IS_AUTORELOAD ) != 0 )
+			{
+				/* Calculate the reload value, and if the reload value results in
+				the timer going into the same timer list then it has already expired
+				and the timer should be re-inserted into the current list so it is
+				processed again within this loop.  Otherwise a command should be sent
+				to restart the timer to ensure it is only inserted into a list after
+				the lists have been swapped. */
+				xReloadTime = ( xNextExpireTime + pxTimer->xTimerPeriodInTicks );
+				if( xReloadTime > xNextExpireTime )
+				{
+					listSET_LIST_ITEM_VALUE( &( pxTimer->xTimerListItem ), xReloadTime );
+					listSET_LIST_ITEM_OWNER( &( pxTimer->xTimerListItem ), pxTimer );
+					vListInsert( pxCurrentTimerList, &( pxTimer->xTimerListItem ) );
+				}
+				else
+				{
+					xResult = xTimerGenericCommand( pxTimer, tmrCOMMAND_START_DONT_TRACE, xNextExpireTime, NULL, tmrNO_DELAY );
+					configASSERT( xResult );
+					( void ) xResult;
+				}
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+
+		pxTemp = pxCurrentTimerList;
+		pxCurrentTimerList = pxOverflowTimerList;
+		pxOverflowTimerList = pxTemp;
+	}
+
+#endif /* configUSE_TIMER_WHEEL */
+/*-----------------------------------------------------------*/
+
+#if( configUSE_TIMER_WHEEL == 1 )
+
+	static void prvWheelInsert( Timer_t * const pxTimer )
+	{
+	const TickType_t xExpiryTime = listGET_LIST_ITEM_VALUE( &( pxTimer->xTimerListItem ) );
+	const TickType_t xTicksToExpiry = xExpiryTime - xWheelTime;
+	UBaseType_t uxLevel = 0U;
+	TickType_t xSlot;
+
+		/* Use the finest level that has a slot for the expiry time.  Timers
+		beyond the span of the top level go in the top level anyway, and are
+		placed again each time their slot is reached until they are in range. */
+		while( ( uxLevel < ( UBaseType_t ) ( configTIMER_WHEEL_LEVELS - 1 ) ) &&
+			   ( ( xTicksToExpiry >> ( configTIMER_WHEEL_SLOT_BITS * ( uxLevel + 1U ) ) ) != ( TickType_t ) 0U ) )
+		{
+			uxLevel++;
+		}
+
+		xSlot = ( xExpiryTime >> ( configTIMER_WHEEL_SLOT_BITS * uxLevel ) ) & tmrWHEEL_SLOT_MASK;
+		vListInsertEnd( &( xTimerWheel[ uxLevel ][ xSlot ] ), &( pxTimer->xTimerListItem ) );
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvWheelCascade( const TickType_t xTick )
+	{
+	UBaseType_t uxLevel, uxShift, uxToMove;
+	List_t *pxSlot;
+	ListItem_t *pxListItem;
+
+		for( uxLevel = ( UBaseType_t ) ( configTIMER_WHEEL_LEVELS - 1 ); uxLevel > ( UBaseType_t ) 0U; uxLevel-- )
 		{
-			/* Calculate the reload value, and if the reload value results in
-			the timer going into the same timer list then it has already expired
-			and the timer should be re-inserted into the current list so it is
-			processed again within this loop.  Otherwise a command should be sent
-			to restart the timer to ensure it is only inserted into a list after
-			the lists have been swapped. */
-			xReloadTime = ( xNextExpireTime + pxTimer->xTimerPeriodInTicks );
-			if( xReloadTime > xNextExpireTime )
+			uxShift = ( UBaseType_t ) configTIMER_WHEEL_SLOT_BITS * uxLevel;
+
+			/* Does the span of a slot on this level start at xTick? */
+			if( ( xTick & ( ( ( TickType_t ) 1U << uxShift ) - ( TickType_t ) 1U ) ) == ( TickType_t ) 0U )
 			{
-				listSET_LIST_ITEM_VALUE( &( pxTimer->xTimerListItem ), xReloadTime );
-				listSET_LIST_ITEM_OWNER( &( pxTimer->xTimerListItem ), pxTimer );
-				vListInsert( pxCurrentTimerList, &( pxTimer->xTimerListItem ) );
+				pxSlot = &( xTimerWheel[ uxLevel ][ ( xTick >> uxShift ) & tmrWHEEL_SLOT_MASK ] );
+
+				/* Timers that are still out of range go back into the same
+				slot, so only move the timers that were there to start with. */
+				uxToMove = listCURRENT_LIST_LENGTH( pxSlot );
+				while( uxToMove > ( UBaseType_t ) 0U )
+				{
+					uxToMove--;
+					pxListItem = listGET_HEAD_ENTRY( pxSlot );
+					( void ) uxListRemove( pxListItem );
+					prvWheelInsert( ( Timer_t * ) listGET_LIST_ITEM_OWNER( pxListItem ) ); /*lint !e9087 !e9079 void * is used as this macro is used with tasks and co-routines too.  Alignment is known to be fine as the type of the pointer stored and retrieved is the same. */
+				}
 			}
 			else
 			{
-				xResult = xTimerGenericCommand( pxTimer, tmrCOMMAND_START_DONT_TRACE, xNextExpireTime, NULL, tmrNO_DELAY );
-				configASSERT( xResult );
-				( void ) xResult;
+				mtCOVERAGE_TEST_MARKER();
 			}
 		}
-		else
+	}
+	/*-----------------------------------------------------------*/
+
+	static TickType_t prvWheelNextEventTime( void )
+	{
+	TickType_t xTicksToEvent = portMAX_DELAY, xTicksToSlot, xBlock;
+	UBaseType_t uxLevel, uxShift, uxSlot;
+
+		/* The first occupied level 0 slot holds the next timers to expire.  The
+		slot for xWheelTime itself has already been processed. */
+		for( uxSlot = 1U; uxSlot < tmrWHEEL_SLOTS; uxSlot++ )
 		{
-			mtCOVERAGE_TEST_MARKER();
+			if( listLIST_IS_EMPTY( &( xTimerWheel[ 0 ][ ( xWheelTime + uxSlot ) & tmrWHEEL_SLOT_MASK ] ) ) == pdFALSE )
+			{
+				xTicksToEvent = ( TickType_t ) uxSlot;
+				break;
+			}
 		}
+
+		/* Timers on the higher levels have to be moved down at the start of
+		their slot's span, which can be before the next level 0 expiry. */
+		for( uxLevel = 1U; uxLevel < ( UBaseType_t ) configTIMER_WHEEL_LEVELS; uxLevel++ )
+		{
+			uxShift = ( UBaseType_t ) configTIMER_WHEEL_SLOT_BITS * uxLevel;
+			xBlock = xWheelTime >> uxShift;
+
+			for( uxSlot = 1U; uxSlot <= tmrWHEEL_SLOTS; uxSlot++ )
+			{
+				xTicksToSlot = ( ( xBlock + uxSlot ) << uxShift ) - xWheelTime;
+
+				if( xTicksToSlot >= xTicksToEvent )
+				{
+					/* Every remaining slot on this level starts later. */
+					break;
+				}
+				else if( listLIST_IS_EMPTY( &( xTimerWheel[ uxLevel ][ ( xBlock + uxSlot ) & tmrWHEEL_SLOT_MASK ] ) ) == pdFALSE )
+				{
+					xTicksToEvent = xTicksToSlot;
+					break;
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+			}
+		}
+
+		/* There is at least one timer in the wheel, so an event was found. */
+		configASSERT( xTicksToEvent != portMAX_DELAY );
+
+		return xWheelTime + xTicksToEvent;
 	}
+	/*-----------------------------------------------------------*/
 
-	pxTemp = pxCurrentTimerList;
-	pxCurrentTimerList = pxOverflowTimerList;
-	pxOverflowTimerList = pxTemp;
-}
+	static void prvProcessExpiredTimers( const TickType_t xTimeNow )
+	{
+	TickType_t xTick;
+	List_t *pxSlot;
+	UBaseType_t uxToExpire;
+	Timer_t *pxTimer;
+
+		/* Step the wheel through each tick up to xTimeNow that has work to do,
+		expiring all the timers that are due on that tick together. */
+		while( uxActiveWheelTimers > ( UBaseType_t ) 0U )
+		{
+			xTick = prvWheelNextEventTime();
+
+			if( tmrTIME_REACHED( xTick, xTimeNow ) == pdFALSE )
+			{
+				break;
+			}
+
+			xWheelTime = xTick;
+			prvWheelCascade( xTick );
+
+			/* Auto reload timers are reloaded relative to xTick, so cannot be
+			placed back in this slot, only remove the timers that were here to
+			start with. */
+			pxSlot = &( xTimerWheel[ 0 ][ xTick & tmrWHEEL_SLOT_MASK ] );
+			uxToExpire = listCURRENT_LIST_LENGTH( pxSlot );
+
+			while( uxToExpire > ( UBaseType_t ) 0U )
+			{
+				uxToExpire--;
+				pxTimer = ( Timer_t * ) listGET_OWNER_OF_HEAD_ENTRY( pxSlot ); /*lint !e9087 !e9079 void * is used as this macro is used with tasks and co-routines too.  Alignment is known to be fine as the type of the pointer stored and retrieved is the same. */
+				configASSERT( listGET_LIST_ITEM_VALUE( &( pxTimer->xTimerListItem ) ) == xTick );
+
+				( void ) uxListRemove( &( pxTimer->xTimerListItem ) );
+				uxActiveWheelTimers--;
+				traceTIMER_EXPIRED( pxTimer );
+
+				if( ( pxTimer->ucStatus & tmrSTATUS_IS_AUTORELOAD ) != 0 )
+				{
+					/* If the next expiry time is also before xTimeNow the
+					timer will be processed again by this loop. */
+					( void ) prvInsertTimerInActiveList( pxTimer, ( xTick + pxTimer->xTimerPeriodInTicks ), xTick, xTick );
+				}
+				else
+				{
+					pxTimer->ucStatus &= ~tmrSTATUS_IS_ACTIVE;
+				}
+
+				/* Call the timer callback. */
+				pxTimer->pxCallbackFunction( ( TimerHandle_t ) pxTimer );
+			}
+		}
+
+		xWheelTime = xTimeNow;
+	}
+
+#endif /* configUSE_TIMER_WHEEL */
 /*-----------------------------------------------------------*/
 
 static void prvCheckForValidListAndQueue( void )
@@ -922,10 +1247,26 @@ static void prvCheckForValidListAndQueue( void )
 	{
 		if( xTimerQueue == NULL )
 		{
-			vListInitialise( &xActiveTimerList1 );
-			vListInitialise( &xActiveTimerList2 );
-			pxCurrentTimerList = &xActiveTimerList1;
-			pxOverflowTimerList = &xActiveTimerList2;
+			#if( configUSE_TIMER_WHEEL == 1 )
+			{
+			UBaseType_t uxLevel, uxSlot;
+
+				for( uxLevel = 0U; uxLevel < ( UBaseType_t ) configTIMER_WHEEL_LEVELS; uxLevel++ )
+				{
+					for( uxSlot = 0U; uxSlot < tmrWHEEL_SLOTS; uxSlot++ )
+					{
+						vListInitialise( &( xTimerWheel[ uxLevel ][ uxSlot ] ) );
+					}
+				}
+			}
+			#else
+			{
+				vListInitialise( &xActiveTimerList1 );
+				vListInitialise( &xActiveTimerList2 );
+				pxCurrentTimerList = &xActiveTimerList1;
+				pxOverflowTimerList = &xActiveTimerList2;
+			}
+			#endif
 
 			#if( configSUPPORT_STATIC_ALLOCATION == 1 )
 			{
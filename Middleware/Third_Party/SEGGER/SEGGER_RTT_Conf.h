@@ -78,13 +78,45 @@ Revision: $Rev: 13430 $
 **********************************************************************
 */
 
-#define SEGGER_RTT_MAX_NUM_UP_BUFFERS             (3)     // Max. number of up-buffers (T->H) available on this target    (Default: 3)
+//
+// High throughput mode (see BSP/RttFast.h) - define SEGGER_RTT_HIGH_THROUGHPUT=1 for the whole build
+// to get larger, cache line aligned buffers and word-at-a-time copies in SEGGER_RTT_Write.
+// Every size below can also be overridden individually from the build.
+//
+#if defined(SEGGER_RTT_HIGH_THROUGHPUT) && (SEGGER_RTT_HIGH_THROUGHPUT == 1)
+  #ifndef   SEGGER_RTT_MAX_NUM_UP_BUFFERS
+    #define SEGGER_RTT_MAX_NUM_UP_BUFFERS         (6)     // room for per-task channels after Terminal, SysView and TokenLog
+  #endif
+  #ifndef   BUFFER_SIZE_UP
+    #define BUFFER_SIZE_UP                        (4096)
+  #endif
+  #ifndef   SEGGER_RTT_PRINTF_BUFFER_SIZE
+    #define SEGGER_RTT_PRINTF_BUFFER_SIZE         (256u)
+  #endif
+  #ifndef   SEGGER_RTT_BUFFER_ALIGNMENT
+    #define SEGGER_RTT_BUFFER_ALIGNMENT           (32)    // Cortex-M7 cache line
+  #endif
+  #ifndef   SEGGER_RTT_ASM
+    void* RttFastCopy(void* Dest, const void* Src, unsigned NumBytes);
+  #endif
+  #define SEGGER_RTT_MEMCPY(pDest, pSrc, NumBytes)  RttFastCopy((pDest), (pSrc), (NumBytes))
+#endif
+
+#ifndef   SEGGER_RTT_MAX_NUM_UP_BUFFERS
+  #define SEGGER_RTT_MAX_NUM_UP_BUFFERS           (3)     // Max. number of up-buffers (T->H) available on this target    (Default: 3)
+#endif
 #define SEGGER_RTT_MAX_NUM_DOWN_BUFFERS           (3)     // Max. number of down-buffers (H->T) available on this target  (Default: 3)
 
-#define BUFFER_SIZE_UP                            (1024)  // Size of the buffer for terminal output of target, up to host (Default: 1k)
-#define BUFFER_SIZE_DOWN                          (16)    // Size of the buffer for terminal input to target from host (Usually keyboard input) (Default: 16)
+#ifndef   BUFFER_SIZE_UP
+  #define BUFFER_SIZE_UP                          (1024)  // Size of the buffer for terminal output of target, up to host (Default: 1k)
+#endif
+#ifndef   BUFFER_SIZE_DOWN
+  #define BUFFER_SIZE_DOWN                        (16)    // Size of the buffer for terminal input to target from host (Usually keyboard input) (Default: 16)
+#endif
 
-#define SEGGER_RTT_PRINTF_BUFFER_SIZE             (64u)    // Size of buffer for RTT printf to bulk-send chars via RTT     (Default: 64)
+#ifndef   SEGGER_RTT_PRINTF_BUFFER_SIZE
+  #define SEGGER_RTT_PRINTF_BUFFER_SIZE           (64u)    // Size of buffer for RTT printf to bulk-send chars via RTT     (Default: 64)
+#endif
 
 #define SEGGER_RTT_MODE_DEFAULT                   SEGGER_RTT_MODE_NO_BLOCK_SKIP // Mode for pre-initialized terminal channel (buffer 0)
 
@@ -125,6 +157,38 @@ Revision: $Rev: 13430 $
 
 #define SEGGER_RTT_MAX_INTERRUPT_PRIORITY         (0x20)   // Interrupt priority to lock on SEGGER_RTT_LOCK on Cortex-M3/4 (Default: 0x20)
 
+/*********************************************************************
+*
+*       RTT lock profiling (GCC, Cortex-M3/4/7 only)
+*
+*       With SEGGER_RTT_LOCK_PROFILE=1 the time interrupts are masked by
+*       SEGGER_RTT_LOCK is measured with the DWT cycle counter (which must
+*       be enabled, see BSP/DWTCycleCounter.h) and accumulated in
+*       RttLockProfile (BSP/RttFast.c).  The totals are only updated while
+*       locked, so they are safe from every writer the lock protects.
+*/
+#if defined(SEGGER_RTT_LOCK_PROFILE) && (SEGGER_RTT_LOCK_PROFILE == 1) && !defined(SEGGER_RTT_ASM)
+  typedef struct {
+    unsigned NumLocks;
+    unsigned TotalCycles;
+    unsigned MaxCycles;
+  } RTT_LOCK_PROFILE;
+  extern volatile RTT_LOCK_PROFILE RttLockProfile;
+  #define SEGGER_RTT_CYCCNT               (*(volatile unsigned*)0xE0001004)
+  #define SEGGER_RTT_LOCK_PROFILE_START() unsigned LockStart = SEGGER_RTT_CYCCNT
+  #define SEGGER_RTT_LOCK_PROFILE_END()   {                                                         \
+                                            unsigned LockCycles = SEGGER_RTT_CYCCNT - LockStart;    \
+                                            RttLockProfile.NumLocks++;                              \
+                                            RttLockProfile.TotalCycles += LockCycles;               \
+                                            if (LockCycles > RttLockProfile.MaxCycles) {            \
+                                              RttLockProfile.MaxCycles = LockCycles;                \
+                                            }                                                       \
+                                          }
+#else
+  #define SEGGER_RTT_LOCK_PROFILE_START()
+  #define SEGGER_RTT_LOCK_PROFILE_END()
+#endif
+
 /*********************************************************************
 *
 *       RTT lock configuration for SEGGER Embedded Studio,
@@ -160,9 +224,11 @@ Revision: $Rev: 13430 $
                                                   : "=r" (LockState)                                \
                                                   : "i"(SEGGER_RTT_MAX_INTERRUPT_PRIORITY)          \
                                                   : "r1"                                            \
-                                                  );
+                                                  );                                                \
+                                  SEGGER_RTT_LOCK_PROFILE_START();
 
-    #define SEGGER_RTT_UNLOCK()   __asm volatile ("msr   basepri, %0  \n\t"                         \
+    #define SEGGER_RTT_UNLOCK()   SEGGER_RTT_LOCK_PROFILE_END();                                    \
+                                  __asm volatile ("msr   basepri, %0  \n\t"                         \
                                                   :                                                 \
                                                   : "r" (LockState)                                 \
                                                   :                                                 \
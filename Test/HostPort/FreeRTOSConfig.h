@@ -0,0 +1,110 @@
+/**
+ * MIT License
+ * 
+ * Copyright (c) 2019 Brian Amos
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#ifndef FREERTOS_CONFIG_H
+#define FREERTOS_CONFIG_H
+
+/**
+ * Kernel configuration for the host tests in Test/
+ * Follows the chapter configurations (Chapter_13/Inc/FreeRTOSConfig.h),
+ * with a heap and stacks sized for a 64 bit host.  Options a test needs
+ * to build both ways can be overridden from its Makefile rule.
+ */
+
+#include <stdint.h>
+
+#define configUSE_PREEMPTION                     1
+#define configSUPPORT_STATIC_ALLOCATION          1
+#define configSUPPORT_DYNAMIC_ALLOCATION         1
+#define configUSE_IDLE_HOOK                      1
+#define configUSE_TICK_HOOK                      1
+#define configCPU_CLOCK_HZ                       ( 216000000UL )
+#define configTICK_RATE_HZ                       ((TickType_t)1000)
+#define configMAX_PRIORITIES                     ( 8 )
+#define configMINIMAL_STACK_SIZE                 ((uint16_t)128)
+#define configTOTAL_HEAP_SIZE                    ((size_t)(4 * 1024 * 1024))
+#define configMAX_TASK_NAME_LEN                  ( 16 )
+#define configUSE_TRACE_FACILITY                 1
+#define configUSE_16_BIT_TICKS                   0
+#define configUSE_MUTEXES                        1
+#define configQUEUE_REGISTRY_SIZE                8
+#define configUSE_RECURSIVE_MUTEXES              1
+#define configUSE_COUNTING_SEMAPHORES            1
+#define configUSE_PORT_OPTIMISED_TASK_SELECTION  0
+#define configUSE_POSIX_ERRNO                    1
+
+#define configUSE_CO_ROUTINES                    0
+#define configMAX_CO_ROUTINE_PRIORITIES          ( 2 )
+
+#define configUSE_TIMERS                         1
+#define configTIMER_TASK_PRIORITY                ( configMAX_PRIORITIES - 1 )
+#define configTIMER_QUEUE_LENGTH                 32
+#define configTIMER_TASK_STACK_DEPTH             256
+
+#define INCLUDE_vTaskPrioritySet            1
+#define INCLUDE_uxTaskPriorityGet           1
+#define INCLUDE_vTaskDelete                 1
+#define INCLUDE_vTaskCleanUpResources       0
+#define INCLUDE_vTaskSuspend                1
+#define INCLUDE_vTaskDelayUntil             1
+#define INCLUDE_vTaskDelay                  1
+#define INCLUDE_xTaskGetSchedulerState      1
+#define INCLUDE_xTimerPendFunctionCall      1
+#define INCLUDE_xQueueGetMutexHolder        1
+#define INCLUDE_uxTaskGetStackHighWaterMark 1
+#define INCLUDE_eTaskGetState               1
+#define INCLUDE_xTaskGetIdleTaskHandle      1
+#define INCLUDE_xTaskGetCurrentTaskHandle   1
+#define configUSE_TASK_NOTIFICATIONS        1
+#define configTASK_NOTIFICATION_ARRAY_ENTRIES	2
+
+#define configGENERATE_RUN_TIME_STATS           0
+#define configUSE_STATS_FORMATTING_FUNCTIONS    0
+
+#ifndef configUSE_TIMER_WHEEL
+	#define configUSE_TIMER_WHEEL               0
+#endif
+
+#ifndef configUSE_EVENT_GROUP_DIRECT_ISR
+	#define configUSE_EVENT_GROUP_DIRECT_ISR    1
+#endif
+
+/* see port.c */
+void vAssertCalled( const char* File, int Line );
+#define configASSERT( x ) if ((x) == 0) { vAssertCalled(__FILE__, __LINE__); }
+
+/* a task is about to block on a queue, which it has locked - see
+vPortHostSetQueueBlockingHook() */
+void vPortHostQueueBlocking( void* pxQueue );
+#define traceBLOCKING_ON_QUEUE_RECEIVE( pxQueue )	vPortHostQueueBlocking( pxQueue )
+#define traceBLOCKING_ON_QUEUE_SEND( pxQueue )		vPortHostQueueBlocking( pxQueue )
+
+/* a task is setting bits in, or about to block on, an event group it has
+locked - see vPortHostSetEventGroupLockedHook() */
+void vPortHostEventGroupLocked( void* pxEventGroup );
+#define traceEVENT_GROUP_SET_BITS( xEventGroup, uxBitsToSet )	vPortHostEventGroupLocked( xEventGroup )
+#define traceEVENT_GROUP_WAIT_BITS_BLOCK( xEventGroup, uxBitsToWaitFor )	vPortHostEventGroupLocked( xEventGroup )
+#define traceEVENT_GROUP_SYNC_BLOCK( xEventGroup, uxBitsToSet, uxBitsToWaitFor )	vPortHostEventGroupLocked( xEventGroup )
+
+#endif /* FREERTOS_CONFIG_H */
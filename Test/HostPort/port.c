@@ -0,0 +1,270 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2019 Brian Amos
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#define _DEFAULT_SOURCE		//ucontext
+#include <FreeRTOS.h>
+#include <task.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/resource.h>
+#include <ucontext.h>
+
+/**
+ * Host port of the FreeRTOS kernel for the tests in Test/ (see portmacro.h)
+ *
+ * pxPortInitialiseStack doesn't use the task's stack at all: it allocates
+ * a context with a host stack of its own and hands back a pointer to it,
+ * which the kernel keeps in pxTopOfStack.  A context switch is then
+ * vTaskSwitchContext() followed by swapcontext() to whatever pxCurrentTCB's
+ * pxTopOfStack points at.  The FreeRTOS stack is still allocated and filled,
+ * so heap and high water mark figures include it like they do on the target.
+ *
+ * Nothing ever preempts a running task.  The idle hook generates ticks, so
+ * time passes (instantly) whenever every task is blocked.
+ */
+
+//host stacks need room for printf and friends
+#define HOST_STACK_SIZE (256 * 1024)
+
+//the idle task giving this many ticks in a row means every task is stuck
+#define HOST_IDLE_TICK_LIMIT (100UL * 1000UL * 1000UL)
+
+typedef struct
+{
+	ucontext_t context;
+	TaskFunction_t code;
+	void* parameters;
+	uint8_t stack[HOST_STACK_SIZE];
+}HostContext;
+
+extern void* volatile pxCurrentTCB;
+
+static ucontext_t schedulerReturn;
+static UBaseType_t criticalNesting = 0;
+static BaseType_t yieldPending = pdFALSE;
+static uint32_t idleTicks = 0;
+static void (*tickHook)( void ) = NULL;
+static void (*queueBlockingHook)( void* Queue ) = NULL;
+static void (*eventGroupLockedHook)( void* EventGroup ) = NULL;
+
+static inline HostContext* currentContext( void )
+{
+	//pxTopOfStack is the first member of the TCB
+	return *(HostContext**)pxCurrentTCB;
+}
+
+static void taskStart( void )
+{
+	HostContext* ctx = currentContext();
+
+	ctx->code(ctx->parameters);
+
+	//FreeRTOS tasks must never return
+	vAssertCalled(__FILE__, __LINE__);
+}
+
+void vAssertCalled( const char* File, int Line )
+{
+	printf("%s:%d: configASSERT failed\n", File, Line);
+	fflush(stdout);
+	abort();
+}
+
+StackType_t* pxPortInitialiseStack( StackType_t* pxTopOfStack, TaskFunction_t pxCode, void* pvParameters )
+{
+	HostContext* ctx = malloc(sizeof(HostContext));
+
+	(void) pxTopOfStack;
+	configASSERT(ctx != NULL);
+	ctx->code = pxCode;
+	ctx->parameters = pvParameters;
+	getcontext(&ctx->context);
+	ctx->context.uc_stack.ss_sp = ctx->stack;
+	ctx->context.uc_stack.ss_size = sizeof(ctx->stack);
+	ctx->context.uc_link = NULL;
+	makecontext(&ctx->context, taskStart, 0);
+
+	return (StackType_t*)ctx;
+}
+
+void vPortHostFreeContext( volatile StackType_t* pxTopOfStack )
+{
+	free((void*)pxTopOfStack);
+}
+
+BaseType_t xPortStartScheduler( void )
+{
+	criticalNesting = 0;
+	swapcontext(&schedulerReturn, &currentContext()->context);
+
+	//back here after vTaskEndScheduler()
+	return pdFALSE;
+}
+
+void vPortEndScheduler( void )
+{
+	swapcontext(&currentContext()->context, &schedulerReturn);
+}
+
+void vPortYield( void )
+{
+	if(criticalNesting > 0)
+	{
+		//like PendSV, the switch waits until the critical section is left
+		yieldPending = pdTRUE;
+		return;
+	}
+	yieldPending = pdFALSE;
+
+	HostContext* from = currentContext();
+	vTaskSwitchContext();
+	HostContext* to = currentContext();
+
+	if(pxCurrentTCB != xTaskGetIdleTaskHandle())
+	{
+		idleTicks = 0;
+	}
+	if(to != from)
+	{
+		swapcontext(&from->context, &to->context);
+	}
+}
+
+void vPortEnterCritical( void )
+{
+	criticalNesting++;
+}
+
+void vPortExitCritical( void )
+{
+	configASSERT(criticalNesting > 0);
+	criticalNesting--;
+	if(criticalNesting == 0 && yieldPending)
+	{
+		vPortYield();
+	}
+}
+
+void vPortHostInterrupt( void (*Isr)( void ) )
+{
+	vPortEnterCritical();
+	Isr();
+	vPortExitCritical();
+}
+
+static void tickIsr( void )
+{
+	if(xTaskIncrementTick() != pdFALSE)
+	{
+		vPortYield();
+	}
+}
+
+void vPortHostTick( void )
+{
+	vPortHostInterrupt(tickIsr);
+}
+
+void vPortHostSetTickHook( void (*Isr)( void ) )
+{
+	tickHook = Isr;
+}
+
+void vPortHostSetQueueBlockingHook( void (*Hook)( void* Queue ) )
+{
+	queueBlockingHook = Hook;
+}
+
+void vPortHostQueueBlocking( void* pxQueue )
+{
+	if(queueBlockingHook != NULL)
+	{
+		queueBlockingHook(pxQueue);
+	}
+}
+
+void vPortHostSetEventGroupLockedHook( void (*Hook)( void* EventGroup ) )
+{
+	eventGroupLockedHook = Hook;
+}
+
+void vPortHostEventGroupLocked( void* pxEventGroup )
+{
+	if(eventGroupLockedHook != NULL)
+	{
+		eventGroupLockedHook(pxEventGroup);
+	}
+}
+
+uint64_t ullPortHostCpuTimeNs( void )
+{
+	//not clock_gettime() (or clock(), which calls it), FreeRTOS+POSIX
+	//replaces that one
+	struct rusage usage;
+
+	getrusage(RUSAGE_SELF, &usage);
+	return ((uint64_t)usage.ru_utime.tv_sec + (uint64_t)usage.ru_stime.tv_sec) * 1000000000ULL +
+		   ((uint64_t)usage.ru_utime.tv_usec + (uint64_t)usage.ru_stime.tv_usec) * 1000ULL;
+}
+
+void vApplicationTickHook( void )
+{
+	if(tickHook != NULL)
+	{
+		tickHook();
+	}
+}
+
+void vApplicationIdleHook( void )
+{
+	if(++idleTicks > HOST_IDLE_TICK_LIMIT)
+	{
+		printf("every task has been blocked for %lu ticks\n", (unsigned long)HOST_IDLE_TICK_LIMIT);
+		fflush(stdout);
+		abort();
+	}
+	vPortHostTick();
+}
+
+void vApplicationGetIdleTaskMemory( StaticTask_t** ppxIdleTaskTCBBuffer, StackType_t** ppxIdleTaskStackBuffer,
+									uint32_t* pulIdleTaskStackSize )
+{
+	static StaticTask_t idleTcb;
+	static StackType_t idleStack[configMINIMAL_STACK_SIZE];
+
+	*ppxIdleTaskTCBBuffer = &idleTcb;
+	*ppxIdleTaskStackBuffer = idleStack;
+	*pulIdleTaskStackSize = configMINIMAL_STACK_SIZE;
+}
+
+void vApplicationGetTimerTaskMemory( StaticTask_t** ppxTimerTaskTCBBuffer, StackType_t** ppxTimerTaskStackBuffer,
+									 uint32_t* pulTimerTaskStackSize )
+{
+	static StaticTask_t timerTcb;
+	static StackType_t timerStack[configTIMER_TASK_STACK_DEPTH];
+
+	*ppxTimerTaskTCBBuffer = &timerTcb;
+	*ppxTimerTaskStackBuffer = timerStack;
+	*pulTimerTaskStackSize = configTIMER_TASK_STACK_DEPTH;
+}
@@ -0,0 +1,140 @@
+/**
+ * MIT License
+ * 
+ * Copyright (c) 2019 Brian Amos
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#ifndef PORTMACRO_H
+#define PORTMACRO_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+/**
+ * Host (Linux/POSIX) port used by the tests in Test/ - see port.c
+ *
+ * Every task runs on its own ucontext, only one of them at a time, so the
+ * kernel sees a single core with no real interrupts.  Ticks and
+ * "interrupts" happen where the test (or the idle task) asks for them with
+ * vPortHostTick() and vPortHostInterrupt(), which run them the way the
+ * Cortex-M port would: masked, with any context switch they request
+ * deferred until they return.
+ */
+
+#define portCHAR		char
+#define portFLOAT		float
+#define portDOUBLE		double
+#define portLONG		long
+#define portSHORT		short
+#define portSTACK_TYPE	uintptr_t
+#define portBASE_TYPE	long
+
+typedef portSTACK_TYPE StackType_t;
+typedef long BaseType_t;
+typedef unsigned long UBaseType_t;
+
+#if( configUSE_16_BIT_TICKS == 1 )
+	typedef uint16_t TickType_t;
+	#define portMAX_DELAY ( TickType_t ) 0xffff
+#else
+	typedef uint32_t TickType_t;
+	#define portMAX_DELAY ( TickType_t ) 0xffffffffUL
+	#define portTICK_TYPE_IS_ATOMIC 1
+#endif
+
+#define portSTACK_GROWTH			( -1 )
+#define portTICK_PERIOD_MS			( ( TickType_t ) 1000 / configTICK_RATE_HZ )
+#define portBYTE_ALIGNMENT			8
+#define portPOINTER_SIZE_TYPE		uintptr_t
+
+/* scheduler utilities */
+extern void vPortYield( void );
+#define portYIELD()					vPortYield()
+#define portEND_SWITCHING_ISR( xSwitchRequired ) if( xSwitchRequired != pdFALSE ) portYIELD()
+#define portYIELD_FROM_ISR( x )		portEND_SWITCHING_ISR( x )
+
+/* critical sections - there are no real interrupts to mask, only yields to
+hold back until the outermost section is left */
+extern void vPortEnterCritical( void );
+extern void vPortExitCritical( void );
+#define portDISABLE_INTERRUPTS()
+#define portENABLE_INTERRUPTS()
+#define portENTER_CRITICAL()		vPortEnterCritical()
+#define portEXIT_CRITICAL()			vPortExitCritical()
+#define portSET_INTERRUPT_MASK_FROM_ISR()		0
+#define portCLEAR_INTERRUPT_MASK_FROM_ISR( x )	( void ) ( x )
+
+/* each task's host stack and context are released with its TCB */
+extern void vPortHostFreeContext( volatile StackType_t* pxTopOfStack );
+#define portCLEAN_UP_TCB( pxTCB )	vPortHostFreeContext( ( pxTCB )->pxTopOfStack )
+
+#define portTASK_FUNCTION_PROTO( vFunction, pvParameters ) void vFunction( void *pvParameters )
+#define portTASK_FUNCTION( vFunction, pvParameters ) void vFunction( void *pvParameters )
+
+#define portNOP()
+
+/**
+ * Run one tick interrupt: increments the tick count (running the tick hook,
+ * if one is set with vPortHostSetTickHook) and switches to a task it woke
+ */
+void vPortHostTick( void );
+
+/**
+ * Run Isr as an interrupt taken at this point
+ * FromISR calls made by Isr can request a context switch with
+ * portYIELD_FROM_ISR, it happens after Isr returns
+ */
+void vPortHostInterrupt( void (*Isr)( void ) );
+
+/**
+ * Isr is called from every tick interrupt (NULL for none)
+ */
+void vPortHostSetTickHook( void (*Isr)( void ) );
+
+/**
+ * Hook is called whenever a task is about to block on a queue, with the
+ * scheduler suspended and the queue locked - the window where interrupts
+ * using the queue only update its lock counts (NULL for none)
+ */
+void vPortHostSetQueueBlockingHook( void (*Hook)( void* Queue ) );
+
+/**
+ * Hook is called whenever a task sets bits in, or is about to block on, an
+ * event group, with the scheduler suspended and (with
+ * configUSE_EVENT_GROUP_DIRECT_ISR) the event group locked - the window
+ * where interrupts setting bits only leave them pending (NULL for none)
+ */
+void vPortHostSetEventGroupLockedHook( void (*Hook)( void* EventGroup ) );
+
+/**
+ * CPU time used by the test so far, for the benchmarks
+ * (the tick count doesn't move while a task is running)
+ */
+uint64_t ullPortHostCpuTimeNs( void );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PORTMACRO_H */
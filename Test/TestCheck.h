@@ -0,0 +1,53 @@
+/**
+ * MIT License
+ * 
+ * Copyright (c) 2019 Brian Amos
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#ifndef TEST_TESTCHECK_H_
+#define TEST_TESTCHECK_H_
+
+#include <stdint.h>
+#include <stdio.h>
+
+/**
+ * Minimal check macros shared by the host tests in this directory
+ * (see Makefile).  A failed CHECK prints its location and the test keeps
+ * going, TestResult() prints the summary and gives main's return value
+ */
+
+static uint32_t failures = 0;
+
+#define CHECK(cond)	do { if(!(cond)) { failures++; \
+						printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); } } while(0)
+
+static inline int TestResult( void )
+{
+	if(failures)
+	{
+		printf("%lu check(s) failed\n", (unsigned long)failures);
+		return 1;
+	}
+	printf("all checks passed\n");
+	return 0;
+}
+
+#endif /* TEST_TESTCHECK_H_ */
@@ -0,0 +1,237 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2019 Brian Amos
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#include <FreeRTOS.h>
+#include <task.h>
+#include <stdio.h>
+#include <CoExecutor.h>
+#include "TestCheck.h"
+
+/**
+ * Coroutines vs. tasks on the host, the same comparison Chapter_9's
+ * coroutineBenchmark configuration makes on the target
+ * (mainCoroutineBenchmark.c)
+ *
+ * RAM: heap used per parked task (TCB + STACK_SIZE word stack + heap_4
+ * overhead) against sizeof(Coroutine) plus a small context, with
+ * NUM_STATE_MACHINES delay-driven coroutines running on one executor
+ * meanwhile.  The host's StackType_t and pointers are wider than the
+ * target's, so the sizes differ from the target's, the ratio less so (the
+ * host port's own context for each task comes from malloc and isn't
+ * counted).
+ *
+ * Switch cost: host CPU ns per round trip, passing control back and forth
+ * 	- between benchmarkTask and pongTask with task notifications
+ * 	- between pingCoroutine and pongCoroutine on the same executor with
+ * 	  CoNotify/CoNotifyWait
+ * A host context switch is a swapcontext() call, which is a good deal
+ * dearer than PendSV on the target, so the gap is wider here.
+ */
+
+#define STACK_SIZE			128
+#define NUM_RAM_TASKS		8
+#define NUM_STATE_MACHINES	200
+#define ROUND_TRIPS			200000
+
+typedef struct
+{
+	TickType_t period;
+	uint32_t count;
+}BlinkerState;
+
+typedef struct
+{
+	uint32_t roundTrips;
+	uint32_t i;
+}PingState;
+
+static TaskHandle_t benchmarkTaskHandle, pongTaskHandle;
+static CoExecutor pingPongExecutor, blinkerExecutor;
+static Coroutine pingCo, pongCo;
+static PingState pingState;
+static Coroutine blinkers[NUM_STATE_MACHINES];
+static BlinkerState blinkerStates[NUM_STATE_MACHINES];
+
+static void blinkerCoroutine( Coroutine* Co )
+{
+	BlinkerState* state = Co->context;
+	BaseType_t result;
+
+	CO_BEGIN(Co);
+	while(1)
+	{
+		CO_AWAIT(Co, result, CoDelay(Co, state->period));
+		state->count += (result == pdPASS);
+	}
+	CO_END(Co);
+}
+
+/**
+ * bounce roundTrips notifications off pongCoroutine each time
+ * benchmarkTask sends them, then notify it back
+ */
+static void pingCoroutine( Coroutine* Co )
+{
+	PingState* state = Co->context;
+	BaseType_t result;
+
+	CO_BEGIN(Co);
+	while(1)
+	{
+		CO_AWAIT(Co, result, CoNotifyWait(Co, &state->roundTrips, portMAX_DELAY));
+		for(state->i = 0; state->i < state->roundTrips; state->i++)
+		{
+			CoNotify(&pongCo, 1);
+			CO_AWAIT(Co, result, CoNotifyWait(Co, NULL, portMAX_DELAY));
+		}
+		xTaskNotifyGive(benchmarkTaskHandle);
+	}
+	CO_END(Co);
+}
+
+static void pongCoroutine( Coroutine* Co )
+{
+	BaseType_t result;
+
+	CO_BEGIN(Co);
+	while(1)
+	{
+		CO_AWAIT(Co, result, CoNotifyWait(Co, NULL, portMAX_DELAY));
+		if(result == pdPASS)
+		{
+			CoNotify(&pingCo, 1);
+		}
+	}
+	CO_END(Co);
+}
+
+static void pongTask( void* Arg )
+{
+	(void) Arg;
+	while(1)
+	{
+		ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+		xTaskNotifyGive(benchmarkTaskHandle);
+	}
+}
+
+static void parkedTask( void* Arg )
+{
+	(void) Arg;
+	while(1)
+	{
+		ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+	}
+}
+
+/**
+ * @returns heap used per task
+ */
+static size_t taskRam( void )
+{
+	const size_t freeBefore = xPortGetFreeHeapSize();
+
+	for(uint32_t i = 0; i < NUM_RAM_TASKS; i++)
+	{
+		CHECK(xTaskCreate(parkedTask, "parked", STACK_SIZE, NULL, tskIDLE_PRIORITY + 1, NULL) == pdPASS);
+	}
+	return (freeBefore - xPortGetFreeHeapSize()) / NUM_RAM_TASKS;
+}
+
+/**
+ * @returns host CPU ns per task round trip
+ */
+static uint64_t taskRun( void )
+{
+	const uint64_t start = ullPortHostCpuTimeNs();
+
+	for(uint32_t i = 0; i < ROUND_TRIPS; i++)
+	{
+		xTaskNotifyGive(pongTaskHandle);
+		ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+	}
+	return (ullPortHostCpuTimeNs() - start) / ROUND_TRIPS;
+}
+
+/**
+ * @returns host CPU ns per coroutine round trip
+ */
+static uint64_t coroutineRun( void )
+{
+	const uint64_t start = ullPortHostCpuTimeNs();
+
+	CoNotify(&pingCo, ROUND_TRIPS);
+	ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+	return (ullPortHostCpuTimeNs() - start) / ROUND_TRIPS;
+}
+
+static void benchmarkTask( void* Arg )
+{
+	(void) Arg;
+	const size_t bytesPerTask = taskRam();
+
+	//let the blinkers run for a while first
+	vTaskDelay(1000);
+	uint32_t wakeups = 0;
+	for(uint32_t i = 0; i < NUM_STATE_MACHINES; i++)
+	{
+		wakeups += blinkerStates[i].count;
+	}
+	CHECK(wakeups > 0);
+
+	const uint64_t taskNs = taskRun();
+	const uint64_t coroutineNs = coroutineRun();
+
+	printf("  RAM per task (%u word stack): %lu bytes\n", STACK_SIZE, (unsigned long)bytesPerTask);
+	printf("  RAM per coroutine:            %lu bytes (%u state machines, %lu wake ups)\n",
+			(unsigned long)(sizeof(Coroutine) + sizeof(BlinkerState)), NUM_STATE_MACHINES, (unsigned long)wakeups);
+	printf("  task round trip:      %5lu ns\n", (unsigned long)taskNs);
+	printf("  coroutine round trip: %5lu ns\n", (unsigned long)coroutineNs);
+	vTaskEndScheduler();
+}
+
+int main( void )
+{
+	uint32_t seed = 1;
+
+	//the blinkers can't preempt the measurements
+	CoExecutorInit(&blinkerExecutor, "blinkers", configMINIMAL_STACK_SIZE, tskIDLE_PRIORITY + 1);
+	for(uint32_t i = 0; i < NUM_STATE_MACHINES; i++)
+	{
+		seed = seed * 1103515245 + 12345;
+		blinkerStates[i].period = 10 + (seed >> 16) % 91;
+		blinkerStates[i].count = 0;
+		CoStart(&blinkerExecutor, &blinkers[i], blinkerCoroutine, &blinkerStates[i]);
+	}
+
+	//pong runs at a higher priority than benchmarkTask in both cases
+	CoExecutorInit(&pingPongExecutor, "pingPong", configMINIMAL_STACK_SIZE, tskIDLE_PRIORITY + 3);
+	CoStart(&pingPongExecutor, &pingCo, pingCoroutine, &pingState);
+	CoStart(&pingPongExecutor, &pongCo, pongCoroutine, NULL);
+
+	xTaskCreate(benchmarkTask, "benchmark", configMINIMAL_STACK_SIZE, NULL, tskIDLE_PRIORITY + 2, &benchmarkTaskHandle);
+	xTaskCreate(pongTask, "pong", STACK_SIZE, NULL, tskIDLE_PRIORITY + 3, &pongTaskHandle);
+	vTaskStartScheduler();
+	return TestResult();
+}
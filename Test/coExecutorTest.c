@@ -0,0 +1,389 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2019 Brian Amos
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#include <FreeRTOS.h>
+#include <task.h>
+#include <queue.h>
+#include <stream_buffer.h>
+#include <string.h>
+#include <CoExecutor.h>
+#include "TestCheck.h"
+
+/**
+ * Host checks for the stackless coroutine executor (BSP/CoExecutor.c):
+ * 	- delays with different periods each resume on the tick they're due,
+ * 	  and a coroutine that reaches CO_END is never run again
+ * 	- CoQueueReceive, woken by a task's CoExecutorWake, and timing out
+ * 	- CoStreamBufferReceive, woken from an interrupt: the coroutine runs
+ * 	  before the interrupted (lower priority) task continues
+ * 	- CoNotify between coroutines on the executor, from a task and
+ * 	  CoNotifyFromISR, and CoNotifyWait timing out
+ * 	- CO_YIELD taking turns with the other ready coroutines
+ *
+ * Every coroutine is started before the scheduler (CoStart can't be called
+ * from outside the executor afterwards), and waits for the test task to
+ * CoNotify it.
+ */
+
+#define EXECUTOR_PRIORITY	3
+#define NUM_DELAYS			20
+#define DELAY_ROUNDS		50
+#define QUEUE_TIMEOUT		10
+#define NOTIFY_TIMEOUT		7
+#define PING_ROUND_TRIPS	1000
+#define YIELD_ROUNDS		5
+
+typedef struct
+{
+	TickType_t period;
+	TickType_t due;
+	uint32_t wakes;
+	uint32_t late;
+}DelayState;
+
+typedef struct
+{
+	uint32_t item;
+	uint32_t received;
+	uint32_t outOfOrder;
+	uint32_t timeouts;
+	TickType_t waitStart;
+	TickType_t timedOutAfter;
+}QueueState;
+
+typedef struct
+{
+	uint8_t buffer[16];
+	size_t bytes;
+	uint32_t wakes;
+}StreamState;
+
+typedef struct
+{
+	uint32_t i;
+	uint32_t value;
+	uint32_t roundTrips;
+	uint32_t timeouts;
+	TickType_t waitStart;
+	TickType_t timedOutAfter;
+}PingState;
+
+static CoExecutor executor;
+static QueueHandle_t queue;
+static StreamBufferHandle_t stream;
+
+static Coroutine delayCos[NUM_DELAYS];
+static DelayState delayStates[NUM_DELAYS];
+static Coroutine queueCo, streamCo, pingCo, pongCo, yieldCos[2];
+static QueueState queueState;
+static StreamState streamState;
+static PingState pingState;
+static char yieldLog[2 * YIELD_ROUNDS + 1];
+static uint32_t yieldLogLen;
+
+static void delayCoroutine( Coroutine* Co )
+{
+	DelayState* state = Co->context;
+	BaseType_t result;
+
+	CO_BEGIN(Co);
+	CO_AWAIT(Co, result, CoNotifyWait(Co, NULL, portMAX_DELAY));
+	while(state->wakes < DELAY_ROUNDS)
+	{
+		state->due = xTaskGetTickCount() + state->period;
+		CO_AWAIT(Co, result, CoDelay(Co, state->period));
+		CHECK(result == pdPASS);
+		state->late += (xTaskGetTickCount() != state->due);
+		state->wakes++;
+	}
+	CO_END(Co);
+}
+
+static void queueCoroutine( Coroutine* Co )
+{
+	QueueState* state = Co->context;
+	BaseType_t result;
+
+	CO_BEGIN(Co);
+	while(1)
+	{
+		state->waitStart = xTaskGetTickCount();
+		CO_AWAIT(Co, result, CoQueueReceive(Co, queue, &state->item, QUEUE_TIMEOUT));
+		if(result == pdPASS)
+		{
+			state->outOfOrder += (state->item != state->received);
+			state->received++;
+		}
+		else
+		{
+			state->timedOutAfter = xTaskGetTickCount() - state->waitStart;
+			state->timeouts++;
+		}
+	}
+	CO_END(Co);
+}
+
+static void streamCoroutine( Coroutine* Co )
+{
+	StreamState* state = Co->context;
+	BaseType_t result;
+	size_t received;
+
+	CO_BEGIN(Co);
+	while(1)
+	{
+		CO_AWAIT(Co, result, CoStreamBufferReceive(Co, stream, state->buffer + state->bytes,
+													sizeof(state->buffer) - state->bytes, &received, portMAX_DELAY));
+		CHECK(result == pdPASS);
+		state->bytes += received;
+		state->wakes++;
+	}
+	CO_END(Co);
+}
+
+/**
+ * waits to be told how many round trips to make (pdFAIL from an
+ * untimely wait is counted), then bounces notifications off pongCoroutine
+ */
+static void pingCoroutine( Coroutine* Co )
+{
+	PingState* state = Co->context;
+	BaseType_t result;
+
+	CO_BEGIN(Co);
+	while(1)
+	{
+		state->waitStart = xTaskGetTickCount();
+		CO_AWAIT(Co, result, CoNotifyWait(Co, &state->value, NOTIFY_TIMEOUT));
+		if(result != pdPASS)
+		{
+			state->timedOutAfter = xTaskGetTickCount() - state->waitStart;
+			state->timeouts++;
+			continue;
+		}
+
+		for(state->i = 0; state->i < state->value; state->i++)
+		{
+			CoNotify(&pongCo, 1);
+			CO_AWAIT(Co, result, CoNotifyWait(Co, NULL, portMAX_DELAY));
+			CHECK(result == pdPASS);
+			state->roundTrips++;
+		}
+	}
+	CO_END(Co);
+}
+
+static void pongCoroutine( Coroutine* Co )
+{
+	BaseType_t result;
+	uint32_t value;
+
+	CO_BEGIN(Co);
+	while(1)
+	{
+		CO_AWAIT(Co, result, CoNotifyWait(Co, &value, portMAX_DELAY));
+		CHECK(result == pdPASS && value == 1);
+		CoNotify(&pingCo, 1);
+	}
+	CO_END(Co);
+}
+
+static void yieldCoroutine( Coroutine* Co )
+{
+	const char name = *(const char*)Co->context;
+	BaseType_t result;
+	static uint32_t i[2];
+	uint32_t* count = &i[name - 'a'];
+
+	CO_BEGIN(Co);
+	CO_AWAIT(Co, result, CoNotifyWait(Co, NULL, portMAX_DELAY));
+	for(*count = 0; *count < YIELD_ROUNDS; (*count)++)
+	{
+		yieldLog[yieldLogLen++] = name;
+		CO_YIELD(Co);
+	}
+	CO_END(Co);
+}
+
+static void testDelays( void )
+{
+	for(uint32_t i = 0; i < NUM_DELAYS; i++)
+	{
+		CoNotify(&delayCos[i], 1);
+	}
+	vTaskDelay(DELAY_ROUNDS * (NUM_DELAYS + 1) + 1);
+	for(uint32_t i = 0; i < NUM_DELAYS; i++)
+	{
+		CHECK(delayStates[i].wakes == DELAY_ROUNDS);
+		CHECK(delayStates[i].late == 0);
+		CHECK(delayCos[i].resumePoint == CO_FINISHED);
+	}
+
+	//a finished coroutine isn't run again, whatever it's sent
+	CoNotify(&delayCos[0], 1);
+	vTaskDelay(1);
+	CHECK(listLIST_ITEM_CONTAINER(&delayCos[0].listItem) == NULL);
+	CHECK(delayStates[0].wakes == DELAY_ROUNDS);
+}
+
+static void testQueue( void )
+{
+	uint32_t item;
+
+	//sent from a task: the executor runs as soon as it's woken, as long as
+	//the coroutine is waiting there's one item to take at a time
+	for(item = 0; item < 100; item++)
+	{
+		CHECK(xQueueSend(queue, &item, 0) == pdPASS);
+		CoExecutorWake(&executor);
+		CHECK(queueState.received == item + 1);
+	}
+
+	//several at once are all taken by the one wake
+	for(uint32_t i = 0; i < 3; i++, item++)
+	{
+		CHECK(xQueueSend(queue, &item, 0) == pdPASS);
+	}
+	CoExecutorWake(&executor);
+	CHECK(queueState.received == item);
+	CHECK(queueState.outOfOrder == 0);
+
+	//without the wake the item waits for the next timeout check, when the
+	//coroutine finds it rather than timing out
+	const uint32_t timeouts = queueState.timeouts;
+	CHECK(xQueueSend(queue, &item, 0) == pdPASS);
+	item++;
+	vTaskDelay(QUEUE_TIMEOUT + 1);
+	CHECK(queueState.received == item);
+	CHECK(queueState.timeouts == timeouts);
+
+	//nothing at all times out on time, again and again
+	vTaskDelay(5 * QUEUE_TIMEOUT);
+	CHECK(queueState.timeouts >= timeouts + 4);
+	CHECK(queueState.timedOutAfter == QUEUE_TIMEOUT);
+	CHECK(queueState.outOfOrder == 0);
+}
+
+static uint32_t isrBytes;
+
+static void streamIsr( void )
+{
+	static const uint8_t data[] = "0123456789";
+	BaseType_t woken = pdFALSE;
+
+	CHECK(xStreamBufferSendFromISR(stream, data, isrBytes, &woken) == isrBytes);
+	CoExecutorWakeFromISR(&executor, &woken);
+	CHECK(woken == pdTRUE);
+	portYIELD_FROM_ISR(woken);
+}
+
+static void testStream( void )
+{
+	isrBytes = 4;
+	vPortHostInterrupt(streamIsr);
+	CHECK(streamState.wakes == 1 && streamState.bytes == 4);
+	isrBytes = 10;
+	vPortHostInterrupt(streamIsr);
+	CHECK(streamState.wakes == 2 && streamState.bytes == 14);
+	CHECK(memcmp(streamState.buffer, "01230123456789", 14) == 0);
+}
+
+static void pingIsr( void )
+{
+	BaseType_t woken = pdFALSE;
+
+	CoNotifyFromISR(&pingCo, PING_ROUND_TRIPS, &woken);
+	portYIELD_FROM_ISR(woken);
+}
+
+static void testNotify( void )
+{
+	//ping has been timing out all along
+	CHECK(pingState.timeouts > 0);
+	CHECK(pingState.timedOutAfter == NOTIFY_TIMEOUT);
+
+	//from a task: the whole exchange between the two coroutines runs
+	//before CoNotify returns here
+	CoNotify(&pingCo, PING_ROUND_TRIPS);
+	CHECK(pingState.roundTrips == PING_ROUND_TRIPS);
+
+	//and from an interrupt
+	vPortHostInterrupt(pingIsr);
+	CHECK(pingState.roundTrips == 2 * PING_ROUND_TRIPS);
+
+	//notifications sent before ping runs are combined in the value it gets
+	vTaskSuspendAll();
+	CoNotify(&pingCo, 1);
+	CoNotify(&pingCo, 2);
+	(void) xTaskResumeAll();
+	CHECK(pingState.roundTrips == 2 * PING_ROUND_TRIPS + 3);
+	CHECK(pingState.value == 3);
+}
+
+static void testYield( void )
+{
+	//both are woken before the executor runs, then take turns
+	vTaskSuspendAll();
+	CoNotify(&yieldCos[0], 1);
+	CoNotify(&yieldCos[1], 1);
+	(void) xTaskResumeAll();
+	yieldLog[yieldLogLen] = '\0';
+	CHECK(strcmp(yieldLog, "ababababab") == 0);
+}
+
+static void testTask( void* Arg )
+{
+	(void) Arg;
+	testDelays();
+	testQueue();
+	testStream();
+	testNotify();
+	testYield();
+	vTaskEndScheduler();
+}
+
+int main( void )
+{
+	static const char yieldNames[2] = {'a', 'b'};
+
+	queue = xQueueCreate(8, sizeof(uint32_t));
+	stream = xStreamBufferCreate(32, 1);
+
+	CoExecutorInit(&executor, "executor", configMINIMAL_STACK_SIZE, EXECUTOR_PRIORITY);
+	for(uint32_t i = 0; i < NUM_DELAYS; i++)
+	{
+		delayStates[i].period = 1 + i;
+		CoStart(&executor, &delayCos[i], delayCoroutine, &delayStates[i]);
+	}
+	CoStart(&executor, &queueCo, queueCoroutine, &queueState);
+	CoStart(&executor, &streamCo, streamCoroutine, &streamState);
+	CoStart(&executor, &pingCo, pingCoroutine, &pingState);
+	CoStart(&executor, &pongCo, pongCoroutine, NULL);
+	CoStart(&executor, &yieldCos[0], yieldCoroutine, (void*)&yieldNames[0]);
+	CoStart(&executor, &yieldCos[1], yieldCoroutine, (void*)&yieldNames[1]);
+
+	xTaskCreate(testTask, "test", configMINIMAL_STACK_SIZE, NULL, EXECUTOR_PRIORITY - 1, NULL);
+	vTaskStartScheduler();
+	return TestResult();
+}
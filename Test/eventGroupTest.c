@@ -0,0 +1,371 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2019 Brian Amos
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#include <FreeRTOS.h>
+#include <task.h>
+#include <event_groups.h>
+#include "TestCheck.h"
+
+/**
+ * Host checks for setting event group bits directly from interrupts
+ * (configUSE_EVENT_GROUP_DIRECT_ISR in event_groups.c):
+ * 	- an unlocked event group: the interrupt sets the bits, wakes the
+ * 	  waiting tasks it satisfies (clearing bits on exit) and asks for a
+ * 	  context switch itself, without the timer task
+ * 	- a locked event group: the bits are only left pending, and the task
+ * 	  that unlocks the group sets them before it resumes the scheduler -
+ * 	  while it blocks waiting or syncing, and while it sets bits itself
+ * 	- clearing bits from an interrupt also clears pending bits
+ * 	- a random mix of task calls and interrupts (from ticks and from the
+ * 	  locked windows), where no wake-up is lost
+ */
+
+#define NUM_WAITERS		3
+
+static EventGroupHandle_t group;
+
+static TaskHandle_t waiters[NUM_WAITERS];
+static volatile uint32_t waiterWakes[NUM_WAITERS];
+static volatile EventBits_t waiterBits[NUM_WAITERS];
+
+//what the interrupt run from the locked window does
+static EventBits_t lockedIsrSet, lockedIsrClear;
+static uint32_t lockedIsrRuns;
+
+static uint32_t waitersReady( void )
+{
+	uint32_t ready = 0;
+
+	for(uint32_t i = 0; i < NUM_WAITERS; i++)
+	{
+		ready += (eTaskGetState(waiters[i]) == eReady);
+	}
+	return ready;
+}
+
+/**
+ * waiter i waits for bit i (any of bits 4-5 for the last one, both of
+ * them for the others), clearing them on exit
+ */
+static void waiterTask( void* Arg )
+{
+	const uintptr_t id = (uintptr_t)Arg;
+
+	for(;;)
+	{
+		if(id == NUM_WAITERS - 1)
+		{
+			waiterBits[id] = xEventGroupWaitBits(group, 0x30, pdTRUE, pdFALSE, portMAX_DELAY);
+		}
+		else
+		{
+			waiterBits[id] = xEventGroupWaitBits(group, (1 << id) | 0x30, pdTRUE, pdTRUE, portMAX_DELAY);
+		}
+		waiterWakes[id]++;
+	}
+}
+
+/**
+ * start the waiters above this task's priority, they block straight away
+ */
+static void startWaiters( void )
+{
+	for(uintptr_t i = 0; i < NUM_WAITERS; i++)
+	{
+		waiterWakes[i] = waiterBits[i] = 0;
+		CHECK(xTaskCreate(waiterTask, "waiter", configMINIMAL_STACK_SIZE, (void*)i,
+							uxTaskPriorityGet(NULL) + 1, &waiters[i]) == pdPASS);
+	}
+}
+
+static void stopWaiters( void )
+{
+	for(uint32_t i = 0; i < NUM_WAITERS; i++)
+	{
+		vTaskDelete(waiters[i]);
+	}
+	xEventGroupClearBits(group, 0xFFFF);
+}
+
+static EventBits_t isrBits;
+static EventBits_t isrReturn;
+static BaseType_t isrWoken;
+
+static void setIsr( void )
+{
+	isrWoken = pdFALSE;
+	isrReturn = xEventGroupSetBitsDirectFromISR(group, isrBits, &isrWoken);
+	portYIELD_FROM_ISR(isrWoken);
+}
+
+static void clearIsr( void )
+{
+	isrReturn = xEventGroupClearBitsDirectFromISR(group, isrBits);
+}
+
+static void testUnlocked( void )
+{
+	startWaiters();
+	CHECK(waitersReady() == 0);
+
+	//a bit that completes nobody's wait is just set
+	isrBits = 0x01;
+	vPortHostInterrupt(setIsr);
+	CHECK(isrWoken == pdFALSE);
+	CHECK(isrReturn == 0x01);
+	CHECK(xEventGroupGetBits(group) == 0x01);
+
+	//bits 4-5 complete waiter 0's wait-all and the last waiter's wait-any,
+	//and the interrupt switches to them before it returns here
+	isrBits = 0x30;
+	vPortHostInterrupt(setIsr);
+	CHECK(isrWoken == pdTRUE);
+	CHECK(waiterWakes[0] == 1 && waiterWakes[1] == 0 && waiterWakes[2] == 1);
+	CHECK(waiterBits[0] == 0x31 && waiterBits[2] == 0x31);
+
+	//both cleared the bits they waited for on exit
+	CHECK(xEventGroupGetBits(group) == 0);
+
+	//a direct clear returns the bits from before it
+	isrBits = 0x06;
+	vPortHostInterrupt(setIsr);
+	CHECK(isrWoken == pdFALSE);
+	isrBits = 0x04;
+	vPortHostInterrupt(clearIsr);
+	CHECK(isrReturn == 0x06);
+	CHECK(xEventGroupGetBits(group) == 0x02);
+
+	//a NULL pxHigherPriorityTaskWoken is fine, the woken tasks run at the
+	//next switch
+	CHECK(xEventGroupSetBitsDirectFromISR(group, 0x30, NULL) == 0);
+	CHECK(waitersReady() == 2);
+	taskYIELD();
+	CHECK(waiterWakes[1] == 1 && waiterWakes[2] == 2);
+	CHECK(waiterBits[1] == 0x32);
+	stopWaiters();
+}
+
+static void lockedIsr( void )
+{
+	BaseType_t woken = pdFALSE;
+
+	//the event group is locked: the bits are pending, not set, and nothing
+	//is woken yet
+	EventBits_t before = xEventGroupGetBitsFromISR(group);
+	if(lockedIsrSet)
+	{
+		CHECK(xEventGroupSetBitsDirectFromISR(group, lockedIsrSet, &woken) == (before | lockedIsrSet));
+		CHECK(xEventGroupGetBitsFromISR(group) == before);
+		CHECK(woken == pdFALSE);
+	}
+	if(lockedIsrClear)
+	{
+		(void) xEventGroupClearBitsDirectFromISR(group, lockedIsrClear);
+	}
+}
+
+static void eventGroupLocked( void* EventGroup )
+{
+	if(EventGroup == group && lockedIsrRuns > 0)
+	{
+		lockedIsrRuns--;
+		vPortHostInterrupt(lockedIsr);
+	}
+}
+
+static void testLocked( void )
+{
+	vPortHostSetEventGroupLockedHook(eventGroupLocked);
+
+	//bits set while this task is blocking on them are set by the unlock,
+	//so it doesn't block at all
+	lockedIsrSet = 0x01;
+	lockedIsrClear = 0;
+	lockedIsrRuns = 1;
+	TickType_t start = xTaskGetTickCount();
+	CHECK(xEventGroupWaitBits(group, 0x01, pdTRUE, pdFALSE, 10) == 0x01);
+	CHECK(xTaskGetTickCount() == start);
+	CHECK(lockedIsrRuns == 0);
+	CHECK(xEventGroupGetBits(group) == 0);
+
+	//bits set, then cleared, while locked are never set
+	lockedIsrSet = 0x02;
+	lockedIsrClear = 0x02;
+	lockedIsrRuns = 1;
+	start = xTaskGetTickCount();
+	CHECK(xEventGroupWaitBits(group, 0x02, pdTRUE, pdFALSE, 10) == 0);
+	CHECK(xTaskGetTickCount() - start >= 10);
+	CHECK(xEventGroupGetBits(group) == 0);
+
+	//bits set while this task sets bits of its own wake the tasks waiting
+	//for the both of them
+	startWaiters();
+	lockedIsrSet = 0x30;
+	lockedIsrClear = 0;
+	lockedIsrRuns = 1;
+	CHECK(xEventGroupSetBits(group, 0x01) == 0);
+	CHECK(waiterWakes[0] == 1 && waiterWakes[1] == 0 && waiterWakes[2] == 1);
+	CHECK(waiterBits[0] == 0x31 && waiterBits[2] == 0x31);
+
+	//a sync sets its bits with the event group locked twice over: the bits
+	//an interrupt sets meanwhile are only set by the outer unlock, once
+	//this task is waiting for them, and complete the rendezvous
+	lockedIsrSet = 0x08;
+	lockedIsrRuns = 1;
+	start = xTaskGetTickCount();
+	CHECK((xEventGroupSync(group, 0x04, 0x04 | 0x08, 10) & 0x0C) == 0x0C);
+	CHECK(xTaskGetTickCount() == start);
+	CHECK(lockedIsrRuns == 0);
+	CHECK(xEventGroupGetBits(group) == 0);
+
+	//the same, setting bits another waiter still needs
+	lockedIsrSet = 0x30;
+	lockedIsrRuns = 1;
+	CHECK(xEventGroupSetBits(group, 0x02) == 0);
+	CHECK(waiterWakes[1] == 1 && waiterWakes[2] == 2);
+	CHECK(waiterBits[1] == 0x32);
+	stopWaiters();
+
+	vPortHostSetEventGroupLockedHook(NULL);
+}
+
+static uint32_t seed = 11;
+static TaskHandle_t randomWaiters[NUM_WAITERS];
+static volatile uint32_t randomSets[NUM_WAITERS], randomWakes[NUM_WAITERS];
+
+//bits an interrupt has set whose waiter hasn't woken yet
+static volatile EventBits_t issued;
+
+static uint32_t random( void )
+{
+	seed = seed * 1103515245 + 12345;
+	return seed >> 16;
+}
+
+/**
+ * for the random mix: waiter i waits for bit i alone, clearing it on exit
+ */
+static void randomWaiterTask( void* Arg )
+{
+	const uintptr_t id = (uintptr_t)Arg;
+
+	for(;;)
+	{
+		CHECK(xEventGroupWaitBits(group, 1 << id, pdTRUE, pdFALSE, portMAX_DELAY) & (1 << id));
+		randomWakes[id]++;
+		taskENTER_CRITICAL();
+		issued &= ~(1 << id);
+		taskEXIT_CRITICAL();
+	}
+}
+
+/**
+ * set one waiter's bit, unless it still has one it hasn't woken for -
+ * so every set should give exactly one wake-up
+ */
+static void randomIsr( void )
+{
+	uint32_t id = random() % NUM_WAITERS;
+
+	if((issued & (1 << id)) == 0)
+	{
+		issued |= 1 << id;
+		randomSets[id]++;
+		(void) xEventGroupSetBitsDirectFromISR(group, 1 << id, NULL);
+	}
+	else if(random() & 1)
+	{
+		(void) xEventGroupClearBitsDirectFromISR(group, 0x40);
+	}
+}
+
+static void randomLocked( void* EventGroup )
+{
+	if(EventGroup == group && (random() & 1))
+	{
+		vPortHostInterrupt(randomIsr);
+	}
+}
+
+static void testRandom( void )
+{
+	for(uintptr_t i = 0; i < NUM_WAITERS; i++)
+	{
+		CHECK(xTaskCreate(randomWaiterTask, "waiter", configMINIMAL_STACK_SIZE, (void*)i,
+							uxTaskPriorityGet(NULL) + 1, &randomWaiters[i]) == pdPASS);
+	}
+	vPortHostSetTickHook(randomIsr);
+	vPortHostSetEventGroupLockedHook(randomLocked);
+
+	//interrupts from ticks and from the locked windows of this task's calls
+	for(uint32_t round = 0; round < 20000; round++)
+	{
+		switch(random() % 4)
+		{
+			case 0:
+				(void) xEventGroupSetBits(group, 0x40);
+				break;
+			case 1:
+				(void) xEventGroupWaitBits(group, 0x40, pdTRUE, pdFALSE, random() % 2);
+				break;
+			case 2:
+				vTaskDelay(random() % 3);
+				break;
+			default:
+				(void) xEventGroupSync(group, 0x80, 0x80, 0);
+				break;
+		}
+
+		//the waiters run before this task whenever their bit is set
+		CHECK((xEventGroupGetBits(group) & 0x07) == 0);
+	}
+
+	vPortHostSetTickHook(NULL);
+	vPortHostSetEventGroupLockedHook(NULL);
+	vTaskDelay(1);
+	CHECK(issued == 0);
+	for(uint32_t i = 0; i < NUM_WAITERS; i++)
+	{
+		CHECK(randomSets[i] > 1000);
+		CHECK(randomWakes[i] == randomSets[i]);
+		vTaskDelete(randomWaiters[i]);
+	}
+}
+
+static void testTask( void* Arg )
+{
+	(void) Arg;
+	testUnlocked();
+	testLocked();
+	testRandom();
+	vTaskEndScheduler();
+}
+
+int main( void )
+{
+	group = xEventGroupCreate();
+	xTaskCreate(testTask, "test", configMINIMAL_STACK_SIZE, NULL, 2, NULL);
+	vTaskStartScheduler();
+	return TestResult();
+}
@@ -0,0 +1,158 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2019 Brian Amos
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#include <LatencyHistogram.h>
+#include "TestCheck.h"
+#include <stdlib.h>
+
+/**
+ * Host regression checks for LatencyHistogram (BSP/LatencyHistogram.c):
+ * reset state, bin placement, overflow, min/max and percentiles against
+ * a sorted copy of the same samples
+ */
+
+#define NUM_SAMPLES 20000
+
+static LatencyHistogram hist;
+static uint32_t samples[NUM_SAMPLES];
+
+static int compareU32( const void* A, const void* B )
+{
+	const uint32_t a = *(const uint32_t*)A, b = *(const uint32_t*)B;
+	return (a > b) - (a < b);
+}
+
+static void testReset( void )
+{
+	LatencyHistogramReset(&hist, 3);
+	CHECK(hist.binShift == 3);
+	CHECK(hist.count == 0 && hist.overflow == 0 && hist.max == 0);
+	CHECK(hist.min == UINT32_MAX);
+	CHECK(LatencyHistogramPercentile(&hist, 500) == 0);
+
+	//a reset clears everything recorded before it
+	LatencyHistogramAdd(&hist, 17);
+	LatencyHistogramAdd(&hist, 1 << 20);
+	LatencyHistogramReset(&hist, 0);
+	CHECK(hist.count == 0 && hist.overflow == 0 && hist.max == 0);
+	for(uint32_t i = 0; i < LATENCY_HISTOGRAM_BINS; i++)
+	{
+		CHECK(hist.bins[i] == 0);
+	}
+}
+
+static void testBins( void )
+{
+	LatencyHistogramReset(&hist, 2);				//4 counts per bin
+	LatencyHistogramAdd(&hist, 0);
+	LatencyHistogramAdd(&hist, 3);
+	LatencyHistogramAdd(&hist, 4);
+	LatencyHistogramAdd(&hist, (LATENCY_HISTOGRAM_BINS << 2) - 1);	//last bin
+	LatencyHistogramAdd(&hist, LATENCY_HISTOGRAM_BINS << 2);		//first past it
+	LatencyHistogramAdd(&hist, UINT32_MAX);
+	CHECK(hist.bins[0] == 2);
+	CHECK(hist.bins[1] == 1);
+	CHECK(hist.bins[LATENCY_HISTOGRAM_BINS - 1] == 1);
+	CHECK(hist.overflow == 2);
+	CHECK(hist.count == 6);
+	CHECK(hist.min == 0);
+	CHECK(hist.max == UINT32_MAX);
+
+	//percentiles landing in the overflow report the exact maximum
+	CHECK(LatencyHistogramPercentile(&hist, 1000) == UINT32_MAX);
+	CHECK(LatencyHistogramPercentile(&hist, 500) == 7);
+}
+
+static void testSingleValue( void )
+{
+	//the bin's upper bound is limited to the largest value seen
+	LatencyHistogramReset(&hist, 4);
+	for(uint32_t i = 0; i < 100; i++)
+	{
+		LatencyHistogramAdd(&hist, 33);
+	}
+	CHECK(hist.min == 33 && hist.max == 33);
+	CHECK(LatencyHistogramPercentile(&hist, 1) == 33);
+	CHECK(LatencyHistogramPercentile(&hist, 999) == 33);
+	CHECK(LatencyHistogramPercentile(&hist, 1000) == 33);
+}
+
+/**
+ * every percentile is the upper bound of the bin holding the sample at that
+ * rank, so it's never below the true value and less than a bin width above
+ */
+static void testPercentiles( uint32_t BinShift, uint32_t Range )
+{
+	static const uint32_t perMille[] = {1, 100, 500, 900, 990, 999, 1000};
+	const uint32_t width = 1 << BinShift;
+
+	srand(BinShift * 7919 + Range);
+	LatencyHistogramReset(&hist, BinShift);
+	for(uint32_t i = 0; i < NUM_SAMPLES; i++)
+	{
+		//mostly short latencies with a long tail, like the real thing
+		uint32_t value = (uint32_t)rand() % (Range / 8);
+		if(rand() % 50 == 0)
+		{
+			value = (uint32_t)rand() % Range;
+		}
+		samples[i] = value;
+		LatencyHistogramAdd(&hist, value);
+	}
+	qsort(samples, NUM_SAMPLES, sizeof(samples[0]), compareU32);
+	CHECK(hist.count == NUM_SAMPLES);
+	CHECK(hist.min == samples[0]);
+	CHECK(hist.max == samples[NUM_SAMPLES - 1]);
+
+	for(uint32_t i = 0; i < sizeof(perMille)/sizeof(perMille[0]); i++)
+	{
+		const uint32_t rank = (uint32_t)(((uint64_t)NUM_SAMPLES * perMille[i] + 999) / 1000);
+		const uint32_t exact = samples[rank - 1];
+		const uint32_t reported = LatencyHistogramPercentile(&hist, perMille[i]);
+
+		if(exact >> BinShift < LATENCY_HISTOGRAM_BINS)
+		{
+			CHECK(reported >= exact);
+			CHECK(reported - exact < width);
+		}
+		else
+		{
+			CHECK(reported == hist.max);
+		}
+	}
+	CHECK(LatencyHistogramPercentile(&hist, 1000) == hist.max);
+}
+
+int main( void )
+{
+	testReset();
+	testBins();
+	testSingleValue();
+	testPercentiles(0, 800);			//everything in range, exact percentiles
+	testPercentiles(0, 5000);			//tail in the overflow
+	testPercentiles(3, 8000);
+	testPercentiles(12, 1u << 24);
+
+	return TestResult();
+}
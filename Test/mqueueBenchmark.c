@@ -0,0 +1,114 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2019 Brian Amos
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#include <FreeRTOS_POSIX.h>
+#include <FreeRTOS_POSIX/fcntl.h>
+#include <FreeRTOS_POSIX/mqueue.h>
+#include "TestCheck.h"
+#include <string.h>
+
+/**
+ * Cost of the FreeRTOS+POSIX message queue storage options, built once with
+ * preallocated slots (mqueueBenchmark) and once with the per message
+ * allocations every queue used before (mqueueBenchmarkMalloc) - see Makefile
+ *
+ * Prints the heap taken by mq_open, the extra heap a full queue holds and
+ * the host CPU time per mq_send/mq_receive pair, for a queue kept nearly
+ * empty and one kept nearly full
+ */
+
+#define MAX_MSGS	10
+#define MSG_SIZE	32
+#define NUM_PAIRS	1000000UL
+
+static struct mq_attr attr = { .mq_maxmsg = MAX_MSGS, .mq_msgsize = MSG_SIZE };
+
+static uint64_t timePairs( mqd_t Mq, uint32_t Backlog )
+{
+	char msg[MSG_SIZE] = "benchmark";
+	char rx[MSG_SIZE];
+
+	for(uint32_t i = 0; i < Backlog; i++)
+	{
+		CHECK(mq_send(Mq, msg, MSG_SIZE, 0) == 0);
+	}
+
+	uint64_t start = ullPortHostCpuTimeNs();
+	for(uint32_t i = 0; i < NUM_PAIRS; i++)
+	{
+		msg[0] = (char)i;
+		if(mq_send(Mq, msg, MSG_SIZE, 0) != 0 ||
+			mq_receive(Mq, rx, sizeof(rx), NULL) != MSG_SIZE)
+		{
+			CHECK(0);
+			break;
+		}
+	}
+	uint64_t elapsed = ullPortHostCpuTimeNs() - start;
+
+	for(uint32_t i = 0; i < Backlog; i++)
+	{
+		CHECK(mq_receive(Mq, rx, sizeof(rx), NULL) == MSG_SIZE);
+	}
+	return elapsed / NUM_PAIRS;
+}
+
+static void benchmarkTask( void* Arg )
+{
+	char msg[MSG_SIZE] = "benchmark";
+
+	(void) Arg;
+	size_t freeBefore = xPortGetFreeHeapSize();
+	mqd_t mq = mq_open("/benchmark", O_CREAT | O_RDWR, 0, &attr);
+	CHECK(mq != (mqd_t)-1);
+	size_t freeOpen = xPortGetFreeHeapSize();
+
+	for(int i = 0; i < MAX_MSGS; i++)
+	{
+		CHECK(mq_send(mq, msg, MSG_SIZE, 0) == 0);
+	}
+	size_t freeFull = xPortGetFreeHeapSize();
+	for(int i = 0; i < MAX_MSGS; i++)
+	{
+		CHECK(mq_receive(mq, msg, sizeof(msg), NULL) == MSG_SIZE);
+	}
+
+	printf("  %d x %d byte queue: mq_open %lu bytes of heap, full queue %lu more\n",
+			MAX_MSGS, MSG_SIZE, (unsigned long)(freeBefore - freeOpen),
+			(unsigned long)(freeOpen - freeFull));
+	printf("  send + receive, empty queue: %lu ns\n", (unsigned long)timePairs(mq, 0));
+	printf("  send + receive, %d queued:    %lu ns\n", MAX_MSGS - 1,
+			(unsigned long)timePairs(mq, MAX_MSGS - 1));
+
+	CHECK(mq_close(mq) == 0);
+	CHECK(mq_unlink("/benchmark") == 0);
+	vTaskEndScheduler();
+}
+
+int main( void )
+{
+	xTaskCreate(benchmarkTask, "benchmark", configMINIMAL_STACK_SIZE, NULL, 2, NULL);
+	vTaskStartScheduler();
+	return TestResult();
+}
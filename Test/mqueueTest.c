@@ -0,0 +1,378 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2019 Brian Amos
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#include <FreeRTOS_POSIX.h>
+#include <FreeRTOS_POSIX/errno.h>
+#include <FreeRTOS_POSIX/fcntl.h>
+#include <FreeRTOS_POSIX/mqueue.h>
+#include <FreeRTOS_POSIX/time.h>
+#include "TestCheck.h"
+#include <string.h>
+
+/**
+ * Host checks for the FreeRTOS+POSIX message queues
+ * (FreeRTOS_POSIX_mqueue.c), built once per storage option - see Makefile:
+ * open/close/unlink, message contents and lengths, the errno values for
+ * each failure, blocking and timeouts, that the preallocated queues
+ * don't touch the heap after mq_open, and msg_prio order when
+ * posixconfigMQ_PRIORITY is 1
+ */
+
+#define MAX_MSGS	4
+#define MSG_SIZE	16
+
+static struct mq_attr attr = { .mq_maxmsg = MAX_MSGS, .mq_msgsize = MSG_SIZE };
+
+static mqd_t openQueue( const char* Name, int Flags )
+{
+	mqd_t mq = mq_open(Name, O_CREAT | O_RDWR | Flags, 0, &attr);
+
+	CHECK(mq != (mqd_t)-1);
+	return mq;
+}
+
+static void closeQueue( mqd_t Mq, const char* Name )
+{
+	CHECK(mq_close(Mq) == 0);
+	CHECK(mq_unlink(Name) == 0);
+}
+
+static void testOpen( void )
+{
+	struct mq_attr badAttr = { .mq_maxmsg = 0, .mq_msgsize = MSG_SIZE };
+
+	errno = 0;
+	CHECK(mq_open("noSlash", O_CREAT | O_RDWR, 0, &attr) == (mqd_t)-1);
+	CHECK(errno == EINVAL);
+	errno = 0;
+	CHECK(mq_open("/missing", O_RDWR, 0, NULL) == (mqd_t)-1);
+	CHECK(errno == ENOENT);
+	errno = 0;
+	CHECK(mq_open("/bad", O_CREAT | O_RDWR, 0, &badAttr) == (mqd_t)-1);
+	CHECK(errno == EINVAL);
+
+	mqd_t mq = openQueue("/open", 0);
+	errno = 0;
+	CHECK(mq_open("/open", O_CREAT | O_EXCL | O_RDWR, 0, &attr) == (mqd_t)-1);
+	CHECK(errno == EEXIST);
+
+	//a second open refers to the same queue
+	mqd_t again = mq_open("/open", O_RDWR, 0, NULL);
+	CHECK(again == mq);
+	CHECK(mq_close(again) == 0);
+
+	//unlinked with a descriptor still open: no new opens, the queue works
+	CHECK(mq_unlink("/open") == 0);
+	errno = 0;
+	CHECK(mq_open("/open", O_RDWR, 0, NULL) == (mqd_t)-1);
+	CHECK(errno == EINVAL);
+	CHECK(mq_send(mq, "x", 1, 0) == 0);
+	CHECK(mq_close(mq) == 0);
+
+	errno = 0;
+	CHECK(mq_unlink("/open") == -1);
+	CHECK(errno == ENOENT);
+
+	errno = 0;
+	CHECK(mq_send((mqd_t)-1, "x", 1, 0) == -1);
+	CHECK(errno == EBADF);
+}
+
+static void testSendReceive( void )
+{
+	mqd_t mq = openQueue("/data", 0);
+	char msg[MSG_SIZE];
+	struct mq_attr current;
+
+	//lengths from 1 to mq_msgsize, received in the order they were sent
+	for(int round = 0; round < 3; round++)
+	{
+		for(int i = 0; i < MAX_MSGS; i++)
+		{
+			size_t len = 1 + (size_t)(round * MAX_MSGS + i) % MSG_SIZE;
+			memset(msg, 'a' + i, sizeof(msg));
+			CHECK(mq_send(mq, msg, len, 0) == 0);
+		}
+
+		CHECK(mq_getattr(mq, &current) == 0);
+		CHECK(current.mq_curmsgs == MAX_MSGS);
+		CHECK(current.mq_maxmsg == MAX_MSGS && current.mq_msgsize == MSG_SIZE);
+
+		for(int i = 0; i < MAX_MSGS; i++)
+		{
+			size_t len = 1 + (size_t)(round * MAX_MSGS + i) % MSG_SIZE;
+			memset(msg, 0, sizeof(msg));
+			CHECK(mq_receive(mq, msg, sizeof(msg), NULL) == (ssize_t)len);
+			for(size_t j = 0; j < len; j++)
+			{
+				CHECK(msg[j] == 'a' + i);
+			}
+		}
+		CHECK(mq_getattr(mq, &current) == 0);
+		CHECK(current.mq_curmsgs == 0);
+	}
+
+	//too long to send, too short a buffer to receive into
+	errno = 0;
+	CHECK(mq_send(mq, msg, MSG_SIZE + 1, 0) == -1);
+	CHECK(errno == EMSGSIZE);
+	CHECK(mq_send(mq, "kept", 4, 0) == 0);
+	errno = 0;
+	CHECK(mq_receive(mq, msg, MSG_SIZE - 1, NULL) == -1);
+	CHECK(errno == EMSGSIZE);
+	CHECK(mq_receive(mq, msg, sizeof(msg), NULL) == 4);
+	CHECK(memcmp(msg, "kept", 4) == 0);
+
+#if( posixconfigMQ_PREALLOCATE == 1 )
+	//pvPortMalloc(0) fails, so only the slots can carry empty messages
+	CHECK(mq_send(mq, msg, 0, 0) == 0);
+	CHECK(mq_receive(mq, msg, sizeof(msg), NULL) == 0);
+#endif
+
+	closeQueue(mq, "/data");
+}
+
+static void testFull( void )
+{
+	mqd_t mq = openQueue("/nonblock", O_NONBLOCK);
+	char msg[MSG_SIZE] = "full";
+
+	for(int i = 0; i < MAX_MSGS; i++)
+	{
+		CHECK(mq_send(mq, msg, 4, 0) == 0);
+	}
+	errno = 0;
+	CHECK(mq_send(mq, msg, 4, 0) == -1);
+	CHECK(errno == EAGAIN);
+
+	for(int i = 0; i < MAX_MSGS; i++)
+	{
+		CHECK(mq_receive(mq, msg, sizeof(msg), NULL) == 4);
+	}
+	errno = 0;
+	CHECK(mq_receive(mq, msg, sizeof(msg), NULL) == -1);
+	CHECK(errno == EAGAIN);
+	closeQueue(mq, "/nonblock");
+
+	//blocking queue: the timed calls give up at abstime
+	mq = openQueue("/timed", 0);
+	struct timespec timeout;
+	for(int i = 0; i < MAX_MSGS; i++)
+	{
+		CHECK(mq_send(mq, msg, 4, 0) == 0);
+	}
+	TickType_t start = xTaskGetTickCount();
+	CHECK(clock_gettime(CLOCK_REALTIME, &timeout) == 0);
+	timeout.tv_nsec += 20 * 1000 * 1000;
+	if(timeout.tv_nsec >= 1000 * 1000 * 1000)
+	{
+		timeout.tv_sec++;
+		timeout.tv_nsec -= 1000 * 1000 * 1000;
+	}
+	errno = 0;
+	CHECK(mq_timedsend(mq, msg, 4, 0, &timeout) == -1);
+	CHECK(errno == ETIMEDOUT);
+	CHECK(xTaskGetTickCount() - start >= pdMS_TO_TICKS(20));
+
+	//abstime already passed
+	for(int i = 0; i < MAX_MSGS; i++)
+	{
+		CHECK(mq_receive(mq, msg, sizeof(msg), NULL) == 4);
+	}
+	errno = 0;
+	CHECK(mq_timedreceive(mq, msg, sizeof(msg), NULL, &timeout) == -1);
+	CHECK(errno == ETIMEDOUT);
+	closeQueue(mq, "/timed");
+}
+
+#if( posixconfigMQ_PRIORITY == 1 )
+static void testPriority( void )
+{
+	static const unsigned sent[] = { 3, 1, 7, 3, 40 };
+	static const unsigned order[] = { 4, 2, 0, 3, 1 };
+	mqd_t mq = mq_open("/priority", O_CREAT | O_RDWR, 0,
+						&(struct mq_attr){ .mq_maxmsg = 5, .mq_msgsize = MSG_SIZE });
+	char msg[MSG_SIZE];
+	unsigned prio;
+
+	CHECK(mq != (mqd_t)-1);
+	for(unsigned i = 0; i < 5; i++)
+	{
+		msg[0] = (char)i;
+		CHECK(mq_send(mq, msg, 1, sent[i]) == 0);
+	}
+
+	//most urgent first, equal priorities in the order they were sent,
+	//priorities above 31 are received as 31
+	for(unsigned i = 0; i < 5; i++)
+	{
+		CHECK(mq_receive(mq, msg, sizeof(msg), &prio) == 1);
+		CHECK(msg[0] == (char)order[i]);
+		CHECK(prio == (sent[order[i]] > 31 ? 31 : sent[order[i]]));
+	}
+
+	//the slots all came back: the queue fills up again
+	for(unsigned i = 0; i < 5; i++)
+	{
+		CHECK(mq_send(mq, msg, 1, i) == 0);
+	}
+	CHECK(mq_receive(mq, msg, sizeof(msg), &prio) == 1 && prio == 4);
+	closeQueue(mq, "/priority");
+}
+#endif
+
+static mqd_t wakeQueue;
+static volatile int wakeReceived;
+
+static void receiverTask( void* Arg )
+{
+	char msg[MSG_SIZE];
+
+	(void) Arg;
+	for(;;)
+	{
+		ssize_t len = mq_receive(wakeQueue, msg, sizeof(msg), NULL);
+		CHECK(len == 4 && memcmp(msg, "wake", 4) == 0);
+		wakeReceived++;
+	}
+}
+
+static void testBlocking( void )
+{
+	char msg[MSG_SIZE] = "wake";
+	TaskHandle_t receiver;
+
+	//a higher priority receiver blocked on the empty queue runs as soon as
+	//a message is sent
+	wakeQueue = openQueue("/wake", 0);
+	wakeReceived = 0;
+	CHECK(xTaskCreate(receiverTask, "receiver", configMINIMAL_STACK_SIZE, NULL,
+						uxTaskPriorityGet(NULL) + 1, &receiver) == pdPASS);
+	for(int i = 0; i < 3 * MAX_MSGS; i++)
+	{
+		CHECK(mq_send(wakeQueue, msg, 4, 0) == 0);
+		CHECK(wakeReceived == i + 1);
+	}
+
+	//a sender blocked on the full queue gets the slot the receiver frees
+	vTaskSuspend(receiver);
+	for(int i = 0; i < MAX_MSGS; i++)
+	{
+		CHECK(mq_send(wakeQueue, msg, 4, 0) == 0);
+	}
+	vTaskPrioritySet(receiver, uxTaskPriorityGet(NULL) - 1);
+	vTaskResume(receiver);
+	wakeReceived = 0;
+	CHECK(mq_send(wakeQueue, msg, 4, 0) == 0);
+	vTaskDelay(1);
+	CHECK(wakeReceived == MAX_MSGS + 1);
+	vTaskDelete(receiver);
+	closeQueue(wakeQueue, "/wake");
+}
+
+static void testHeap( void )
+{
+	char msg[MSG_SIZE] = "heap";
+	size_t freeBefore = xPortGetFreeHeapSize();
+	mqd_t mq = openQueue("/heap", 0);
+	size_t freeOpen = xPortGetFreeHeapSize();
+
+	for(int i = 0; i < MAX_MSGS; i++)
+	{
+		CHECK(mq_send(mq, msg, MSG_SIZE, 0) == 0);
+	}
+#if( posixconfigMQ_PREALLOCATE == 1 )
+	//all of the storage comes from mq_open
+	CHECK(xPortGetFreeHeapSize() == freeOpen);
+#else
+	//every queued message has an allocation of its own
+	CHECK(xPortGetFreeHeapSize() < freeOpen);
+#endif
+	for(int i = 0; i < MAX_MSGS; i++)
+	{
+		CHECK(mq_receive(mq, msg, sizeof(msg), NULL) == MSG_SIZE);
+	}
+	CHECK(xPortGetFreeHeapSize() == freeOpen);
+
+#if( posixconfigMQ_POOL_SIZE > 0 )
+	CHECK(freeOpen == freeBefore);
+
+	//the pool runs out, and its entries only hold queues up to the defaults
+	mqd_t pool[posixconfigMQ_POOL_SIZE];
+	struct mq_attr bigAttr = { .mq_maxmsg = posixconfigMQ_MAX_MESSAGES + 1,
+							   .mq_msgsize = posixconfigMQ_MAX_SIZE };
+	errno = 0;
+	CHECK(mq_open("/big", O_CREAT | O_RDWR, 0, &bigAttr) == (mqd_t)-1);
+	CHECK(errno == ENOSPC);
+	pool[0] = mq;
+	for(int i = 1; i < posixconfigMQ_POOL_SIZE; i++)
+	{
+		char name[] = "/poolN";
+		name[5] = (char)('0' + i);
+		pool[i] = openQueue(name, 0);
+	}
+	errno = 0;
+	CHECK(mq_open("/overflow", O_CREAT | O_RDWR, 0, &attr) == (mqd_t)-1);
+	CHECK(errno == ENOSPC);
+	for(int i = 1; i < posixconfigMQ_POOL_SIZE; i++)
+	{
+		char name[] = "/poolN";
+		name[5] = (char)('0' + i);
+		closeQueue(pool[i], name);
+	}
+#else
+	CHECK(freeOpen < freeBefore);
+#endif
+
+	closeQueue(mq, "/heap");
+	CHECK(xPortGetFreeHeapSize() == freeBefore);
+
+#if( posixconfigMQ_POOL_SIZE > 0 )
+	//a closed descriptor (still pool memory, so safe to look at) is rejected rather than used
+	errno = 0;
+	CHECK(mq_send(mq, msg, 1, 0) == -1);
+	CHECK(errno == EBADF);
+#endif
+}
+
+static void testTask( void* Arg )
+{
+	(void) Arg;
+	testOpen();
+	testSendReceive();
+	testFull();
+	testBlocking();
+	testHeap();
+#if( posixconfigMQ_PRIORITY == 1 )
+	testPriority();
+#endif
+	vTaskEndScheduler();
+}
+
+int main( void )
+{
+	xTaskCreate(testTask, "test", configMINIMAL_STACK_SIZE, NULL, 2, NULL);
+	vTaskStartScheduler();
+	return TestResult();
+}
@@ -0,0 +1,370 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2019 Brian Amos
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#include <FreeRTOS.h>
+#include <task.h>
+#include <queue.h>
+#include "TestCheck.h"
+
+/**
+ * Host checks for the batch queue calls (xQueueSendMultiple() etc. in
+ * queue.c):
+ * 	- partial batches: what fits is moved, in order, and the count
+ * 	  returned, with and without blocking for the rest
+ * 	- one waiting task is unblocked per item moved
+ * 	- the FromISR calls, including while a task has the queue locked,
+ * 	  where a batch bigger than the lock count can hold has to saturate it
+ * 	  rather than wrap (which would leave the waiting tasks blocked)
+ */
+
+#define SMALL_LENGTH	5
+#define BIG_LENGTH		200
+#define NUM_HELPERS		3
+
+static QueueHandle_t small, big;
+static uint32_t nextTx, nextRx;
+
+static TaskHandle_t helpers[NUM_HELPERS];
+static volatile uint32_t helperItems[NUM_HELPERS];
+static volatile uint32_t helperWakes[NUM_HELPERS];
+
+static void fill( uint32_t* Items, uint32_t Count )
+{
+	for(uint32_t i = 0; i < Count; i++)
+	{
+		Items[i] = nextTx++;
+	}
+}
+
+static void checkItems( const uint32_t* Items, uint32_t Count )
+{
+	for(uint32_t i = 0; i < Count; i++)
+	{
+		CHECK(Items[i] == nextRx);
+		nextRx++;
+	}
+}
+
+static UBaseType_t min( UBaseType_t A, UBaseType_t B )
+{
+	return A < B ? A : B;
+}
+
+static void testPartialBatches( void )
+{
+	uint32_t items[4 * SMALL_LENGTH];
+	uint32_t seed = 7;
+
+	//only what fits is sent, only what's there is received
+	nextTx = nextRx = 0;
+	fill(items, 8);
+	CHECK(xQueueSendMultiple(small, items, 8, 0) == SMALL_LENGTH);
+	nextTx = SMALL_LENGTH;
+	CHECK(uxQueueMessagesWaiting(small) == SMALL_LENGTH);
+	CHECK(xQueueSendMultiple(small, items, 2, 0) == 0);
+	CHECK(xQueueReceiveMultiple(small, items, 3, 0) == 3);
+	checkItems(items, 3);
+	CHECK(xQueueReceiveMultiple(small, items, 10, 0) == 2);
+	checkItems(items, 2);
+	CHECK(xQueueReceiveMultiple(small, items, 10, 0) == 0);
+
+	//order is kept as the queue wraps, mixed with single item calls
+	for(uint32_t round = 0; round < 1000; round++)
+	{
+		seed = seed * 1103515245 + 12345;
+		uint32_t count = (seed >> 16) % (SMALL_LENGTH + 2);
+		UBaseType_t space = uxQueueSpacesAvailable(small);
+
+		fill(items, count);
+		if(count == 1 && (round & 1))
+		{
+			CHECK(xQueueSend(small, items, 0) == (space > 0 ? pdPASS : errQUEUE_FULL));
+		}
+		else
+		{
+			CHECK(xQueueSendMultiple(small, items, count, 0) == min(count, space));
+		}
+		nextTx -= count - min(count, space);
+
+		uint32_t max = 1 + (seed >> 24) % (SMALL_LENGTH + 1);
+		UBaseType_t waiting = uxQueueMessagesWaiting(small);
+		UBaseType_t received = xQueueReceiveMultiple(small, items, max, 0);
+		CHECK(received == min(max, waiting));
+		checkItems(items, received);
+	}
+	xQueueReset(small);
+	nextRx = nextTx;
+
+	//a timed send posts what fits, then gives up on the rest
+	fill(items, SMALL_LENGTH - 2);
+	CHECK(xQueueSendMultiple(small, items, SMALL_LENGTH - 2, 0) == SMALL_LENGTH - 2);
+	TickType_t start = xTaskGetTickCount();
+	fill(items, 5);
+	CHECK(xQueueSendMultiple(small, items, 5, 10) == 2);
+	CHECK(xTaskGetTickCount() - start >= 10);
+	nextTx -= 3;
+	CHECK(xQueueReceiveMultiple(small, items, SMALL_LENGTH, 0) == SMALL_LENGTH);
+	checkItems(items, SMALL_LENGTH);
+
+	//a timed receive on an empty queue gives up with nothing
+	start = xTaskGetTickCount();
+	CHECK(xQueueReceiveMultiple(small, items, SMALL_LENGTH, 10) == 0);
+	CHECK(xTaskGetTickCount() - start >= 10);
+}
+
+static volatile uint32_t consumed;
+
+static void consumerTask( void* Arg )
+{
+	uint32_t items[2];
+
+	(void) Arg;
+	for(;;)
+	{
+		UBaseType_t count = xQueueReceiveMultiple(small, items, 2, portMAX_DELAY);
+		checkItems(items, count);
+		consumed += count;
+	}
+}
+
+static void tickSend( void )
+{
+	static uint32_t ticks = 0;
+
+	if(++ticks == 5)
+	{
+		uint32_t items[3];
+		BaseType_t woken = pdFALSE;
+
+		fill(items, 3);
+		CHECK(xQueueSendMultipleFromISR(small, items, 3, &woken) == 3);
+		CHECK(woken == pdTRUE);
+		portYIELD_FROM_ISR(woken);
+	}
+}
+
+static void testBlocking( void )
+{
+	uint32_t items[4 * SMALL_LENGTH];
+	TaskHandle_t consumer;
+
+	//a blocked send carries on posting as a lower priority consumer
+	//makes room, until the whole batch is in
+	xQueueReset(small);
+	nextTx = nextRx = 0;
+	consumed = 0;
+	CHECK(xTaskCreate(consumerTask, "consumer", configMINIMAL_STACK_SIZE, NULL,
+						uxTaskPriorityGet(NULL) - 1, &consumer) == pdPASS);
+	fill(items, 4 * SMALL_LENGTH);
+	CHECK(xQueueSendMultiple(small, items, 4 * SMALL_LENGTH, portMAX_DELAY) == 4 * SMALL_LENGTH);
+	vTaskDelay(1);
+	CHECK(consumed == 4 * SMALL_LENGTH);
+	vTaskDelete(consumer);
+
+	//a blocked receive takes the whole batch an interrupt sends
+	xQueueReset(small);
+	vPortHostSetTickHook(tickSend);
+	CHECK(xQueueReceiveMultiple(small, items, SMALL_LENGTH, portMAX_DELAY) == 3);
+	vPortHostSetTickHook(NULL);
+	checkItems(items, 3);
+
+	//the FromISR calls move what fits, without blocking
+	BaseType_t woken = pdFALSE;
+	fill(items, SMALL_LENGTH + 2);
+	CHECK(xQueueSendMultipleFromISR(small, items, SMALL_LENGTH + 2, &woken) == SMALL_LENGTH);
+	CHECK(woken == pdFALSE);
+	CHECK(xQueueReceiveMultipleFromISR(small, items, SMALL_LENGTH + 2, &woken) == SMALL_LENGTH);
+	checkItems(items, SMALL_LENGTH);
+	CHECK(xQueueReceiveMultipleFromISR(small, items, 1, &woken) == 0);
+	CHECK(woken == pdFALSE);
+}
+
+static void receiverTask( void* Arg )
+{
+	const uintptr_t id = (uintptr_t)Arg;
+	uint8_t items[50];
+
+	for(;;)
+	{
+		helperItems[id] += xQueueReceiveMultiple(big, items, sizeof(items), portMAX_DELAY);
+		helperWakes[id]++;
+	}
+}
+
+static void senderTask( void* Arg )
+{
+	const uintptr_t id = (uintptr_t)Arg;
+	uint8_t items[10] = {0};
+
+	for(;;)
+	{
+		helperItems[id] += xQueueSendMultiple(big, items, sizeof(items), portMAX_DELAY);
+		helperWakes[id]++;
+		vTaskSuspend(NULL);
+	}
+}
+
+/**
+ * start NUM_HELPERS copies of Task below this task's priority and let
+ * them block on the big queue
+ */
+static void startHelpers( TaskFunction_t Task )
+{
+	for(uintptr_t i = 0; i < NUM_HELPERS; i++)
+	{
+		helperItems[i] = helperWakes[i] = 0;
+		CHECK(xTaskCreate(Task, "helper", configMINIMAL_STACK_SIZE, (void*)i,
+							uxTaskPriorityGet(NULL) - 1, &helpers[i]) == pdPASS);
+	}
+	vTaskDelay(1);
+}
+
+static void stopHelpers( void )
+{
+	for(uint32_t i = 0; i < NUM_HELPERS; i++)
+	{
+		vTaskDelete(helpers[i]);
+	}
+	xQueueReset(big);
+}
+
+static uint32_t helpersReady( void )
+{
+	uint32_t ready = 0;
+
+	for(uint32_t i = 0; i < NUM_HELPERS; i++)
+	{
+		ready += (eTaskGetState(helpers[i]) == eReady);
+	}
+	return ready;
+}
+
+static void testWakeCounts( void )
+{
+	uint8_t items[BIG_LENGTH] = {0};
+
+	//two items sent in one batch ready two of the three waiting receivers
+	xQueueReset(big);
+	startHelpers(receiverTask);
+	CHECK(helpersReady() == 0);
+	CHECK(xQueueSendMultiple(big, items, 2, 0) == 2);
+	CHECK(helpersReady() == 2);
+	vTaskDelay(1);
+	CHECK(helperItems[0] + helperItems[1] + helperItems[2] == 2);
+	stopHelpers();
+
+	//room for two items readies two of the three waiting senders
+	CHECK(xQueueSendMultiple(big, items, BIG_LENGTH, 0) == BIG_LENGTH);
+	startHelpers(senderTask);
+	CHECK(helpersReady() == 0);
+	CHECK(xQueueReceiveMultiple(big, items, 2, 0) == 2);
+	CHECK(helpersReady() == 2);
+	stopHelpers();
+}
+
+static uint32_t lockedIsrItems;
+static BaseType_t lockedIsrSend;
+
+static void lockedIsr( void )
+{
+	uint8_t items[BIG_LENGTH] = {0};
+	BaseType_t woken = pdFALSE;
+
+	//the queue is locked, so the event lists are left for the unlock
+	if(lockedIsrSend)
+	{
+		CHECK(xQueueSendMultipleFromISR(big, items, lockedIsrItems, &woken) == lockedIsrItems);
+	}
+	else
+	{
+		CHECK(xQueueReceiveMultipleFromISR(big, items, lockedIsrItems, &woken) == lockedIsrItems);
+	}
+	CHECK(woken == pdFALSE);
+}
+
+static void queueBlocking( void* Queue )
+{
+	if(Queue == big && lockedIsrItems > 0)
+	{
+		vPortHostInterrupt(lockedIsr);
+		lockedIsrItems = 0;
+	}
+}
+
+static void testLockSaturation( void )
+{
+	uint8_t items[BIG_LENGTH] = {0};
+
+	vPortHostSetQueueBlockingHook(queueBlocking);
+
+	//an interrupt sends more items than the lock count can hold while this
+	//task is blocking on the empty queue: the unlock still wakes every
+	//waiting receiver
+	startHelpers(receiverTask);
+	lockedIsrItems = BIG_LENGTH;
+	lockedIsrSend = pdTRUE;
+	CHECK(xQueueReceiveMultiple(big, items, 1, 10) == 1);
+	CHECK(helpersReady() == NUM_HELPERS);
+	vTaskDelay(1);
+	CHECK(helperItems[0] + helperItems[1] + helperItems[2] == BIG_LENGTH - 1);
+	CHECK(uxQueueMessagesWaiting(big) == 0);
+	stopHelpers();
+
+	//the same for an interrupt emptying the full queue while this task is
+	//blocking on it: every waiting sender gets to post its batch
+	CHECK(xQueueSendMultiple(big, items, BIG_LENGTH, 0) == BIG_LENGTH);
+	startHelpers(senderTask);
+	lockedIsrItems = BIG_LENGTH;
+	lockedIsrSend = pdFALSE;
+	CHECK(xQueueSendMultiple(big, items, 1, 10) == 1);
+	CHECK(helpersReady() == NUM_HELPERS);
+	vTaskDelay(1);
+	for(uint32_t i = 0; i < NUM_HELPERS; i++)
+	{
+		CHECK(helperItems[i] == 10 && helperWakes[i] == 1);
+	}
+	CHECK(uxQueueMessagesWaiting(big) == 1 + NUM_HELPERS * 10);
+	stopHelpers();
+
+	vPortHostSetQueueBlockingHook(NULL);
+}
+
+static void testTask( void* Arg )
+{
+	(void) Arg;
+	testPartialBatches();
+	testBlocking();
+	testWakeCounts();
+	testLockSaturation();
+	vTaskEndScheduler();
+}
+
+int main( void )
+{
+	small = xQueueCreate(SMALL_LENGTH, sizeof(uint32_t));
+	big = xQueueCreate(BIG_LENGTH, sizeof(uint8_t));
+	xTaskCreate(testTask, "test", configMINIMAL_STACK_SIZE, NULL, 2, NULL);
+	vTaskStartScheduler();
+	return TestResult();
+}
@@ -0,0 +1,139 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2019 Brian Amos
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#include <FreeRTOS.h>
+#include <task.h>
+#include <stream_buffer.h>
+#include "TestCheck.h"
+
+/**
+ * Copying vs zero-copy stream buffer throughput on the host, the same
+ * measurement Chapter_10's streamBufferZeroCopy configuration makes on the
+ * target (mainStreamBufferZeroCopy.c)
+ *
+ * A producer/consumer pair runs back to back in a single task:
+ * 	copy		- generate into a local buffer, xStreamBufferSend, then
+ * 				  xStreamBufferReceive into another and checksum it
+ * 	zero-copy	- generate straight into the xStreamBufferSendAcquire spans
+ * 				  and checksum straight from the xStreamBufferReceiveAcquire
+ * 				  spans
+ *
+ * The chunk sizes don't divide the buffer size evenly, so wrapped (two
+ * span) transfers are included.  Prints host CPU ns per KB moved
+ */
+
+#define BUFFER_SIZE 1024
+#define BYTES_PER_RUN (64UL * 1024 * 1024)
+#define NUM_CHUNK_SIZES 4
+
+static const uint32_t chunkSizes[NUM_CHUNK_SIZES] = {15, 63, 255, 511};
+
+static StreamBufferHandle_t stream;
+static uint8_t txChunk[BUFFER_SIZE];
+static uint8_t rxChunk[BUFFER_SIZE];
+static uint8_t nextValue;
+
+static void generate( uint8_t* Dst, uint32_t Len )
+{
+	for(uint32_t i = 0; i < Len; i++)
+	{
+		Dst[i] = nextValue++;
+	}
+}
+
+static uint32_t sum( const uint8_t* Src, uint32_t Len )
+{
+	uint32_t total = 0;
+	for(uint32_t i = 0; i < Len; i++)
+	{
+		total += Src[i];
+	}
+	return total;
+}
+
+static uint64_t runCopy( uint32_t ChunkSize, uint32_t* Checksum )
+{
+	uint32_t total = 0;
+	uint64_t start = ullPortHostCpuTimeNs();
+	for(uint32_t moved = 0; moved < BYTES_PER_RUN; moved += ChunkSize)
+	{
+		generate(txChunk, ChunkSize);
+		xStreamBufferSend(stream, txChunk, ChunkSize, 0);
+		uint32_t numBytes = xStreamBufferReceive(stream, rxChunk, ChunkSize, 0);
+		total += sum(rxChunk, numBytes);
+	}
+	*Checksum = total;
+	return (ullPortHostCpuTimeNs() - start) / (BYTES_PER_RUN / 1024);
+}
+
+static uint64_t runZeroCopy( uint32_t ChunkSize, uint32_t* Checksum )
+{
+	StreamBufferSpan_t spans[2];
+	uint32_t total = 0;
+	uint64_t start = ullPortHostCpuTimeNs();
+	for(uint32_t moved = 0; moved < BYTES_PER_RUN; moved += ChunkSize)
+	{
+		//the buffer is always empty here, so at least ChunkSize is free
+		xStreamBufferSendAcquire(stream, spans, ChunkSize, 0);
+		uint32_t firstLen = spans[0].xLength < ChunkSize ? spans[0].xLength : ChunkSize;
+		generate(spans[0].pucData, firstLen);
+		generate(spans[1].pucData, ChunkSize - firstLen);
+		xStreamBufferSendCommit(stream, ChunkSize);
+
+		uint32_t numBytes = xStreamBufferReceiveAcquire(stream, spans, 0);
+		total += sum(spans[0].pucData, spans[0].xLength);
+		total += sum(spans[1].pucData, spans[1].xLength);
+		xStreamBufferReceiveCommit(stream, numBytes);
+	}
+	*Checksum = total;
+	return (ullPortHostCpuTimeNs() - start) / (BYTES_PER_RUN / 1024);
+}
+
+static void benchmarkTask( void* Arg )
+{
+	(void) Arg;
+	for(uint32_t i = 0; i < NUM_CHUNK_SIZES; i++)
+	{
+		uint32_t copySum, zeroCopySum;
+
+		//restart the pattern so both runs produce the same checksum
+		nextValue = 0;
+		uint64_t copy = runCopy(chunkSizes[i], &copySum);
+		nextValue = 0;
+		uint64_t zeroCopy = runZeroCopy(chunkSizes[i], &zeroCopySum);
+		CHECK(copySum == zeroCopySum);
+
+		printf("  chunk %3lu ns/KB copy: %5lu zero-copy: %5lu\n", (unsigned long)chunkSizes[i],
+				(unsigned long)copy, (unsigned long)zeroCopy);
+	}
+	vTaskEndScheduler();
+}
+
+int main( void )
+{
+	stream = xStreamBufferCreate(BUFFER_SIZE, 1);
+	xTaskCreate(benchmarkTask, "benchmark", configMINIMAL_STACK_SIZE, NULL, 2, NULL);
+	vTaskStartScheduler();
+	return TestResult();
+}
@@ -0,0 +1,387 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2019 Brian Amos
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#include <FreeRTOS.h>
+#include <task.h>
+#include <stream_buffer.h>
+#include <message_buffer.h>
+#include "TestCheck.h"
+#include <string.h>
+
+/**
+ * Host checks for the zero-copy stream and message buffer functions
+ * (xStreamBufferSendAcquire() etc. in stream_buffer.c):
+ * 	- spans that wrap around the end of the storage, against a byte
+ * 	  pattern checked on the other side, mixed with the copying calls
+ * 	- message lengths that wrap, exact length acquires, messages that
+ * 	  don't fit and whole message receive commits
+ * 	- committing fewer bytes than were acquired (and 0 to abandon)
+ * 	- a blocked reader/writer woken by the commits, and the FromISR calls
+ */
+
+//sizes that don't divide evenly, so every offset gets a turn at wrapping
+#define STREAM_STORAGE	61
+#define MSG_STORAGE		67
+#define MSG_HEADER		sizeof(configMESSAGE_BUFFER_LENGTH_TYPE)
+#define NUM_ROUNDS		5000
+
+static uint8_t streamStorage[STREAM_STORAGE];
+static uint8_t msgStorage[MSG_STORAGE];
+static StaticStreamBuffer_t streamStruct, msgStruct;
+static StreamBufferHandle_t stream;
+static MessageBufferHandle_t msgs;
+
+static uint8_t nextTx, nextRx;
+static uint32_t wrappedSpans;
+static uint32_t seed = 1;
+
+static uint32_t rnd( uint32_t Limit )
+{
+	seed = seed * 1103515245 + 12345;
+	return (seed >> 16) % Limit;
+}
+
+static void checkSpans( const StreamBufferSpan_t Spans[2], size_t Total, const uint8_t* Storage, size_t StorageSize )
+{
+	CHECK(Spans[0].xLength + Spans[1].xLength == Total);
+	CHECK(Spans[0].pucData >= Storage && Spans[0].pucData + Spans[0].xLength <= Storage + StorageSize);
+	if(Spans[1].xLength > 0)
+	{
+		//the first span runs to the end of the storage, the rest wraps to its start
+		CHECK(Spans[0].pucData + Spans[0].xLength == Storage + StorageSize);
+		CHECK(Spans[1].pucData == Storage);
+		wrappedSpans++;
+	}
+}
+
+static void fillSpans( const StreamBufferSpan_t Spans[2], size_t Len )
+{
+	for(size_t i = 0; i < Len; i++)
+	{
+		if(i < Spans[0].xLength)
+		{
+			Spans[0].pucData[i] = nextTx++;
+		}
+		else
+		{
+			Spans[1].pucData[i - Spans[0].xLength] = nextTx++;
+		}
+	}
+}
+
+static void checkSpanData( const StreamBufferSpan_t Spans[2], size_t Len )
+{
+	for(size_t i = 0; i < Len; i++)
+	{
+		uint8_t value = i < Spans[0].xLength ? Spans[0].pucData[i] : Spans[1].pucData[i - Spans[0].xLength];
+		CHECK(value == nextRx);
+		nextRx++;
+	}
+}
+
+static void fillBuffer( uint8_t* Buffer, size_t Len )
+{
+	for(size_t i = 0; i < Len; i++)
+	{
+		Buffer[i] = nextTx++;
+	}
+}
+
+static void checkBuffer( const uint8_t* Buffer, size_t Len )
+{
+	for(size_t i = 0; i < Len; i++)
+	{
+		CHECK(Buffer[i] == nextRx);
+		nextRx++;
+	}
+}
+
+static void testStreamSpans( void )
+{
+	StreamBufferSpan_t spans[2];
+	uint8_t buffer[STREAM_STORAGE];
+	size_t queued = 0;
+
+	nextTx = nextRx = 0;
+	wrappedSpans = 0;
+	for(uint32_t round = 0; round < NUM_ROUNDS; round++)
+	{
+		//write: zero-copy with a random (possibly 0) commit, or a copy
+		size_t space = STREAM_STORAGE - 1 - queued;
+		if(space > 0 && rnd(2))
+		{
+			size_t acquired = xStreamBufferSendAcquire(stream, spans, 1, 0);
+			CHECK(acquired == space);
+			checkSpans(spans, acquired, streamStorage, STREAM_STORAGE);
+			size_t len = rnd(acquired + 1);
+			fillSpans(spans, len);
+			CHECK(xStreamBufferSendCommit(stream, len) == len);
+			queued += len;
+		}
+		else if(space > 0)
+		{
+			size_t len = 1 + rnd(space);
+			fillBuffer(buffer, len);
+			CHECK(xStreamBufferSend(stream, buffer, len, 0) == len);
+			queued += len;
+		}
+		CHECK(xStreamBufferBytesAvailable(stream) == queued);
+
+		//read: zero-copy with a partial commit, or a copy
+		if(queued > 0 && rnd(2))
+		{
+			size_t acquired = xStreamBufferReceiveAcquire(stream, spans, 0);
+			CHECK(acquired == queued);
+			checkSpans(spans, acquired, streamStorage, STREAM_STORAGE);
+			size_t len = rnd(acquired + 1);
+			checkSpanData(spans, len);
+			CHECK(xStreamBufferReceiveCommit(stream, len) == len);
+			queued -= len;
+		}
+		else if(queued > 0)
+		{
+			size_t len = xStreamBufferReceive(stream, buffer, 1 + rnd(queued), 0);
+			checkBuffer(buffer, len);
+			queued -= len;
+		}
+		CHECK(xStreamBufferBytesAvailable(stream) == queued);
+	}
+	CHECK(wrappedSpans > NUM_ROUNDS / 10);
+
+	//nothing to read: no spans
+	xStreamBufferReset(stream);
+	CHECK(xStreamBufferReceiveAcquire(stream, spans, 0) == 0);
+	CHECK(spans[0].xLength == 0 && spans[1].xLength == 0);
+}
+
+static void testStreamPartialCommit( void )
+{
+	StreamBufferSpan_t spans[2];
+	uint8_t buffer[STREAM_STORAGE];
+
+	xStreamBufferReset(stream);
+	nextTx = nextRx = 0;
+
+	//commit fewer than acquired: only those become readable, the next
+	//acquire continues straight after them
+	CHECK(xStreamBufferSendAcquire(stream, spans, 10, 0) == STREAM_STORAGE - 1);
+	uint8_t* first = spans[0].pucData;
+	fillSpans(spans, 5);
+	CHECK(xStreamBufferSendCommit(stream, 5) == 5);
+	CHECK(xStreamBufferBytesAvailable(stream) == 5);
+	CHECK(xStreamBufferSendAcquire(stream, spans, 1, 0) == STREAM_STORAGE - 6);
+	CHECK(spans[0].pucData == first + 5);
+
+	//committing 0 abandons the acquire
+	memset(spans[0].pucData, 0xEE, spans[0].xLength);
+	CHECK(xStreamBufferSendCommit(stream, 0) == 0);
+	CHECK(xStreamBufferBytesAvailable(stream) == 5);
+
+	//the same on the read side, the rest stays for the next reader
+	CHECK(xStreamBufferReceiveAcquire(stream, spans, 0) == 5);
+	checkSpanData(spans, 2);
+	CHECK(xStreamBufferReceiveCommit(stream, 2) == 2);
+	CHECK(xStreamBufferReceiveCommit(stream, 0) == 0);
+	CHECK(xStreamBufferReceive(stream, buffer, sizeof(buffer), 0) == 3);
+	checkBuffer(buffer, 3);
+
+	//a writer can't get more space than is free
+	fillBuffer(buffer, STREAM_STORAGE - 1);
+	CHECK(xStreamBufferSend(stream, buffer, STREAM_STORAGE - 1, 0) == STREAM_STORAGE - 1);
+	CHECK(xStreamBufferSendAcquire(stream, spans, 1, 0) == 0);
+	CHECK(spans[0].xLength == 0 && spans[1].xLength == 0);
+}
+
+static void testMessages( void )
+{
+	StreamBufferSpan_t spans[2];
+	uint8_t buffer[MSG_STORAGE];
+	size_t lengths[MSG_STORAGE];
+	size_t head = 0, tail = 0, used = 0, writeOffset = 0;
+	uint32_t headerWraps = 0;
+
+	nextTx = nextRx = 0;
+	wrappedSpans = 0;
+	for(uint32_t round = 0; round < NUM_ROUNDS; round++)
+	{
+		//send a message that fits (if one does)
+		size_t space = MSG_STORAGE - 1 - used;
+		if(space > MSG_HEADER)
+		{
+			size_t len = 1 + rnd(space - MSG_HEADER);
+			if(writeOffset + MSG_HEADER > MSG_STORAGE)
+			{
+				headerWraps++;
+			}
+
+			if(rnd(2))
+			{
+				//exactly the length asked for, committing no more than that
+				CHECK(xMessageBufferSendAcquire(msgs, spans, len, 0) == len);
+				checkSpans(spans, len, msgStorage, MSG_STORAGE);
+				size_t committed = 1 + rnd(len);
+				fillSpans(spans, committed);
+				CHECK(xMessageBufferSendCommit(msgs, committed) == committed);
+				len = committed;
+			}
+			else
+			{
+				fillBuffer(buffer, len);
+				CHECK(xMessageBufferSend(msgs, buffer, len, 0) == len);
+			}
+			lengths[head++ % MSG_STORAGE] = len;
+			used += len + MSG_HEADER;
+			writeOffset = (writeOffset + len + MSG_HEADER) % MSG_STORAGE;
+		}
+
+		//no room for one more byte than is left
+		space = MSG_STORAGE - 1 - used;
+		if(space >= MSG_HEADER)
+		{
+			CHECK(xMessageBufferSendAcquire(msgs, spans, space - MSG_HEADER + 1, 0) == 0);
+			CHECK(spans[0].xLength == 0 && spans[1].xLength == 0);
+		}
+
+		//receive whole messages
+		uint32_t count = rnd(3);
+		while(count-- > 0 && tail != head)
+		{
+			size_t expected = lengths[tail++ % MSG_STORAGE];
+			if(rnd(2))
+			{
+				CHECK(xMessageBufferReceiveAcquire(msgs, spans, 0) == expected);
+				checkSpans(spans, expected, msgStorage, MSG_STORAGE);
+				checkSpanData(spans, expected);
+				CHECK(xMessageBufferReceiveCommit(msgs) == expected);
+			}
+			else
+			{
+				CHECK(xMessageBufferReceive(msgs, buffer, sizeof(buffer), 0) == expected);
+				checkBuffer(buffer, expected);
+			}
+			used -= expected + MSG_HEADER;
+		}
+		CHECK(xStreamBufferBytesAvailable(msgs) == used);
+	}
+	CHECK(wrappedSpans > 0);
+	CHECK(headerWraps > 0);
+
+	//an empty message buffer has no message to acquire
+	xMessageBufferReset(msgs);
+	CHECK(xMessageBufferReceiveAcquire(msgs, spans, 0) == 0);
+}
+
+static volatile size_t taskReceived;
+
+static void readerTask( void* Arg )
+{
+	StreamBufferSpan_t spans[2];
+
+	(void) Arg;
+	for(;;)
+	{
+		size_t len = xStreamBufferReceiveAcquire(stream, spans, portMAX_DELAY);
+		checkSpanData(spans, len);
+		xStreamBufferReceiveCommit(stream, len);
+		taskReceived += len;
+	}
+}
+
+static StreamBufferSpan_t isrSpans[2];
+static size_t isrLength;
+
+static void sendFromIsr( void )
+{
+	BaseType_t woken = pdFALSE;
+
+	CHECK(xStreamBufferSendAcquireFromISR(stream, isrSpans, isrLength) >= isrLength);
+	fillSpans(isrSpans, isrLength);
+	CHECK(xStreamBufferSendCommitFromISR(stream, isrLength, &woken) == isrLength);
+	portYIELD_FROM_ISR(woken);
+}
+
+static void testBlocking( void )
+{
+	StreamBufferSpan_t spans[2];
+	TaskHandle_t reader;
+
+	xStreamBufferReset(stream);
+	nextTx = nextRx = 0;
+	taskReceived = 0;
+
+	//a higher priority reader blocked in ReceiveAcquire runs on each commit
+	CHECK(xTaskCreate(readerTask, "reader", configMINIMAL_STACK_SIZE, NULL,
+						uxTaskPriorityGet(NULL) + 1, &reader) == pdPASS);
+	for(size_t len = 1; len < 3 * STREAM_STORAGE; len = len * 2 + 1)
+	{
+		size_t chunk = len % (STREAM_STORAGE - 1) + 1;
+		CHECK(xStreamBufferSendAcquire(stream, spans, chunk, portMAX_DELAY) >= chunk);
+		fillSpans(spans, chunk);
+		size_t before = taskReceived;
+		xStreamBufferSendCommit(stream, chunk);
+		CHECK(taskReceived == before + chunk);
+	}
+
+	//and when the commit comes from an interrupt
+	isrLength = 7;
+	size_t before = taskReceived;
+	vPortHostInterrupt(sendFromIsr);
+	CHECK(taskReceived == before + 7);
+
+	//a writer blocked in SendAcquire gets the space a lower priority
+	//reader's commit returns
+	vTaskSuspend(reader);
+	CHECK(xStreamBufferSendAcquire(stream, spans, STREAM_STORAGE - 1, 0) == STREAM_STORAGE - 1);
+	fillSpans(spans, STREAM_STORAGE - 1);
+	xStreamBufferSendCommit(stream, STREAM_STORAGE - 1);
+	vTaskPrioritySet(reader, uxTaskPriorityGet(NULL) - 1);
+	vTaskResume(reader);
+	CHECK(xStreamBufferSendAcquire(stream, spans, 10, portMAX_DELAY) >= 10);
+	fillSpans(spans, 10);
+	xStreamBufferSendCommit(stream, 10);
+	vTaskDelay(1);
+	CHECK(xStreamBufferIsEmpty(stream));
+	CHECK(nextRx == nextTx);
+
+	vTaskDelete(reader);
+}
+
+static void testTask( void* Arg )
+{
+	(void) Arg;
+	testStreamSpans();
+	testStreamPartialCommit();
+	testMessages();
+	testBlocking();
+	vTaskEndScheduler();
+}
+
+int main( void )
+{
+	stream = xStreamBufferCreateStatic(sizeof(streamStorage), 1, streamStorage, &streamStruct);
+	msgs = xMessageBufferCreateStatic(sizeof(msgStorage), msgStorage, &msgStruct);
+	xTaskCreate(testTask, "test", configMINIMAL_STACK_SIZE, NULL, 2, NULL);
+	vTaskStartScheduler();
+	return TestResult();
+}
@@ -0,0 +1,196 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2019 Brian Amos
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#include <FreeRTOS.h>
+#include <task.h>
+#include <stream_buffer.h>
+#include "TestCheck.h"
+
+/**
+ * Host checks for the indexed task notification arrays (the host port sets
+ * configTASK_NOTIFICATION_ARRAY_ENTRIES to 2):
+ * 	- a notification on one index neither satisfies nor clears a wait on
+ * 	  the other, from tasks and from interrupts
+ * 	- each index has its own value and pending state
+ * 	- eTaskGetState and vTaskSuspend look at every index
+ * 	- a stream buffer (which uses index 0) and index 1 can be waited on by
+ * 	  the same task, the way the USB virtual comm drivers do
+ */
+
+static TaskHandle_t testHandle, waiter, streamTask;
+static volatile uint32_t waiterWakes, waiterCount;
+static volatile uint32_t streamBytes;
+static StreamBufferHandle_t stream;
+
+/**
+ * takes index 1 only
+ */
+static void waiterTask( void* Arg )
+{
+	(void) Arg;
+	for(;;)
+	{
+		waiterCount = ulTaskNotifyTakeIndexed(1, pdTRUE, portMAX_DELAY);
+		waiterWakes++;
+	}
+}
+
+/**
+ * receives from the stream buffer, then takes index 1, like the USB
+ * drivers' tx tasks
+ */
+static void streamReceiveTask( void* Arg )
+{
+	uint8_t buffer[8];
+
+	(void) Arg;
+	for(;;)
+	{
+		streamBytes += xStreamBufferReceive(stream, buffer, sizeof(buffer), portMAX_DELAY);
+		(void) ulTaskNotifyTakeIndexed(1, pdTRUE, portMAX_DELAY);
+	}
+}
+
+static void testIndexes( void )
+{
+	uint32_t value;
+
+	//each index keeps its own value
+	CHECK(xTaskNotifyIndexed(testHandle, 1, 0x05, eSetBits) == pdPASS);
+	CHECK(xTaskNotifyIndexed(testHandle, 0, 7, eSetValueWithOverwrite) == pdPASS);
+	CHECK(xTaskNotifyWaitIndexed(1, 0, 0xFFFFFFFF, &value, 0) == pdPASS);
+	CHECK(value == 0x05);
+	CHECK(xTaskNotifyWaitIndexed(1, 0, 0xFFFFFFFF, &value, 0) == pdFAIL);
+	CHECK(xTaskNotifyWait(0, 0, &value, 0) == pdPASS);
+	CHECK(value == 7);
+
+	//and its own pending state
+	CHECK(xTaskNotify(testHandle, 1, eSetValueWithoutOverwrite) == pdPASS);
+	CHECK(xTaskNotify(testHandle, 2, eSetValueWithoutOverwrite) == pdFAIL);
+	CHECK(xTaskNotifyIndexed(testHandle, 1, 3, eSetValueWithoutOverwrite) == pdPASS);
+	CHECK(xTaskNotifyAndQueryIndexed(testHandle, 1, 1, eIncrement, &value) == pdPASS);
+	CHECK(value == 3);
+	CHECK(xTaskNotifyStateClearIndexed(NULL, 1) == pdTRUE);
+	CHECK(xTaskNotifyStateClearIndexed(NULL, 1) == pdFALSE);
+	CHECK(xTaskNotifyStateClear(NULL) == pdTRUE);
+
+	//clearing the state leaves the values, to be taken
+	CHECK(ulTaskNotifyTakeIndexed(1, pdTRUE, 0) == 4);
+	CHECK(ulTaskNotifyTake(pdTRUE, 0) == 1);
+
+	//a pending index 0 doesn't end a wait on index 1
+	xTaskNotifyGive(testHandle);
+	TickType_t start = xTaskGetTickCount();
+	CHECK(ulTaskNotifyTakeIndexed(1, pdTRUE, 5) == 0);
+	CHECK(xTaskGetTickCount() - start == 5);
+	CHECK(ulTaskNotifyTake(pdTRUE, 0) == 1);
+}
+
+static void notifyIsr( void )
+{
+	BaseType_t woken = pdFALSE;
+
+	//index 0 first, which the waiter isn't waiting on
+	vTaskNotifyGiveFromISR(waiter, &woken);
+	CHECK(woken == pdFALSE);
+	vTaskNotifyGiveIndexedFromISR(waiter, 1, &woken);
+	CHECK(woken == pdTRUE);
+	portYIELD_FROM_ISR(woken);
+}
+
+static void testWaiter( void )
+{
+	CHECK(xTaskCreate(waiterTask, "waiter", configMINIMAL_STACK_SIZE, NULL,
+						uxTaskPriorityGet(NULL) + 1, &waiter) == pdPASS);
+
+	//waiting forever on index 1 is blocked, not suspended
+	CHECK(eTaskGetState(waiter) == eBlocked);
+
+	//index 0 doesn't wake it, index 1 does
+	xTaskNotifyGive(waiter);
+	CHECK(waiterWakes == 0);
+	CHECK(eTaskGetState(waiter) == eBlocked);
+	xTaskNotifyGiveIndexed(waiter, 1);
+	CHECK(waiterWakes == 1 && waiterCount == 1);
+
+	//the same from an interrupt
+	vPortHostInterrupt(notifyIsr);
+	CHECK(waiterWakes == 2 && waiterCount == 1);
+
+	//index 0 still has both gives pending
+	CHECK(xTaskNotifyStateClearIndexed(waiter, 0) == pdTRUE);
+	CHECK(xTaskNotifyStateClearIndexed(waiter, 1) == pdFALSE);
+
+	//suspending it ends its wait on index 1, so a notification doesn't
+	//resume it - the notification is there when it's resumed
+	vTaskSuspend(waiter);
+	CHECK(eTaskGetState(waiter) == eSuspended);
+	xTaskNotifyGiveIndexed(waiter, 1);
+	CHECK(eTaskGetState(waiter) == eSuspended);
+	CHECK(waiterWakes == 2);
+	vTaskResume(waiter);
+	CHECK(waiterWakes == 3 && waiterCount == 1);
+	vTaskDelete(waiter);
+}
+
+static void testStreamBuffer( void )
+{
+	static const uint8_t data[4] = {1, 2, 3, 4};
+
+	CHECK(xTaskCreate(streamReceiveTask, "stream", configMINIMAL_STACK_SIZE, NULL,
+						uxTaskPriorityGet(NULL) + 1, &streamTask) == pdPASS);
+
+	//index 1 doesn't end the wait for data, which still arrives
+	xTaskNotifyGiveIndexed(streamTask, 1);
+	CHECK(streamBytes == 0);
+	CHECK(eTaskGetState(streamTask) == eBlocked);
+	CHECK(xStreamBufferSend(stream, data, sizeof(data), 0) == sizeof(data));
+	CHECK(streamBytes == sizeof(data));
+
+	//the give on index 1 is still pending, so it's back on the stream
+	//buffer, where index 1 is pending but it's waiting on index 0
+	CHECK(xStreamBufferSend(stream, data, sizeof(data), 0) == sizeof(data));
+	CHECK(streamBytes == 2 * sizeof(data));
+	xTaskNotifyGiveIndexed(streamTask, 1);
+	CHECK(xStreamBufferSend(stream, data, sizeof(data), 0) == sizeof(data));
+	CHECK(streamBytes == 3 * sizeof(data));
+	vTaskDelete(streamTask);
+}
+
+static void testTask( void* Arg )
+{
+	(void) Arg;
+	testIndexes();
+	testWaiter();
+	testStreamBuffer();
+	vTaskEndScheduler();
+}
+
+int main( void )
+{
+	stream = xStreamBufferCreate(16, 1);
+	xTaskCreate(testTask, "test", configMINIMAL_STACK_SIZE, NULL, 2, &testHandle);
+	vTaskStartScheduler();
+	return TestResult();
+}
@@ -0,0 +1,378 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2019 Brian Amos
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#include <FreeRTOS.h>
+#include <task.h>
+#include <timers.h>
+#include "TestCheck.h"
+
+/**
+ * Host checks for the software timers, built with both backends of
+ * timers.c (the sorted lists and configUSE_TIMER_WHEEL, with the default
+ * wheel and one much smaller than the periods used) - see Makefile.
+ * Every callback checks that it runs on the tick a model of the timer
+ * says it should:
+ * 	- one-shot timers filed on each level of the wheel, or beyond it,
+ * 	  have to be moved down and expire on time
+ * 	- auto-reload timers
+ * 	- stopping, resetting and changing the period of a timer waiting on
+ * 	  an upper level
+ * 	- the tick count overflowing (configINITIAL_TICK_COUNT puts it
+ * 	  within reach), while timers on every level are running and while
+ * 	  the timer task is held up
+ * 	- a random mix of starts, stops, resets and period changes, running
+ * 	  across the overflow as well
+ */
+
+#define NUM_TIMERS		34
+#define NUM_RANDOM		24		//timers 0..NUM_RANDOM-1 are the random mix's
+
+typedef struct
+{
+	TimerHandle_t handle;
+	TickType_t period;
+	TickType_t expiry;
+	UBaseType_t autoReload;
+	BaseType_t active;
+	uint32_t fires;
+}TimerModel;
+
+static TimerModel timers[NUM_TIMERS];
+static uint32_t seed = 5;
+
+//how late the timer task may be, while the test holds it up
+static TickType_t lateTicks = 0;
+
+static uint32_t random( void )
+{
+	seed = seed * 1103515245 + 12345;
+	return seed >> 16;
+}
+
+static void timerCallback( TimerHandle_t Timer )
+{
+	TimerModel* model = &timers[(uintptr_t)pvTimerGetTimerID(Timer)];
+	const TickType_t now = xTaskGetTickCount();
+
+	CHECK(model->active);
+	CHECK((TickType_t)(now - model->expiry) <= lateTicks);
+	model->fires++;
+	if(model->autoReload)
+	{
+		model->expiry += model->period;
+	}
+	else
+	{
+		model->active = pdFALSE;
+	}
+}
+
+static void create( uint32_t Id, TickType_t Period, UBaseType_t AutoReload )
+{
+	timers[Id].period = Period;
+	timers[Id].autoReload = AutoReload;
+	timers[Id].active = pdFALSE;
+	timers[Id].fires = 0;
+	timers[Id].handle = xTimerCreate("timer", Period, AutoReload, (void*)(uintptr_t)Id, timerCallback);
+	CHECK(timers[Id].handle != NULL);
+}
+
+static void destroy( uint32_t Id )
+{
+	CHECK(xTimerDelete(timers[Id].handle, 0) == pdPASS);
+	timers[Id].active = pdFALSE;
+}
+
+//the timer task runs above this task, so each command is carried out
+//before the call returns, on the tick it was sent
+
+static void start( uint32_t Id )
+{
+	CHECK(xTimerStart(timers[Id].handle, 0) == pdPASS);
+	timers[Id].expiry = xTaskGetTickCount() + timers[Id].period;
+	timers[Id].active = pdTRUE;
+}
+
+static void reset( uint32_t Id )
+{
+	CHECK(xTimerReset(timers[Id].handle, 0) == pdPASS);
+	timers[Id].expiry = xTaskGetTickCount() + timers[Id].period;
+	timers[Id].active = pdTRUE;
+}
+
+static void stop( uint32_t Id )
+{
+	CHECK(xTimerStop(timers[Id].handle, 0) == pdPASS);
+	timers[Id].active = pdFALSE;
+}
+
+static void changePeriod( uint32_t Id, TickType_t Period )
+{
+	CHECK(xTimerChangePeriod(timers[Id].handle, Period, 0) == pdPASS);
+	timers[Id].period = Period;
+	timers[Id].expiry = xTaskGetTickCount() + Period;
+	timers[Id].active = pdTRUE;
+}
+
+/**
+ * the kernel agrees with the model about which timers are running, and
+ * every running timer expires within its period from now
+ */
+static void checkTimers( uint32_t First, uint32_t Count )
+{
+	const TickType_t now = xTaskGetTickCount();
+
+	for(uint32_t i = First; i < First + Count; i++)
+	{
+		CHECK((xTimerIsTimerActive(timers[i].handle) != pdFALSE) == (timers[i].active != pdFALSE));
+		if(timers[i].active)
+		{
+			CHECK(xTimerGetExpiryTime(timers[i].handle) == timers[i].expiry);
+			CHECK(timers[i].expiry - now - 1 < timers[i].period);
+		}
+	}
+}
+
+static void testLevels( void )
+{
+	//the default wheel's levels hold 32, 1024, 32768 and 1048576 ticks
+	static const TickType_t periods[] = {1, 2, 31, 32, 33, 1000, 1024, 1025, 5000, 32768, 40000, 70000};
+	const uint32_t count = sizeof(periods) / sizeof(periods[0]);
+
+	for(uint32_t i = 0; i < count; i++)
+	{
+		create(i, periods[i], pdFALSE);
+		start(i);
+	}
+	checkTimers(0, count);
+	vTaskDelay(periods[count - 1] + 10);
+	for(uint32_t i = 0; i < count; i++)
+	{
+		CHECK(timers[i].fires == 1);
+		destroy(i);
+	}
+}
+
+static void testAutoReload( void )
+{
+	create(0, 3, pdTRUE);
+	create(1, 700, pdTRUE);
+	create(2, 2000, pdTRUE);
+	start(0);
+	start(1);
+	start(2);
+	vTaskDelay(7000);
+	CHECK(timers[0].fires == 7000 / 3);
+	CHECK(timers[1].fires == 10);
+	CHECK(timers[2].fires == 3);
+	checkTimers(0, 3);
+
+	//stopping one leaves the others running
+	stop(1);
+	vTaskDelay(7000);
+	CHECK(timers[0].fires == 14000 / 3);
+	CHECK(timers[1].fires == 10);
+	CHECK(timers[2].fires == 7);
+	for(uint32_t i = 0; i < 3; i++)
+	{
+		destroy(i);
+	}
+}
+
+static void testUpperLevel( void )
+{
+	create(0, 3000, pdFALSE);
+	create(1, 3000, pdFALSE);
+
+	//a stopped timer waiting on an upper level never fires
+	start(0);
+	vTaskDelay(1000);
+	stop(0);
+	vTaskDelay(4000);
+	CHECK(timers[0].fires == 0);
+
+	//a reset one fires a whole period after the reset, once
+	start(0);
+	vTaskDelay(1500);
+	reset(0);
+	vTaskDelay(2999);
+	CHECK(timers[0].fires == 0);
+	vTaskDelay(1);
+	CHECK(timers[0].fires == 1);
+	vTaskDelay(4000);
+	CHECK(timers[0].fires == 1);
+
+	//a new period moves it to a lower level, or a higher one
+	start(0);
+	start(1);
+	vTaskDelay(1200);
+	changePeriod(0, 10);
+	changePeriod(1, 40000);
+	vTaskDelay(10);
+	CHECK(timers[0].fires == 2);
+	vTaskDelay(40000);
+	CHECK(timers[1].fires == 1);
+
+	//resetting a timer on the tick it was moved down a level: started at
+	//the start of a 1024 tick span, it's moved down 2048 ticks later
+	vTaskDelay(1024 - (xTaskGetTickCount() & 1023));
+	changePeriod(0, 3000);
+	vTaskDelay(2048);
+	reset(0);
+	vTaskDelay(2999);
+	CHECK(timers[0].fires == 2);
+	vTaskDelay(1);
+	CHECK(timers[0].fires == 3);
+	destroy(0);
+	destroy(1);
+}
+
+static void randomMix( TickType_t Ticks )
+{
+	const TickType_t begin = xTaskGetTickCount();
+
+	while((TickType_t)(xTaskGetTickCount() - begin) < Ticks)
+	{
+		uint32_t id = random() % NUM_RANDOM;
+		uint32_t r = random();
+		TickType_t period;
+
+		switch(r % 4)
+		{
+			case 0:		period = 1 + random() % 40;		break;
+			case 1:		period = 1 + random() % 2000;	break;
+			case 2:		period = 1 + random() % 40000;	break;
+			default:	period = 1 + random() * 7 % 200000;	break;
+		}
+
+		switch((r >> 2) % 5)
+		{
+			case 0:		start(id);					break;
+			case 1:		reset(id);					break;
+			case 2:		stop(id);					break;
+			default:	changePeriod(id, period);	break;
+		}
+		checkTimers(0, NUM_RANDOM);
+
+		if(r & 0x100)
+		{
+			vTaskDelay(random() % ((r & 0x200) ? 50 : 3000));
+		}
+	}
+}
+
+static void testOverflow( void )
+{
+	static const TickType_t periods[] = {50, 100, 101, 150, 1100, 5000, 40000};
+	const uint32_t count = sizeof(periods) / sizeof(periods[0]);
+	const uint32_t first = NUM_RANDOM;
+
+	//run the random mix up to 100 ticks before the tick count overflows,
+	//then start the timers that span it
+	for(uint32_t i = 0; i < NUM_RANDOM; i++)
+	{
+		create(i, 1 + random() % 1000, i & 1);
+	}
+	TickType_t beforeOverflow = (TickType_t)0 - xTaskGetTickCount();
+	CHECK(beforeOverflow > 200000);
+	randomMix(beforeOverflow - 5000);
+	vTaskDelay((TickType_t)0 - xTaskGetTickCount() - 100);
+	CHECK((TickType_t)0 - xTaskGetTickCount() == 100);
+
+	for(uint32_t i = 0; i < count; i++)
+	{
+		create(first + i, periods[i], pdFALSE);
+		start(first + i);
+	}
+	create(first + count, 30, pdTRUE);
+	start(first + count);
+	checkTimers(first, count + 1);
+
+	//timers started 30 ticks before the overflow, with the timer task held
+	//up until 30 ticks after it: everything due by then (including every
+	//period of the auto-reload timer) is processed late, then on time
+	const uint32_t late = first + count + 1;
+	vTaskDelay(70);
+	create(late, 10, pdTRUE);
+	create(late + 1, 45, pdFALSE);
+	vTaskSuspendAll();
+	start(late);
+	start(late + 1);
+	lateTicks = 60;
+	for(uint32_t i = 0; i < lateTicks; i++)
+	{
+		vPortHostTick();
+	}
+	(void) xTaskResumeAll();
+	lateTicks = 0;
+	CHECK(xTaskGetTickCount() == 30);
+	CHECK(timers[late].fires == 6);
+	CHECK(timers[late + 1].fires == 1);
+	CHECK(timers[first + 1].fires == 1);
+	CHECK(timers[first + count].fires == 4);
+	checkTimers(first, count + 3);
+	vTaskDelay(100);
+	CHECK(timers[late].fires == 16);
+	stop(late);
+
+	//an upper level timer stopped, and one reset, across the overflow
+	vTaskDelay(70);
+	CHECK(xTaskGetTickCount() == 200);
+	stop(first + 5);
+	reset(first + 4);
+	vTaskDelay(periods[count - 1]);
+	for(uint32_t i = 0; i < count; i++)
+	{
+		CHECK(timers[first + i].fires == (i == 5 ? 0 : 1));
+	}
+	CHECK(timers[first + count].fires == (40000 + 300) / 30);
+	stop(first + count);
+
+	//and the random timers carry on after it
+	randomMix(200000);
+	for(uint32_t i = 0; i < NUM_RANDOM; i++)
+	{
+		CHECK(timers[i].fires > 0);
+		stop(i);
+	}
+	vTaskDelay(200000);
+	checkTimers(0, NUM_TIMERS);
+}
+
+static void testTask( void* Arg )
+{
+	(void) Arg;
+	testLevels();
+	testAutoReload();
+	testUpperLevel();
+	testOverflow();
+	vTaskEndScheduler();
+}
+
+int main( void )
+{
+	xTaskCreate(testTask, "test", configMINIMAL_STACK_SIZE, NULL, 2, NULL);
+	vTaskStartScheduler();
+	return TestResult();
+}